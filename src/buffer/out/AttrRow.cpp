@@ -3,19 +3,25 @@
 
 #include "precomp.h"
 #include "AttrRow.hpp"
+#include "textBuffer.hpp"
 
 // Routine Description:
 // - constructor
 // Arguments:
 // - cchRowWidth - the length of the default text attribute
 // - attr - the default text attribute
+// - pParent - the buffer the row belongs to, if any. It keeps count of the
+//   hyperlinks the row refers to.
 // Return Value:
 // - constructed object
-ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr) noexcept
+ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr, TextBuffer* const pParent) noexcept :
+    _pParent{ pParent }
 {
     try
     {
-        _list.emplace_back(TextAttributeRun(cchRowWidth, attr));
+        _attrs.emplace_back(attr);
+        _list.push_back({ gsl::narrow<uint16_t>(cchRowWidth), 0 });
+        _ReferenceHyperlink(attr);
     }
     catch (...)
     {
@@ -24,14 +30,85 @@ ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr) noexcept
     _cchRowWidth = cchRowWidth;
 }
 
+ATTR_ROW::~ATTR_ROW()
+{
+    _ReleaseHyperlinks();
+}
+
+// Routine Description:
+// - Copies the row. The copy belongs to the same buffer, so its attributes
+//   count as further references to their hyperlinks.
+ATTR_ROW::ATTR_ROW(const ATTR_ROW& other) :
+    _list{ other._list },
+    _attrs{ other._attrs },
+    _cchRowWidth{ other._cchRowWidth },
+    _pParent{ other._pParent }
+{
+    for (const auto& attr : _attrs)
+    {
+        _ReferenceHyperlink(attr);
+    }
+}
+
+ATTR_ROW& ATTR_ROW::operator=(const ATTR_ROW& other)
+{
+    if (this != &other)
+    {
+        auto copy{ other };
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// Routine Description:
+// - Moves the row. The references to hyperlinks move along with it.
+ATTR_ROW::ATTR_ROW(ATTR_ROW&& other) noexcept :
+    _list{ std::move(other._list) },
+    _attrs{ std::move(other._attrs) },
+    _cchRowWidth{ other._cchRowWidth },
+    _pParent{ std::exchange(other._pParent, nullptr) }
+{
+}
+
+ATTR_ROW& ATTR_ROW::operator=(ATTR_ROW&& other) noexcept
+{
+    if (this != &other)
+    {
+        _ReleaseHyperlinks();
+        _list = std::move(other._list);
+        _attrs = std::move(other._attrs);
+        _cchRowWidth = other._cchRowWidth;
+        _pParent = std::exchange(other._pParent, nullptr);
+    }
+    return *this;
+}
+
+// Routine Description:
+// - Stops counting the hyperlinks of this row towards its buffer. This is for
+//   rows that outlive their buffer, which must not hear about them anymore.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ATTR_ROW::Detach() noexcept
+{
+    _pParent = nullptr;
+}
+
 // Routine Description:
 // - Sets all properties of the ATTR_ROW to default values
 // Arguments:
 // - attr - The default text attributes to use on text in this row.
 void ATTR_ROW::Reset(const TextAttribute attr)
 {
+    // Hold on to the new hyperlink before letting go of the old ones, in case
+    // they're the same.
+    _ReferenceHyperlink(attr);
+    _ReleaseHyperlinks();
+    _attrs.clear();
+    _attrs.emplace_back(attr);
     _list.clear();
-    _list.emplace_back(TextAttributeRun(_cchRowWidth, attr));
+    _list.push_back({ gsl::narrow_cast<uint16_t>(_cchRowWidth), 0 });
 }
 
 // Routine Description:
@@ -46,6 +123,7 @@ void ATTR_ROW::Reset(const TextAttribute attr)
 void ATTR_ROW::Resize(const size_t newWidth)
 {
     THROW_HR_IF(E_INVALIDARG, 0 == newWidth);
+    THROW_HR_IF(E_INVALIDARG, newWidth > std::numeric_limits<uint16_t>::max());
 
     // Easy case. If the new row is longer, increase the length of the last run by how much new space there is.
     if (newWidth > _cchRowWidth)
@@ -55,7 +133,7 @@ void ATTR_ROW::Resize(const size_t newWidth)
         auto& run = _list.at(runPos);
 
         // Extend its length by the additional columns we're adding.
-        run.SetLength(run.GetLength() + newWidth - _cchRowWidth);
+        run.length = gsl::narrow_cast<uint16_t>(run.length + newWidth - _cchRowWidth);
 
         // Store that the new total width we represent is the new width.
         _cchRowWidth = newWidth;
@@ -73,7 +151,7 @@ void ATTR_ROW::Resize(const size_t newWidth)
         // then when we called FindAttrIndex, it returned the B5 as the pIndexedRun and a 2 for how many more segments it covers
         // after and including the 3rd column.
         // B5-2 = B3, which is what we desire to cover the new 3 size buffer.
-        run.SetLength(run.GetLength() - CountOfAttr + 1);
+        run.length = gsl::narrow_cast<uint16_t>(run.length - CountOfAttr + 1);
 
         // Store that the new total width we represent is the new width.
         _cchRowWidth = newWidth;
@@ -84,6 +162,9 @@ void ATTR_ROW::Resize(const size_t newWidth)
         // NOTE: Under some circumstances here, we have leftover run segments in memory or blank run segments
         // in memory. We're not going to waste time redimensioning the array in the heap. We're just noting that the useful
         // portions of it have changed.
+
+        // The erased runs might have been the only users of some of our attributes.
+        _CompactAttrs();
     }
 }
 
@@ -114,7 +195,7 @@ TextAttribute ATTR_ROW::GetAttrByColumn(const size_t column,
 {
     THROW_HR_IF(E_INVALIDARG, column >= _cchRowWidth);
     const auto runPos = FindAttrIndex(column, pApplies);
-    return _list.at(runPos).GetAttributes();
+    return _attrs.at(_list.at(runPos).attrIndex);
 }
 
 // Routine Description:
@@ -126,6 +207,58 @@ size_t ATTR_ROW::GetNumberOfRuns() const noexcept
     return _list.size();
 }
 
+// Routine Description:
+// - Gets the runs of this row, for callers that walk all of them at once.
+// Return Value:
+// - The runs, in column order. Their attrIndex indexes into Attrs().
+gsl::span<const ATTR_ROW::Run> ATTR_ROW::Runs() const noexcept
+{
+    return { _list.data(), _list.size() };
+}
+
+// Routine Description:
+// - Gets the distinct attributes that the runs of this row use.
+// Return Value:
+// - The attributes, indexed by the attrIndex of the runs.
+gsl::span<const TextAttribute> ATTR_ROW::Attrs() const noexcept
+{
+    return { _attrs.data(), _attrs.size() };
+}
+
+// Routine Description:
+// - Gets the runs that cover a span of this row, cut to the span, in a form
+//   that InsertAttrRuns takes back.
+// Arguments:
+// - column - the first column of the span
+// - count - how many columns the span covers
+// Return Value:
+// - The runs, in column order.
+// Note:
+// - will throw on error
+std::vector<TextAttributeRun> ATTR_ROW::GetAttrRuns(const size_t column, const size_t count) const
+{
+    THROW_HR_IF(E_INVALIDARG, column + count > _cchRowWidth);
+
+    std::vector<TextAttributeRun> runs;
+    size_t runStart = 0;
+    for (const auto& run : _list)
+    {
+        const auto runEnd = runStart + run.length;
+        const auto start = std::max(runStart, column);
+        const auto end = std::min(runEnd, column + count);
+        if (start < end)
+        {
+            runs.emplace_back(end - start, _attrs.at(run.attrIndex));
+        }
+        if (runEnd >= column + count)
+        {
+            break;
+        }
+        runStart = runEnd;
+    }
+    return runs;
+}
+
 // Routine Description:
 // - This routine finds the nth attribute in this ATTR_ROW.
 // Arguments:
@@ -147,7 +280,7 @@ size_t ATTR_ROW::FindAttrIndex(const size_t index, size_t* const pApplies) const
     auto runPos = _list.cbegin();
     do
     {
-        cTotalLength += runPos->GetLength();
+        cTotalLength += runPos->length;
 
         if (cTotalLength > index)
         {
@@ -190,9 +323,10 @@ std::vector<uint16_t> ATTR_ROW::GetHyperlinks()
     std::vector<uint16_t> ids;
     for (const auto& run : _list)
     {
-        if (run.GetAttributes().IsHyperlink())
+        const auto& attr = _attrs.at(run.attrIndex);
+        if (attr.IsHyperlink())
         {
-            ids.emplace_back(run.GetAttributes().GetHyperlinkId());
+            ids.emplace_back(attr.GetHyperlinkId());
         }
     }
     return ids;
@@ -223,11 +357,34 @@ bool ATTR_ROW::SetAttrToEnd(const UINT iStart, const TextAttribute attr)
 // - <none>
 void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith) noexcept
 {
+    const auto toBeReplaced = std::find(_attrs.begin(), _attrs.end(), toBeReplacedAttr);
+    if (toBeReplaced == _attrs.end())
+    {
+        return;
+    }
+
+    // Every attribute is stored only once, so if we already have the new
+    // one, the matching runs have to be pointed at it instead.
+    const auto existing = std::find(_attrs.cbegin(), _attrs.cend(), replaceWith);
+    if (existing == _attrs.cend())
+    {
+        try
+        {
+            _ReferenceHyperlink(replaceWith);
+        }
+        CATCH_LOG();
+        _ReleaseHyperlink(*toBeReplaced);
+        *toBeReplaced = replaceWith;
+        return;
+    }
+
+    const auto from = gsl::narrow_cast<uint16_t>(toBeReplaced - _attrs.begin());
+    const auto to = gsl::narrow_cast<uint16_t>(existing - _attrs.cbegin());
     for (auto& run : _list)
     {
-        if (run.GetAttributes() == toBeReplacedAttr)
+        if (run.attrIndex == from)
         {
-            run.SetAttributes(replaceWith);
+            run.attrIndex = to;
         }
     }
 }
@@ -273,11 +430,11 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     if (newAttrs.size() == 1)
     {
         // Get the new color attribute we're trying to apply
-        const TextAttribute NewAttr = til::at(newAttrs, 0).GetAttributes();
+        const auto NewAttr = _InternAttr(til::at(newAttrs, 0).GetAttributes());
 
         // If the existing run was only 1 element...
         // ...and the new color is the same as the old, we don't have to do anything and can exit quick.
-        if (_list.size() == 1 && _list.at(0).GetAttributes() == NewAttr)
+        if (_list.size() == 1 && _list.at(0).attrIndex == NewAttr)
         {
             return S_OK;
         }
@@ -293,7 +450,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
             for (size_t i = 0; i < _list.size(); i++)
             {
                 const auto curr = begin + i;
-                upperBound += curr->GetLength();
+                upperBound += curr->length;
 
                 if (iStart >= lowerBound && iStart < upperBound)
                 {
@@ -305,7 +462,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                     //
                     // 'B' is the new color and '^' represents where iStart is. We don't have to
                     // do anything.
-                    if (curr->GetAttributes() == NewAttr)
+                    if (curr->attrIndex == NewAttr)
                     {
                         return S_OK;
                     }
@@ -318,9 +475,10 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                     // AAAAADCCCCCCCCC
                     //
                     // Here 'D' is the new color.
-                    if (curr->GetLength() == 1)
+                    if (curr->length == 1)
                     {
-                        curr->SetAttributes(NewAttr);
+                        curr->attrIndex = NewAttr;
+                        _CompactAttrs();
                         return S_OK;
                     }
 
@@ -336,15 +494,16 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                         // AAAAAABBBBBBCCC
                         //
                         // Here 'A' is the new color.
-                        if (NewAttr == prev->GetAttributes())
+                        if (NewAttr == prev->attrIndex)
                         {
-                            prev->IncrementLength();
-                            curr->DecrementLength();
+                            prev->length++;
+                            curr->length--;
 
                             // If we just reduced the right half to zero, just erase it out of the list.
-                            if (curr->GetLength() == 0)
+                            if (curr->length == 0)
                             {
                                 _list.erase(curr);
+                                _CompactAttrs();
                             }
 
                             return S_OK;
@@ -363,14 +522,15 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                         //
                         // Here 'B' is the new color.
                         const auto next = std::next(curr, 1);
-                        if (NewAttr == next->GetAttributes())
+                        if (NewAttr == next->attrIndex)
                         {
-                            curr->DecrementLength();
-                            next->IncrementLength();
+                            curr->length--;
+                            next->length++;
 
-                            if (curr->GetLength() == 0)
+                            if (curr->length == 0)
                             {
                                 _list.erase(curr);
+                                _CompactAttrs();
                             }
 
                             return S_OK;
@@ -395,11 +555,33 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     if (iStart == 0 && iEnd == iLastBufferCol)
     {
         // Just dump what we're given over what we have and call it a day.
-        _list.assign(newAttrs.begin(), newAttrs.end());
+        // None of our existing attributes will survive this, so start over with those as well.
+        // They let go of their hyperlinks only once the new ones hold on to theirs,
+        // so that a hyperlink both of them refer to isn't dropped in between.
+        decltype(_attrs) oldAttrs;
+        oldAttrs.swap(_attrs);
+        _list.clear();
+        _list.reserve(newAttrs.size());
+        for (const auto& attr : newAttrs)
+        {
+            _list.push_back({ gsl::narrow<uint16_t>(attr.GetLength()), _InternAttr(attr.GetAttributes()) });
+        }
+        for (const auto& attr : oldAttrs)
+        {
+            _ReleaseHyperlink(attr);
+        }
 
         return S_OK;
     }
 
+    // Translate the runs we were given into runs of our own.
+    boost::container::small_vector<Run, 2> insertRuns;
+    insertRuns.reserve(newAttrs.size());
+    for (const auto& attr : newAttrs)
+    {
+        insertRuns.push_back({ gsl::narrow<uint16_t>(attr.GetLength()), _InternAttr(attr.GetAttributes()) });
+    }
+
     // In the worst case scenario, we will need a new run that is the length of
     // The existing run in memory + The new run in memory + 1.
     // This worst case occurs when we inject a new item in the middle of an existing run like so
@@ -418,8 +600,8 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     const auto existingRun = _list.begin();
     auto pExistingRunPos = existingRun;
     const auto pExistingRunEnd = _list.end();
-    auto pInsertRunPos = newAttrs.begin();
-    size_t cInsertRunRemaining = newAttrs.size();
+    auto pInsertRunPos = insertRuns.cbegin();
+    size_t cInsertRunRemaining = insertRuns.size();
     size_t iExistingRunCoverage = 0;
 
     // Copy the existing run into the new buffer up to the "start index" where the new run will be injected.
@@ -430,7 +612,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
         while (iExistingRunCoverage < iStart)
         {
             // Add up how much length we can cover by copying an item from the existing run.
-            iExistingRunCoverage += pExistingRunPos->GetLength();
+            iExistingRunCoverage += pExistingRunPos->length;
 
             // Copy it to the new run buffer and advance both pointers.
             newRun.push_back(*pExistingRunPos++);
@@ -453,7 +635,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
         //      the new/final run.
 
         // Fetch out the length so we can fix it up based on the below conditions.
-        size_t length = newRun.back().GetLength();
+        size_t length = newRun.back().length;
 
         // If we've covered more cells already than the start of the attributes to be inserted...
         if (iExistingRunCoverage > iStart)
@@ -468,9 +650,9 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
         // Now we're still on that "last cell copied" into the new run.
         // If the color of that existing copied cell matches the color of the first segment
         // of the run we're about to insert, we can just increment the length to extend the coverage.
-        if (newRun.back().GetAttributes() == pInsertRunPos->GetAttributes())
+        if (newRun.back().attrIndex == pInsertRunPos->attrIndex)
         {
-            length += pInsertRunPos->GetLength();
+            length += pInsertRunPos->length;
 
             // Since the color matched, we have already "used up" part of the insert run
             // and can skip it in our big "memcopy" step below that will copy the bulk of the insert run.
@@ -479,7 +661,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
         }
 
         // We're done manipulating the length. Store it back.
-        newRun.back().SetLength(length);
+        newRun.back().length = gsl::narrow_cast<uint16_t>(length);
     }
 
     // Bulk copy the majority (or all, depending on circumstance) of the insert run into the final run buffer.
@@ -493,7 +675,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     while (iExistingRunCoverage <= iEnd)
     {
         FAIL_FAST_IF(!(pExistingRunPos != pExistingRunEnd));
-        iExistingRunCoverage += pExistingRunPos->GetLength();
+        iExistingRunCoverage += pExistingRunPos->length;
         pExistingRunPos++;
     }
 
@@ -523,26 +705,21 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
             // This case is slightly off from the example above. This case is for if the B2 above was actually Y2.
             // That Y2 from the existing run is the same color as the Y2 we just filled a few columns left in the final run
             // so we can just adjust the final run's column count instead of adding another segment here.
-            if (newRun.back().GetAttributes() == pExistingRunPos->GetAttributes())
+            if (newRun.back().attrIndex == pExistingRunPos->attrIndex)
             {
-                size_t length = newRun.back().GetLength();
+                size_t length = newRun.back().length;
                 length += (iExistingRunCoverage - (iEnd + 1));
-                newRun.back().SetLength(length);
+                newRun.back().length = gsl::narrow_cast<uint16_t>(length);
             }
             else
             {
                 // If the color didn't match, then we just need to copy the piece we skipped and adjust
                 // its length for the discrepancy in columns not yet covered by the final/new run.
 
-                // Move forward to a blank spot in the new run
-                newRun.emplace_back();
-
-                // Copy the existing run's color information to the new run
-                newRun.back().SetAttributes(pExistingRunPos->GetAttributes());
-
-                // Adjust the length of that copied color to cover only the reduced number of columns needed
+                // Copy the existing run's color information to the new run and adjust the length
+                // of that copied color to cover only the reduced number of columns needed
                 // now that some have been replaced by the insert run.
-                newRun.back().SetLength(iExistingRunCoverage - (iEnd + 1));
+                newRun.push_back({ gsl::narrow_cast<uint16_t>(iExistingRunCoverage - (iEnd + 1)), pExistingRunPos->attrIndex });
             }
 
             // Now that we're done recovering a piece of the existing run we skipped, move the pointer forward again.
@@ -560,12 +737,12 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
         // New Run desired when done = R3 -> B7
         // Existing run pointer is on B2.
         // We want to merge the 2 from the B2 into the B5 so we get B7.
-        else if (newRun.back().GetAttributes() == pExistingRunPos->GetAttributes())
+        else if (newRun.back().attrIndex == pExistingRunPos->attrIndex)
         {
             // Add the value from the existing run into the current new run position.
-            size_t length = newRun.back().GetLength();
-            length += pExistingRunPos->GetLength();
-            newRun.back().SetLength(length);
+            size_t length = newRun.back().length;
+            length += pExistingRunPos->length;
+            newRun.back().length = gsl::narrow_cast<uint16_t>(length);
 
             // Advance the existing run position since we consumed its value and merged it in.
             pExistingRunPos++;
@@ -581,6 +758,9 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     // OK, phew. We're done. Now we just need to free the existing run and store the new run in its place.
     _list.swap(newRun);
 
+    // Some of our attributes might not be covering any columns anymore.
+    _CompactAttrs();
+
     return S_OK;
 }
 
@@ -631,6 +811,108 @@ ATTR_ROW::const_iterator ATTR_ROW::cend() const noexcept
     return AttrRowIterator::CreateEndIterator(this);
 }
 
+// Routine Description:
+// - Finds the given attribute among the ones used by this row, adding it if it isn't there yet.
+// Arguments:
+// - attr - the attribute to find
+// Return Value:
+// - the index of the attribute in _attrs
+// Note:
+// - will throw on error
+uint16_t ATTR_ROW::_InternAttr(const TextAttribute& attr)
+{
+    // Rows rarely use more than a handful of distinct attributes, so a linear
+    // scan beats hashing the attribute.
+    const auto it = std::find(_attrs.cbegin(), _attrs.cend(), attr);
+    if (it != _attrs.cend())
+    {
+        return gsl::narrow_cast<uint16_t>(it - _attrs.cbegin());
+    }
+
+    const auto index = gsl::narrow<uint16_t>(_attrs.size());
+    _attrs.emplace_back(attr);
+    _ReferenceHyperlink(attr);
+    return index;
+}
+
+// Routine Description:
+// - Drops the attributes that are no longer used by any run. This is only done once
+//   there are twice as many attributes as runs, so that recoloring a single cell over
+//   and over again doesn't rebuild the table every time.
+// Note:
+// - will throw on error
+void ATTR_ROW::_CompactAttrs()
+{
+    if (_attrs.size() <= _list.size() * 2)
+    {
+        return;
+    }
+
+    static constexpr auto unmapped = std::numeric_limits<uint16_t>::max();
+    std::vector<uint16_t> remap(_attrs.size(), unmapped);
+    decltype(_attrs) attrs;
+
+    for (auto& run : _list)
+    {
+        auto& mapped = til::at(remap, run.attrIndex);
+        if (mapped == unmapped)
+        {
+            mapped = gsl::narrow_cast<uint16_t>(attrs.size());
+            attrs.emplace_back(til::at(_attrs, run.attrIndex));
+        }
+        run.attrIndex = mapped;
+    }
+
+    for (size_t index = 0; index < remap.size(); ++index)
+    {
+        if (til::at(remap, index) == unmapped)
+        {
+            _ReleaseHyperlink(til::at(_attrs, index));
+        }
+    }
+
+    _attrs.swap(attrs);
+}
+
+// Routine Description:
+// - Tells the buffer that one more attribute of this row refers to the
+//   hyperlink of the given attribute, if it has one.
+// Arguments:
+// - attr - the attribute that was added to _attrs
+// Note:
+// - will throw on error
+void ATTR_ROW::_ReferenceHyperlink(const TextAttribute& attr)
+{
+    if (_pParent && attr.IsHyperlink())
+    {
+        _pParent->AddHyperlinkReference(attr.GetHyperlinkId());
+    }
+}
+
+// Routine Description:
+// - Tells the buffer that one less attribute of this row refers to the
+//   hyperlink of the given attribute, if it has one.
+// Arguments:
+// - attr - the attribute that is about to leave _attrs
+void ATTR_ROW::_ReleaseHyperlink(const TextAttribute& attr) noexcept
+{
+    if (_pParent && attr.IsHyperlink())
+    {
+        _pParent->RemoveHyperlinkReference(attr.GetHyperlinkId());
+    }
+}
+
+// Routine Description:
+// - Releases the hyperlinks of all the attributes in _attrs, before they're
+//   thrown away at once.
+void ATTR_ROW::_ReleaseHyperlinks() noexcept
+{
+    for (const auto& attr : _attrs)
+    {
+        _ReleaseHyperlink(attr);
+    }
+}
+
 bool operator==(const ATTR_ROW& a, const ATTR_ROW& b) noexcept
 {
     return (a._list.size() == b._list.size() &&
@@ -23,21 +23,34 @@ Revision History:
 #include "TextAttributeRun.hpp"
 #include "AttrRowIterator.hpp"
 
+class TextBuffer;
+
 class ATTR_ROW final
 {
 public:
     using const_iterator = typename AttrRowIterator;
 
-    ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr)
+    // A run of columns that share one of the attributes in _attrs. Runs are
+    // kept this small so that walking them, e.g. to find the attribute of a
+    // column, touches as little memory as possible.
+    struct Run
+    {
+        uint16_t length;
+        uint16_t attrIndex;
+    };
+
+    ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr, TextBuffer* const pParent = nullptr)
     noexcept;
 
-    ~ATTR_ROW() = default;
+    ~ATTR_ROW();
+
+    ATTR_ROW(const ATTR_ROW& other);
+    ATTR_ROW& operator=(const ATTR_ROW& other);
+    ATTR_ROW(ATTR_ROW&& other)
+    noexcept;
+    ATTR_ROW& operator=(ATTR_ROW&& other) noexcept;
 
-    ATTR_ROW(const ATTR_ROW&) = default;
-    ATTR_ROW& operator=(const ATTR_ROW&) = default;
-    ATTR_ROW(ATTR_ROW&&)
-    noexcept = default;
-    ATTR_ROW& operator=(ATTR_ROW&&) noexcept = default;
+    void Detach() noexcept;
 
     void Reset(const TextAttribute attr);
 
@@ -46,6 +59,9 @@ public:
                                   size_t* const pApplies) const;
 
     size_t GetNumberOfRuns() const noexcept;
+    gsl::span<const Run> Runs() const noexcept;
+    gsl::span<const TextAttribute> Attrs() const noexcept;
+    std::vector<TextAttributeRun> GetAttrRuns(const size_t column, const size_t count) const;
 
     size_t FindAttrIndex(const size_t index,
                          size_t* const pApplies) const;
@@ -74,9 +90,25 @@ public:
     friend class AttrRowIterator;
 
 private:
-    boost::container::small_vector<TextAttributeRun, 1> _list;
+    uint16_t _InternAttr(const TextAttribute& attr);
+    void _CompactAttrs();
+
+    void _ReferenceHyperlink(const TextAttribute& attr);
+    void _ReleaseHyperlink(const TextAttribute& attr) noexcept;
+    void _ReleaseHyperlinks() noexcept;
+
+    boost::container::small_vector<Run, 1> _list;
+
+    // The distinct attributes used by the runs of this row. Every attribute
+    // is stored once, so two runs have the same attribute exactly when their
+    // attrIndex is the same.
+    boost::container::small_vector<TextAttribute, 1> _attrs;
     size_t _cchRowWidth;
 
+    // The buffer that keeps count of the hyperlinks the attributes in _attrs
+    // refer to, if this row belongs to one.
+    TextBuffer* _pParent; // non ownership pointer
+
 #ifdef UNIT_TESTING
     friend class AttrRowTests;
 #endif
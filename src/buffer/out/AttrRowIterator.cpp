@@ -15,7 +15,7 @@ AttrRowIterator AttrRowIterator::CreateEndIterator(const ATTR_ROW* const attrRow
 
 AttrRowIterator::AttrRowIterator(const ATTR_ROW* const attrRow) noexcept :
     _pAttrRow{ attrRow },
-    _run{ attrRow->_list.cbegin() },
+    _run{ 0 },
     _currentAttributeIndex{ 0 },
     _exceeded{ false }
 {
@@ -23,7 +23,7 @@ AttrRowIterator::AttrRowIterator(const ATTR_ROW* const attrRow) noexcept :
 
 AttrRowIterator::operator bool() const noexcept
 {
-    return !_exceeded && _run < _pAttrRow->_list.cend();
+    return !_exceeded && _run < _pAttrRow->_list.size();
 }
 
 bool AttrRowIterator::operator==(const AttrRowIterator& it) const noexcept
@@ -64,13 +64,13 @@ AttrRowIterator& AttrRowIterator::operator-=(const ptrdiff_t& movement)
 const TextAttribute* AttrRowIterator::operator->() const
 {
     THROW_HR_IF(E_BOUNDS, _exceeded);
-    return &_run->GetAttributes();
+    return &_pAttrRow->_attrs.at(_pAttrRow->_list.at(_run).attrIndex);
 }
 
 const TextAttribute& AttrRowIterator::operator*() const
 {
     THROW_HR_IF(E_BOUNDS, _exceeded);
-    return _run->GetAttributes();
+    return _pAttrRow->_attrs.at(_pAttrRow->_list.at(_run).attrIndex);
 }
 
 // Routine Description:
@@ -81,7 +81,7 @@ void AttrRowIterator::_increment(size_t count) noexcept
 {
     while (count > 0)
     {
-        const size_t runLength = _run->GetLength();
+        const size_t runLength = til::at(_pAttrRow->_list, _run).length;
         if (count + _currentAttributeIndex < runLength)
         {
             _currentAttributeIndex += count;
@@ -115,14 +115,14 @@ void AttrRowIterator::_decrement(size_t count) noexcept
         else
         {
             // make sure we don't go out of bounds
-            if (_run == _pAttrRow->_list.cbegin())
+            if (_run == 0)
             {
                 _exceeded = true;
                 return;
             }
             count -= _currentAttributeIndex + 1;
             --_run;
-            _currentAttributeIndex = _run->GetLength() - 1;
+            _currentAttributeIndex = til::at(_pAttrRow->_list, _run).length - 1;
         }
     }
 }
@@ -131,6 +131,6 @@ void AttrRowIterator::_decrement(size_t count) noexcept
 // - sets fields on the iterator to describe the end() state of the ATTR_ROW
 void AttrRowIterator::_setToEnd() noexcept
 {
-    _run = _pAttrRow->_list.cend();
+    _run = _pAttrRow->_list.size();
     _currentAttributeIndex = 0;
 }
@@ -69,7 +69,7 @@ public:
     const TextAttribute& operator*() const;
 
 private:
-    boost::container::small_vector_base<TextAttributeRun>::const_iterator _run;
+    size_t _run; // index of the current run within the ATTR_ROW
     const ATTR_ROW* _pAttrRow;
     size_t _currentAttributeIndex; // index of TextAttribute within the current TextAttributeRun
     bool _exceeded;
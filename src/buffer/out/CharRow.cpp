@@ -20,7 +20,9 @@
 CharRow::CharRow(size_t rowWidth, ROW* const pParent) noexcept :
     _wrapForced{ false },
     _doubleBytePadded{ false },
-    _data(rowWidth, value_type()),
+    _chars(rowWidth, UNICODE_SPACE),
+    _dbcsAttrs(rowWidth, DbcsAttribute{}),
+    _unicodeStorage{},
     _pParent{ FAIL_FAST_IF_NULL(pParent) }
 {
 }
@@ -78,7 +80,7 @@ bool CharRow::WasDoubleBytePadded() const noexcept
 // - the size of the row
 size_t CharRow::size() const noexcept
 {
-    return _data.size();
+    return _chars.size();
 }
 
 // Routine Description:
@@ -89,10 +91,9 @@ size_t CharRow::size() const noexcept
 // - <none>
 void CharRow::Reset() noexcept
 {
-    for (auto& cell : _data)
-    {
-        cell.Reset();
-    }
+    std::fill(_chars.begin(), _chars.end(), UNICODE_SPACE);
+    std::fill(_dbcsAttrs.begin(), _dbcsAttrs.end(), DbcsAttribute{});
+    _unicodeStorage.Clear();
 
     _wrapForced = false;
     _doubleBytePadded = false;
@@ -108,34 +109,15 @@ void CharRow::Reset() noexcept
 {
     try
     {
-        const value_type insertVals;
-        _data.resize(newSize, insertVals);
+        _chars.resize(newSize, UNICODE_SPACE);
+        _dbcsAttrs.resize(newSize, DbcsAttribute{});
+        _unicodeStorage.Trim(newSize);
     }
     CATCH_RETURN();
 
     return S_OK;
 }
 
-typename CharRow::iterator CharRow::begin() noexcept
-{
-    return _data.begin();
-}
-
-typename CharRow::const_iterator CharRow::cbegin() const noexcept
-{
-    return _data.cbegin();
-}
-
-typename CharRow::iterator CharRow::end() noexcept
-{
-    return _data.end();
-}
-
-typename CharRow::const_iterator CharRow::cend() const noexcept
-{
-    return _data.cend();
-}
-
 // Routine Description:
 // - Inspects the current internal string to find the left edge of it
 // Arguments:
@@ -144,12 +126,12 @@ typename CharRow::const_iterator CharRow::cend() const noexcept
 // - The calculated left boundary of the internal string.
 size_t CharRow::MeasureLeft() const noexcept
 {
-    const_iterator it = _data.cbegin();
-    while (it != _data.cend() && it->IsSpace())
+    size_t column = 0;
+    while (column < _chars.size() && _IsSpaceAt(column))
     {
-        ++it;
+        ++column;
     }
-    return it - _data.cbegin();
+    return column;
 }
 
 // Routine Description:
@@ -160,17 +142,19 @@ size_t CharRow::MeasureLeft() const noexcept
 // - The calculated right boundary of the internal string.
 size_t CharRow::MeasureRight() const
 {
-    const_reverse_iterator it = _data.crbegin();
-    while (it != _data.crend() && it->IsSpace())
+    size_t column = _chars.size();
+    while (column > 0 && _IsSpaceAt(column - 1))
     {
-        ++it;
+        --column;
     }
-    return _data.crend() - it;
+    return column;
 }
 
 void CharRow::ClearCell(const size_t column)
 {
-    _data.at(column).Reset();
+    _chars.at(column) = UNICODE_SPACE;
+    _dbcsAttrs.at(column).Reset();
+    _unicodeStorage.Erase(column);
 }
 
 // Routine Description:
@@ -181,9 +165,9 @@ void CharRow::ClearCell(const size_t column)
 // - True if there is valid text in this row. False otherwise.
 bool CharRow::ContainsText() const noexcept
 {
-    for (const value_type& cell : _data)
+    for (size_t column = 0; column < _chars.size(); ++column)
     {
-        if (!cell.IsSpace())
+        if (!_IsSpaceAt(column))
         {
             return true;
         }
@@ -200,7 +184,7 @@ bool CharRow::ContainsText() const noexcept
 // Note: will throw exception if column is out of bounds
 const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 {
-    return _data.at(column).DbcsAttr();
+    return _dbcsAttrs.at(column);
 }
 
 // Routine Description:
@@ -212,7 +196,7 @@ const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 // Note: will throw exception if column is out of bounds
 DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 {
-    return _data.at(column).DbcsAttr();
+    return _dbcsAttrs.at(column);
 }
 
 // Routine Description:
@@ -224,7 +208,86 @@ DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 // Note: will throw exception if column is out of bounds
 void CharRow::ClearGlyph(const size_t column)
 {
-    _data.at(column).EraseChars();
+    _chars.at(column) = UNICODE_SPACE;
+    _dbcsAttrs.at(column).SetGlyphStored(false);
+    _unicodeStorage.Erase(column);
+}
+
+// Routine Description:
+// - Copies a span of cells from the given row into this one. The source may
+//   be this row, in which case the spans may overlap.
+// Arguments:
+// - source - the row to copy the cells from
+// - sourceColumn - the first column to copy from
+// - targetColumn - the first column to copy to
+// - count - how many cells to copy
+// Return Value:
+// - <none>
+// Note: will throw exception if either span is out of bounds
+void CharRow::CopyCells(const CharRow& source, const size_t sourceColumn, const size_t targetColumn, const size_t count)
+{
+    THROW_HR_IF(E_INVALIDARG, sourceColumn + count > source.size() || targetColumn + count > size());
+
+    // The glyphs that don't fit into a single wchar_t are kept by column, so
+    // they're taken out before the target span is overwritten. All of them
+    // have to be read before any are erased, since the spans may overlap.
+    std::vector<std::pair<size_t, std::wstring>> storedGlyphs;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (source._dbcsAttrs.at(sourceColumn + i).IsGlyphStored())
+        {
+            storedGlyphs.emplace_back(targetColumn + i, source._unicodeStorage.GetText(sourceColumn + i));
+        }
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (_dbcsAttrs.at(targetColumn + i).IsGlyphStored())
+        {
+            _unicodeStorage.Erase(targetColumn + i);
+        }
+    }
+
+    const auto chars = source._chars.begin() + sourceColumn;
+    const auto dbcsAttrs = source._dbcsAttrs.begin() + sourceColumn;
+    if (&source == this && targetColumn > sourceColumn)
+    {
+        std::copy_backward(chars, chars + count, _chars.begin() + targetColumn + count);
+        std::copy_backward(dbcsAttrs, dbcsAttrs + count, _dbcsAttrs.begin() + targetColumn + count);
+    }
+    else
+    {
+        std::copy(chars, chars + count, _chars.begin() + targetColumn);
+        std::copy(dbcsAttrs, dbcsAttrs + count, _dbcsAttrs.begin() + targetColumn);
+    }
+
+    for (const auto& [column, glyph] : storedGlyphs)
+    {
+        _unicodeStorage.StoreGlyph(column, glyph);
+    }
+}
+
+// Routine Description:
+// - Fills a span of cells with a single-width character.
+// Arguments:
+// - column - the first column to fill
+// - count - how many cells to fill
+// - wch - the character to fill them with
+// Return Value:
+// - <none>
+// Note: will throw exception if the span is out of bounds
+void CharRow::FillCells(const size_t column, const size_t count, const wchar_t wch)
+{
+    THROW_HR_IF(E_INVALIDARG, column + count > size());
+
+    for (size_t i = column; i < column + count; ++i)
+    {
+        if (_dbcsAttrs.at(i).IsGlyphStored())
+        {
+            _unicodeStorage.Erase(i);
+        }
+    }
+    std::fill_n(_chars.begin() + column, count, wch);
+    std::fill_n(_dbcsAttrs.begin() + column, count, DbcsAttribute{});
 }
 
 // Routine Description:
@@ -236,7 +299,7 @@ void CharRow::ClearGlyph(const size_t column)
 // - Note: will throw exception if column is out of bounds
 const CharRow::reference CharRow::GlyphAt(const size_t column) const
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _chars.size());
     return { const_cast<CharRow&>(*this), column };
 }
 
@@ -249,24 +312,30 @@ const CharRow::reference CharRow::GlyphAt(const size_t column) const
 // - Note: will throw exception if column is out of bounds
 CharRow::reference CharRow::GlyphAt(const size_t column)
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _chars.size());
     return { *this, column };
 }
 
 std::wstring CharRow::GetText() const
 {
     std::wstring wstr;
-    wstr.reserve(_data.size());
+    wstr.reserve(_chars.size());
 
-    for (size_t i = 0; i < _data.size(); ++i)
+    for (size_t i = 0; i < _chars.size(); ++i)
     {
-        const auto glyph = GlyphAt(i);
-        if (!DbcsAttrAt(i).IsTrailing())
+        const auto& dbcsAttr = til::at(_dbcsAttrs, i);
+        if (dbcsAttr.IsTrailing())
+        {
+            continue;
+        }
+
+        if (dbcsAttr.IsGlyphStored())
+        {
+            wstr.append(_unicodeStorage.GetText(i));
+        }
+        else
         {
-            for (const auto wch : glyph)
-            {
-                wstr.push_back(wch);
-            }
+            wstr.push_back(til::at(_chars, i));
         }
     }
     return wstr;
@@ -282,7 +351,7 @@ std::wstring CharRow::GetText() const
 // - the delimiter class for the given char
 const DelimiterClass CharRow::DelimiterClassAt(const size_t column, const std::wstring_view wordDelimiters) const
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _chars.size());
 
     const auto glyph = *GlyphAt(column).begin();
     if (glyph <= UNICODE_SPACE)
@@ -299,25 +368,38 @@ const DelimiterClass CharRow::DelimiterClassAt(const size_t column, const std::w
     }
 }
 
-UnicodeStorage& CharRow::GetUnicodeStorage() noexcept
-{
-    return _pParent->GetUnicodeStorage();
-}
-
-const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
+// Routine Description:
+// - Gets the first wchar_t of the glyph of every cell. Glyphs that don't fit
+//      into a single one are kept in the UnicodeStorage, and the DBCS
+//      attributes of their cells say so.
+// Arguments:
+// - <none>
+// Return Value:
+// - the characters of the row, one per cell
+gsl::span<const CharRow::glyph_type> CharRow::Chars() const noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return { _chars.data(), _chars.size() };
 }
 
 // Routine Description:
-// - calculates the key used by the given column of the char row to store glyph data in UnicodeStorage
+// - Gets the DBCS attributes of every cell.
 // Arguments:
-// - column - the column to generate the key for
+// - <none>
 // Return Value:
-// - the COORD key for data access from UnicodeStorage for the column
-COORD CharRow::GetStorageKey(const size_t column) const noexcept
+// - the DBCS attributes of the row, one per cell
+gsl::span<const DbcsAttribute> CharRow::DbcsAttrs() const noexcept
+{
+    return { _dbcsAttrs.data(), _dbcsAttrs.size() };
+}
+
+UnicodeStorage& CharRow::GetUnicodeStorage() noexcept
 {
-    return { gsl::narrow<SHORT>(column), _pParent->GetId() };
+    return _unicodeStorage;
+}
+
+const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
+{
+    return _unicodeStorage;
 }
 
 // Routine Description:
@@ -328,3 +410,14 @@ void CharRow::UpdateParent(ROW* const pParent)
 {
     _pParent = FAIL_FAST_IF_NULL(pParent);
 }
+
+// Routine Description:
+// - checks if the cell at the column contains a space glyph
+// Arguments:
+// - column - the column to check. must be in bounds.
+// Return Value:
+// - true if cell contains a space glyph, false otherwise
+bool CharRow::_IsSpaceAt(const size_t column) const noexcept
+{
+    return til::at(_chars, column) == UNICODE_SPACE && !til::at(_dbcsAttrs, column).IsGlyphStored();
+}
@@ -22,8 +22,8 @@ Revision History:
 
 #include "DbcsAttribute.hpp"
 #include "CharRowCellReference.hpp"
-#include "CharRowCell.hpp"
 #include "UnicodeStorage.hpp"
+#include "unicode.hpp"
 
 class ROW;
 
@@ -48,10 +48,6 @@ class CharRow final
 {
 public:
     using glyph_type = typename wchar_t;
-    using value_type = typename CharRowCell;
-    using iterator = typename boost::container::small_vector_base<value_type>::iterator;
-    using const_iterator = typename boost::container::small_vector_base<value_type>::const_iterator;
-    using const_reverse_iterator = typename boost::container::small_vector_base<value_type>::const_reverse_iterator;
     using reference = typename CharRowCellReference;
 
     CharRow(size_t rowWidth, ROW* const pParent) noexcept;
@@ -70,24 +66,21 @@ public:
     const DbcsAttribute& DbcsAttrAt(const size_t column) const;
     DbcsAttribute& DbcsAttrAt(const size_t column);
     void ClearGlyph(const size_t column);
+    void CopyCells(const CharRow& source, const size_t sourceColumn, const size_t targetColumn, const size_t count);
+    void FillCells(const size_t column, const size_t count, const wchar_t wch);
     std::wstring GetText() const;
 
+    gsl::span<const glyph_type> Chars() const noexcept;
+    gsl::span<const DbcsAttribute> DbcsAttrs() const noexcept;
+
     const DelimiterClass DelimiterClassAt(const size_t column, const std::wstring_view wordDelimiters) const;
 
     // working with glyphs
     const reference GlyphAt(const size_t column) const;
     reference GlyphAt(const size_t column);
 
-    // iterators
-    iterator begin() noexcept;
-    const_iterator cbegin() const noexcept;
-
-    iterator end() noexcept;
-    const_iterator cend() const noexcept;
-
     UnicodeStorage& GetUnicodeStorage() noexcept;
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    COORD GetStorageKey(const size_t column) const noexcept;
 
     void UpdateParent(ROW* const pParent);
 
@@ -101,28 +94,39 @@ protected:
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded;
 
-    // storage for glyph data and dbcs attributes
-    boost::container::small_vector<value_type, 120> _data;
+    // storage for the first (usually only) wchar_t of the glyph of every cell
+    boost::container::small_vector<glyph_type, 120> _chars;
+
+    // storage for the dbcs attributes of every cell, kept apart from the
+    // text so that scans over either one of them stay dense
+    boost::container::small_vector<DbcsAttribute, 120> _dbcsAttrs;
+
+    // storage for the glyphs that don't fit into a single wchar_t
+    UnicodeStorage _unicodeStorage;
 
     // ROW that this CharRow belongs to
     ROW* _pParent;
+
+private:
+    bool _IsSpaceAt(const size_t column) const noexcept;
 };
 
 constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept
 {
     return (a._wrapForced == b._wrapForced &&
             a._doubleBytePadded == b._doubleBytePadded &&
-            a._data == b._data);
+            a._chars == b._chars &&
+            a._dbcsAttrs == b._dbcsAttrs);
 }
 
 template<typename InputIt1, typename InputIt2>
-void OverwriteColumns(InputIt1 startChars, InputIt1 endChars, InputIt2 startAttrs, CharRow::iterator outIt)
+void OverwriteColumns(InputIt1 startChars, InputIt1 endChars, InputIt2 startAttrs, CharRow& charRow)
 {
-    std::transform(startChars,
-                   endChars,
-                   startAttrs,
-                   outIt,
-                   [](const wchar_t wch, const DbcsAttribute attr) {
-                       return CharRow::value_type{ wch, attr };
-                   });
+    size_t column = 0;
+    for (auto it = startChars; it != endChars; ++it, ++startAttrs, ++column)
+    {
+        const wchar_t wch = *it;
+        charRow.GlyphAt(column) = std::wstring_view{ &wch, 1 };
+        charRow.DbcsAttrAt(column) = *startAttrs;
+    }
 }
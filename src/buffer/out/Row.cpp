@@ -20,7 +20,7 @@ ROW::ROW(const SHORT rowId, const unsigned short rowWidth, const TextAttribute f
     _id{ rowId },
     _rowWidth{ rowWidth },
     _charRow{ rowWidth, this },
-    _attrRow{ rowWidth, fillAttribute },
+    _attrRow{ rowWidth, fillAttribute, pParent },
     _pParent{ pParent }
 {
 }
@@ -67,25 +67,47 @@ bool ROW::Reset(const TextAttribute Attr)
 }
 
 // Routine Description:
-// - clears char data in column in row
+// - Hands out the contents of the row as contiguous spans, so that readers of
+//      the whole row don't have to go through it cell by cell.
 // Arguments:
-// - column - 0-indexed column index
-// Return Value:
 // - <none>
-void ROW::ClearColumn(const size_t column)
+// Return Value:
+// - the contents of the row, valid until the row is changed
+RowSnapshot ROW::GetSnapshot() const noexcept
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _charRow.size());
-    _charRow.ClearCell(column);
+    return { _charRow.Chars(),
+             _charRow.DbcsAttrs(),
+             _attrRow.Runs(),
+             _attrRow.Attrs(),
+             &_charRow.GetUnicodeStorage() };
 }
 
-UnicodeStorage& ROW::GetUnicodeStorage() noexcept
+// Routine Description:
+// - Gets the glyph of the given cell.
+// Arguments:
+// - column - 0-indexed column index
+// Return Value:
+// - the glyph, which is either in chars, or in the unicode storage
+std::wstring_view RowSnapshot::GlyphAt(const size_t column) const
 {
-    return _pParent->GetUnicodeStorage();
+    const auto& ch = til::at(chars, column);
+    if (til::at(dbcsAttrs, column).IsGlyphStored())
+    {
+        return unicodeStorage->GetText(column);
+    }
+    return { &ch, 1 };
 }
 
-const UnicodeStorage& ROW::GetUnicodeStorage() const noexcept
+// Routine Description:
+// - clears char data in column in row
+// Arguments:
+// - column - 0-indexed column index
+// Return Value:
+// - <none>
+void ROW::ClearColumn(const size_t column)
 {
-    return _pParent->GetUnicodeStorage();
+    THROW_HR_IF(E_INVALIDARG, column >= _charRow.size());
+    _charRow.ClearCell(column);
 }
 
 // Routine Description:
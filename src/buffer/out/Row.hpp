@@ -25,10 +25,28 @@ Revision History:
 #include "OutputCellIterator.hpp"
 #include "CharRow.hpp"
 #include "RowCellIterator.hpp"
-#include "UnicodeStorage.hpp"
 
 class TextBuffer;
 
+// The contents of a ROW as contiguous spans, for code that reads whole rows at
+// once, like the renderer. It's only valid until the row is changed.
+struct RowSnapshot
+{
+    // The first wchar_t of the glyph of every cell.
+    gsl::span<const wchar_t> chars;
+    // The DBCS attributes of every cell. They tell how many columns a glyph
+    // takes, and whether it didn't fit into chars.
+    gsl::span<const DbcsAttribute> dbcsAttrs;
+    // The runs of columns that share an attribute, in column order, and the
+    // attributes they index.
+    gsl::span<const ATTR_ROW::Run> attrRuns;
+    gsl::span<const TextAttribute> attrs;
+    // Holds the glyphs that didn't fit into chars.
+    const UnicodeStorage* unicodeStorage;
+
+    std::wstring_view GlyphAt(const size_t column) const;
+};
+
 class ROW final
 {
 public:
@@ -52,12 +70,11 @@ public:
     void ClearColumn(const size_t column);
     std::wstring GetText() const { return _charRow.GetText(); }
 
+    RowSnapshot GetSnapshot() const noexcept;
+
     RowCellIterator AsCellIter(const size_t startIndex) const { return AsCellIter(startIndex, size() - startIndex); }
     RowCellIterator AsCellIter(const size_t startIndex, const size_t count) const { return RowCellIterator(*this, startIndex, count); }
 
-    UnicodeStorage& GetUnicodeStorage() noexcept;
-    const UnicodeStorage& GetUnicodeStorage() const noexcept;
-
     OutputCellIterator WriteCells(OutputCellIterator it, const size_t index, const std::optional<bool> wrap = std::nullopt, std::optional<size_t> limitRight = std::nullopt);
 
     friend bool operator==(const ROW& a, const ROW& b) noexcept;
@@ -0,0 +1,354 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "RowArchive.hpp"
+#include "Row.hpp"
+
+RowArchive::RowArchive() noexcept :
+    _segments{},
+    _frontSkip{ 0 },
+    _count{ 0 },
+    _capacity{ 0 }
+{
+}
+
+RowArchive::RowArchive(RowArchive&& other) noexcept :
+    RowArchive()
+{
+    *this = std::move(other);
+}
+
+// Routine Description:
+// - Takes over the rows and the capacity of the other archive. The other
+//   archive is left empty and disabled.
+RowArchive& RowArchive::operator=(RowArchive&& other) noexcept
+{
+    if (this != &other)
+    {
+        _segments = std::move(other._segments);
+        _frontSkip = std::exchange(other._frontSkip, 0);
+        _count = std::exchange(other._count, 0);
+        _capacity = std::exchange(other._capacity, 0);
+        other._segments.clear();
+    }
+    return *this;
+}
+
+// Routine Description:
+// - Sets the maximum number of rows that the archive will retain. When more
+//   rows than this are appended, the oldest ones are discarded.
+// Arguments:
+// - capacity - The number of rows to retain. 0 disables the archive and
+//   releases everything stored in it.
+void RowArchive::SetCapacity(const uint64_t capacity)
+{
+    _capacity = capacity;
+    _Trim();
+}
+
+uint64_t RowArchive::GetCapacity() const noexcept
+{
+    return _capacity;
+}
+
+bool RowArchive::IsEnabled() const noexcept
+{
+    return _capacity != 0;
+}
+
+// Routine Description:
+// - Packs the given row and appends it as the newest row of the archive.
+// - Trailing spaces are not stored and hyperlink ids are stripped from the
+//   attributes, as the hyperlink map entries they refer to are pruned
+//   once the row leaves the live buffer.
+// Arguments:
+// - row - The row to archive. It is not modified.
+void RowArchive::Append(const ROW& row)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    if (_segments.empty() || _segments.back().records.size() == s_rowsPerSegment)
+    {
+        if (!_segments.empty())
+        {
+            // The previous segment is full and will never grow again.
+            auto& sealed = _segments.back();
+            sealed.text.shrink_to_fit();
+            sealed.runs.shrink_to_fit();
+        }
+
+        auto& segment = _segments.emplace_back();
+        segment.records.reserve(s_rowsPerSegment);
+    }
+
+    auto& segment = _segments.back();
+    const auto& charRow = row.GetCharRow();
+    const auto& attrRow = row.GetAttrRow();
+
+    Record record{};
+    record.textOffset = gsl::narrow<uint32_t>(segment.text.size());
+    record.runOffset = gsl::narrow<uint32_t>(segment.runs.size());
+    record.wrapForced = charRow.WasWrapForced();
+    record.doubleBytePadded = charRow.WasDoubleBytePadded();
+
+    const auto right = charRow.MeasureRight();
+    for (size_t column = 0; column < right; ++column)
+    {
+        if (!charRow.DbcsAttrAt(column).IsTrailing())
+        {
+            segment.text.append(charRow.GlyphAt(column));
+        }
+    }
+    record.textLength = gsl::narrow<uint32_t>(segment.text.size() - record.textOffset);
+
+    size_t applies = 0;
+    for (size_t column = 0; column < row.size(); column += applies)
+    {
+        auto attr = attrRow.GetAttrByColumn(column, &applies);
+        attr.SetHyperlinkId(0);
+
+        // Stripping the hyperlink can make two neighboring runs identical.
+        if (segment.runs.size() > record.runOffset && segment.runs.back().GetAttributes() == attr)
+        {
+            segment.runs.back().SetLength(segment.runs.back().GetLength() + applies);
+        }
+        else
+        {
+            segment.runs.emplace_back(applies, attr);
+        }
+    }
+    record.runCount = gsl::narrow<uint32_t>(segment.runs.size() - record.runOffset);
+
+    segment.records.push_back(record);
+    ++_count;
+
+    _Trim();
+}
+
+// Routine Description:
+// - Discards the newest rows, as if they had never been appended. This is how
+//   rows that are brought back into the live buffer leave the archive.
+// Arguments:
+// - count - The number of rows to discard. Asking for more rows than are
+//   retained discards all of them.
+void RowArchive::PopNewest(const uint64_t count) noexcept
+{
+    auto remaining = std::min(count, _count);
+    while (remaining > 0)
+    {
+        auto& segment = _segments.back();
+
+        // Rows that were evicted but not freed yet are never popped.
+        const auto evicted = _segments.size() == 1 ? _frontSkip : 0;
+        const auto popped = gsl::narrow_cast<size_t>(std::min<uint64_t>(remaining, segment.records.size() - evicted));
+        const auto kept = segment.records.size() - popped;
+        if (kept == evicted)
+        {
+            _segments.pop_back();
+            if (_segments.empty())
+            {
+                _frontSkip = 0;
+            }
+        }
+        else
+        {
+            const auto& first = segment.records.at(kept);
+            segment.text.erase(first.textOffset);
+            segment.runs.erase(segment.runs.begin() + first.runOffset, segment.runs.end());
+            segment.records.erase(segment.records.begin() + kept, segment.records.end());
+        }
+
+        _count -= popped;
+        remaining -= popped;
+    }
+}
+
+// Routine Description:
+// - Discards every archived row.
+void RowArchive::Clear() noexcept
+{
+    _segments.clear();
+    _frontSkip = 0;
+    _count = 0;
+}
+
+// Routine Description:
+// - Gets the number of rows currently retained in the archive.
+uint64_t RowArchive::size() const noexcept
+{
+    return _count;
+}
+
+bool RowArchive::empty() const noexcept
+{
+    return _count == 0;
+}
+
+// Routine Description:
+// - Retrieves the text of an archived row. Trailing spaces are not included.
+// Arguments:
+// - index - The row to retrieve. 0 is the oldest row in the archive.
+// Return Value:
+// - A view over the text of the row. It is invalidated by the next Append.
+// Note: will throw if the index is out of bounds
+std::wstring_view RowArchive::GetText(const uint64_t index) const
+{
+    const Record* record = nullptr;
+    const auto& segment = _GetSegment(index, record);
+    return std::wstring_view{ segment.text }.substr(record->textOffset, record->textLength);
+}
+
+// Routine Description:
+// - Retrieves whether the archived row was soft-wrapped onto the next row.
+// Arguments:
+// - index - The row to retrieve. 0 is the oldest row in the archive.
+// Note: will throw if the index is out of bounds
+bool RowArchive::WasWrapForced(const uint64_t index) const
+{
+    const Record* record = nullptr;
+    _GetSegment(index, record);
+    return record->wrapForced;
+}
+
+// Routine Description:
+// - Retrieves the width the row had when it was archived.
+// Arguments:
+// - index - The row to retrieve. 0 is the oldest row in the archive.
+// Note: will throw if the index is out of bounds
+size_t RowArchive::GetWidth(const uint64_t index) const
+{
+    const Record* record = nullptr;
+    const auto& segment = _GetSegment(index, record);
+    const auto first = segment.runs.cbegin() + record->runOffset;
+
+    size_t width = 0;
+    for (auto it = first; it != first + record->runCount; ++it)
+    {
+        width += it->GetLength();
+    }
+    return width;
+}
+
+// Routine Description:
+// - Retrieves the run-length encoded attributes of an archived row. The runs
+//   cover the width the row had when it was archived.
+// Arguments:
+// - index - The row to retrieve. 0 is the oldest row in the archive.
+// Note: will throw if the index is out of bounds
+std::vector<TextAttributeRun> RowArchive::GetAttrRuns(const uint64_t index) const
+{
+    const Record* record = nullptr;
+    const auto& segment = _GetSegment(index, record);
+    const auto first = segment.runs.cbegin() + record->runOffset;
+    return { first, first + record->runCount };
+}
+
+// Routine Description:
+// - Materializes an archived row back into a live row. Text that does not fit
+//   into the width of the target row is dropped and attributes are clipped or
+//   extended to fit it.
+// Arguments:
+// - index - The row to retrieve. 0 is the oldest row in the archive.
+// - row - The row to overwrite with the archived contents.
+// Note: will throw if the index is out of bounds
+void RowArchive::Restore(const uint64_t index, ROW& row) const
+{
+    const Record* record = nullptr;
+    const auto& segment = _GetSegment(index, record);
+
+    const auto width = row.size();
+    const auto first = segment.runs.cbegin() + record->runOffset;
+    const auto last = first + record->runCount;
+
+    std::vector<TextAttributeRun> runs;
+    runs.reserve(record->runCount);
+    size_t covered = 0;
+    for (auto it = first; it != last && covered < width; ++it)
+    {
+        const auto length = std::min(it->GetLength(), width - covered);
+        runs.emplace_back(length, it->GetAttributes());
+        covered += length;
+    }
+    if (covered < width)
+    {
+        runs.back().SetLength(runs.back().GetLength() + width - covered);
+    }
+
+    THROW_HR_IF(E_OUTOFMEMORY, !row.Reset(runs.front().GetAttributes()));
+
+    const auto text = std::wstring_view{ segment.text }.substr(record->textOffset, record->textLength);
+    if (!text.empty())
+    {
+        row.WriteCells(OutputCellIterator{ text }, 0);
+    }
+
+    auto& charRow = row.GetCharRow();
+    charRow.SetWrapForced(record->wrapForced);
+    charRow.SetDoubleBytePadded(record->doubleBytePadded);
+
+    THROW_IF_FAILED(row.GetAttrRow().InsertAttrRuns(runs, 0, width - 1, width));
+}
+
+// Routine Description:
+// - Reports the approximate number of bytes held by the archive.
+size_t RowArchive::GetMemoryUsage() const noexcept
+{
+    size_t bytes = 0;
+    for (const auto& segment : _segments)
+    {
+        bytes += segment.text.capacity() * sizeof(wchar_t);
+        bytes += segment.runs.capacity() * sizeof(TextAttributeRun);
+        bytes += segment.records.capacity() * sizeof(Record);
+    }
+    return bytes;
+}
+
+// Routine Description:
+// - Finds the segment and the record that describe the given row.
+// Arguments:
+// - index - The row to find. 0 is the oldest row in the archive.
+// - record - Receives the record of the row.
+// Return Value:
+// - The segment that holds the data of the row.
+// Note: will throw if the index is out of bounds
+const RowArchive::Segment& RowArchive::_GetSegment(const uint64_t index, const Record*& record) const
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _count);
+
+    // Every segment but the last one is full, so the physical position of the
+    // row tells us directly which segment it lives in.
+    const auto physical = index + _frontSkip;
+    const auto& segment = _segments.at(gsl::narrow_cast<size_t>(physical / s_rowsPerSegment));
+    record = &segment.records.at(gsl::narrow_cast<size_t>(physical % s_rowsPerSegment));
+    return segment;
+}
+
+// Routine Description:
+// - Evicts the oldest rows until we're within our capacity again. Memory is
+//   only released a whole segment at a time.
+void RowArchive::_Trim() noexcept
+{
+    if (_count <= _capacity)
+    {
+        return;
+    }
+
+    _frontSkip += gsl::narrow_cast<size_t>(_count - _capacity);
+    _count = _capacity;
+
+    while (!_segments.empty() && _frontSkip >= _segments.front().records.size())
+    {
+        const auto& front = _segments.front();
+        // Only full segments can be released while rows are left after them.
+        if (front.records.size() < s_rowsPerSegment && _segments.size() > 1)
+        {
+            break;
+        }
+        _frontSkip -= front.records.size();
+        _segments.pop_front();
+    }
+}
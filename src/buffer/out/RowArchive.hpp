@@ -0,0 +1,93 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RowArchive.hpp
+
+Abstract:
+- Cold storage for rows that have scrolled out of the top of a text buffer.
+- Rows are packed into fixed-size segments: the UTF-16 text of every row in
+  a segment shares one string and the run-length encoded attributes share one
+  vector. Nothing is kept per-cell, so an archived row costs roughly its
+  printable text plus one run per color change instead of a full-width
+  CharRow and ATTR_ROW.
+- Archived rows are addressed with 64-bit indices where 0 is the oldest row
+  still retained, so the history is not bound to the SHORT row ids used by
+  the live buffer.
+--*/
+
+#pragma once
+
+#include "TextAttributeRun.hpp"
+
+class ROW;
+
+class RowArchive final
+{
+public:
+    RowArchive() noexcept;
+    RowArchive(const RowArchive&) = delete;
+    RowArchive& operator=(const RowArchive&) = delete;
+    RowArchive(RowArchive&& other) noexcept;
+    RowArchive& operator=(RowArchive&& other) noexcept;
+    ~RowArchive() = default;
+
+    void SetCapacity(const uint64_t capacity);
+    uint64_t GetCapacity() const noexcept;
+    bool IsEnabled() const noexcept;
+
+    void Append(const ROW& row);
+    void PopNewest(const uint64_t count) noexcept;
+    void Clear() noexcept;
+
+    uint64_t size() const noexcept;
+    bool empty() const noexcept;
+
+    std::wstring_view GetText(const uint64_t index) const;
+    bool WasWrapForced(const uint64_t index) const;
+    size_t GetWidth(const uint64_t index) const;
+
+    std::vector<TextAttributeRun> GetAttrRuns(const uint64_t index) const;
+
+    void Restore(const uint64_t index, ROW& row) const;
+
+    size_t GetMemoryUsage() const noexcept;
+
+private:
+    // The number of rows packed into one segment. Whole segments are
+    // released at once when the capacity is exceeded.
+    static constexpr size_t s_rowsPerSegment = 1024;
+
+    struct Record
+    {
+        uint32_t textOffset;
+        uint32_t textLength;
+        uint32_t runOffset;
+        uint32_t runCount;
+        bool wrapForced;
+        bool doubleBytePadded;
+    };
+
+    struct Segment
+    {
+        std::wstring text;
+        std::vector<TextAttributeRun> runs;
+        std::vector<Record> records;
+    };
+
+    const Segment& _GetSegment(const uint64_t index, const Record*& record) const;
+    void _Trim() noexcept;
+
+    std::deque<Segment> _segments;
+
+    // The number of records at the front of the first segment that have
+    // already been evicted but not freed yet.
+    size_t _frontSkip;
+    uint64_t _count;
+    uint64_t _capacity;
+
+#ifdef UNIT_TESTING
+    friend class TextBufferTests;
+#endif
+};
@@ -5,94 +5,166 @@
 #include "UnicodeStorage.hpp"
 
 UnicodeStorage::UnicodeStorage() noexcept :
-    _map{}
+    _entries{},
+    _text{},
+    _unused{ 0 }
 {
 }
 
 // Routine Description:
-// - fetches the text associated with key
+// - fetches the glyph stored for the column
 // Arguments:
-// - key - the key into the storage
+// - column - the column of the glyph in the row
 // Return Value:
-// - the glyph data associated with key
-// Note: will throw exception if key is not stored yet
-const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) const
+// - the glyph data associated with the column. It's invalidated by the next
+//   change to the storage.
+// Note: will throw exception if no glyph is stored for the column
+std::wstring_view UnicodeStorage::GetText(const key_type column) const
 {
-    return _map.at(key);
+    const auto it = _Find(column);
+    THROW_HR_IF(E_INVALIDARG, it == _entries.cend() || it->column != column);
+    return std::wstring_view{ _text }.substr(it->offset, it->length);
 }
 
 // Routine Description:
-// - stores glyph data associated with key.
+// - stores glyph data for the column, replacing whatever was stored for it before.
 // Arguments:
-// - key - the key into the storage
+// - column - the column of the glyph in the row
 // - glyph - the glyph data to store
-void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
+void UnicodeStorage::StoreGlyph(const key_type column, const std::wstring_view glyph)
 {
-    _map.insert_or_assign(key, glyph);
+    // The glyph might have been read out of this very storage, for instance
+    // when cells are copied within a row. Appending it to itself could
+    // reallocate the string out from under it, so make a copy first.
+    const auto textBegin = _text.data();
+    const auto textEnd = textBegin + _text.size();
+    if (!std::less<const wchar_t*>{}(glyph.data(), textBegin) && std::less<const wchar_t*>{}(glyph.data(), textEnd))
+    {
+        StoreGlyph(column, std::wstring{ glyph });
+        return;
+    }
+
+    const auto length = gsl::narrow<uint32_t>(glyph.size());
+    const auto offset = gsl::narrow<uint32_t>(_text.size());
+
+    const auto it = _Find(column);
+    if (it != _entries.end() && it->column == column)
+    {
+        if (length <= it->length)
+        {
+            // It fits where the old glyph was.
+            std::copy(glyph.cbegin(), glyph.cend(), _text.begin() + it->offset);
+            _unused += it->length - length;
+            it->length = length;
+            return;
+        }
+
+        _unused += it->length;
+        it->offset = offset;
+        it->length = length;
+    }
+    else
+    {
+        _entries.insert(it, { gsl::narrow<uint32_t>(column), offset, length });
+    }
+
+    _text.append(glyph);
+
+    // Only bother once the holes take up more space than the glyphs do.
+    if (_unused > _text.size() / 2)
+    {
+        _Compact();
+    }
 }
 
 // Routine Description:
-// - erases key and its associated data from the storage
+// - erases the glyph stored for the column, if any
 // Arguments:
-// - key - the key to remove
-void UnicodeStorage::Erase(const key_type key) noexcept
+// - column - the column of the glyph in the row
+void UnicodeStorage::Erase(const key_type column) noexcept
 {
-    _map.erase(key);
+    const auto it = _Find(column);
+    if (it != _entries.end() && it->column == column)
+    {
+        _unused += it->length;
+        _entries.erase(it);
+    }
+
+    if (_entries.empty())
+    {
+        Clear();
+    }
 }
 
 // Routine Description:
-// - Remaps all of the stored items to new coordinate positions
-//   based on a bulk rearrangement of row IDs and potential row width resize.
+// - erases every glyph stored at or beyond the given column, e.g. when the
+//   row is resized to be narrower.
 // Arguments:
-// - rowMap - A map of the old row IDs to the new row IDs.
-// - width - The width of the new row. Remove any items that are beyond the row width.
-//         - Use nullopt if we're not resizing the width of the row, just renumbering the rows.
-void UnicodeStorage::Remap(const std::unordered_map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width)
+// - width - the new width of the row
+void UnicodeStorage::Trim(const size_t width) noexcept
 {
-    // Make a temporary map to hold all the new row positioning
-    std::unordered_map<key_type, mapped_type> newMap;
-
-    // Walk through every stored item.
-    for (const auto& pair : _map)
+    const auto first = _Find(width);
+    for (auto it = first; it != _entries.end(); ++it)
     {
-        // Extract the old coordinate position
-        const auto oldCoord = pair.first;
+        _unused += it->length;
+    }
+    _entries.erase(first, _entries.end());
 
-        // Only try to short-circuit based on width if we were told it changed
-        // by being given a new width value.
-        if (width.has_value())
-        {
-            // Get the column ID
-            const auto oldColId = oldCoord.X;
-
-            // If the column index is at/beyond the row width, don't bother copying it to the new map.
-            if (oldColId >= width.value())
-            {
-                continue;
-            }
-        }
+    if (_entries.empty())
+    {
+        Clear();
+    }
+}
 
-        // Get the row ID from the position as that's what we need to remap
-        const auto oldRowId = oldCoord.Y;
+// Routine Description:
+// - erases every stored glyph. The memory is kept for reuse by the row.
+void UnicodeStorage::Clear() noexcept
+{
+    _entries.clear();
+    _text.clear();
+    _unused = 0;
+}
 
-        // Use the mapping given to convert the old row ID to the new row ID
-        const auto mapIter = rowMap.find(oldRowId);
+// Routine Description:
+// - gets the number of glyphs stored
+size_t UnicodeStorage::size() const noexcept
+{
+    return _entries.size();
+}
 
-        // If there's no mapping to a new row, don't bother copying it to the new map. The row is gone.
-        if (mapIter == rowMap.end())
-        {
-            continue;
-        }
+bool UnicodeStorage::empty() const noexcept
+{
+    return _entries.empty();
+}
 
-        const auto newRowId = mapIter->second;
+// Routine Description:
+// - finds the entry for the column, or the one it would be inserted before
+std::vector<UnicodeStorage::Entry>::iterator UnicodeStorage::_Find(const key_type column) noexcept
+{
+    return std::lower_bound(_entries.begin(), _entries.end(), column, [](const Entry& entry, const key_type column) {
+        return entry.column < column;
+    });
+}
 
-        // Generate a new coordinate with the same X as the old one, but a new Y value.
-        const auto newCoord = COORD{ oldCoord.X, newRowId };
+std::vector<UnicodeStorage::Entry>::const_iterator UnicodeStorage::_Find(const key_type column) const noexcept
+{
+    return std::lower_bound(_entries.cbegin(), _entries.cend(), column, [](const Entry& entry, const key_type column) {
+        return entry.column < column;
+    });
+}
 
-        // Put the adjusted coordinate into the map with the original value.
-        newMap.emplace(newCoord, pair.second);
+// Routine Description:
+// - reclaims the space left behind by overwritten and erased glyphs
+void UnicodeStorage::_Compact()
+{
+    std::wstring text;
+    text.reserve(_text.size() - _unused);
+    for (auto& entry : _entries)
+    {
+        const auto offset = gsl::narrow<uint32_t>(text.size());
+        text.append(_text, entry.offset, entry.length);
+        entry.offset = offset;
     }
-
-    // Swap into the stored map, free the temporary when we exit.
-    _map.swap(newMap);
+    _text.swap(text);
+    _unused = 0;
 }
@@ -7,6 +7,9 @@ Module Name:
 
 Abstract:
 - dynamic storage location for glyphs that can't normally fit in the output buffer
+- Each CharRow owns one, so the glyphs move along with their row and are keyed
+  by column alone. The glyphs of a row are stored back to back in a single
+  string instead of being allocated individually.
 
 Author(s):
 - Austin Diviness (AustDi) 02-May-2018
@@ -15,50 +18,46 @@ Author(s):
 #pragma once
 
 #include <vector>
-#include <unordered_map>
-#include <climits>
-
-// std::unordered_map needs help to know how to hash a COORD
-namespace std
-{
-    template<>
-    struct hash<COORD>
-    {
-        // Routine Description:
-        // - hashes a coord. coord will be hashed by storing the x and y values consecutively in the lower
-        // bits of a size_t.
-        // Arguments:
-        // - coord - the coord to hash
-        // Return Value:
-        // - the hashed coord
-        constexpr size_t operator()(const COORD& coord) const noexcept
-        {
-            size_t retVal = coord.Y;
-            const size_t xCoord = coord.X;
-            retVal |= xCoord << (sizeof(coord.Y) * CHAR_BIT);
-            return retVal;
-        }
-    };
-}
+#include <string>
+#include <string_view>
 
 class UnicodeStorage final
 {
 public:
-    using key_type = typename COORD;
-    using mapped_type = typename std::vector<wchar_t>;
+    using key_type = size_t;
 
     UnicodeStorage() noexcept;
 
-    const mapped_type& GetText(const key_type key) const;
+    std::wstring_view GetText(const key_type column) const;
 
-    void StoreGlyph(const key_type key, const mapped_type& glyph);
+    void StoreGlyph(const key_type column, const std::wstring_view glyph);
 
-    void Erase(const key_type key) noexcept;
+    void Erase(const key_type column) noexcept;
+    void Trim(const size_t width) noexcept;
+    void Clear() noexcept;
 
-    void Remap(const std::unordered_map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width);
+    size_t size() const noexcept;
+    bool empty() const noexcept;
 
 private:
-    std::unordered_map<key_type, mapped_type> _map;
+    struct Entry
+    {
+        uint32_t column;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    std::vector<Entry>::iterator _Find(const key_type column) noexcept;
+    std::vector<Entry>::const_iterator _Find(const key_type column) const noexcept;
+    void _Compact();
+
+    // sorted by column
+    std::vector<Entry> _entries;
+
+    // the text of every glyph, back to back. Overwritten and erased glyphs
+    // leave holes behind that are reclaimed once they take up too much space.
+    std::wstring _text;
+    size_t _unused;
 
 #ifdef UNIT_TESTING
     friend class UnicodeStorageTests;
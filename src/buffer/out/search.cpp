@@ -33,6 +33,7 @@ Search::Search(IUiaData& uiaData,
     _coordAnchor(s_GetInitialAnchor(uiaData, direction))
 {
     _coordNext = _coordAnchor;
+    _CompileNeedle();
 }
 
 // Routine Description:
@@ -58,6 +59,7 @@ Search::Search(IUiaData& uiaData,
     _uiaData(uiaData)
 {
     _coordNext = _coordAnchor;
+    _CompileNeedle();
 }
 
 // Routine Description
@@ -75,22 +77,134 @@ bool Search::FindNext()
         return false;
     }
 
-    do
+    const auto next = _ToIndex(_coordNext);
+    const auto anchor = _ToIndex(_coordAnchor);
+    const auto end = _ToIndex(_uiaData.GetTextBufferEndPosition());
+
+    // We visit every position from _coordNext up to (but not including) the anchor,
+    // wrapping around at the end of the written text like _UpdateNextPosition does.
+    // That walk is made of at most two ranges, which are scanned in the order they're visited.
+    std::array<std::pair<ptrdiff_t, ptrdiff_t>, 2> ranges{};
+    if (_direction == Direction::Forward)
+    {
+        if (next < anchor && anchor <= end)
+        {
+            ranges = { { { next, anchor - 1 }, { 0, -1 } } };
+        }
+        else
+        {
+            ranges = { { { next, std::max(next, end) }, { 0, std::min(anchor, end + 1) - 1 } } };
+        }
+    }
+    else
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
+        if (next <= end && anchor < next)
         {
+            ranges = { { { anchor + 1, next }, { 0, -1 } } };
+        }
+        else if (next <= end)
+        {
+            ranges = { { { 0, next }, { anchor + 1, end } } };
+        }
+        else
+        {
+            ranges = { { { next, next }, { anchor <= end ? anchor + 1 : 0, end } } };
+        }
+    }
+
+    for (const auto& range : ranges)
+    {
+        COORD found{};
+        if (_FindInRange(range.first, range.second, found))
+        {
+            std::tie(_coordSelStart, _coordSelEnd) = _GetMatchAt(found);
+            _coordNext = found;
             _UpdateNextPosition();
             _reachedEnd = _coordNext == _coordAnchor;
             return true;
         }
-        else
+    }
+
+    _coordNext = _coordAnchor;
+    return false;
+}
+
+// Routine Description
+// - Locates every instance of the search term within the written text of the screen buffer.
+// Return Value:
+// - The [start, end] coord positions of every match, in buffer order.
+std::vector<std::pair<COORD, COORD>> Search::FindAll() const
+{
+    return FindAll({ 0, 0 }, _uiaData.GetTextBufferEndPosition());
+}
+
+// Routine Description
+// - Locates every instance of the search term that starts within the given range
+//   of the screen buffer. Unlike FindNext(), this scans the range only once and
+//   doesn't depend on the direction or the anchor of the search.
+// Arguments:
+// - first - The first position a match may start at
+// - last - The last position a match may start at
+// Return Value:
+// - The [start, end] coord positions of every match, in buffer order.
+std::vector<std::pair<COORD, COORD>> Search::FindAll(const COORD first, const COORD last) const
+{
+    std::vector<std::pair<COORD, COORD>> matches;
+
+    const auto firstIndex = _ToIndex(first);
+    const auto lastIndex = _ToIndex(last);
+    if (_needleKeys.empty() || firstIndex > lastIndex)
+    {
+        return matches;
+    }
+
+    std::vector<SHORT> columns;
+    for (auto row = first.Y; row <= last.Y; ++row)
+    {
+        const auto firstColumn = gsl::narrow_cast<SHORT>(row == first.Y ? first.X : 0);
+        const auto lastColumn = row == last.Y ? last.X : _uiaData.GetTextBuffer().GetSize().RightInclusive();
+
+        columns.clear();
+        _FindInRow(row, firstColumn, lastColumn, columns);
+        for (const auto column : columns)
         {
-            _UpdateNextPosition();
+            matches.emplace_back(_GetMatchAt({ column, row }));
         }
+    }
 
-    } while (_coordNext != _coordAnchor);
+    return matches;
+}
 
-    return false;
+// Routine Description
+// - Locates every instance of the search term within the history of the buffer:
+//   the rows that scrolled into its archive, followed by its written text.
+// Return Value:
+// - The position of the start of every match, in history order.
+std::vector<Search::HistoryPosition> Search::FindAllInHistory() const
+{
+    std::vector<HistoryPosition> matches;
+    if (_needleKeys.empty())
+    {
+        return matches;
+    }
+
+    const auto& textBuffer = _uiaData.GetTextBuffer();
+    const auto last = _uiaData.GetTextBufferEndPosition();
+    const auto rightmost = textBuffer.GetSize().RightInclusive();
+    const auto top = -gsl::narrow_cast<int64_t>(textBuffer.GetArchive().size());
+
+    std::vector<SHORT> columns;
+    for (auto row = top; row <= last.Y; ++row)
+    {
+        columns.clear();
+        _FindInRow(row, 0, row == last.Y ? last.X : rightmost, columns);
+        for (const auto column : columns)
+        {
+            matches.emplace_back(row, column);
+        }
+    }
+
+    return matches;
 }
 
 // Routine Description:
@@ -171,26 +285,27 @@ COORD Search::s_GetInitialAnchor(IUiaData& uiaData, const Direction direction)
 
 // Routine Description:
 // - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
+//   at the given position in the history of the screen buffer.
 // - Performs one comparison. Call again with new positions to check other spots.
 // Arguments:
 // - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
 // Return Value:
 // - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const
+bool Search::_FindNeedleInHaystackAt(HistoryPosition pos) const
 {
-    start = { 0 };
-    end = { 0 };
-
-    COORD bufferPos = pos;
+    const ROW* row = nullptr;
+    int64_t rowOffset = 0;
 
     for (const auto& needleCell : _needle)
     {
+        if (!row || pos.first != rowOffset)
+        {
+            row = &_GetHistoryRow(pos.first);
+            rowOffset = pos.first;
+        }
+
         // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _uiaData.GetTextBuffer().GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
+        const std::wstring_view hayChars = row->GetCharRow().GlyphAt(pos.second);
         const auto needleChars = std::wstring_view(needleCell.data(), needleCell.size());
 
         // If we didn't match at any point of the needle, return false.
@@ -199,16 +314,10 @@ bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end)
             return false;
         }
 
-        _IncrementCoord(bufferPos);
+        _IncrementHistoryPosition(pos);
     }
 
-    _DecrementCoord(bufferPos);
-
     // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
-
     return true;
 }
 
@@ -275,6 +384,25 @@ void Search::_DecrementCoord(COORD& coord) const noexcept
     _uiaData.GetTextBuffer().GetSize().DecrementInBoundsCircular(coord);
 }
 
+// Routine Description:
+// - Helper to increment a position in the history of the screen buffer. Archived
+//   rows run on into the first row of the buffer, and the last row of the buffer
+//   wraps around to the first one, like it does for _IncrementCoord.
+// Arguments
+// - position - Updated by function to increment one position
+void Search::_IncrementHistoryPosition(HistoryPosition& position) const noexcept
+{
+    const auto bufferSize = _uiaData.GetTextBuffer().GetSize();
+    if (++position.second > bufferSize.RightInclusive())
+    {
+        position.second = 0;
+        if (++position.first > bufferSize.BottomInclusive())
+        {
+            position.first = 0;
+        }
+    }
+}
+
 // Routine Description:
 // - Helper to update the coordinate position to the next point to be searched
 // Return Value:
@@ -315,6 +443,181 @@ void Search::_UpdateNextPosition()
     }
 }
 
+// Routine Description:
+// - Precomputes what we need to scan for the needle: the key of every needle cell
+//   and the Boyer-Moore-Horspool shift table for those keys.
+void Search::_CompileNeedle()
+{
+    _needleKeys.reserve(_needle.size());
+    for (const auto& cell : _needle)
+    {
+        _needleKeys.push_back(_ApplySensitivity(cell.front()));
+    }
+
+    // When the last key of a window doesn't occur anywhere else in the needle,
+    // we can skip past the whole window. Otherwise we may only skip far enough
+    // to line it up with its last occurrence.
+    const auto needleLength = _needleKeys.size();
+    _skip.fill(std::max<size_t>(needleLength, 1));
+    for (size_t i = 0; i + 1 < needleLength; ++i)
+    {
+        til::at(_skip, til::at(_needleKeys, i) & 0xFF) = needleLength - 1 - i;
+    }
+}
+
+// Routine Description:
+// - Finds the first (forward) or last (backward) position in the range where a match starts.
+// Arguments:
+// - first - The index of the first position to consider (see _ToIndex)
+// - last - The index of the last position to consider
+// - found - If we found it, this is filled with the coordinate the match starts at.
+// Return Value:
+// - True if we found it. False if not.
+bool Search::_FindInRange(const ptrdiff_t first, const ptrdiff_t last, COORD& found) const
+{
+    if (first > last)
+    {
+        return false;
+    }
+
+    // An empty needle matches everywhere.
+    if (_needleKeys.empty())
+    {
+        found = _ToCoord(_direction == Direction::Forward ? first : last);
+        return true;
+    }
+
+    const auto firstCoord = _ToCoord(first);
+    const auto lastCoord = _ToCoord(last);
+    const auto rightmost = _uiaData.GetTextBuffer().GetSize().RightInclusive();
+
+    std::vector<SHORT> columns;
+    for (SHORT i = 0; i <= lastCoord.Y - firstCoord.Y; ++i)
+    {
+        const auto row = gsl::narrow_cast<SHORT>(_direction == Direction::Forward ? firstCoord.Y + i : lastCoord.Y - i);
+        const auto firstColumn = gsl::narrow_cast<SHORT>(row == firstCoord.Y ? firstCoord.X : 0);
+        const auto lastColumn = row == lastCoord.Y ? lastCoord.X : rightmost;
+
+        columns.clear();
+        _FindInRow(row, firstColumn, lastColumn, columns);
+        if (!columns.empty())
+        {
+            found = { _direction == Direction::Forward ? columns.front() : columns.back(), row };
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Routine Description:
+// - Finds every column in the given part of a row where a match starts. Just like
+//   _FindNeedleInHaystackAt, a match may continue onto the following rows.
+// - The row is scanned with the Boyer-Moore-Horspool skip table, comparing only
+//   the first wchar_t of every glyph. Whole glyphs are only compared for the
+//   few candidates this turns up.
+// Arguments:
+// - row - The row to scan. Rows that scrolled into the archive are negative.
+// - firstColumn - The first column a match may start at
+// - lastColumn - The last column a match may start at
+// - columns - Receives the columns of the matches, in ascending order.
+void Search::_FindInRow(const int64_t row, const SHORT firstColumn, const SHORT lastColumn, std::vector<SHORT>& columns) const
+{
+    const auto needleLength = _needleKeys.size();
+    const auto lastStart = gsl::narrow_cast<size_t>(lastColumn - firstColumn);
+
+    // Gather the keys of every cell that a match within the columns could cover.
+    _haystackKeys.clear();
+    _haystackKeys.reserve(lastStart + needleLength);
+
+    HistoryPosition pos{ row, firstColumn };
+    const ROW* currentRow = nullptr;
+    int64_t currentY = 0;
+    for (size_t i = 0; i < lastStart + needleLength; ++i)
+    {
+        if (!currentRow || pos.first != currentY)
+        {
+            currentRow = &_GetHistoryRow(pos.first);
+            currentY = pos.first;
+        }
+        _haystackKeys.push_back(_ApplySensitivity(*currentRow->GetCharRow().GlyphAt(pos.second).begin()));
+        _IncrementHistoryPosition(pos);
+    }
+
+    const auto lastKey = til::at(_needleKeys, needleLength - 1);
+    size_t start = 0;
+    while (start <= lastStart)
+    {
+        const auto key = til::at(_haystackKeys, start + needleLength - 1);
+        if (key == lastKey &&
+            std::equal(_needleKeys.cbegin(), _needleKeys.cend() - 1, _haystackKeys.cbegin() + start))
+        {
+            const HistoryPosition candidate{ row, gsl::narrow_cast<SHORT>(firstColumn + start) };
+            if (_FindNeedleInHaystackAt(candidate))
+            {
+                columns.push_back(candidate.second);
+            }
+        }
+        start += til::at(_skip, key & 0xFF);
+    }
+}
+
+// Routine Description:
+// - Gets a row of the history of the screen buffer (see TextBuffer::GetHistoryRow).
+// - A row restored from the archive is only valid until the next one is.
+// Arguments:
+// - row - The row to get. Rows that scrolled into the archive are negative.
+// Return Value:
+// - The row.
+const ROW& Search::_GetHistoryRow(const int64_t row) const
+{
+    const auto& textBuffer = _uiaData.GetTextBuffer();
+    if (row >= 0)
+    {
+        return textBuffer.GetRowByOffset(gsl::narrow_cast<size_t>(row));
+    }
+
+    const auto width = gsl::narrow_cast<unsigned short>(textBuffer.GetSize().Width());
+    if (!_archivedRow || _archivedRow->size() != width)
+    {
+        _archivedRow.emplace(SHORT{ 0 }, width, TextAttribute{}, nullptr);
+    }
+    return textBuffer.GetHistoryRow(row, *_archivedRow);
+}
+
+// Routine Description:
+// - Converts a coordinate into its index when counting cells left to right, top to bottom.
+ptrdiff_t Search::_ToIndex(const COORD coord) const noexcept
+{
+    const auto width = _uiaData.GetTextBuffer().GetSize().Width();
+    return static_cast<ptrdiff_t>(coord.Y) * width + coord.X;
+}
+
+// Routine Description:
+// - Converts an index (see _ToIndex) back into a coordinate.
+COORD Search::_ToCoord(const ptrdiff_t index) const noexcept
+{
+    const auto width = _uiaData.GetTextBuffer().GetSize().Width();
+    return { gsl::narrow_cast<SHORT>(index % width), gsl::narrow_cast<SHORT>(index / width) };
+}
+
+// Routine Description:
+// - Gets the span covered by the match starting at the given position.
+// Arguments:
+// - start - The position the match starts at
+// Return Value:
+// - The [start, end] coord positions of the match
+std::pair<COORD, COORD> Search::_GetMatchAt(const COORD start) const noexcept
+{
+    const auto bufferSize = _uiaData.GetTextBuffer().GetSize();
+    const auto cellCount = static_cast<ptrdiff_t>(bufferSize.Width()) * bufferSize.Height();
+    const auto needleLength = gsl::narrow_cast<ptrdiff_t>(_needle.size());
+
+    // The match wraps around the end of the buffer just like _FindNeedleInHaystackAt does.
+    const auto end = (_ToIndex(start) + needleLength - 1 + cellCount) % cellCount;
+    return { start, _ToCoord(end) };
+}
+
 // Routine Description:
 // - Creates a "needle" of the correct format for comparison to the screen buffer text data
 //   that we can use for our search
@@ -55,16 +55,34 @@ public:
     void Select() const;
     void Color(const TextAttribute attr) const;
 
+    std::vector<std::pair<COORD, COORD>> FindAll() const;
+    std::vector<std::pair<COORD, COORD>> FindAll(const COORD first, const COORD last) const;
+
+    // A position in the history of the buffer: the row, where rows that
+    // scrolled into the archive are negative (see TextBuffer::GetHistoryRow),
+    // and the column.
+    using HistoryPosition = std::pair<int64_t, SHORT>;
+    std::vector<HistoryPosition> FindAllInHistory() const;
+
     std::pair<COORD, COORD> GetFoundLocation() const noexcept;
 
 private:
     wchar_t _ApplySensitivity(const wchar_t wch) const noexcept;
-    bool _FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const;
+    bool _FindNeedleInHaystackAt(HistoryPosition pos) const;
     bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept;
     void _UpdateNextPosition();
 
+    void _CompileNeedle();
+    bool _FindInRange(const ptrdiff_t first, const ptrdiff_t last, COORD& found) const;
+    void _FindInRow(const int64_t row, const SHORT firstColumn, const SHORT lastColumn, std::vector<SHORT>& columns) const;
+    const ROW& _GetHistoryRow(const int64_t row) const;
+    ptrdiff_t _ToIndex(const COORD coord) const noexcept;
+    COORD _ToCoord(const ptrdiff_t index) const noexcept;
+    std::pair<COORD, COORD> _GetMatchAt(const COORD start) const noexcept;
+
     void _IncrementCoord(COORD& coord) const noexcept;
     void _DecrementCoord(COORD& coord) const noexcept;
+    void _IncrementHistoryPosition(HistoryPosition& position) const noexcept;
 
     static COORD s_GetInitialAnchor(Microsoft::Console::Types::IUiaData& uiaData, const Direction dir);
 
@@ -81,6 +99,19 @@ private:
     const Sensitivity _sensitivity;
     Microsoft::Console::Types::IUiaData& _uiaData;
 
+    // The first wchar_t of every cell of the needle, with the sensitivity applied.
+    std::vector<wchar_t> _needleKeys;
+
+    // Boyer-Moore-Horspool shift for every (low byte of a) key that ends a
+    // window of the haystack. Keys that share a low byte share the smallest shift.
+    std::array<size_t, 256> _skip;
+
+    // scratch space for the keys of the haystack cells being scanned
+    mutable std::vector<wchar_t> _haystackKeys;
+
+    // scratch space for the row being scanned, if it was restored from the archive
+    mutable std::optional<ROW> _archivedRow;
+
 #ifdef UNIT_TESTING
     friend class SearchTests;
 #endif
@@ -35,22 +35,35 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
     _storage{},
-    _unicodeStorage{},
+    _rowIndex{},
+    _archive{},
+    _hasPendingReflow{ false },
     _renderTarget{ renderTarget },
+
     _size{},
     _currentHyperlinkId{ 1 },
-    _currentPatternId{ 0 }
+    _currentPatternId{ 0 },
+    _patternCache{}
 {
     // initialize ROWs
     _storage.reserve(static_cast<size_t>(screenBufferSize.Y));
+    _rowIndex.reserve(static_cast<size_t>(screenBufferSize.Y));
     for (size_t i = 0; i < static_cast<size_t>(screenBufferSize.Y); ++i)
     {
         _storage.emplace_back(static_cast<SHORT>(i), screenBufferSize.X, _currentAttributes, this);
+        _rowIndex.push_back(static_cast<SHORT>(i));
     }
 
     _UpdateSize();
 }
 
+TextBuffer::~TextBuffer()
+{
+    // The rows tell us about every hyperlink they stop referring to, so they
+    // have to go while our hyperlink maps are still around.
+    _storage.clear();
+}
+
 // Routine Description:
 // - Copies properties from another text buffer into this one.
 // - This is primarily to copy properties that would otherwise not be specified during CreateInstance
@@ -83,11 +96,15 @@ UINT TextBuffer::TotalRowCount() const noexcept
 // - const reference to the requested row. Asserts if out of bounds.
 const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 {
+    // The rows left behind by a lazy reflow are laid out when they're first
+    // needed, which is the one thing reading a row may change.
+    _ReflowPendingForReader(index, false);
+
     const size_t totalRows = TotalRowCount();
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
     const size_t offsetIndex = (_firstRow + index) % totalRows;
-    return _storage.at(offsetIndex);
+    return _storage.at(_rowIndex.at(offsetIndex));
 }
 
 // Routine Description:
@@ -98,12 +115,54 @@ const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 // Return Value:
 // - reference to the requested row. Asserts if out of bounds.
 ROW& TextBuffer::GetRowByOffset(const size_t index)
+{
+    if (_pendingReflow)
+    {
+        _ReflowPendingFrom(index);
+    }
+
+    return _GetRowByOffsetNoReflow(index);
+}
+
+// Routine Description:
+// - Retrieves a row from the history of the buffer: the rows that scrolled
+//   into the archive, followed by the rows of the buffer itself.
+// Arguments:
+// - offset - Number of rows down from the first row of the buffer. Rows that
+//   scrolled into the archive have negative offsets, -1 being the newest one.
+// - scratch - Receives the row if it has to be restored from the archive. It
+//   should be as wide as the buffer.
+// Return Value:
+// - const reference to the requested row, which is scratch for archived rows.
+// Note: will throw if the offset is above the oldest archived row
+const ROW& TextBuffer::GetHistoryRow(const int64_t offset, ROW& scratch) const
+{
+    if (offset >= 0)
+    {
+        return GetRowByOffset(gsl::narrow_cast<size_t>(offset));
+    }
+
+    const auto& archive = GetArchive();
+    const auto fromNewest = gsl::narrow_cast<uint64_t>(-offset);
+    THROW_HR_IF(E_INVALIDARG, fromNewest > archive.size());
+    archive.Restore(archive.size() - fromNewest, scratch);
+    return scratch;
+}
+
+// Routine Description:
+// - Retrieves a row like GetRowByOffset does, but doesn't lay out the row if
+//   a lazy reflow left it pending. Used to write the rows of pending lines.
+// Arguments:
+// - Number of rows down from the first row of the buffer.
+// Return Value:
+// - reference to the requested row. Asserts if out of bounds.
+ROW& TextBuffer::_GetRowByOffsetNoReflow(const size_t index)
 {
     const size_t totalRows = TotalRowCount();
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
     const size_t offsetIndex = (_firstRow + index) % totalRows;
-    return _storage.at(offsetIndex);
+    return _storage.at(_rowIndex.at(offsetIndex));
 }
 
 // Routine Description:
@@ -555,10 +614,36 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
 {
     // FirstRow is at any given point in time the array index in the circular buffer that corresponds
     // to the logical position 0 in the window (cursor coordinates and all other coordinates).
+
+    // The first row might still be waiting for a lazy reflow to lay it out.
+    if (_pendingReflow)
+    {
+        try
+        {
+            _ReflowPendingAbove(1);
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            return false;
+        }
+    }
+
     _renderTarget.TriggerCircling();
 
-    // Prune hyperlinks to delete obsolete references
-    _PruneHyperlinks();
+    // Keep a packed copy of the old "first row" if we're retaining history beyond the buffer height.
+    if (_archive.IsEnabled())
+    {
+        try
+        {
+            _archive.Append(_storage.at(_rowIndex.at(_firstRow)));
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            return false;
+        }
+    }
 
     // Second, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
     auto fillAttributes = _currentAttributes;
@@ -568,7 +653,7 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         // the current background color, but with no meta attributes set.
         fillAttributes.SetStandardErase();
     }
-    const bool fSuccess = _storage.at(_firstRow).Reset(fillAttributes);
+    const bool fSuccess = _storage.at(_rowIndex.at(_firstRow)).Reset(fillAttributes);
     if (fSuccess)
     {
         // Now proceed to increment.
@@ -580,6 +665,11 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         {
             _firstRow = 0;
         }
+
+        if (_pendingReflow)
+        {
+            _pendingReflow->scrolledOff++;
+        }
     }
     return fSuccess;
 }
@@ -688,17 +778,35 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         return;
     }
 
-    // OK. We're about to play games by moving rows around within the deque to
-    // scroll a massive region in a faster way than copying things.
-    // To make this easier, first correct the circular buffer to have the first row be 0 again.
-    if (_firstRow != 0)
+    const auto top = std::min<SHORT>(firstRow, gsl::narrow_cast<SHORT>(firstRow + delta));
+
+    // Rows that are moved around have to be laid out already.
+    if (_pendingReflow)
     {
-        // Rotate the buffer to put the first row at the front.
-        std::rotate(_storage.begin(), _storage.begin() + _firstRow, _storage.end());
+        _ReflowPendingFrom(gsl::narrow_cast<size_t>(std::max<SHORT>(top, 0)));
+    }
+
+    // Scrolling only reorders the entries of the row index that belong to the
+    // rows in the region. The ROWs themselves stay where they are, so this
+    // costs as much as the region is high, no matter how large the buffer is.
+    const auto totalRows = _rowIndex.size();
+    const auto count = gsl::narrow_cast<size_t>(size) + gsl::narrow_cast<size_t>(std::abs(delta));
 
-        // The first row is now at the top.
-        _firstRow = 0;
+    // The rotations below work on the entries of the rows from top to
+    // top + count. If they wrap around the end of the circular buffer, copy
+    // them out so that they're contiguous for the rotation.
+    const auto topSlot = (gsl::narrow_cast<size_t>(_firstRow) + gsl::narrow_cast<size_t>(top)) % totalRows;
+    const auto wraps = topSlot + count > totalRows;
+    std::vector<SHORT> wrapped;
+    if (wraps)
+    {
+        wrapped.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            wrapped.push_back(_rowIndex.at((topSlot + i) % totalRows));
+        }
     }
+    const auto region = wraps ? wrapped.begin() : _rowIndex.begin() + topSlot;
 
     // Rotate just the subsection specified
     if (delta < 0)
@@ -736,7 +844,7 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // | 10
         // | 11
         // - end
-        std::rotate(_storage.begin() + firstRow + delta, _storage.begin() + firstRow, _storage.begin() + firstRow + size);
+        std::rotate(region, region - delta, region + count);
     }
     else
     {
@@ -773,12 +881,179 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // | 10
         // | 11
         // - end
-        std::rotate(_storage.begin() + firstRow, _storage.begin() + firstRow + size, _storage.begin() + firstRow + size + delta);
+        std::rotate(region, region + size, region + count);
+    }
+
+    if (wraps)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            _rowIndex.at((topSlot + i) % totalRows) = wrapped.at(i);
+        }
+    }
+}
+
+// Routine Description:
+// - Copies a rectangle of cells to another place in the buffer. The cells are
+//   copied a span of a row at a time, both the text and the attribute runs,
+//   so this costs as much as the rectangle is high, plus the cells it moves.
+// - The source and the target may overlap.
+// Arguments:
+// - source - the rectangle to copy
+// - targetOrigin - the upper left corner of the place to copy it to. The part
+//   of the target that falls outside of the buffer is clipped, and so is the
+//   part of the source that would have gone there.
+// Return Value:
+// - <none>
+void TextBuffer::CopyRect(const Viewport& source, const COORD targetOrigin)
+{
+    const auto size = GetSize();
+
+    auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
+    target = Viewport::Intersect(size, target);
+    if (!target.IsValid())
+    {
+        return;
+    }
+
+    // Shift the source along with the part of the target that was clipped.
+    const auto clippedOrigin = COORD{ gsl::narrow_cast<SHORT>(source.Left() + target.Left() - targetOrigin.X),
+                                      gsl::narrow_cast<SHORT>(source.Top() + target.Top() - targetOrigin.Y) };
+    const auto clippedSource = Viewport::FromDimensions(clippedOrigin, target.Dimensions());
+    if (!size.IsInBounds(clippedSource))
+    {
+        return;
+    }
+
+    // When the target is below the source, walk the rows bottom up, so that
+    // no row of the source is overwritten before it was copied.
+    const auto height = target.Height();
+    const auto width = gsl::narrow_cast<size_t>(target.Width());
+    const auto left = gsl::narrow_cast<size_t>(target.Left());
+    const auto right = gsl::narrow_cast<size_t>(target.RightInclusive());
+    const auto bottomUp = target.Top() > clippedSource.Top();
+    for (SHORT i = 0; i < height; ++i)
+    {
+        const auto offset = gsl::narrow_cast<SHORT>(bottomUp ? height - 1 - i : i);
+        const ROW& sourceRow = GetRowByOffset(gsl::narrow_cast<size_t>(clippedSource.Top() + offset));
+        ROW& targetRow = GetRowByOffset(gsl::narrow_cast<size_t>(target.Top() + offset));
+
+        const auto sourceLeft = gsl::narrow_cast<size_t>(clippedSource.Left());
+        const auto runs = sourceRow.GetAttrRow().GetAttrRuns(sourceLeft, width);
+        targetRow.GetCharRow().CopyCells(sourceRow.GetCharRow(), sourceLeft, left, width);
+        THROW_IF_FAILED(targetRow.GetAttrRow().InsertAttrRuns(runs, left, right, targetRow.size()));
+
+        _ClearSplitGlyphs(targetRow, left, right);
+    }
+
+    _NotifyPaint(target);
+}
+
+// Routine Description:
+// - Fills a rectangle of cells with a single-width character, a span of a row
+//   at a time.
+// Arguments:
+// - rect - the rectangle to fill. The part outside of the buffer is clipped.
+// - fillChar - the character to fill the cells with
+// - fillAttrs - the attributes to fill the cells with. If not given, the
+//   cells keep their attributes.
+// Return Value:
+// - <none>
+void TextBuffer::FillRect(const Viewport& rect,
+                          const wchar_t fillChar,
+                          const std::optional<TextAttribute> fillAttrs)
+{
+    const auto area = Viewport::Intersect(GetSize(), rect);
+    if (!area.IsValid())
+    {
+        return;
+    }
+
+    const auto width = gsl::narrow_cast<size_t>(area.Width());
+    const auto left = gsl::narrow_cast<size_t>(area.Left());
+    const auto right = gsl::narrow_cast<size_t>(area.RightInclusive());
+    for (auto y = area.Top(); y < area.BottomExclusive(); ++y)
+    {
+        ROW& row = GetRowByOffset(y);
+        row.GetCharRow().FillCells(left, width, fillChar);
+        if (fillAttrs)
+        {
+            const TextAttributeRun run{ width, fillAttrs.value() };
+            THROW_IF_FAILED(row.GetAttrRow().InsertAttrRuns({ &run, 1 }, left, right, row.size()));
+        }
+
+        _ClearSplitGlyphs(row, left, right);
+    }
+
+    _NotifyPaint(area);
+}
+
+// Routine Description:
+// - Changes the attributes of a rectangle of cells. The change is applied to
+//   each of the attribute runs that cover the rectangle, rather than to each
+//   of the cells.
+// Arguments:
+// - rect - the rectangle to change. The part outside of the buffer is clipped.
+// - change - changes the given attributes in place
+// Return Value:
+// - <none>
+void TextBuffer::ChangeAttrsInRect(const Viewport& rect,
+                                   const std::function<void(TextAttribute&)>& change)
+{
+    const auto area = Viewport::Intersect(GetSize(), rect);
+    if (!area.IsValid())
+    {
+        return;
+    }
+
+    const auto width = gsl::narrow_cast<size_t>(area.Width());
+    const auto left = gsl::narrow_cast<size_t>(area.Left());
+    const auto right = gsl::narrow_cast<size_t>(area.RightInclusive());
+    for (auto y = area.Top(); y < area.BottomExclusive(); ++y)
+    {
+        auto& attrRow = GetRowByOffset(y).GetAttrRow();
+        auto runs = attrRow.GetAttrRuns(left, width);
+        for (auto& run : runs)
+        {
+            auto attr = run.GetAttributes();
+            change(attr);
+            run.SetAttributes(attr);
+        }
+        THROW_IF_FAILED(attrRow.InsertAttrRuns(runs, left, right, GetSize().Width()));
     }
 
-    // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
-    // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
-    _RefreshRowIDs(std::nullopt);
+    _NotifyPaint(area);
+}
+
+// Routine Description:
+// - Clears the halves of wide glyphs that an operation on the span of the
+//   given row has split, either at the edges of the span, or just outside of
+//   them. The cells keep their attributes.
+// Arguments:
+// - row - the row that was written to
+// - left - the first column of the span
+// - right - the last column of the span, inclusive
+// Return Value:
+// - <none>
+void TextBuffer::_ClearSplitGlyphs(ROW& row, const size_t left, const size_t right)
+{
+    auto& charRow = row.GetCharRow();
+    if (left > 0 && charRow.DbcsAttrAt(left - 1).IsLeading())
+    {
+        row.ClearColumn(left - 1);
+    }
+    if (charRow.DbcsAttrAt(left).IsTrailing())
+    {
+        row.ClearColumn(left);
+    }
+    if (charRow.DbcsAttrAt(right).IsLeading())
+    {
+        row.ClearColumn(right);
+    }
+    if (right + 1 < row.size() && charRow.DbcsAttrAt(right + 1).IsTrailing())
+    {
+        row.ClearColumn(right + 1);
+    }
 }
 
 Cursor& TextBuffer::GetCursor() noexcept
@@ -808,6 +1083,14 @@ void TextBuffer::Reset()
 {
     const auto attr = GetCurrentAttributes();
 
+    // The lines a lazy reflow hasn't laid out yet are gone as well, but the
+    // ones that already scrolled off still belong in the archive.
+    if (_pendingReflow)
+    {
+        _ReflowPendingAbove(0);
+        _SetPendingReflow(nullptr);
+    }
+
     for (auto& row : _storage)
     {
         row.GetCharRow().Reset();
@@ -827,6 +1110,12 @@ void TextBuffer::Reset()
 
     try
     {
+        // This moves every row around, so they all have to be laid out.
+        if (_pendingReflow)
+        {
+            _ReflowPendingFrom(0);
+        }
+
         const auto currentSize = GetSize().Dimensions();
         const auto attributes = GetCurrentAttributes();
 
@@ -837,30 +1126,25 @@ void TextBuffer::Reset()
         }
         const SHORT TopRowIndex = (GetFirstRowIndex() + TopRow) % currentSize.Y;
 
-        // rotate rows until the top row is at index 0
-        for (int i = 0; i < TopRowIndex; i++)
-        {
-            _storage.emplace_back(std::move(_storage.front()));
-            _storage.erase(_storage.begin());
-        }
-
-        _SetFirstRowIndex(0);
-
-        // realloc in the Y direction
-        // remove rows if we're shrinking
-        while (_storage.size() > static_cast<size_t>(newSize.Y))
+        // lay the rows out in order, starting with the top row at index 0,
+        // and realloc in the Y direction while at it: rows past the new
+        // height are dropped, and rows are added if we're growing
+        std::vector<ROW> storage;
+        storage.reserve(static_cast<size_t>(newSize.Y));
+        for (SHORT i = 0; i < std::min(currentSize.Y, newSize.Y); i++)
         {
-            _storage.pop_back();
+            storage.emplace_back(std::move(_storage.at(_rowIndex.at((TopRowIndex + i) % currentSize.Y))));
         }
-        // add rows if we're growing
-        while (_storage.size() < static_cast<size_t>(newSize.Y))
+        while (storage.size() < static_cast<size_t>(newSize.Y))
         {
-            _storage.emplace_back(static_cast<short>(_storage.size()), newSize.X, attributes, this);
+            storage.emplace_back(static_cast<short>(storage.size()), newSize.X, attributes, this);
         }
+        _storage = std::move(storage);
+
+        _SetFirstRowIndex(0);
 
         // Now that we've tampered with the row placement, refresh all the row IDs.
-        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
-        // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
+        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension.
         _RefreshRowIDs(newSize.X);
 
         // Update the cached size value
@@ -871,14 +1155,108 @@ void TextBuffer::Reset()
     return S_OK;
 }
 
-const UnicodeStorage& TextBuffer::GetUnicodeStorage() const noexcept
+// Routine Description:
+// - Sets how many rows that scroll out of the top of the buffer are retained
+//   in the packed archive behind it.
+// Arguments:
+// - rows - The number of rows to retain. 0 disables the archive.
+void TextBuffer::SetArchiveCapacity(const uint64_t rows)
+{
+    _archive.SetCapacity(rows);
+}
+
+// Routine Description:
+// - Discards every row retained in the archive, e.g. when the scrollback is erased.
+void TextBuffer::ClearArchive() noexcept
+{
+    _archive.Clear();
+
+    // Lines a lazy reflow hasn't laid out yet may have scrolled off the top
+    // already. Those are gone now, and the rows of the line that straddles
+    // the top are no longer archived when it's laid out.
+    if (_pendingReflow)
+    {
+        auto& pending = *_pendingReflow;
+        while (pending.firstLine < pending.endLine)
+        {
+            const auto& line = pending.lines.at(pending.firstLine);
+            if (line.newRow + line.endRow >= pending.scrolledOff)
+            {
+                break;
+            }
+            pending.firstLine++;
+        }
+        pending.archiveFrom = pending.scrolledOff;
+
+        if (pending.firstLine == pending.endLine)
+        {
+            _SetPendingReflow(nullptr);
+        }
+    }
+}
+
+// Routine Description:
+// - Retrieves the archive of rows that have scrolled out of the top of the buffer.
+// Return Value:
+// - The archive. Index 0 is the oldest retained row.
+const RowArchive& TextBuffer::GetArchive() const
+{
+    // Rows that scrolled off during a lazy reflow are only archived once
+    // they're laid out.
+    _ReflowPendingForReader(0, true);
+
+    return _archive;
+}
+
+// Routine Description:
+// - Lays out the rows a lazy reflow left pending for a reader of the buffer.
+//   Only writers hold the buffer exclusively, while readers may share it
+//   across threads. Readers take turns laying out rows, and only look at
+//   what's still pending once it's their turn.
+// - Rows that aren't pending are never written to by laying out the others,
+//   so readers that don't need any rows laid out don't have to wait.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer.
+// - above - If set, lays out the lines above the row, like _ReflowPendingAbove.
+//   Otherwise lays out the line the row belongs to, like _ReflowPendingFrom.
+void TextBuffer::_ReflowPendingForReader(const size_t index, const bool above) const
 {
-    return _unicodeStorage;
+    if (!_hasPendingReflow.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{ _pendingReflowLock };
+    if (!_pendingReflow)
+    {
+        return;
+    }
+
+    // Laying out rows is the one change readers make, and only ever under the lock.
+    auto& self = const_cast<TextBuffer&>(*this);
+    if (above)
+    {
+        self._ReflowPendingAbove(index);
+    }
+    else
+    {
+        self._ReflowPendingFrom(index);
+    }
 }
 
-UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
+// Routine Description:
+// - Replaces the lines a lazy reflow left pending, if any. Hyperlinks that
+//   only they referred to are pruned once no lines are left.
+// Arguments:
+// - pending - The lines to lay out later, or nullptr once there are none.
+void TextBuffer::_SetPendingReflow(std::unique_ptr<PendingReflow> pending)
 {
-    return _unicodeStorage;
+    _pendingReflow = std::move(pending);
+    _hasPendingReflow.store(_pendingReflow != nullptr, std::memory_order_release);
+    if (!_pendingReflow)
+    {
+        _PruneHyperlinks();
+    }
 }
 
 // Routine Description:
@@ -886,20 +1264,20 @@ UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
 //   by shuffling pointers around.
 // - This will also update parent pointers that are stored in depth within the buffer
 //   (e.g. it will update CharRow parents pointing at Rows that might have been moved around)
-// - Optionally takes a new row width if we're resizing to perform a resize operation and cleanup
-//   any high unicode (UnicodeStorage) runs while we're already looping through the rows.
+// - The row index is reset to match, so the rows are in the order they're stored in.
+// - Optionally takes a new row width if we're resizing to perform a resize operation
+//   while we're already looping through the rows.
 // Arguments:
 // - newRowWidth - Optional new value for the row width.
 void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
 {
-    std::unordered_map<SHORT, SHORT> rowMap;
+    _rowIndex.resize(_storage.size());
+
     SHORT i = 0;
     for (auto& it : _storage)
     {
-        // Build a map so we can update Unicode Storage
-        rowMap.emplace(it.GetId(), i);
-
-        // Update the IDs
+        // Update the IDs, and put the row in the position it's stored at
+        _rowIndex.at(i) = i;
         it.SetId(i++);
 
         // Also update the char row parent pointers as they can get shuffled up in the rotates.
@@ -912,9 +1290,6 @@ void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
             THROW_IF_FAILED(it.Resize(newRowWidth.value()));
         }
     }
-
-    // Give the new mapping to Unicode Storage
-    _unicodeStorage.Remap(rowMap, newRowWidth);
 }
 
 void TextBuffer::_NotifyPaint(const Viewport& viewport) const
@@ -933,27 +1308,6 @@ ROW& TextBuffer::_GetFirstRow()
     return GetRowByOffset(0);
 }
 
-// Routine Description:
-// - Retrieves the row that comes before the given row.
-// - Does not wrap around the screen buffer.
-// Arguments:
-// - The current row.
-// Return Value:
-// - reference to the previous row
-// Note:
-// - will throw exception if called with the first row of the text buffer
-ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
-{
-    int prevRowIndex = Row.GetId() - 1;
-    if (prevRowIndex < 0)
-    {
-        prevRowIndex = TotalRowCount() - 1;
-    }
-
-    THROW_HR_IF(E_FAIL, Row.GetId() == _firstRow);
-    return _storage.at(prevRowIndex);
-}
-
 // Method Description:
 // - Retrieves this buffer's current render target.
 // Arguments:
@@ -1223,48 +1577,32 @@ const COORD TextBuffer::_GetWordEndForSelection(const COORD target, const std::w
     return result;
 }
 
+// Routine Description:
+// - Removes the hyperlinks that nothing refers to from our maps. The rows
+//   remove a hyperlink as soon as they stop referring to it, so this is only
+//   needed for the ones they couldn't remove while a lazy reflow was pending,
+//   and for the ones copied over from the buffer we were reflowed from.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
 void TextBuffer::_PruneHyperlinks()
 {
-    // Check the old first row for hyperlink references
-    // If there are any, search the entire buffer for the same reference
-    // If the buffer does not contain the same reference, we can remove that hyperlink from our map
-    // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
-    // Get all the hyperlink references in the row we're erasing
-    const auto hyperlinks = _storage.at(_firstRow).GetAttrRow().GetHyperlinks();
-
-    if (!hyperlinks.empty())
-    {
-        // Move to unordered set so we can use hashed lookup of IDs instead of linear search.
-        // Only make it an unordered set now because set always heap allocates but vector
-        // doesn't when the set is empty (saving an allocation in the common case of no links.)
-        std::unordered_set<uint16_t> firstRowRefs{ hyperlinks.cbegin(), hyperlinks.cend() };
-
-        const auto total = TotalRowCount();
-        // Loop through all the rows in the buffer except the first row -
-        // we have found all hyperlink references in the first row and put them in refs,
-        // now we need to search the rest of the buffer (i.e. all the rows except the first)
-        // to see if those references are anywhere else
-        for (size_t i = 1; i != total; ++i)
-        {
-            const auto nextRowRefs = GetRowByOffset(i).GetAttrRow().GetHyperlinks();
-            for (auto id : nextRowRefs)
-            {
-                if (firstRowRefs.find(id) != firstRowRefs.end())
-                {
-                    firstRowRefs.erase(id);
-                }
-            }
-            if (firstRowRefs.empty())
-            {
-                // No more hyperlink references left to search for, terminate early
-                break;
-            }
-        }
+    // The lines a lazy reflow hasn't laid out yet may still refer to any of
+    // the hyperlinks, so we can't tell whether one is obsolete.
+    if (_pendingReflow)
+    {
+        return;
+    }
 
-        // Now delete obsolete references from our map
-        for (auto hyperlinkReference : firstRowRefs)
+    std::lock_guard<std::mutex> lock{ _hyperlinkLock };
+    for (auto it = _hyperlinkMap.begin(); it != _hyperlinkMap.end();)
+    {
+        const auto id = it->first;
+        ++it;
+        if (_hyperlinkRefCounts.find(id) == _hyperlinkRefCounts.end() && id != _currentAttributes.GetHyperlinkId())
         {
-            RemoveHyperlinkFromMap(hyperlinkReference);
+            RemoveHyperlinkFromMap(id);
         }
     }
 }
@@ -1516,7 +1854,8 @@ void TextBuffer::_ExpandTextRow(SMALL_RECT& textRow) const
 // Arguments:
 // - includeCRLF - inject CRLF pairs to the end of each line
 // - trimTrailingWhitespace - remove the trailing whitespace at the end of each line
-// - textRects - the rectangular regions from which the data will be extracted from the buffer (i.e.: selection rects)
+// - textRects - the rectangular regions from which the data will be extracted from the buffer (i.e.: selection rects).
+//   Rows above the top of the buffer are read from the archive (see GetHistoryRow).
 // - GetAttributeColors - function used to map TextAttribute to RGB COLORREFs. If null, only extract the text.
 // - formatWrappedRows - if set we will apply formatting (CRLF inclusion and whitespace trimming) on wrapped rows
 // Return Value:
@@ -1539,15 +1878,24 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
         data.BkAttr.reserve(rows);
     }
 
+    // archived rows are restored into this one as we get to them
+    std::optional<ROW> scratch;
+
     // for each row in the selection
     for (UINT i = 0; i < rows; i++)
     {
-        const UINT iRow = selectionRects.at(i).Top;
+        const SHORT iRow = selectionRects.at(i).Top;
 
         const Viewport highlight = Viewport::FromInclusive(selectionRects.at(i));
 
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
+        if (iRow < 0 && !scratch)
+        {
+            scratch.emplace(SHORT{ 0 }, gsl::narrow_cast<unsigned short>(_size.Width()), _currentAttributes, nullptr);
+        }
+
+        // retrieve the data from the screen buffer, or the archive if the row scrolled off the top
+        const ROW& row = iRow < 0 ? GetHistoryRow(iRow, *scratch) : GetRowByOffset(iRow);
+        auto it = row.AsCellIter(highlight.Left(), highlight.Width());
 
         // allocate a string buffer
         std::wstring selectionText;
@@ -1588,7 +1936,8 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
         }
 
         // We apply formatting to rows if the row was NOT wrapped or formatting of wrapped rows is allowed
-        const bool shouldFormatRow = formatWrappedRows || !GetRowByOffset(iRow).GetCharRow().WasWrapForced();
+        const bool shouldFormatRow = formatWrappedRows || !row.GetCharRow().WasWrapForced();
+
 
         if (trimTrailingWhitespace)
         {
@@ -2019,6 +2368,20 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
 //   can have different dimensions than the old buffer. If it does, then this
 //   function will attempt to maintain the logical contents of the old buffer,
 //   by continuing wrapped lines onto the next line in the new buffer.
+// - The new buffer is expected to be empty, with its cursor at the origin.
+// - Once this succeeds, the new buffer has taken over the archive of the old
+//   buffer, and possibly its rows. The old buffer must not be used for
+//   anything but its destruction then, which may happen at any time.
+
+// - The old buffer is split into logical lines first. Every logical line
+//   starts at the beginning of a row in the new buffer, so once we know how
+//   many rows each of them takes up, they are laid out into their rows
+//   independently of each other, on as many threads as it's worth.
+// - When reflowing lazily, only the lines from a little above the rows we
+//   need to find in the new buffer on down are laid out right away. The rest
+//   keep the width they had and are laid out when their rows are first
+//   accessed. The lines the old buffer still had pending are carried over as
+//   they are, so resizing over and over doesn't lay them out every time.
 // Arguments:
 // - oldBuffer - the text buffer to copy the contents FROM
 // - newBuffer - the text buffer to copy the contents TO
@@ -2028,12 +2391,17 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
 // - positionInfo - Optional. The caller can provide a pair of rows in this
 //   parameter and we'll calculate the position of the _end_ of those rows in
 //   the new buffer. The rows's new value is placed back into this parameter.
+// - lazily - Optional. Defers laying out the lines above the rows we need to
+//   find. If anything is deferred, the new buffer takes over the rows of the
+//   old buffer as well, and keeps them alive until they're laid out.
 // Return Value:
+
 // - S_OK if we successfully copied the contents to the new buffer, otherwise an appropriate HRESULT.
 HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
                            TextBuffer& newBuffer,
                            const std::optional<Viewport> lastCharacterViewport,
-                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
+                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo,
+                           const bool lazily)
 {
     const Cursor& oldCursor = oldBuffer.GetCursor();
     Cursor& newCursor = newBuffer.GetCursor();
@@ -2044,157 +2412,308 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
     const COORD cOldCursorPos = oldCursor.GetPosition();
     const COORD cOldLastChar = oldBuffer.GetLastNonSpaceCharacter(lastCharacterViewport);
 
-    const short cOldRowsTotal = cOldLastChar.Y + 1;
-    const short cOldColsTotal = oldBuffer.GetSize().Width();
-
-    COORD cNewCursorPos = { 0 };
-    bool fFoundCursorPos = false;
-    bool foundOldMutable = false;
-    bool foundOldVisible = false;
-    HRESULT hr = S_OK;
-    // Loop through all the rows of the old buffer and reprint them into the new buffer
-    for (short iOldRow = 0; iOldRow < cOldRowsTotal; iOldRow++)
-    {
-        // Fetch the row and its "right" which is the last printable character.
-        const ROW& row = oldBuffer.GetRowByOffset(iOldRow);
-        const CharRow& charRow = row.GetCharRow();
-        short iRight = gsl::narrow_cast<short>(charRow.MeasureRight());
-
-        // There is a special case here. If the row has a "wrap"
-        // flag on it, but the right isn't equal to the width (one
-        // index past the final valid index in the row) then there
-        // were a bunch trailing of spaces in the row.
-        // (But the measuring functions for each row Left/Right do
-        // not count spaces as "displayable" so they're not
-        // included.)
-        // As such, adjust the "right" to be the width of the row
-        // to capture all these spaces
-        if (charRow.WasWrapForced())
-        {
-            iRight = cOldColsTotal;
-
-            // And a combined special case.
-            // If we wrapped off the end of the row by adding a
-            // piece of padding because of a double byte LEADING
-            // character, then remove one from the "right" to
-            // leave this padding out of the copy process.
-            if (charRow.WasDoubleBytePadded())
-            {
-                iRight--;
-            }
-        }
+    // These are the positions in the old buffer we'll need to find in the
+    // new one: the cursor, and the ends of the rows the caller asked about.
+    std::array<ReflowPosition, 3> positions{};
+    positions.at(0).oldRow = cOldCursorPos.Y;
+    positions.at(0).oldColumn = cOldCursorPos.X;
+    positions.at(1).oldRow = -1;
+    positions.at(2).oldRow = -1;
+    if (positionInfo.has_value())
+    {
+        positions.at(1).oldRow = std::max<short>(positionInfo.value().get().mutableViewportTop, 0);
+        positions.at(1).endOfRow = true;
+        positions.at(2).oldRow = std::max<short>(positionInfo.value().get().visibleViewportTop, 0);
+        positions.at(2).endOfRow = true;
+    }
 
-        // Loop through every character in the current row (up to
-        // the "right" boundary, which is one past the final valid
-        // character)
-        for (short iOldCol = 0; iOldCol < iRight; iOldCol++)
+    // If the old buffer was reflowed lazily as well, the rows we need to find
+    // are laid out by looking at them. The lines that scrolled off its top
+    // are archived, so that they don't come back into the new buffer.
+    if (oldBuffer._pendingReflow)
+    {
+        try
         {
-            if (iOldCol == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
-            {
-                cNewCursorPos = newCursor.GetPosition();
-                fFoundCursorPos = true;
-            }
-
-            try
+            oldBuffer._ReflowPendingAbove(0);
+            for (const auto& position : positions)
             {
-                // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-                const auto glyph = row.GetCharRow().GlyphAt(iOldCol);
-                const auto dbcsAttr = row.GetCharRow().DbcsAttrAt(iOldCol);
-                const auto textAttr = row.GetAttrRow().GetAttrByColumn(iOldCol);
-
-                if (!newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr))
+                if (position.oldRow >= 0)
                 {
-                    hr = E_OUTOFMEMORY;
-                    break;
+                    oldBuffer.GetRowByOffset(position.oldRow);
                 }
             }
-            CATCH_RETURN();
         }
+        CATCH_RETURN();
+    }
 
-        // If we found the old row that the caller was interested in, set the
-        // out value of that parameter to the cursor's current Y position (the
-        // new location of the _end_ of that row in the buffer).
-        if (positionInfo.has_value())
+    // The archive doesn't depend on the width of the buffer, so hand it over
+    // before we start. Rows that don't fit into the new buffer while we reflow
+    // are then appended behind the rows that were already archived.
+    newBuffer._archive = std::move(oldBuffer._archive);
+    auto restoreArchive = wil::scope_exit([&]() noexcept {
+        oldBuffer._archive = std::move(newBuffer._archive);
+    });
+
+    const short cOldColsTotal = oldBuffer.GetSize().Width();
+    const short cNewRowsTotal = newBuffer.GetSize().Height();
+    const short cNewColsTotal = newBuffer.GetSize().Width();
+
+    COORD cNewCursorPos = { 0 };
+    bool fFoundCursorPos = false;
+    uint64_t restoredRows = 0;
+    HRESULT hr = S_OK;
+    try
+    {
+        // The lines the old buffer has yet to lay out sit between the rows
+        // above and below them, which are blank until then.
+        gsl::span<const ReflowLine> carriedLines;
+        short pendingTop = cOldLastChar.Y + 1;
+        short pendingBottom = pendingTop;
+        if (const auto& pending = oldBuffer._pendingReflow)
         {
-            if (!foundOldMutable)
+            carriedLines = gsl::make_span(pending->lines).subspan(pending->firstLine, pending->endLine - pending->firstLine);
+            const auto& last = carriedLines.back();
+            pendingTop = gsl::narrow<short>(carriedLines.front().newRow - pending->scrolledOff);
+            pendingBottom = gsl::narrow<short>(last.newRow + last.endRow + 1 - pending->scrolledOff);
+        }
+        const short cOldRowsTotal = std::max<short>(cOldLastChar.Y + 1, pendingBottom);
+
+        const auto oldSource = std::make_shared<ReflowSource>();
+        oldSource->storage = oldBuffer._storage;
+        oldSource->rowIndex = oldBuffer._rowIndex;
+        oldSource->firstRow = gsl::narrow_cast<size_t>(oldBuffer._firstRow);
+        oldSource->width = cOldColsTotal;
+        oldSource->rows.resize(gsl::narrow_cast<size_t>(cOldRowsTotal));
+
+        // First find the "right" of every row, which is one past the last
+        // character we need to copy from it.
+        _ForEachRange(oldSource->rows.size(), [&](const size_t first, const size_t last) {
+            for (size_t iOldRow = first; iOldRow < last; ++iOldRow)
             {
-                if (iOldRow >= positionInfo.value().get().mutableViewportTop)
+                if (iOldRow >= gsl::narrow_cast<size_t>(pendingTop) && iOldRow < gsl::narrow_cast<size_t>(pendingBottom))
                 {
-                    positionInfo.value().get().mutableViewportTop = newCursor.GetPosition().Y;
-                    foundOldMutable = true;
+                    continue;
                 }
-            }
 
-            if (!foundOldVisible)
+                oldSource->rows.at(iOldRow) = _MeasureRow(oldSource->GetRowByOffset(iOldRow).GetCharRow(), cOldColsTotal);
+            }
+        });
+
+        // A logical line ends with every row that didn't have a full row to
+        // copy and wasn't forced to wrap. Only those get a newline in the new
+        // buffer. Everything else runs on into the row after it.
+        std::vector<ReflowLine> lines;
+        const auto splitRows = [&](const short firstRow, const short endRow) {
+            for (short iOldRow = firstRow, iFirstRow = firstRow; iOldRow < endRow; iOldRow++)
             {
-                if (iOldRow >= positionInfo.value().get().visibleViewportTop)
+                if (iOldRow == endRow - 1 || oldSource->EndsWithNewline(iOldRow))
                 {
-                    positionInfo.value().get().visibleViewportTop = newCursor.GetPosition().Y;
-                    foundOldVisible = true;
+                    lines.push_back({ oldSource.get(), iFirstRow, iOldRow });
+                    iFirstRow = gsl::narrow_cast<short>(iOldRow + 1);
                 }
             }
-        }
-
-        if (SUCCEEDED(hr))
+        };
+        splitRows(0, pendingTop);
+        lines.insert(lines.end(), carriedLines.begin(), carriedLines.end());
+        splitRows(pendingBottom, cOldRowsTotal);
+
+        // Measure how many rows each line takes up in the new buffer without
+        // writing anything yet. The positions we need to find are all in the
+        // rows of the old buffer itself.
+        _ForEachRange(lines.size(), [&](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i)
+            {
+                auto& line = lines.at(i);
+                std::tie(line.endRow, line.endColumn) = _MeasureLine(line, cNewColsTotal, line.source == oldSource.get() ? gsl::span<ReflowPosition>{ positions } : gsl::span<ReflowPosition>{});
+            }
+        });
+
+        // The lines that scrolled into the archive come back into the rows
+        // reflowing frees up at the top of the buffer, as long as the text
+        // keeps as many blank rows below it as it had before.
+        std::shared_ptr<ReflowSource> archivedSource;
+        if (!newBuffer._archive.empty())
         {
-            // If we didn't have a full row to copy, insert a new
-            // line into the new buffer.
-            // Only do so if we were not forced to wrap. If we did
-            // force a word wrap, then the existing line break was
-            // only because we ran out of space.
-            if (iRight < cOldColsTotal && !charRow.WasWrapForced())
+            // The cursor may need a row of its own after the final line.
+            size_t rowsNeeded = 1;
+            for (const auto& line : lines)
             {
-                if (iRight == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
-                {
-                    cNewCursorPos = newCursor.GetPosition();
-                    fFoundCursorPos = true;
-                }
-                // Only do this if it's not the final line in the buffer.
-                // On the final line, we want the cursor to sit
-                // where it is done printing for the cursor
-                // adjustment to follow.
-                if (iOldRow < cOldRowsTotal - 1)
-                {
-                    hr = newBuffer.NewlineCursor() ? hr : E_OUTOFMEMORY;
-                }
-                else
+                rowsNeeded += line.endRow + 1;
+            }
+            rowsNeeded += gsl::narrow_cast<size_t>(std::max(oldBuffer.GetSize().Height() - cOldRowsTotal, 0));
+
+
+            if (rowsNeeded < gsl::narrow_cast<size_t>(cNewRowsTotal))
+            {
+                std::vector<ReflowLine> archivedLines;
+                archivedSource = newBuffer._RestoreArchivedLines(gsl::narrow_cast<size_t>(cNewRowsTotal) - rowsNeeded, cNewColsTotal, archivedLines);
+                if (archivedSource)
                 {
-                    // If we are on the final line of the buffer, we have one more check.
-                    // We got into this code path because we are at the right most column of a row in the old buffer
-                    // that had a hard return (no wrap was forced).
-                    // However, as we're inserting, the old row might have just barely fit into the new buffer and
-                    // caused a new soft return (wrap was forced) putting the cursor at x=0 on the line just below.
-                    // We need to preserve the memory of the hard return at this point by inserting one additional
-                    // hard newline, otherwise we've lost that information.
-                    // We only do this when the cursor has just barely poured over onto the next line so the hard return
-                    // isn't covered by the soft one.
-                    // e.g.
-                    // The old line was:
-                    // |aaaaaaaaaaaaaaaaaaa | with no wrap which means there was a newline after that final a.
-                    // The cursor was here ^
-                    // And the new line will be:
-                    // |aaaaaaaaaaaaaaaaaaa| and show a wrap at the end
-                    // |                   |
-                    //  ^ and the cursor is now there.
-                    // If we leave it like this, we've lost the newline information.
-                    // So we insert one more newline so a continued reflow of this buffer by resizing larger will
-                    // continue to look as the original output intended with the newline data.
-                    // After this fix, it looks like this:
-                    // |aaaaaaaaaaaaaaaaaaa| no wrap at the end (preserved hard newline)
-                    // |                   |
-                    //  ^ and the cursor is now here.
-                    const COORD coordNewCursor = newCursor.GetPosition();
-                    if (coordNewCursor.X == 0 && coordNewCursor.Y > 0)
+                    restoredRows = archivedSource->rows.size();
+
+                    // The positions we found point at the lines they're in.
+                    const auto shift = archivedLines.size();
+                    archivedLines.insert(archivedLines.end(), lines.begin(), lines.end());
+                    for (auto& position : positions)
                     {
-                        if (newBuffer.GetRowByOffset(gsl::narrow_cast<size_t>(coordNewCursor.Y) - 1).GetCharRow().WasWrapForced())
+                        if (position.line)
                         {
-                            hr = newBuffer.NewlineCursor() ? hr : E_OUTOFMEMORY;
+                            position.line = &archivedLines.at(shift + gsl::narrow_cast<size_t>(position.line - lines.data()));
                         }
                     }
+                    lines = std::move(archivedLines);
                 }
             }
         }
+
+        // Each line starts on the row after the one the previous line ended on.
+        size_t newRow = 0;
+        for (auto& line : lines)
+        {
+            line.newRow = newRow;
+            newRow += line.endRow + 1;
+        }
+
+        // On the final line, we want the cursor to sit where it is done
+        // printing for the cursor adjustment to follow, so it doesn't get a
+        // newline. With one exception:
+        // We got into this code path because we are at the right most column of a row in the old buffer
+        // that had a hard return (no wrap was forced).
+        // However, as we're inserting, the old row might have just barely fit into the new buffer and
+        // caused a new soft return (wrap was forced) putting the cursor at x=0 on the line just below.
+        // We need to preserve the memory of the hard return at this point by inserting one additional
+        // hard newline, otherwise we've lost that information.
+        // We only do this when the cursor has just barely poured over onto the next line so the hard return
+        // isn't covered by the soft one.
+        // e.g.
+        // The old line was:
+        // |aaaaaaaaaaaaaaaaaaa | with no wrap which means there was a newline after that final a.
+        // The cursor was here ^
+        // And the new line will be:
+        // |aaaaaaaaaaaaaaaaaaa| and show a wrap at the end
+        // |                   |
+        //  ^ and the cursor is now there.
+        // If we leave it like this, we've lost the newline information.
+        // So we insert one more newline so a continued reflow of this buffer by resizing larger will
+        // continue to look as the original output intended with the newline data.
+        // After this fix, it looks like this:
+        // |aaaaaaaaaaaaaaaaaaa| no wrap at the end (preserved hard newline)
+        // |                   |
+        //  ^ and the cursor is now here.
+        const auto& finalLine = lines.back();
+        size_t finalRow = finalLine.newRow + finalLine.endRow;
+        const short finalColumn = finalLine.endColumn;
+        if (finalLine.source->EndsWithNewline(finalLine.lastRow) && finalColumn == 0 && finalLine.endRow > 0 && cNewRowsTotal > 1)
+        {
+            finalRow++;
+        }
+
+        // Once the cursor runs past the bottom of the new buffer, every row it
+        // moves on circles the buffer, so the rows at the top scroll off.
+        const size_t newRowsTotal = gsl::narrow_cast<size_t>(cNewRowsTotal);
+        const size_t scrolledOff = finalRow >= newRowsTotal ? finalRow - (newRowsTotal - 1) : 0;
+        const auto toNewPosition = [&](const size_t row, const short column) {
+            return COORD{ column, gsl::narrow_cast<short>(std::min(row, newRowsTotal - 1)) };
+        };
+
+        const auto& cursorPosition = positions.at(0);
+        if (cursorPosition.line)
+        {
+            cNewCursorPos = toNewPosition(cursorPosition.line->newRow + cursorPosition.newRow, cursorPosition.newColumn);
+            fFoundCursorPos = true;
+        }
+
+        // If we found the old rows that the caller was interested in, set the
+        // out value of that parameter to the cursor's Y position at the
+        // end of those rows (the new location of the _end_ of that row in the buffer).
+        if (positionInfo.has_value())
+        {
+            const auto& mutablePosition = positions.at(1);
+            if (mutablePosition.line)
+            {
+                positionInfo.value().get().mutableViewportTop = toNewPosition(mutablePosition.line->newRow + mutablePosition.newRow, 0).Y;
+            }
+
+            const auto& visiblePosition = positions.at(2);
+            if (visiblePosition.line)
+            {
+                positionInfo.value().get().visibleViewportTop = toNewPosition(visiblePosition.line->newRow + visiblePosition.newRow, 0).Y;
+            }
+        }
+
+        // When reflowing lazily, the lines above the topmost position we found
+        // are left for later, save for a margin to scroll around in. If any of
+        // the lines left to lay out now scroll off the top, they have to be
+        // archived in order, so nothing is left for later.
+        size_t firstEagerLine = 0;
+        if (lazily)
+        {
+            size_t topRow = finalRow;
+            for (const auto& position : positions)
+            {
+                if (position.line)
+                {
+                    topRow = std::min(topRow, position.line->newRow + position.newRow);
+                }
+            }
+
+            const auto topLine = std::upper_bound(lines.cbegin(), lines.cend(), topRow, [](const size_t row, const ReflowLine& line) {
+                return row < line.newRow;
+            });
+            firstEagerLine = gsl::narrow_cast<size_t>(std::distance(lines.cbegin(), topLine) - 1);
+            firstEagerLine -= std::min(firstEagerLine, s_reflowGrain);
+            if (lines.at(firstEagerLine).newRow < scrolledOff)
+            {
+                firstEagerLine = 0;
+            }
+        }
+
+        // Line up the circular buffer the way it would have ended up if the rows
+        // had scrolled off one by one.
+        newBuffer._firstRow = gsl::narrow_cast<SHORT>(scrolledOff % newRowsTotal);
+
+        newBuffer._LayOutLines(gsl::make_span(lines).subspan(firstEagerLine), scrolledOff, 0, newBuffer._currentAttributes);
+
+        if (firstEagerLine > 0)
+        {
+            auto pending = std::make_unique<PendingReflow>();
+            pending->lines.assign(lines.cbegin(), lines.cbegin() + firstEagerLine);
+            pending->firstLine = 0;
+            pending->endLine = firstEagerLine;
+            pending->scrolledOff = scrolledOff;
+            pending->archiveFrom = 0;
+            pending->fillAttributes = newBuffer._currentAttributes;
+
+            // Hold on to the rows the pending lines are made of.
+            if (oldBuffer._pendingReflow)
+            {
+                pending->sources = oldBuffer._pendingReflow->sources;
+            }
+            pending->sources.push_back(oldSource);
+            if (archivedSource)
+            {
+                pending->sources.push_back(archivedSource);
+            }
+            auto& sources = pending->sources;
+            sources.erase(std::remove_if(sources.begin(), sources.end(), [&](const auto& source) {
+                              return std::none_of(pending->lines.cbegin(), pending->lines.cend(), [&](const ReflowLine& line) {
+                                  return line.source == source.get();
+                              });
+                          }),
+                          sources.end());
+
+            newBuffer._SetPendingReflow(std::move(pending));
+        }
+
+        if (scrolledOff > 0)
+        {
+            newBuffer._renderTarget.TriggerCircling();
+        }
+
+        newCursor.SetPosition(toNewPosition(finalRow, finalColumn));
     }
+    CATCH_RETURN();
+
     if (SUCCEEDED(hr))
     {
         // Finish copying remaining parameters from the old text buffer to the new one
@@ -2262,11 +2781,608 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
 
         // Set size back to real size as it will be taking over the rendering duties.
         newCursor.SetSize(ulSize);
+
+        // The new buffer is taking over, so it keeps the archive, less the
+        // rows that came back into it.
+        newBuffer._archive.PopNewest(restoredRows);
+        restoreArchive.release();
+
+
+        // It also keeps the rows of the old buffer if any of its pending
+        // lines are made of them.
+        if (newBuffer._pendingReflow)
+        {
+            for (const auto& source : newBuffer._pendingReflow->sources)
+            {
+                if (source->storage.data() == oldBuffer._storage.data())
+                {
+                    source->ownedStorage = std::move(oldBuffer._storage);
+                    source->ownedRowIndex = std::move(oldBuffer._rowIndex);
+
+                    // The old buffer isn't going to count their hyperlinks anymore.
+                    for (auto& row : source->ownedStorage)
+                    {
+                        row.GetAttrRow().Detach();
+                    }
+                }
+            }
+        }
     }
 
     return hr;
 }
 
+// Routine Description:
+// - Lays out measured lines into the rows of this buffer that they start on.
+//   The lines that scroll off the top, in full or in part, are laid out one
+//   after the other into scratch rows, which are handed to the archive in
+//   order. Without an archive, only the line that straddles the top needs to
+//   be laid out at all. Everything else is laid out in parallel, as no two
+//   lines share a row.
+// Arguments:
+// - lines - the lines to lay out. Lines that scroll off the top must be the
+//   oldest ones that weren't archived yet.
+// - scrolledOff - the row of the lines that is at the top of the buffer
+// - archiveFrom - rows above this one aren't handed to the archive
+// - fillAttributes - the attributes to reset the scratch rows with
+void TextBuffer::_LayOutLines(const gsl::span<const ReflowLine> lines,
+                              const size_t scrolledOff,
+                              const size_t archiveFrom,
+                              const TextAttribute fillAttributes)
+{
+    const short width = GetSize().Width();
+    const auto firstVisibleLine = std::find_if(lines.begin(), lines.end(), [&](const ReflowLine& line) {
+        return line.newRow >= scrolledOff;
+    });
+    if (firstVisibleLine != lines.begin())
+    {
+        std::array<ROW, 2> scratch{ ROW{ 0, gsl::narrow_cast<unsigned short>(width), fillAttributes, this },
+                                    ROW{ 1, gsl::narrow_cast<unsigned short>(width), fillAttributes, this } };
+        size_t archived = 0;
+
+        // A scratch row is only reused two rows later, as laying out a row can
+        // still clear the final cell of the row before it.
+        const auto archiveUpTo = [&](const size_t row) {
+            for (; archived < row; ++archived)
+            {
+                if (_archive.IsEnabled())
+                {
+                    _archive.Append(scratch.at(archived % 2));
+                }
+            }
+        };
+
+        auto line = _archive.IsEnabled() ? lines.begin() : std::prev(firstVisibleLine);
+        archived = std::max(line->newRow, archiveFrom);
+        for (; line != firstVisibleLine; ++line)
+        {
+            _ReflowLine(*line, width, [&](const size_t offset) {
+                const auto row = line->newRow + offset;
+                if (row >= scrolledOff)
+                {
+                    return &_GetRowByOffsetNoReflow(row - scrolledOff);
+                }
+
+                archiveUpTo(row > 0 ? row - 1 : 0);
+                auto& target = scratch.at(row % 2);
+                THROW_HR_IF(E_OUTOFMEMORY, !target.Reset(fillAttributes));
+                return &target;
+            },
+                        {});
+        }
+        archiveUpTo(scrolledOff);
+    }
+
+    const auto firstParallelLine = gsl::narrow_cast<size_t>(std::distance(lines.begin(), firstVisibleLine));
+    _ForEachRange(lines.size() - firstParallelLine, [&](const size_t first, const size_t last) {
+        for (size_t i = firstParallelLine + first; i < firstParallelLine + last; ++i)
+        {
+            const auto& line = gsl::at(lines, i);
+            _ReflowLine(line, width, [&](const size_t offset) {
+                return &_GetRowByOffsetNoReflow(line.newRow + offset - scrolledOff);
+            },
+                        {});
+        }
+    });
+}
+
+// Routine Description:
+// - Lays out the lines a lazy reflow left pending that the given row or any
+//   row below it belongs to. At least s_reflowGrain lines are laid out at
+//   once, so that scrolling up through them doesn't stop for every line.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer.
+void TextBuffer::_ReflowPendingFrom(const size_t index)
+{
+    auto& pending = *_pendingReflow;
+    const auto first = pending.lines.cbegin() + pending.firstLine;
+    const auto end = pending.lines.cbegin() + pending.endLine;
+    const auto& last = *std::prev(end);
+
+    const auto row = pending.scrolledOff + index;
+    if (row < first->newRow || row > last.newRow + last.endRow)
+    {
+        return;
+    }
+
+    auto line = std::prev(std::upper_bound(first, end, row, [](const size_t row, const ReflowLine& line) {
+        return row < line.newRow;
+    }));
+    line = std::min(line, end - std::min(gsl::narrow_cast<ptrdiff_t>(s_reflowGrain), end - first));
+
+    // Lines that scrolled off the top have to be archived in order.
+    if (line->newRow < pending.scrolledOff)
+    {
+        line = first;
+    }
+
+    _LayOutLines({ &*line, gsl::narrow_cast<size_t>(end - line) }, pending.scrolledOff, pending.archiveFrom, pending.fillAttributes);
+
+    pending.endLine = gsl::narrow_cast<size_t>(line - pending.lines.cbegin());
+    if (pending.firstLine == pending.endLine)
+    {
+        _SetPendingReflow(nullptr);
+    }
+}
+
+// Routine Description:
+// - Lays out the lines a lazy reflow left pending that start above the given
+//   row. Rows of theirs that scrolled off the top are archived.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer.
+void TextBuffer::_ReflowPendingAbove(const size_t index)
+{
+    auto& pending = *_pendingReflow;
+    const auto first = pending.lines.cbegin() + pending.firstLine;
+    const auto end = pending.lines.cbegin() + pending.endLine;
+
+    const auto row = pending.scrolledOff + index;
+    const auto line = std::lower_bound(first, end, row, [](const ReflowLine& line, const size_t row) {
+        return line.newRow < row;
+    });
+    if (line == first)
+    {
+        return;
+    }
+
+    _LayOutLines({ &*first, gsl::narrow_cast<size_t>(line - first) }, pending.scrolledOff, pending.archiveFrom, pending.fillAttributes);
+
+    pending.firstLine = gsl::narrow_cast<size_t>(line - pending.lines.cbegin());
+    if (pending.firstLine == pending.endLine)
+    {
+        _SetPendingReflow(nullptr);
+    }
+}
+
+// Routine Description:
+// - Measures where a line ends without laying it out, like _ReflowLine does
+//   without a row to write into. A line without double-byte characters takes
+//   up one cell per character, so unless we need to find a position in it,
+//   we only need to know how many characters it has.
+// Arguments:
+// - line - the rows of the old buffer that make up the line
+// - newWidth - the width of the rows to measure the line in
+// - positions - positions in the old buffer to find. The ones found within
+//   this line are updated with where they ended up.
+// Return Value:
+// - Where the cursor stops after the last character of the line, with the
+//   row relative to the first row of the line.
+std::pair<size_t, short> TextBuffer::_MeasureLine(const ReflowLine& line,
+                                                  const short newWidth,
+                                                  gsl::span<ReflowPosition> positions)
+{
+    size_t length = 0;
+    for (short iOldRow = line.firstRow; iOldRow <= line.lastRow; iOldRow++)
+    {
+        const auto& row = line.source->rows.at(iOldRow);
+        const auto hasPosition = std::any_of(positions.begin(), positions.end(), [&](const ReflowPosition& position) {
+            return position.oldRow == iOldRow;
+        });
+        if (row.doubleByte || hasPosition)
+        {
+            return _ReflowLine(line, newWidth, [](const size_t) -> ROW* { return nullptr; }, positions);
+        }
+        length += gsl::narrow_cast<size_t>(row.right);
+    }
+
+    const auto width = gsl::narrow_cast<size_t>(newWidth);
+    return { length / width, gsl::narrow_cast<short>(length % width) };
+}
+
+// Routine Description:
+// - Finds how much of a row needs to be copied when it's reflowed.
+// Arguments:
+// - charRow - the row to measure
+// - width - the width of the buffer the row is in
+// Return Value:
+// - The "right" of the row, which is one past the last character we need to
+//   copy from it, and whether any of those characters are double-byte.
+TextBuffer::ReflowRow TextBuffer::_MeasureRow(const CharRow& charRow, const short width)
+{
+    short iRight = gsl::narrow_cast<short>(charRow.MeasureRight());
+
+    // There is a special case here. If the row has a "wrap"
+    // flag on it, but the right isn't equal to the width (one
+    // index past the final valid index in the row) then there
+    // were a bunch trailing of spaces in the row.
+    // (But the measuring functions for each row Left/Right do
+    // not count spaces as "displayable" so they're not
+    // included.)
+    // As such, adjust the "right" to be the width of the row
+    // to capture all these spaces
+    if (charRow.WasWrapForced())
+    {
+        iRight = width;
+
+        // And a combined special case.
+        // If we wrapped off the end of the row by adding a
+        // piece of padding because of a double byte LEADING
+        // character, then remove one from the "right" to
+        // leave this padding out of the copy process.
+        if (charRow.WasDoubleBytePadded())
+        {
+            iRight--;
+        }
+    }
+
+    ReflowRow row{ iRight, false };
+    for (short iOldCol = 0; iOldCol < iRight && !row.doubleByte; iOldCol++)
+    {
+        row.doubleByte = !charRow.DbcsAttrAt(iOldCol).IsSingle();
+    }
+    return row;
+}
+
+// Routine Description:
+// - Restores the newest lines of the archive for a reflow to lay out again,
+//   as many as fit into the given number of rows. Only whole lines come back,
+//   so none do if the newest archived row was wrapped onto the top row of the
+//   buffer. Every row is restored with the width it was archived with.
+// - The rows stay in the archive until the reflow no longer needs them there.
+// Arguments:
+// - rows - the number of rows of the new width that the lines may take up
+// - newWidth - the width of the rows to lay the lines out into
+// - lines - receives the measured lines, oldest first
+// Return Value:
+// - The rows the lines are made of, or nullptr if no line fit.
+std::shared_ptr<TextBuffer::ReflowSource> TextBuffer::_RestoreArchivedLines(const size_t rows,
+                                                                           const short newWidth,
+                                                                           std::vector<ReflowLine>& lines) const
+{
+    auto end = _archive.size();
+    if (end == 0 || _archive.WasWrapForced(end - 1))
+    {
+        return nullptr;
+    }
+
+    // Each line is restored and measured on its own, newest first, until one
+    // doesn't fit anymore.
+    struct RestoredLine
+    {
+        std::vector<ROW> storage;
+        std::vector<ReflowRow> rows;
+        size_t endRow;
+        short endColumn;
+    };
+    std::vector<RestoredLine> restored;
+    size_t rowsLeft = rows;
+    size_t rowCount = 0;
+    short widest = 0;
+
+    while (end > 0 && rowsLeft > 0)
+    {
+        // Every row but the last one of a line was wrapped and copies at
+        // least all but one of its cells, so we can tell that a long line
+        // won't fit before we've found where it starts.
+        auto first = end - 1;
+        size_t cells = 0;
+        while (first > 0 && _archive.WasWrapForced(first - 1))
+        {
+            cells += _archive.GetWidth(first - 1) - 1;
+            if (cells / gsl::narrow_cast<size_t>(newWidth) >= rowsLeft)
+            {
+                break;
+            }
+            --first;
+        }
+        if (first > 0 && _archive.WasWrapForced(first - 1))
+        {
+            break;
+        }
+
+        const auto count = gsl::narrow_cast<size_t>(end - first);
+        if (rowCount + count > gsl::narrow_cast<size_t>(SHRT_MAX))
+        {
+            break;
+        }
+
+        ReflowSource probe;
+        probe.firstRow = 0;
+        probe.width = 0;
+        probe.ownedStorage.reserve(count);
+        for (auto index = first; index < end; ++index)
+        {
+            const auto width = gsl::narrow<unsigned short>(_archive.GetWidth(index));
+            auto& row = probe.ownedStorage.emplace_back(SHORT{ 0 }, width, _currentAttributes, nullptr);
+            _archive.Restore(index, row);
+            probe.rows.push_back(_MeasureRow(row.GetCharRow(), gsl::narrow_cast<short>(width)));
+            probe.ownedRowIndex.push_back(gsl::narrow_cast<SHORT>(probe.ownedRowIndex.size()));
+            probe.width = std::max(probe.width, gsl::narrow_cast<short>(width));
+        }
+        probe.storage = probe.ownedStorage;
+        probe.rowIndex = probe.ownedRowIndex;
+
+        const ReflowLine line{ &probe, 0, gsl::narrow_cast<short>(count - 1) };
+        const auto [endRow, endColumn] = _MeasureLine(line, newWidth, {});
+        if (endRow >= rowsLeft)
+        {
+            break;
+        }
+
+        restored.push_back({ std::move(probe.ownedStorage), std::move(probe.rows), endRow, endColumn });
+        rowsLeft -= endRow + 1;
+        rowCount += count;
+        widest = std::max(widest, probe.width);
+        end = first;
+    }
+
+    if (restored.empty())
+    {
+        return nullptr;
+    }
+
+    auto source = std::make_shared<ReflowSource>();
+    source->firstRow = 0;
+    source->width = widest;
+    source->ownedStorage.reserve(rowCount);
+    source->rows.reserve(rowCount);
+    for (auto it = restored.rbegin(); it != restored.rend(); ++it)
+    {
+        const auto firstRow = gsl::narrow_cast<short>(source->rows.size());
+        for (auto& row : it->storage)
+        {
+            source->ownedStorage.emplace_back(std::move(row));
+            source->ownedRowIndex.push_back(gsl::narrow_cast<SHORT>(source->ownedRowIndex.size()));
+        }
+        source->rows.insert(source->rows.end(), it->rows.begin(), it->rows.end());
+        lines.push_back({ source.get(), firstRow, gsl::narrow_cast<short>(source->rows.size() - 1), it->endRow, it->endColumn, 0 });
+    }
+    source->storage = source->ownedStorage;
+    source->rowIndex = source->ownedRowIndex;
+    return source;
+}
+
+const ROW& TextBuffer::ReflowSource::GetRowByOffset(const size_t index) const
+
+{
+    return gsl::at(storage, gsl::at(rowIndex, (firstRow + index) % storage.size()));
+}
+
+// Routine Description:
+// - Determines whether the given row ends a logical line, which is when it
+//   didn't have a full row to copy and wasn't forced to wrap.
+bool TextBuffer::ReflowSource::EndsWithNewline(const size_t index) const
+{
+    return rows.at(index).right < width && !GetRowByOffset(index).GetCharRow().WasWrapForced();
+}
+
+// Routine Description:
+// - Lays out one logical line of the old buffer into rows of the new width,
+//   exactly like InsertCharacter would if the line was printed starting at
+//   the beginning of a row.
+// Arguments:
+// - line - the rows of the old buffer that make up the line
+// - newWidth - the width of the rows to lay the line out into
+// - rowAt - called with the index of each row the line moves onto, relative
+//   to the first row of the line. Returns the row to write into, or nullptr
+//   if we're only measuring the line.
+// - positions - positions in the old buffer to find. The ones found within
+//   this line are updated with where they ended up.
+// Return Value:
+// - Where the cursor stops after the last character of the line, with the
+//   row relative to the first row of the line.
+std::pair<size_t, short> TextBuffer::_ReflowLine(const ReflowLine& line,
+                                                 const short newWidth,
+                                                 const std::function<ROW*(size_t)>& rowAt,
+                                                 gsl::span<ReflowPosition> positions)
+{
+    size_t newRow = 0;
+    short newColumn = 0;
+    ROW* row = rowAt(newRow);
+    ROW* previousRow = nullptr;
+
+    // The line starts on a fresh row, so there's nothing but space before it.
+    DbcsAttribute previous{};
+
+    // The color of the last character written to the current row.
+    TextAttribute rowAttr{};
+
+    // Marks the current row as wrapped and moves onto the next one,
+    // like IncrementCursor does when it runs off the end of a row.
+    const auto wrap = [&]() {
+        if (row)
+        {
+            row->GetCharRow().SetWrapForced(true);
+        }
+        newRow++;
+        newColumn = 0;
+        previousRow = std::exchange(row, rowAt(newRow));
+    };
+
+    const auto found = [&](ReflowPosition& position) {
+        position.line = &line;
+        position.newRow = newRow;
+        position.newColumn = newColumn;
+    };
+
+    for (short iOldRow = line.firstRow; iOldRow <= line.lastRow; iOldRow++)
+    {
+        const ROW& oldRow = line.source->GetRowByOffset(iOldRow);
+        const CharRow& charRow = oldRow.GetCharRow();
+        const short iRight = line.source->rows.at(iOldRow).right;
+
+        ReflowPosition* columnPosition = nullptr;
+        for (auto& position : positions)
+        {
+            if (position.oldRow == iOldRow && !position.endOfRow)
+            {
+                columnPosition = &position;
+            }
+        }
+
+        TextAttribute attr{};
+        size_t applies = 0;
+        for (short iOldCol = 0; iOldCol < iRight; iOldCol++)
+        {
+            if (columnPosition && columnPosition->oldColumn == iOldCol)
+            {
+                found(*columnPosition);
+            }
+
+            const auto dbcsAttr = charRow.DbcsAttrAt(iOldCol);
+
+            // A trailing byte must have had a leading byte before it.
+            // See _AssertValidDoubleByteSequence.
+            FAIL_FAST_IF(dbcsAttr.IsTrailing() && !previous.IsLeading());
+
+            // A leading byte without a trailing byte after it is erased.
+            // A leading byte is only ever left in the final column of a row
+            // if the row is a single column wide, so the cell before the
+            // cursor is on the previous row exactly then.
+            if (previous.IsLeading() && !dbcsAttr.IsTrailing() && row)
+            {
+                if (newColumn > 0)
+                {
+                    row->GetCharRow().ClearCell(gsl::narrow_cast<size_t>(newColumn) - 1);
+                }
+                else
+                {
+                    previousRow->GetCharRow().ClearCell(gsl::narrow_cast<size_t>(newWidth) - 1);
+                }
+            }
+
+            // If we're about to lead on the last column in the row, we need
+            // to add a padding space and move onto the next row.
+            if (dbcsAttr.IsLeading() && newColumn == newWidth - 1)
+            {
+                if (row)
+                {
+                    row->GetCharRow().SetDoubleBytePadded(true);
+                }
+                wrap();
+                previous = {};
+            }
+
+            if (row)
+            {
+                if (applies == 0)
+                {
+                    attr = oldRow.GetAttrRow().GetAttrByColumn(iOldCol, &applies);
+                }
+                applies--;
+
+                CharRow& newCharRow = row->GetCharRow();
+                newCharRow.GlyphAt(newColumn) = charRow.GlyphAt(iOldCol);
+                newCharRow.DbcsAttrAt(newColumn) = dbcsAttr;
+
+                // Every character colors the rest of its row, so we only need to
+                // do so at the start of each row and whenever the color changes.
+                if (newColumn == 0 || attr != rowAttr)
+                {
+                    THROW_HR_IF(E_OUTOFMEMORY, !row->GetAttrRow().SetAttrToEnd(newColumn, attr));
+                    rowAttr = attr;
+                }
+            }
+
+            previous = dbcsAttr;
+            newColumn++;
+            if (newColumn == newWidth)
+            {
+                wrap();
+            }
+        }
+
+        for (auto& position : positions)
+        {
+            if (position.oldRow == iOldRow && position.endOfRow)
+            {
+                found(position);
+            }
+        }
+
+        // The cursor may also sit right after the last character of a row
+        // that ends with a newline.
+        if (columnPosition && columnPosition->oldColumn == iRight && iRight < line.source->width && !charRow.WasWrapForced())
+        {
+            found(*columnPosition);
+        }
+    }
+
+    return { newRow, newColumn };
+}
+
+// Routine Description:
+// - Splits [0, count) into contiguous ranges and calls func for each of them,
+//   on as many threads as there are cores. Every range covers at least
+//   s_reflowGrain items, so small counts are handled on the calling thread.
+// - If func throws, the first exception is rethrown once all ranges are done.
+// Arguments:
+// - count - the number of items to process
+// - func - called with the first and one past the last item of each range
+void TextBuffer::_ForEachRange(const size_t count, const std::function<void(size_t, size_t)>& func)
+{
+    const size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t workers = std::clamp<size_t>(count / s_reflowGrain, 1, cores);
+    if (workers == 1)
+    {
+        func(0, count);
+        return;
+    }
+
+    const size_t rangeSize = (count + workers - 1) / workers;
+    std::vector<std::exception_ptr> errors(workers);
+    const auto runRange = [&](const size_t worker) noexcept {
+        try
+        {
+            const auto first = worker * rangeSize;
+            func(first, std::min(first + rangeSize, count));
+        }
+        catch (...)
+        {
+            errors.at(worker) = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t worker = 1; worker < workers; ++worker)
+    {
+        try
+        {
+            threads.emplace_back(runRange, worker);
+        }
+        catch (...)
+        {
+            // If we can't get another thread, do the work ourselves.
+            runRange(worker);
+        }
+    }
+    runRange(0);
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
 // Method Description:
 // - Adds or updates a hyperlink in our hyperlink table
 // Arguments:
@@ -2371,19 +3487,62 @@ void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
     _hyperlinkMap = other._hyperlinkMap;
     _hyperlinkCustomIdMap = other._hyperlinkCustomIdMap;
     _currentHyperlinkId = other._currentHyperlinkId;
+
+    // Some of them may have only been used by rows that didn't make it here.
+    _PruneHyperlinks();
+}
+
+// Method Description:
+// - Notes that one more attribute in our rows refers to the given hyperlink.
+// Arguments:
+// - The ID of the hyperlink
+void TextBuffer::AddHyperlinkReference(const uint16_t id)
+{
+    std::lock_guard<std::mutex> lock{ _hyperlinkLock };
+    ++_hyperlinkRefCounts[id];
+}
+
+// Method Description:
+// - Notes that one less attribute in our rows refers to the given hyperlink.
+//   Once none does, the hyperlink is removed from our maps, unless the current
+//   attributes still use it, or the lines a lazy reflow hasn't laid out yet
+//   might. This way, rows that scroll out or are overwritten don't leave
+//   obsolete hyperlinks behind, without searching the buffer for them.
+// Arguments:
+// - The ID of the hyperlink
+void TextBuffer::RemoveHyperlinkReference(const uint16_t id) noexcept
+{
+    std::lock_guard<std::mutex> lock{ _hyperlinkLock };
+    const auto count = _hyperlinkRefCounts.find(id);
+    if (count == _hyperlinkRefCounts.end() || --count->second > 0)
+    {
+        return;
+    }
+
+    _hyperlinkRefCounts.erase(count);
+    if (!_pendingReflow && id != _currentAttributes.GetHyperlinkId())
+    {
+        RemoveHyperlinkFromMap(id);
+    }
 }
 
 // Method Description:
 // - Adds a regex pattern we should search for
 // - The searching does not happen here, we only search when asked to by TerminalCore
+// - The pattern is compiled here, once, rather than on every search.
 // Arguments:
 // - The regex pattern
 // Return value:
 // - An ID that the caller should associate with the given pattern
+// Note: will throw if the pattern isn't a valid regular expression
 const size_t TextBuffer::AddPatternRecognizer(const std::wstring_view regexString)
 {
+    auto regex = std::make_shared<const std::wregex>(regexString.data(),
+                                                     regexString.size(),
+                                                     std::regex_constants::ECMAScript | std::regex_constants::optimize);
     ++_currentPatternId;
-    _idsAndPatterns.emplace(std::make_pair(_currentPatternId, regexString));
+    _idsAndPatterns.emplace(_currentPatternId, std::move(regex));
+    _patternCache.clear();
     return _currentPatternId;
 }
 
@@ -2395,10 +3554,14 @@ void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 {
     _idsAndPatterns = OtherBuffer._idsAndPatterns;
     _currentPatternId = OtherBuffer._currentPatternId;
+    _patternCache.clear();
 }
 
 // Method Description:
 // - Finds patterns within the requested region of the text buffer
+// - Rows are searched a line at a time, where a line is a row together with
+//   the rows it wrapped onto. Lines whose text is unchanged since the last
+//   call reuse the matches found back then instead of being searched again.
 // Arguments:
 // - The firstRow to start searching from
 // - The lastRow to search
@@ -2408,48 +3571,45 @@ PointTree TextBuffer::GetPatterns(const size_t firstRow, const size_t lastRow) c
 {
     PointTree::interval_vector intervals;
 
-    std::wstring concatAll;
     const auto rowSize = GetRowByOffset(0).size();
-    concatAll.reserve(rowSize * (lastRow - firstRow + 1));
 
-    // to deal with text that spans multiple lines, we will first concatenate
-    // all the text into one string and find the patterns in that string
-    for (auto i = firstRow; i <= lastRow; ++i)
-    {
-        auto& row = GetRowByOffset(i);
-        concatAll += row.GetCharRow().GetText();
-    }
+    // Only the lines we see now are kept for the next call, so the cache
+    // never grows beyond the size of the region that's searched.
+    decltype(_patternCache) cache;
 
-    // for each pattern we know of, iterate through the string
-    for (const auto& idAndPattern : _idsAndPatterns)
+    std::wstring lineText;
+    auto lineFirstRow = firstRow;
+    for (auto i = firstRow; i <= lastRow; ++i)
     {
-        std::wregex regexObj{ idAndPattern.second };
-
-        // search through the run with our regex object
-        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), regexObj);
-        auto words_end = std::wsregex_iterator();
+        const auto& charRow = GetRowByOffset(i).GetCharRow();
+        lineText += charRow.GetText();
 
-        size_t lenUpToThis = 0;
-        for (auto i = words_begin; i != words_end; ++i)
+        // to deal with text that spans multiple lines, the text of rows that
+        // wrapped onto the next one is searched together with it
+        if (i < lastRow && charRow.WasWrapForced())
         {
-            // record the locations -
-            // when we find a match, the prefix is text that is between this
-            // match and the previous match, so we use the size of the prefix
-            // along with the size of the match to determine the locations
-            size_t prefixSize = 0;
+            continue;
+        }
 
-            for (const auto ch : i->prefix().str())
+        auto matches = cache.find(lineText);
+        if (matches == cache.end())
+        {
+            auto cached = _patternCache.extract(lineText);
+            if (cached.empty())
             {
-                prefixSize += IsGlyphFullWidth(ch) ? 2 : 1;
+                matches = cache.emplace(lineText, _FindPatternsInLine(lineText)).first;
             }
-            const auto start = lenUpToThis + prefixSize;
-            size_t matchSize = 0;
-            for (const auto ch : i->str())
+            else
             {
-                matchSize += IsGlyphFullWidth(ch) ? 2 : 1;
+                matches = cache.insert(std::move(cached)).position;
             }
-            const auto end = start + matchSize;
-            lenUpToThis = end;
+        }
+
+        const auto lineStart = (lineFirstRow - firstRow) * rowSize;
+        for (const auto& match : matches->second)
+        {
+            const auto start = lineStart + match.start;
+            const auto end = lineStart + match.end;
 
             const til::point startCoord{ gsl::narrow<SHORT>(start % rowSize), gsl::narrow<SHORT>(start / rowSize) };
             const til::point endCoord{ gsl::narrow<SHORT>(end % rowSize), gsl::narrow<SHORT>(end / rowSize) };
@@ -2459,9 +3619,50 @@ PointTree TextBuffer::GetPatterns(const size_t firstRow, const size_t lastRow) c
             // Keeping these relative to the viewport for now because its the renderer
             // that actually uses these locations and the renderer works relative to
             // the viewport
-            intervals.push_back(PointTree::interval(startCoord, endCoord, idAndPattern.first));
+            intervals.push_back(PointTree::interval(startCoord, endCoord, match.patternId));
         }
+
+        lineText.clear();
+        lineFirstRow = i + 1;
     }
+
+    _patternCache = std::move(cache);
+
     PointTree result(std::move(intervals));
     return result;
 }
+
+// Method Description:
+// - Searches one line of text for every pattern we know of
+// Arguments:
+// - text - The text of the line, as returned by CharRow::GetText
+// Return value:
+// - The matches, with their positions given in cells from the start of the line
+std::vector<TextBuffer::PatternMatch> TextBuffer::_FindPatternsInLine(const std::wstring& text) const
+{
+    std::vector<PatternMatch> matches;
+
+    for (const auto& [patternId, regex] : _idsAndPatterns)
+    {
+        // Matches are found in order, so we only need to measure the width of
+        // the text between them once.
+        size_t textPos = 0;
+        size_t cellPos = 0;
+        const auto advanceTo = [&](const size_t target) {
+            cellPos += MeasureGlyphColumns(std::wstring_view{ text }.substr(textPos, target - textPos));
+            textPos = target;
+            return cellPos;
+        };
+
+        const auto wordsEnd = std::wsregex_iterator();
+        for (auto i = std::wsregex_iterator(text.begin(), text.end(), *regex); i != wordsEnd; ++i)
+        {
+            const auto matchStart = gsl::narrow_cast<size_t>(i->position());
+            const auto start = advanceTo(matchStart);
+            const auto end = advanceTo(matchStart + gsl::narrow_cast<size_t>(i->length()));
+            matches.push_back({ patternId, start, end });
+        }
+    }
+
+    return matches;
+}
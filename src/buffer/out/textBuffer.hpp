@@ -53,8 +53,8 @@ filling in the last row, and updating the screen.
 
 #include "cursor.h"
 #include "Row.hpp"
+#include "RowArchive.hpp"
 #include "TextAttribute.hpp"
-#include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "../buffer/out/textBufferCellIterator.hpp"
@@ -70,6 +70,7 @@ public:
                const UINT cursorSize,
                Microsoft::Console::Render::IRenderTarget& renderTarget);
     TextBuffer(const TextBuffer& a) = delete;
+    ~TextBuffer();
 
     // Used for duplicating properties to another text buffer
     void CopyProperties(const TextBuffer& OtherBuffer) noexcept;
@@ -77,6 +78,8 @@ public:
     // row manipulation
     const ROW& GetRowByOffset(const size_t index) const;
     ROW& GetRowByOffset(const size_t index);
+    const ROW& GetHistoryRow(const int64_t offset, ROW& scratch) const;
+
 
     TextBufferCellIterator GetCellDataAt(const COORD at) const;
     TextBufferCellIterator GetCellLineDataAt(const COORD at) const;
@@ -116,6 +119,13 @@ public:
 
     void ScrollRows(const SHORT firstRow, const SHORT size, const SHORT delta);
 
+    void CopyRect(const Microsoft::Console::Types::Viewport& source, const COORD targetOrigin);
+    void FillRect(const Microsoft::Console::Types::Viewport& rect,
+                  const wchar_t fillChar,
+                  const std::optional<TextAttribute> fillAttrs);
+    void ChangeAttrsInRect(const Microsoft::Console::Types::Viewport& rect,
+                           const std::function<void(TextAttribute&)>& change);
+
     UINT TotalRowCount() const noexcept;
 
     [[nodiscard]] TextAttribute GetCurrentAttributes() const noexcept;
@@ -126,8 +136,9 @@ public:
 
     [[nodiscard]] HRESULT ResizeTraditional(const COORD newSize) noexcept;
 
-    const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    UnicodeStorage& GetUnicodeStorage() noexcept;
+    void SetArchiveCapacity(const uint64_t rows);
+    void ClearArchive() noexcept;
+    const RowArchive& GetArchive() const;
 
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget() noexcept;
 
@@ -147,6 +158,8 @@ public:
     std::wstring GetHyperlinkUriFromId(uint16_t id) const;
     uint16_t GetHyperlinkId(std::wstring_view uri, std::wstring_view id);
     void RemoveHyperlinkFromMap(uint16_t id) noexcept;
+    void AddHyperlinkReference(const uint16_t id);
+    void RemoveHyperlinkReference(const uint16_t id) noexcept;
     std::wstring GetCustomIdFromId(uint16_t id) const;
     void CopyHyperlinkMaps(const TextBuffer& OtherBuffer);
 
@@ -183,7 +196,8 @@ public:
     static HRESULT Reflow(TextBuffer& oldBuffer,
                           TextBuffer& newBuffer,
                           const std::optional<Microsoft::Console::Types::Viewport> lastCharacterViewport,
-                          std::optional<std::reference_wrapper<PositionInformation>> positionInfo);
+                          std::optional<std::reference_wrapper<PositionInformation>> positionInfo,
+                          const bool lazily = false);
 
     const size_t AddPatternRecognizer(const std::wstring_view regexString);
     void CopyPatterns(const TextBuffer& OtherBuffer);
@@ -193,19 +207,29 @@ private:
     void _UpdateSize();
     Microsoft::Console::Types::Viewport _size;
     std::vector<ROW> _storage;
+    // The index in _storage of the row in every position of the circular
+    // buffer. Scrolling a region reorders the entries of its rows only, and
+    // leaves the ROWs where they are.
+    std::vector<SHORT> _rowIndex;
     Cursor _cursor;
 
     SHORT _firstRow; // indexes top row (not necessarily 0)
 
     TextAttribute _currentAttributes;
 
-    // storage location for glyphs that can't fit into the buffer normally
-    UnicodeStorage _unicodeStorage;
+    // packed storage for rows that have scrolled out of the top of the buffer
+    RowArchive _archive;
 
     std::unordered_map<uint16_t, std::wstring> _hyperlinkMap;
     std::unordered_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
     uint16_t _currentHyperlinkId;
 
+    // How many attributes in the rows refer to each hyperlink. The rows keep
+    // the counts up to date as their attributes change, which they may do from
+    // the threads of a reflow, so the counts are guarded by a lock.
+    std::unordered_map<uint16_t, size_t> _hyperlinkRefCounts;
+    std::mutex _hyperlinkLock;
+
     void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
 
     Microsoft::Console::Render::IRenderTarget& _renderTarget;
@@ -219,12 +243,13 @@ private:
 
     void _NotifyPaint(const Microsoft::Console::Types::Viewport& viewport) const;
 
+    void _ClearSplitGlyphs(ROW& row, const size_t left, const size_t right);
+
     // Assist with maintaining proper buffer state for Double Byte character sequences
     bool _PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute);
     bool _AssertValidDoubleByteSequence(const DbcsAttribute dbcsAttribute);
 
     ROW& _GetFirstRow();
-    ROW& _GetPrevRowNoWrap(const ROW& row);
 
     void _ExpandTextRow(SMALL_RECT& selectionRow) const;
 
@@ -236,9 +261,126 @@ private:
 
     void _PruneHyperlinks();
 
-    std::unordered_map<size_t, std::wstring> _idsAndPatterns;
+    // The least number of rows or lines each thread works on while
+    // reflowing. Smaller buffers are reflowed on the calling thread.
+    static constexpr size_t s_reflowGrain = 256;
+
+    // What we measured about a row of the buffer being reflowed.
+    struct ReflowRow
+    {
+        short right; // one past the final character to copy from the row
+        bool doubleByte; // whether any of those characters is double-byte
+    };
+
+    // The rows of a buffer being reflowed. If a lazy reflow leaves some of
+    // them to be laid out later, they outlive the buffer they came from.
+    struct ReflowSource
+    {
+        const ROW& GetRowByOffset(const size_t index) const;
+        bool EndsWithNewline(const size_t index) const;
+
+        gsl::span<const ROW> storage;
+        gsl::span<const SHORT> rowIndex;
+        size_t firstRow;
+        short width;
+        std::vector<ReflowRow> rows;
+
+        // Takes over the rows when a reflow leaves lines made of them pending,
+        // as the buffer they came from may be destroyed right after it. The
+        // spans above keep pointing at the same rows.
+
+        std::vector<ROW> ownedStorage;
+        std::vector<SHORT> ownedRowIndex;
+    };
+
+    // A run of rows in the buffer being reflowed where every row but the
+    // last one was wrapped onto the next.
+    struct ReflowLine
+    {
+        const ReflowSource* source;
+        short firstRow;
+        short lastRow; // inclusive
+        size_t endRow; // where the line ends, relative to newRow
+        short endColumn;
+        size_t newRow; // where the line starts in the new buffer, counting rows that scroll off the top
+    };
+
+    // A position in the buffer being reflowed that we need to find in the new buffer.
+    struct ReflowPosition
+    {
+        short oldRow;
+        short oldColumn;
+        bool endOfRow; // if set, the position right after the row's last character instead of oldColumn
+        const ReflowLine* line; // the line the position was found in, or nullptr
+        size_t newRow; // relative to the first row of line
+        short newColumn;
+    };
+
+    // The lines a lazy reflow hasn't laid out yet. They always sit above
+    // the ones it did lay out, and are laid out once their rows are needed.
+    struct PendingReflow
+    {
+        std::vector<std::shared_ptr<ReflowSource>> sources;
+        std::vector<ReflowLine> lines;
+        size_t firstLine; // lines [firstLine, endLine) are still pending
+        size_t endLine;
+        size_t scrolledOff; // the row of the lines that is at the top of the buffer now
+        size_t archiveFrom; // rows above this one are not archived when they're laid out
+        TextAttribute fillAttributes;
+    };
+
+    std::unique_ptr<PendingReflow> _pendingReflow;
+
+    // Guards laying out pending rows for readers, which may share the buffer
+    // across threads (see _ReflowPendingForReader). The flag tells them
+    // whether anything is pending without taking the lock.
+    mutable std::mutex _pendingReflowLock;
+    std::atomic<bool> _hasPendingReflow;
+
+    void _SetPendingReflow(std::unique_ptr<PendingReflow> pending);
+    void _ReflowPendingForReader(const size_t index, const bool above) const;
+    ROW& _GetRowByOffsetNoReflow(const size_t index);
+
+    void _ReflowPendingFrom(const size_t index);
+    void _ReflowPendingAbove(const size_t index);
+    void _LayOutLines(const gsl::span<const ReflowLine> lines,
+                      const size_t scrolledOff,
+                      const size_t archiveFrom,
+                      const TextAttribute fillAttributes);
+
+    static std::pair<size_t, short> _ReflowLine(const ReflowLine& line,
+                                                const short newWidth,
+                                                const std::function<ROW*(size_t)>& rowAt,
+                                                gsl::span<ReflowPosition> positions);
+    static std::pair<size_t, short> _MeasureLine(const ReflowLine& line,
+                                                 const short newWidth,
+                                                 gsl::span<ReflowPosition> positions);
+    static ReflowRow _MeasureRow(const CharRow& charRow, const short width);
+    std::shared_ptr<ReflowSource> _RestoreArchivedLines(const size_t rows,
+                                                        const short newWidth,
+                                                        std::vector<ReflowLine>& lines) const;
+
+    static void _ForEachRange(const size_t count, const std::function<void(size_t, size_t)>& func);
+
+    struct PatternMatch
+    {
+        size_t patternId;
+        size_t start; // in cells from the beginning of the line
+        size_t end;
+    };
+
+    std::vector<PatternMatch> _FindPatternsInLine(const std::wstring& text) const;
+
+    // The patterns are compiled once when they're added and shared with
+    // the buffers they're copied into.
+    std::unordered_map<size_t, std::shared_ptr<const std::wregex>> _idsAndPatterns;
     size_t _currentPatternId;
 
+    // The matches found in each line of the last region searched by
+    // GetPatterns, keyed by the text of the line. A line whose text hasn't
+    // changed doesn't need to be searched again.
+    mutable std::unordered_map<std::wstring, std::vector<PatternMatch>> _patternCache;
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     friend class UiaTextRangeTests;
@@ -0,0 +1,418 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderTarget.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class ReflowTests
+{
+    TEST_CLASS(ReflowTests);
+
+    TEST_METHOD(NarrowerBufferWrapsLines);
+    TEST_METHOD(WiderBufferJoinsWrappedRows);
+    TEST_METHOD(WideGlyphsArePaddedOntoTheNextRow);
+    TEST_METHOD(RowsThatScrollOffAreArchived);
+    TEST_METHOD(ArchivedLinesComeBackIntoFreedRows);
+    TEST_METHOD(TracksViewportRows);
+    TEST_METHOD(LargeBufferRoundTrips);
+    TEST_METHOD(LazyReflowMatchesEagerReflow);
+    TEST_METHOD(ChainedLazyReflowsMatchEagerReflows);
+    TEST_METHOD(LazyReflowArchivesRowsInOrder);
+    TEST_METHOD(ConcurrentReadersLayOutPendingRows);
+
+    // Prints the text like a console would, with newlines moving to the next row.
+    static void _Print(TextBuffer& buffer, const std::wstring_view text, const TextAttribute attr = {})
+    {
+        for (const auto wch : text)
+        {
+            if (wch == L'\n')
+            {
+                VERIFY_IS_TRUE(buffer.NewlineCursor());
+            }
+            else
+            {
+                VERIFY_IS_TRUE(buffer.InsertCharacter(wch, {}, attr));
+            }
+        }
+    }
+
+    static void _PrintWide(TextBuffer& buffer, const std::wstring_view glyph, const TextAttribute attr = {})
+    {
+        VERIFY_IS_TRUE(buffer.InsertCharacter(glyph, DbcsAttribute{ DbcsAttribute::Attribute::Leading }, attr));
+        VERIFY_IS_TRUE(buffer.InsertCharacter(glyph, DbcsAttribute{ DbcsAttribute::Attribute::Trailing }, attr));
+    }
+
+    // Prints lines of varying length with changing colors and a few wide glyphs.
+    static void _PrintLines(TextBuffer& buffer, const size_t lines)
+    {
+        const std::wstring_view grinning{ L"\xD83D\xDE00" };
+        for (size_t line = 0; line < lines; ++line)
+        {
+            if (line > 0)
+            {
+                VERIFY_IS_TRUE(buffer.NewlineCursor());
+            }
+
+            const auto length = (line * 37) % 119;
+            for (size_t column = 0; column < length; ++column)
+            {
+                const TextAttribute attr{ gsl::narrow_cast<WORD>((line + column / 7) % 16) };
+                if (column % 13 == 5 && column + 1 < length)
+                {
+                    _PrintWide(buffer, grinning, attr);
+                    ++column;
+                }
+                else
+                {
+                    VERIFY_IS_TRUE(buffer.InsertCharacter(gsl::narrow_cast<wchar_t>(L'a' + (line + column) % 26), {}, attr));
+                }
+            }
+        }
+    }
+
+    // Verifies that the buffers hold the same rows, comparing the attributes
+    // of the cells up to the last character of every row.
+    static void _VerifyBuffersMatch(const TextBuffer& expected, const TextBuffer& actual)
+    {
+        VERIFY_ARE_EQUAL(expected.GetCursor().GetPosition(), actual.GetCursor().GetPosition());
+        for (SHORT row = 0; row < expected.GetSize().Height(); ++row)
+        {
+            const auto& expectedRow = expected.GetRowByOffset(row);
+            const auto& actualRow = actual.GetRowByOffset(row);
+            VERIFY_ARE_EQUAL(expectedRow.GetText(), actualRow.GetText(), NoThrowString().Format(L"row %d", row));
+            VERIFY_ARE_EQUAL(expectedRow.GetCharRow().WasWrapForced(), actualRow.GetCharRow().WasWrapForced());
+
+            const auto right = expectedRow.GetCharRow().MeasureRight();
+            for (size_t column = 0; column < right; ++column)
+            {
+                VERIFY_ARE_EQUAL(expectedRow.GetAttrRow().GetAttrByColumn(column), actualRow.GetAttrRow().GetAttrByColumn(column));
+            }
+        }
+
+        const auto& expectedArchive = expected.GetArchive();
+        const auto& actualArchive = actual.GetArchive();
+        VERIFY_ARE_EQUAL(expectedArchive.size(), actualArchive.size());
+        for (uint64_t row = 0; row < expectedArchive.size(); ++row)
+        {
+            VERIFY_ARE_EQUAL(std::wstring{ expectedArchive.GetText(row) }, std::wstring{ actualArchive.GetText(row) });
+            VERIFY_ARE_EQUAL(expectedArchive.WasWrapForced(row), actualArchive.WasWrapForced(row));
+        }
+    }
+
+    // Gets the text of a row without its trailing spaces.
+    static std::wstring _GetRowText(const TextBuffer& buffer, const size_t row)
+    {
+        auto text = buffer.GetRowByOffset(row).GetText();
+        text.erase(text.find_last_not_of(L' ') + 1);
+        return text;
+    }
+
+    DummyRenderTarget _renderTarget;
+};
+
+void ReflowTests::NarrowerBufferWrapsLines()
+{
+    TextBuffer oldBuffer{ { 10, 5 }, {}, 12, _renderTarget };
+    _Print(oldBuffer, L"abcdefg\nhij");
+
+    TextBuffer newBuffer{ { 4, 5 }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer, std::nullopt, std::nullopt));
+
+    VERIFY_ARE_EQUAL(L"abcd", _GetRowText(newBuffer, 0));
+    VERIFY_IS_TRUE(newBuffer.GetRowByOffset(0).GetCharRow().WasWrapForced());
+    VERIFY_ARE_EQUAL(L"efg", _GetRowText(newBuffer, 1));
+    VERIFY_IS_FALSE(newBuffer.GetRowByOffset(1).GetCharRow().WasWrapForced());
+    VERIFY_ARE_EQUAL(L"hij", _GetRowText(newBuffer, 2));
+    VERIFY_ARE_EQUAL(L"", _GetRowText(newBuffer, 3));
+    VERIFY_ARE_EQUAL((COORD{ 3, 2 }), newBuffer.GetCursor().GetPosition());
+}
+
+void ReflowTests::WiderBufferJoinsWrappedRows()
+{
+    TextBuffer oldBuffer{ { 4, 5 }, {}, 12, _renderTarget };
+    _Print(oldBuffer, L"abcdefg\nhij");
+    VERIFY_IS_TRUE(oldBuffer.GetRowByOffset(0).GetCharRow().WasWrapForced());
+
+    TextBuffer newBuffer{ { 10, 5 }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer, std::nullopt, std::nullopt));
+
+    VERIFY_ARE_EQUAL(L"abcdefg", _GetRowText(newBuffer, 0));
+    VERIFY_IS_FALSE(newBuffer.GetRowByOffset(0).GetCharRow().WasWrapForced());
+    VERIFY_ARE_EQUAL(L"hij", _GetRowText(newBuffer, 1));
+    VERIFY_ARE_EQUAL(L"", _GetRowText(newBuffer, 2));
+    VERIFY_ARE_EQUAL((COORD{ 3, 1 }), newBuffer.GetCursor().GetPosition());
+}
+
+void ReflowTests::WideGlyphsArePaddedOntoTheNextRow()
+{
+    const std::wstring_view grinning{ L"\xD83D\xDE00" };
+
+    TextBuffer oldBuffer{ { 6, 3 }, {}, 12, _renderTarget };
+    _Print(oldBuffer, L"ab");
+    _PrintWide(oldBuffer, grinning);
+
+    TextBuffer narrowBuffer{ { 3, 3 }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, narrowBuffer, std::nullopt, std::nullopt));
+
+    // The glyph doesn't fit into the final column, so it's moved onto the next row.
+    const auto& firstRow = narrowBuffer.GetRowByOffset(0).GetCharRow();
+    VERIFY_ARE_EQUAL(L"ab", _GetRowText(narrowBuffer, 0));
+    VERIFY_IS_TRUE(firstRow.WasWrapForced());
+    VERIFY_IS_TRUE(firstRow.WasDoubleBytePadded());
+
+    const auto& secondRow = narrowBuffer.GetRowByOffset(1).GetCharRow();
+    VERIFY_IS_TRUE(secondRow.DbcsAttrAt(0).IsLeading());
+    VERIFY_IS_TRUE(secondRow.DbcsAttrAt(1).IsTrailing());
+    VERIFY_ARE_EQUAL(String(grinning.data(), 2), String(secondRow.GlyphAt(0).data(), 2));
+    VERIFY_ARE_EQUAL((COORD{ 2, 1 }), narrowBuffer.GetCursor().GetPosition());
+
+    // Widening the buffer again drops the padding.
+    TextBuffer wideBuffer{ { 6, 3 }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(narrowBuffer, wideBuffer, std::nullopt, std::nullopt));
+
+    VERIFY_ARE_EQUAL(std::wstring{ L"ab" } + std::wstring{ grinning }, _GetRowText(wideBuffer, 0));
+    VERIFY_IS_FALSE(wideBuffer.GetRowByOffset(0).GetCharRow().WasDoubleBytePadded());
+    VERIFY_ARE_EQUAL((COORD{ 4, 0 }), wideBuffer.GetCursor().GetPosition());
+}
+
+void ReflowTests::RowsThatScrollOffAreArchived()
+{
+    TextBuffer oldBuffer{ { 10, 4 }, {}, 12, _renderTarget };
+    oldBuffer.SetArchiveCapacity(100);
+    _Print(oldBuffer, L"0bcdef\n1bcdef\n2bcdef\n3bcdef");
+    VERIFY_IS_TRUE(oldBuffer.GetArchive().empty());
+
+    TextBuffer newBuffer{ { 4, 4 }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer, std::nullopt, std::nullopt));
+
+    // Every line takes up two rows now, so the first half of them no longer
+    // fits into the buffer.
+    const auto& archive = newBuffer.GetArchive();
+    VERIFY_ARE_EQUAL(4u, archive.size());
+    VERIFY_ARE_EQUAL(L"0bcd", std::wstring{ archive.GetText(0) });
+    VERIFY_IS_TRUE(archive.WasWrapForced(0));
+    VERIFY_ARE_EQUAL(L"ef", std::wstring{ archive.GetText(1) });
+    VERIFY_IS_FALSE(archive.WasWrapForced(1));
+    VERIFY_ARE_EQUAL(L"1bcd", std::wstring{ archive.GetText(2) });
+    VERIFY_ARE_EQUAL(L"ef", std::wstring{ archive.GetText(3) });
+
+    VERIFY_ARE_EQUAL(L"2bcd", _GetRowText(newBuffer, 0));
+    VERIFY_ARE_EQUAL(L"ef", _GetRowText(newBuffer, 1));
+    VERIFY_ARE_EQUAL(L"3bcd", _GetRowText(newBuffer, 2));
+    VERIFY_ARE_EQUAL(L"ef", _GetRowText(newBuffer, 3));
+    VERIFY_ARE_EQUAL((COORD{ 2, 3 }), newBuffer.GetCursor().GetPosition());
+}
+
+void ReflowTests::ArchivedLinesComeBackIntoFreedRows()
+{
+    for (const auto lazily : { false, true })
+    {
+        TextBuffer oldBuffer{ { 4, 4 }, {}, 12, _renderTarget };
+        oldBuffer.SetArchiveCapacity(100);
+        _Print(oldBuffer, L"0bcdef\n1bcdef\n2bcdef\n3bcdef");
+        VERIFY_ARE_EQUAL(4u, oldBuffer.GetArchive().size());
+
+        // The visible lines only take up two rows in the wider buffer, which
+        // leaves room for one more line above them and a row for the cursor.
+        TextBuffer newBuffer{ { 10, 4 }, {}, 12, _renderTarget };
+        VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer, std::nullopt, std::nullopt, lazily));
+
+        VERIFY_ARE_EQUAL(L"1bcdef", _GetRowText(newBuffer, 0));
+        VERIFY_IS_FALSE(newBuffer.GetRowByOffset(0).GetCharRow().WasWrapForced());
+        VERIFY_ARE_EQUAL(L"2bcdef", _GetRowText(newBuffer, 1));
+        VERIFY_ARE_EQUAL(L"3bcdef", _GetRowText(newBuffer, 2));
+        VERIFY_ARE_EQUAL(L"", _GetRowText(newBuffer, 3));
+        VERIFY_ARE_EQUAL((COORD{ 6, 2 }), newBuffer.GetCursor().GetPosition());
+
+        // The line that came back is no longer archived.
+        const auto& archive = newBuffer.GetArchive();
+        VERIFY_ARE_EQUAL(2u, archive.size());
+        VERIFY_ARE_EQUAL(L"0bcd", std::wstring{ archive.GetText(0) });
+        VERIFY_ARE_EQUAL(L"ef", std::wstring{ archive.GetText(1) });
+    }
+}
+
+void ReflowTests::TracksViewportRows()
+
+{
+    TextBuffer oldBuffer{ { 10, 6 }, {}, 12, _renderTarget };
+    _Print(oldBuffer, L"abcdefg\nij\nklmnopq\nrs");
+
+    TextBuffer::PositionInformation positionInfo{};
+    positionInfo.mutableViewportTop = 2;
+    positionInfo.visibleViewportTop = 1;
+
+    TextBuffer newBuffer{ { 4, 10 }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer, std::nullopt, { positionInfo }));
+
+    // The rows report where they end in the new buffer.
+    VERIFY_ARE_EQUAL(L"klmn", _GetRowText(newBuffer, 3));
+    VERIFY_ARE_EQUAL(L"opq", _GetRowText(newBuffer, 4));
+    VERIFY_ARE_EQUAL(4, positionInfo.mutableViewportTop);
+    VERIFY_ARE_EQUAL(L"ij", _GetRowText(newBuffer, 2));
+    VERIFY_ARE_EQUAL(2, positionInfo.visibleViewportTop);
+}
+
+void ReflowTests::LargeBufferRoundTrips()
+{
+    // Enough rows to have the lines laid out on several threads.
+    const COORD size{ 120, 3000 };
+
+    TextBuffer oldBuffer{ size, {}, 12, _renderTarget };
+    _PrintLines(oldBuffer, 1400);
+
+    // Every line takes up to two rows in the narrow buffer, so nothing scrolls off.
+    TextBuffer narrowBuffer{ { 61, size.Y }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, narrowBuffer, std::nullopt, std::nullopt));
+    TextBuffer newBuffer{ size, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(narrowBuffer, newBuffer, std::nullopt, std::nullopt));
+
+    _VerifyBuffersMatch(oldBuffer, newBuffer);
+}
+
+void ReflowTests::LazyReflowMatchesEagerReflow()
+{
+    const COORD size{ 120, 3000 };
+
+    TextBuffer oldBuffer{ size, {}, 12, _renderTarget };
+    _PrintLines(oldBuffer, 1400);
+
+    TextBuffer::PositionInformation eagerPositions{};
+    eagerPositions.mutableViewportTop = 1370;
+    eagerPositions.visibleViewportTop = 1350;
+    auto lazyPositions = eagerPositions;
+
+    TextBuffer eagerBuffer{ { 61, size.Y }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, eagerBuffer, std::nullopt, { eagerPositions }));
+    TextBuffer lazyBuffer{ { 61, size.Y }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, lazyBuffer, std::nullopt, { lazyPositions }, true));
+
+    VERIFY_ARE_EQUAL(eagerPositions.mutableViewportTop, lazyPositions.mutableViewportTop);
+    VERIFY_ARE_EQUAL(eagerPositions.visibleViewportTop, lazyPositions.visibleViewportTop);
+
+    // Reading the rows lays out the ones that were left pending.
+    _VerifyBuffersMatch(eagerBuffer, lazyBuffer);
+}
+
+void ReflowTests::ChainedLazyReflowsMatchEagerReflows()
+{
+    const SHORT height = 3000;
+    const std::array<SHORT, 4> widths{ 61, 97, 33, 120 };
+
+    auto eagerBuffer = std::make_unique<TextBuffer>(COORD{ 120, height }, TextAttribute{}, 12, _renderTarget);
+    _PrintLines(*eagerBuffer, 1400);
+    auto lazyBuffer = std::make_unique<TextBuffer>(COORD{ 120, height }, TextAttribute{}, 12, _renderTarget);
+    _PrintLines(*lazyBuffer, 1400);
+
+    // Every resize but the last one leaves rows pending that the next
+    // resize has to pick up from the buffer before it.
+    for (const auto width : widths)
+    {
+        auto newEagerBuffer = std::make_unique<TextBuffer>(COORD{ width, height }, TextAttribute{}, 12, _renderTarget);
+        VERIFY_SUCCEEDED(TextBuffer::Reflow(*eagerBuffer, *newEagerBuffer, std::nullopt, std::nullopt));
+        eagerBuffer.swap(newEagerBuffer);
+
+        auto newLazyBuffer = std::make_unique<TextBuffer>(COORD{ width, height }, TextAttribute{}, 12, _renderTarget);
+        VERIFY_SUCCEEDED(TextBuffer::Reflow(*lazyBuffer, *newLazyBuffer, std::nullopt, std::nullopt, true));
+        lazyBuffer.swap(newLazyBuffer);
+    }
+
+    _VerifyBuffersMatch(*eagerBuffer, *lazyBuffer);
+}
+
+void ReflowTests::LazyReflowArchivesRowsInOrder()
+{
+    const COORD size{ 120, 1000 };
+
+    // A reflow hands the archive of the old buffer over to the new one, so
+    // each of them reflows a buffer of its own.
+    TextBuffer eagerOldBuffer{ size, {}, 12, _renderTarget };
+    TextBuffer lazyOldBuffer{ size, {}, 12, _renderTarget };
+    for (auto buffer : { &eagerOldBuffer, &lazyOldBuffer })
+    {
+        buffer->SetArchiveCapacity(10000);
+        _PrintLines(*buffer, 990);
+    }
+
+    // Lines take up to four rows in the narrow buffer, so most of them
+    // scroll off into the archive.
+    TextBuffer eagerBuffer{ { 33, size.Y }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(eagerOldBuffer, eagerBuffer, std::nullopt, std::nullopt));
+    TextBuffer lazyBuffer{ { 33, size.Y }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(lazyOldBuffer, lazyBuffer, std::nullopt, std::nullopt, true));
+    VERIFY_IS_FALSE(eagerBuffer.GetArchive().empty());
+
+
+    // New output scrolls the top rows off before anyone looked at them.
+    for (auto buffer : { &eagerBuffer, &lazyBuffer })
+    {
+        _Print(*buffer, L"\nabc\ndef\nghi");
+    }
+
+    _VerifyBuffersMatch(eagerBuffer, lazyBuffer);
+}
+
+void ReflowTests::ConcurrentReadersLayOutPendingRows()
+{
+    const COORD size{ 120, 3000 };
+
+    TextBuffer eagerOldBuffer{ size, {}, 12, _renderTarget };
+    TextBuffer lazyOldBuffer{ size, {}, 12, _renderTarget };
+    for (auto buffer : { &eagerOldBuffer, &lazyOldBuffer })
+    {
+        buffer->SetArchiveCapacity(10000);
+        _PrintLines(*buffer, 1400);
+    }
+
+    TextBuffer eagerBuffer{ { 33, size.Y }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(eagerOldBuffer, eagerBuffer, std::nullopt, std::nullopt));
+    TextBuffer lazyBuffer{ { 33, size.Y }, {}, 12, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(lazyOldBuffer, lazyBuffer, std::nullopt, std::nullopt, true));
+
+    // Readers share the buffer, so any of them may be the one that lays out
+    // a pending row. They all have to see it the same way.
+    const TextBuffer& reader = lazyBuffer;
+    std::array<std::vector<std::wstring>, 4> texts;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < texts.size(); ++i)
+    {
+        threads.emplace_back([&reader, &text = texts.at(i), i, height = size.Y]() {
+            // Every reader starts at a different row and looks at the archive
+            // halfway through.
+            for (SHORT offset = 0; offset < height; ++offset)
+            {
+                const auto row = gsl::narrow_cast<size_t>((offset + i * height / 4) % height);
+                text.push_back(reader.GetRowByOffset(row).GetText());
+                if (offset == height / 2)
+                {
+                    reader.GetArchive();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    SetVerifyOutput settings(VerifyOutputSettings::LogOnlyFailures);
+    for (size_t i = 0; i < texts.size(); ++i)
+
+    {
+        for (SHORT offset = 0; offset < size.Y; ++offset)
+        {
+            const auto row = gsl::narrow_cast<size_t>((offset + i * size.Y / 4) % size.Y);
+            VERIFY_ARE_EQUAL(eagerBuffer.GetRowByOffset(row).GetText(), texts.at(i).at(offset));
+        }
+    }
+
+    _VerifyBuffersMatch(eagerBuffer, lazyBuffer);
+}
@@ -18,34 +18,106 @@ class UnicodeStorageTests
     TEST_METHOD(CanOverwriteEmoji)
     {
         UnicodeStorage storage;
-        const COORD coord{ 1, 3 };
-        const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
-        const std::vector<wchar_t> fullMoon{ 0xD83C, 0xDF15 };
+        const size_t column = 1;
+        const std::wstring_view newMoon{ L"\xD83C\xDF11" };
+        const std::wstring_view fullMoon{ L"\xD83C\xDF15" };
 
         // store initial glyph
-        storage.StoreGlyph(coord, newMoon);
+        storage.StoreGlyph(column, newMoon);
 
         // verify it was stored
-        auto findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& newMoonGlyph = findIt->second;
-        VERIFY_ARE_EQUAL(newMoonGlyph.size(), newMoon.size());
-        for (size_t i = 0; i < newMoon.size(); ++i)
-        {
-            VERIFY_ARE_EQUAL(newMoonGlyph.at(i), newMoon.at(i));
-        }
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        VERIFY_ARE_EQUAL(String(newMoon.data(), 2), String(storage.GetText(column).data(), 2));
 
         // overwrite it
-        storage.StoreGlyph(coord, fullMoon);
+        storage.StoreGlyph(column, fullMoon);
 
         // verify the glyph was overwritten
-        findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& fullMoonGlyph = findIt->second;
-        VERIFY_ARE_EQUAL(fullMoonGlyph.size(), fullMoon.size());
-        for (size_t i = 0; i < fullMoon.size(); ++i)
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        VERIFY_ARE_EQUAL(2u, storage.GetText(column).size());
+        VERIFY_ARE_EQUAL(String(fullMoon.data(), 2), String(storage.GetText(column).data(), 2));
+    }
+
+    TEST_METHOD(GlyphsAreKeptInColumnOrder)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view eggplant{ L"\xD83C\xDF46" };
+        const std::wstring_view combining{ L"e\x0301\x0302" };
+
+        storage.StoreGlyph(7, eggplant);
+        storage.StoreGlyph(2, combining);
+        storage.StoreGlyph(4, eggplant);
+
+        VERIFY_ARE_EQUAL(3u, storage.size());
+        VERIFY_ARE_EQUAL(2u, storage._entries.at(0).column);
+        VERIFY_ARE_EQUAL(4u, storage._entries.at(1).column);
+        VERIFY_ARE_EQUAL(7u, storage._entries.at(2).column);
+        VERIFY_ARE_EQUAL(3u, storage.GetText(2).size());
+        VERIFY_ARE_EQUAL(2u, storage.GetText(7).size());
+
+        VERIFY_THROWS_SPECIFIC(storage.GetText(3), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+    }
+
+    TEST_METHOD(CanEraseAndTrim)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view eggplant{ L"\xD83C\xDF46" };
+
+        for (size_t column = 0; column < 10; ++column)
         {
-            VERIFY_ARE_EQUAL(fullMoonGlyph.at(i), fullMoon.at(i));
+            storage.StoreGlyph(column, eggplant);
         }
+
+        storage.Erase(3);
+        VERIFY_ARE_EQUAL(9u, storage.size());
+        VERIFY_THROWS_SPECIFIC(storage.GetText(3), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+
+        // erasing a column that has nothing stored is fine
+        storage.Erase(3);
+        VERIFY_ARE_EQUAL(9u, storage.size());
+
+        storage.Trim(5);
+        VERIFY_ARE_EQUAL(4u, storage.size());
+        VERIFY_ARE_EQUAL(2u, storage.GetText(4).size());
+        VERIFY_THROWS_SPECIFIC(storage.GetText(5), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+
+        storage.Clear();
+        VERIFY_IS_TRUE(storage.empty());
+        VERIFY_IS_TRUE(storage._text.empty());
+    }
+
+    TEST_METHOD(OverwritingReclaimsSpace)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view longGlyph{ L"e\x0301\x0302\x0303" };
+        const std::wstring_view longerGlyph{ L"e\x0301\x0302\x0303\x0304" };
+
+        storage.StoreGlyph(0, longGlyph);
+        storage.StoreGlyph(1, longGlyph);
+
+        // Growing a glyph over and over again must not grow the storage without bound.
+        for (auto i = 0; i < 100; ++i)
+        {
+            storage.StoreGlyph(0, (i % 2) ? longGlyph : longerGlyph);
+        }
+
+        VERIFY_IS_LESS_THAN_OR_EQUAL(storage._text.size(), 4 * longerGlyph.size());
+        VERIFY_ARE_EQUAL(String(longGlyph.data(), 4), String(storage.GetText(1).data(), 4));
+        VERIFY_ARE_EQUAL(String(longGlyph.data(), 4), String(storage.GetText(0).data(), 4));
+    }
+
+    TEST_METHOD(CanStoreGlyphReadFromItself)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view eggplant{ L"\xD83C\xDF46" };
+
+        storage.StoreGlyph(0, eggplant);
+        for (size_t column = 1; column < 100; ++column)
+        {
+            storage.StoreGlyph(column, storage.GetText(column - 1));
+        }
+
+        VERIFY_ARE_EQUAL(100u, storage.size());
+        VERIFY_ARE_EQUAL(String(eggplant.data(), 2), String(storage.GetText(99).data(), 2));
     }
 };
@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "SearchBoxControl.h"
+#include <LibraryResources.h>
 #include "SearchBoxControl.g.cpp"
 
 using namespace winrt;
@@ -124,6 +125,24 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         }
     }
 
+    // Method Description:
+    // - Shows how many matches the last search found
+    // Arguments:
+    // - totalMatches: the number of matches in the whole history of the
+    //   buffer, including the rows that scrolled into its archive
+    // Return Value:
+    // - <none>
+    void SearchBoxControl::SetStatus(int32_t totalMatches)
+    {
+        if (StatusBox())
+        {
+            const auto status = totalMatches == 0 ?
+                                    RS_(L"SearchBox_NoResults") :
+                                    winrt::hstring{ fmt::format(std::wstring_view{ RS_(L"SearchBox_ResultCount") }, totalMatches) };
+            StatusBox().Text(status);
+        }
+    }
+
     // Method Description:
     // - Check if the current focus is on any element within the
     //   search box
@@ -30,6 +30,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
         void SetFocusOnTextbox();
         void PopulateTextbox(winrt::hstring const& text);
+        void SetStatus(int32_t totalMatches);
         bool ContainsFocus();
 
         void GoBackwardClicked(winrt::Windows::Foundation::IInspectable const& /*sender*/, winrt::Windows::UI::Xaml::RoutedEventArgs const& /*e*/);
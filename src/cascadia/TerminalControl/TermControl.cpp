@@ -38,6 +38,10 @@ constexpr const auto TsfRedrawInterval = std::chrono::milliseconds(100);
 // The minimum delay between updating the locations of regex patterns
 constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(500);
 
+// The minimum delay between resizing the buffer while the control is resized.
+// Dragging the window's border only reflows the buffer about once per frame.
+constexpr const auto ResizeBufferInterval = std::chrono::milliseconds(16);
+
 DEFINE_ENUM_FLAG_OPERATORS(winrt::Microsoft::Terminal::TerminalControl::CopyFormat);
 
 namespace winrt::Microsoft::Terminal::TerminalControl::implementation
@@ -184,6 +188,16 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             ScrollBarUpdateInterval,
             Dispatcher());
 
+        _resizeBuffer = std::make_shared<ThrottledFunc<winrt::Windows::Foundation::Size>>(
+            [weakThis = get_weak()](const auto& size) {
+                if (auto control{ weakThis.get() })
+                {
+                    control->_ResizeBuffer(size);
+                }
+            },
+            ResizeBufferInterval,
+            Dispatcher());
+
         static constexpr auto AutoScrollUpdateInterval = std::chrono::microseconds(static_cast<int>(1.0 / 30.0 * 1000000));
         _autoScrollTimer.Interval(AutoScrollUpdateInterval);
         _autoScrollTimer.Tick({ this, &TermControl::_UpdateAutoScroll });
@@ -256,6 +270,13 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             search.Select();
             _renderer->TriggerSelection();
         }
+
+        // The count includes the matches in the archived history, which the
+        // selection can't reach yet.
+        if (_searchBox)
+        {
+            _searchBox->SetStatus(gsl::narrow_cast<int32_t>(search.FindAllInHistory().size()));
+        }
     }
 
     // Method Description:
@@ -2164,6 +2185,9 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
     // Method Description:
     // - Triggered when the swapchain changes size. We use this to resize the
     //      terminal buffers to match the new visible size.
+    // - While the window's border is dragged we get an event for every
+    //   mouse move, so the resizes are throttled. Only the latest size is
+    //   applied, once per ResizeBufferInterval.
     // Arguments:
     // - e: a SizeChangedEventArgs with the new dimensions of the SwapChainPanel
     void TermControl::_SwapChainSizeChanged(winrt::Windows::Foundation::IInspectable const& /*sender*/,
@@ -2174,10 +2198,24 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             return;
         }
 
+        _resizeBuffer->Run(e.NewSize());
+    }
+
+    // Method Description:
+    // - Resizes the terminal buffers to match the given size of the
+    //   SwapChainPanel. Called by the _resizeBuffer throttled function.
+    // Arguments:
+    // - newSize: the size of the SwapChainPanel, in DIPs
+    void TermControl::_ResizeBuffer(const winrt::Windows::Foundation::Size newSize)
+    {
+        // The control may have been closed while the resize was pending.
+        if (!_initializedTerminal || _closing)
+        {
+            return;
+        }
+
         auto lock = _terminal->LockForWriting();
 
-        const auto newSize = e.NewSize();
-        const auto currentScaleX = SwapChainPanel().CompositionScaleX();
         const auto currentEngineScale = _renderEngine->GetScaling();
         auto foundationSize = newSize;
 
@@ -2251,11 +2289,17 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
             _renderer->TriggerFontChange(::base::saturated_cast<int>(dpi), _desiredFont, _actualFont);
 
+            // The buffer is resized through the same throttle as the size
+            // changes, so one of those that's still pending can't run after
+            // this and resize the buffer for the old scale. Whichever runs
+            // last resizes it for the current size of the panel.
             const auto actualFontNewSize = _actualFont.GetSize();
             if (actualFontNewSize != actualFontOldSize)
             {
-                _RefreshSizeUnderLock();
+                _resizeBuffer->Run(winrt::Windows::Foundation::Size{ gsl::narrow_cast<float>(sender.ActualWidth()),
+                                                                     gsl::narrow_cast<float>(sender.ActualHeight()) });
             }
+
         }
     }
 
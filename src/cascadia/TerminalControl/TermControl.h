@@ -216,6 +216,8 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             double newViewportSize;
         };
         std::shared_ptr<ThrottledFunc<ScrollBarUpdate>> _updateScrollBar;
+
+        std::shared_ptr<ThrottledFunc<winrt::Windows::Foundation::Size>> _resizeBuffer;
         bool _isInternalScrollBarUpdate;
 
         unsigned int _rowsToScroll;
@@ -289,6 +291,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         void _SendInputToConnection(std::wstring_view wstr);
         void _SendPastedTextToConnection(const std::wstring& wstr);
         void _SwapChainSizeChanged(Windows::Foundation::IInspectable const& sender, Windows::UI::Xaml::SizeChangedEventArgs const& e);
+        void _ResizeBuffer(const winrt::Windows::Foundation::Size newSize);
         void _SwapChainScaleChanged(Windows::UI::Xaml::Controls::SwapChainPanel const& sender, Windows::Foundation::IInspectable const& args);
         void _DoResizeUnderLock(const double newWidth, const double newHeight);
         void _RefreshSizeUnderLock();
@@ -102,6 +102,12 @@ void Terminal::CreateFromSettings(ICoreSettings settings,
     // TODO:MSFT:20642297 - Support infinite scrollback here, if HistorySize is -1
     Create(viewportSize, Utils::ClampToShortMax(settings.HistorySize(), 0), renderTarget);
 
+    // The buffer can only hold as many rows as fit into a SHORT. Whatever part
+    // of the requested history doesn't fit is kept in the buffer's packed archive.
+    const int64_t bufferHistory = _buffer->GetSize().Height() - viewportSize.Y;
+    const int64_t archivedHistory = static_cast<int64_t>(settings.HistorySize()) - bufferHistory;
+    _buffer->SetArchiveCapacity(gsl::narrow_cast<uint64_t>(std::max<int64_t>(archivedHistory, 0)));
+
     UpdateSettings(settings);
 }
 
@@ -251,10 +257,15 @@ void Terminal::UpdateSettings(ICoreSettings settings)
         oldRows.visibleViewportTop = newVisibleTop;
 
         const std::optional<short> oldViewStart{ oldViewportTop };
+
+        // Only the rows around the viewports are laid out right away. The
+        // scrollback is laid out when it's first accessed, so that dragging
+        // the window's border stays responsive with a deep history.
         RETURN_IF_FAILED(TextBuffer::Reflow(*_buffer.get(),
                                             *newTextBuffer.get(),
                                             _mutableViewport,
-                                            { oldRows }));
+                                            { oldRows },
+                                            true));
 
         newViewportTop = oldRows.mutableViewportTop;
         newVisibleTop = oldRows.visibleViewportTop;
@@ -875,64 +886,65 @@ Viewport Terminal::_GetVisibleViewport() const noexcept
 void Terminal::_WriteBuffer(const std::wstring_view& stringView)
 {
     auto& cursor = _buffer->GetCursor();
+    const auto bufferSize = _buffer->GetSize();
 
     // Defer the cursor drawing while we are iterating the string, for a better performance.
     // We can not waste time displaying a cursor event when we know more text is coming right behind it.
     cursor.StartDeferDrawing();
 
-    for (size_t i = 0; i < stringView.size(); i++)
+    // The text is written a row at a time. The cursor itself is only moved
+    // (and the viewport scrolled) once the whole string has been written, or
+    // when we need rows past the bottom of the buffer.
+    COORD position = cursor.GetPosition();
+    size_t i = 0;
+    while (i < stringView.size())
     {
-        const auto wch = stringView.at(i);
-        const COORD cursorPosBefore = cursor.GetPosition();
-        COORD proposedCursorPosition = cursorPosBefore;
-
-        // TODO: MSFT 21006766
-        // This is not great but I need it demoable. Fix by making a buffer stream writer.
-        //
-        // If wch is a surrogate character we need to read 2 code units
-        // from the stringView to form a single code point.
-        const auto isSurrogate = wch >= 0xD800 && wch <= 0xDFFF;
-        const auto view = stringView.substr(i, isSurrogate ? 2 : 1);
-        const OutputCellIterator it{ view, _buffer->GetCurrentAttributes() };
-        const auto end = _buffer->Write(it);
-        const auto cellDistance = end.GetCellDistance(it);
+        const OutputCellIterator it{ stringView.substr(i), _buffer->GetCurrentAttributes() };
+        const auto end = _buffer->WriteLine(it, position);
         const auto inputDistance = end.GetInputDistance(it);
 
         if (inputDistance > 0)
         {
-            // If "wch" was a surrogate character, we just consumed 2 code units above.
-            // -> Increment "i" by 1 in that case and thus by 2 in total in this iteration.
-            proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
-            i += inputDistance - 1;
+            position.X += gsl::narrow<SHORT>(end.GetCellDistance(it));
+            i += inputDistance;
+            continue;
         }
-        else
+
+        // If the rest of the row can't fit the next character (or the previous
+        // run already filled it), WriteLine() refuses to write anything.
+        // This basically behaves as if "\r\n" had been encountered and
+        // retries the write on the next row.
+        //
+        // TODO: GH#780 - This should really be a _deferred_ newline. If
+        // the next character to come in is a newline or a cursor
+        // movement or anything, then we should _not_ wrap this line
+        // here.
+        position.X = 0;
+        position.Y++;
+
+        if (position.Y >= bufferSize.Height())
         {
-            // If _WriteBuffer() is called with a consecutive string longer than the viewport/buffer width
-            // the call to _buffer->Write() will refuse to write anything on the current line.
-            // GetInputDistance() thus returns 0, which would in turn cause i to be
-            // decremented by 1 below and force the outer loop to loop forever.
-            // This if() basically behaves as if "\r\n" had been encountered above and retries the write.
-            // With well behaving shells during normal operation this safeguard should normally not be encountered.
-            proposedCursorPosition.X = 0;
-            proposedCursorPosition.Y++;
-
-            // Try the character again.
-            i--;
-
-            // If we write the last cell of the row here, TextBuffer::Write will
-            // mark this line as wrapped for us. If the next character we
-            // process is a newline, the Terminal::CursorLineFeed will unmark
-            // this line as wrapped.
-
-            // TODO: GH#780 - This should really be a _deferred_ newline. If
-            // the next character to come in is a newline or a cursor
-            // movement or anything, then we should _not_ wrap this line
-            // here.
+            // Every code point takes up at least one cell, so the rest of the
+            // string needs at least this many rows. Cycle the buffer for all of
+            // them at once instead of once for every row we're about to fill.
+            const auto remaining = stringView.substr(i);
+            const auto trailingSurrogates = std::count_if(remaining.begin(), remaining.end(), [](const wchar_t wch) {
+                return wch >= 0xDC00 && wch <= 0xDFFF;
+            });
+            const auto minCells = remaining.size() - gsl::narrow_cast<size_t>(trailingSurrogates);
+            const auto width = gsl::narrow_cast<size_t>(bufferSize.Width());
+            const auto newRows = std::clamp<size_t>((minCells + width - 1) / width,
+                                                    1,
+                                                    gsl::narrow_cast<size_t>(bufferSize.Height()));
+            const auto rowsBelow = gsl::narrow_cast<SHORT>(newRows - 1);
+
+            _AdjustCursorPosition({ 0, gsl::narrow<SHORT>(position.Y + rowsBelow) });
+            position.Y = gsl::narrow_cast<SHORT>(cursor.GetPosition().Y - rowsBelow);
         }
-
-        _AdjustCursorPosition(proposedCursorPosition);
     }
 
+    _AdjustCursorPosition(position);
+
     cursor.EndDeferDrawing();
 }
 
@@ -108,6 +108,7 @@ public:
     bool EnableButtonEventMouseMode(const bool enabled) noexcept override;
     bool EnableAnyEventMouseMode(const bool enabled) noexcept override;
     bool EnableAlternateScrollMode(const bool enabled) noexcept override;
+    bool EnableSynchronizedOutput(const bool enabled) noexcept override;
 
     bool IsVtInputEnabled() const noexcept override;
 
@@ -165,6 +166,7 @@ public:
     const std::wstring GetHyperlinkUri(uint16_t id) const noexcept override;
     const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept override;
     const std::vector<size_t> GetPatternId(const COORD location) const noexcept override;
+    void GetPatternSpans(const SHORT row, std::vector<Microsoft::Console::Render::PatternSpan>& spans) const override;
 #pragma endregion
 
 #pragma region IUiaData
@@ -295,6 +297,10 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+    // scratch space for GetPatternSpans, which runs for every row of every frame
+    mutable std::vector<std::tuple<SHORT, SHORT, size_t>> _patternClips;
+    mutable std::vector<SHORT> _patternEdges;
+    mutable std::vector<size_t> _patternRunIds;
     void _InvalidatePatternTree(interval_tree::IntervalTree<til::point, size_t>& tree);
     void _InvalidateFromCoords(const COORD start, const COORD end);
 
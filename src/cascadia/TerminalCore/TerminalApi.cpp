@@ -325,6 +325,9 @@ try
             _buffer->GetRowByOffset(i).Reset(_buffer->GetCurrentAttributes());
         }
 
+        // Anything that scrolled out of the buffer itself is part of the scrollback too.
+        _buffer->ClearArchive();
+
         // Reset the scroll offset now because there's nothing for the user to 'scroll' to
         _scrollOffset = 0;
 
@@ -537,6 +540,14 @@ bool Terminal::EnableAlternateScrollMode(const bool enabled) noexcept
     return true;
 }
 
+bool Terminal::EnableSynchronizedOutput(const bool enabled) noexcept
+try
+{
+    _buffer->GetRenderTarget().SetSynchronizedOutput(enabled);
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
 bool Terminal::IsVtInputEnabled() const noexcept
 {
     // We should never be getting this call in Terminal.
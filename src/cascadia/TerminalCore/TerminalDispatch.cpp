@@ -112,6 +112,14 @@ try
 }
 CATCH_LOG_RETURN_FALSE()
 
+bool TerminalDispatch::RepeatCharacter(const wchar_t wch, const size_t count) noexcept
+try
+{
+    // The buffer writes the run a row at a time already.
+    return _terminalApi.PrintString(std::wstring(count, wch));
+}
+CATCH_LOG_RETURN_FALSE()
+
 bool TerminalDispatch::WarningBell() noexcept
 try
 {
@@ -371,6 +379,18 @@ bool TerminalDispatch::EnableAlternateScroll(const bool enabled) noexcept
     return true;
 }
 
+//Routine Description:
+// Synchronized Output Mode - While enabled, the output is not painted, so that
+//      the frames of an application aren't painted half-finished.
+//Arguments:
+// - enabled - true to enable, false to disable.
+// Return value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::EnableSynchronizedOutput(const bool enabled) noexcept
+{
+    return _terminalApi.EnableSynchronizedOutput(enabled);
+}
+
 bool TerminalDispatch::SetMode(const DispatchTypes::ModeParams param) noexcept
 {
     return _ModeParamsHelper(param, true);
@@ -502,6 +522,9 @@ bool TerminalDispatch::_ModeParamsHelper(const DispatchTypes::ModeParams param,
     case DispatchTypes::ModeParams::W32IM_Win32InputMode:
         success = EnableWin32InputMode(enable);
         break;
+    case DispatchTypes::ModeParams::SO_SynchronizedOutput:
+        success = EnableSynchronizedOutput(enable);
+        break;
     default:
         // If no functions to call, overall dispatch was a failure.
         success = false;
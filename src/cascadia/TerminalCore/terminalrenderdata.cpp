@@ -159,6 +159,91 @@ const std::vector<size_t> Terminal::GetPatternId(const COORD location) const noe
     return {};
 }
 
+// Method Description:
+// - Gets the runs of cells in a row that are covered by regex patterns
+// Arguments:
+// - row - The row, relative to the viewport
+// - spans - Receives the runs, sorted by column. Runs that aren't covered
+//   by any pattern are left out. The spans it already holds are reused, so
+//   that painting a frame doesn't allocate for every row.
+// Return value:
+// - <none>
+void Terminal::GetPatternSpans(const SHORT row, std::vector<PatternSpan>& spans) const
+{
+    size_t count = 0;
+    auto trimSpans = wil::scope_exit([&]() { spans.resize(count); });
+
+    const auto width = _mutableViewport.Width();
+
+    // Clip every pattern that touches this row to the row.
+    auto& clipped = _patternClips;
+    clipped.clear();
+    _patternIntervalTree.visit_overlapping(COORD{ 1, row }, COORD{ gsl::narrow_cast<SHORT>(width - 1), row }, [&](const auto& interval) {
+        const auto start = interval.start.y() < row ? 0 : interval.start.x();
+        const auto end = interval.stop.y() > row ? width : interval.stop.x();
+        if (start < end)
+        {
+            clipped.emplace_back(gsl::narrow_cast<SHORT>(start), gsl::narrow_cast<SHORT>(end), interval.value);
+        }
+    });
+
+    if (clipped.empty())
+    {
+        return;
+    }
+
+    // Patterns may overlap, so split the row at every edge of a pattern and
+    // collect the patterns that cover each of the resulting runs.
+    auto& edges = _patternEdges;
+    edges.clear();
+    for (const auto& [start, end, patternId] : clipped)
+    {
+        edges.push_back(start);
+        edges.push_back(end);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    for (size_t i = 1; i < edges.size(); ++i)
+    {
+        const auto runStart = til::at(edges, i - 1);
+        const auto runEnd = til::at(edges, i);
+
+        auto& patternIds = _patternRunIds;
+        patternIds.clear();
+        for (const auto& [start, end, patternId] : clipped)
+        {
+            if (start <= runStart && runEnd <= end)
+            {
+                patternIds.push_back(patternId);
+            }
+        }
+
+        if (patternIds.empty())
+        {
+            continue;
+        }
+        std::sort(patternIds.begin(), patternIds.end());
+
+        if (count != 0 && til::at(spans, count - 1).end == runStart && til::at(spans, count - 1).patternIds == patternIds)
+        {
+            til::at(spans, count - 1).end = runEnd;
+        }
+        else if (count < spans.size())
+        {
+            auto& span = til::at(spans, count++);
+            span.start = runStart;
+            span.end = runEnd;
+            span.patternIds.assign(patternIds.begin(), patternIds.end());
+        }
+        else
+        {
+            spans.push_back({ runStart, runEnd, patternIds });
+            ++count;
+        }
+    }
+}
+
 std::vector<Microsoft::Console::Types::Viewport> Terminal::GetSelectionRects() noexcept
 try
 {
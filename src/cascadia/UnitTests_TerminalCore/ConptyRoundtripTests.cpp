@@ -688,7 +688,8 @@ void ConptyRoundtripTests::MoveCursorAtEOL()
     // TODO: GH#405/#4415 - Before #405 merges, the VT sequences conpty emits
     // might change, but the buffer contents shouldn't.
     // If they do change and these tests break, that's to be expected.
-    expectedOutput.push_back(std::string(TerminalViewWidth, 'A'));
+    expectedOutput.push_back("A");
+    expectedOutput.push_back("\x1b[79b");
     expectedOutput.push_back("\x1b[1;80H");
 
     VERIFY_SUCCEEDED(renderer.PaintFrame());
@@ -1235,8 +1236,10 @@ void ConptyRoundtripTests::OutputWrappedLinesAtTopOfBuffer()
 
     verifyBuffer(hostTb);
 
-    expectedOutput.push_back(std::string(TerminalViewWidth, 'A'));
-    expectedOutput.push_back(std::string(20, 'A'));
+    expectedOutput.push_back("A");
+    expectedOutput.push_back("\x1b[79b");
+    expectedOutput.push_back("A");
+    expectedOutput.push_back("\x1b[19b");
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 
     verifyBuffer(termTb);
@@ -1298,7 +1301,8 @@ void ConptyRoundtripTests::OutputWrappedLinesAtBottomOfBuffer()
     // |X              | (b)
     // |_              | (b)
 
-    expectedOutput.push_back(std::string(TerminalViewWidth, 'A'));
+    expectedOutput.push_back("A");
+    expectedOutput.push_back("\x1b[79b");
     // |X              | (b)
     // |X              | (b)
     // ...
@@ -1331,7 +1335,8 @@ void ConptyRoundtripTests::OutputWrappedLinesAtBottomOfBuffer()
     // |AAAAAAAA...AAAA|_ (w) The cursor is actually on the last A here
     // |               | (b)
 
-    expectedOutput.push_back(std::string(20, 'A')); // Print the second line.
+    expectedOutput.push_back("A"); // Print the second line.
+    expectedOutput.push_back("\x1b[19b");
     // |X              | (b)
     // |X              | (b)
     // ...
@@ -1422,7 +1427,8 @@ void ConptyRoundtripTests::ScrollWithChangesInMiddle()
     expectedOutput.push_back("\x1b[15;1H"); // Move the cursor to row 14, col 0
     expectedOutput.push_back("Y"); // Print a 'Y'
     expectedOutput.push_back("\x1b[32;1H"); // Move the cursor to the last row
-    expectedOutput.push_back(std::string(TerminalViewWidth, 'A')); // Print the first 80 'A's
+    expectedOutput.push_back("A"); // Print the first 80 'A's
+    expectedOutput.push_back("\x1b[79b");
     // This is going to be the end of the first frame - b/c we moved the cursor
     // in the middle of the frame, we're going to hide/show the cursor during
     // this frame
@@ -1433,7 +1439,8 @@ void ConptyRoundtripTests::ScrollWithChangesInMiddle()
     expectedOutput.push_back("\n"); // add a newline to the bottom of the buffer
     expectedOutput.push_back("\x1b[31;80H"); // Move the cursor BACK to the wrapped row
     expectedOutput.push_back(std::string(1, 'A')); // Reprint the last character of the wrapped row
-    expectedOutput.push_back(std::string(20, 'A')); // Print the second line.
+    expectedOutput.push_back("A"); // Print the second line.
+    expectedOutput.push_back("\x1b[19b");
 
     _logConpty = true;
 
@@ -1558,8 +1565,11 @@ void ConptyRoundtripTests::ScrollWithMargins()
         expectedOutput.push_back("\r\n");
     }
     {
-        const std::string expectedString(initialTermView.Width() - 1, '*');
-        expectedOutput.push_back(expectedString);
+        // The asterisks are repeated with REP.
+        std::stringstream ss;
+        ss << "\x1b[" << initialTermView.Width() - 2 << "b";
+        expectedOutput.push_back("*");
+        expectedOutput.push_back(ss.str());
     }
 
     Log::Comment(L"Verify host buffer contains pattern.");
@@ -1692,9 +1702,13 @@ void ConptyRoundtripTests::ScrollWithMargins()
         expectedOutput.push_back("\r\n");
     }
     {
-        const std::string expectedString(initialTermView.Width() - 1, '*');
+        // The asterisks are repeated with REP.
+        std::stringstream ss;
+        ss << "\x1b[" << initialTermView.Width() - 2 << "b";
+        expectedOutput.push_back("*");
+        expectedOutput.push_back(ss.str());
         // There will be one extra blank space at the end of the line, to prevent delayed EOL wrapping
-        expectedOutput.push_back(expectedString + " ");
+        expectedOutput.push_back(" ");
     }
     {
         // Cursor gets reset into second line from bottom, left most column
@@ -2141,11 +2155,12 @@ void ConptyRoundtripTests::OutputWrappedLineWithSpace()
     Log::Comment(L"========== Checking the host buffer state ==========");
     verifyBuffer(hostTb);
 
-    std::string firstLine = std::string(firstTextLength, 'A');
-    firstLine += "  ";
     std::string secondLine{ " B" };
 
-    expectedOutput.push_back(firstLine);
+    // The run of 'A's is repeated with REP.
+    expectedOutput.push_back("A");
+    expectedOutput.push_back("\x1b[77b");
+    expectedOutput.push_back("  ");
     expectedOutput.push_back(secondLine);
     Log::Comment(L"Painting the frame");
     VERIFY_SUCCEEDED(renderer.PaintFrame());
@@ -2201,8 +2216,6 @@ void ConptyRoundtripTests::OutputWrappedLineWithSpaceAtBottomOfBuffer()
     const auto spacesLength = 3;
     const auto secondTextLength = 1;
 
-    std::string firstLine = std::string(firstTextLength, 'A');
-    firstLine += "  ";
     std::string secondLine{ " B" };
 
     // The following diagrams show the buffer contents after each string emitted
@@ -2218,7 +2231,9 @@ void ConptyRoundtripTests::OutputWrappedLineWithSpaceAtBottomOfBuffer()
     // |X              | (b)
     // |_              | (b)
 
-    expectedOutput.push_back(firstLine);
+    expectedOutput.push_back("A"); // The run of 'A's is repeated with REP.
+    expectedOutput.push_back("\x1b[77b");
+    expectedOutput.push_back("  ");
     // |X              | (b)
     // |X              | (b)
     // ...
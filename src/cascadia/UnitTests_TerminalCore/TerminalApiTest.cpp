@@ -8,13 +8,17 @@
 #include "MockTermSettings.h"
 #include "../renderer/inc/DummyRenderTarget.hpp"
 #include "consoletaeftemplates.hpp"
+#include "TestUtils.h"
 
 using namespace winrt::Microsoft::Terminal::TerminalControl;
 using namespace Microsoft::Terminal::Core;
 
 using namespace WEX::Logging;
+using namespace WEX::Common;
 using namespace WEX::TestExecution;
 
+using PointTree = interval_tree::IntervalTree<til::point, size_t>;
+
 namespace TerminalCoreUnitTests
 {
 #define WCS(x) WCSHELPER(x)
@@ -34,6 +38,9 @@ namespace TerminalCoreUnitTests
         // PrintString() is called with more code units than the buffer width.
         TEST_METHOD(PrintStringOfSurrogatePairs);
         TEST_METHOD(CheckDoubleWidthCursor);
+        TEST_METHOD(PrintStringPastBottomOfBuffer);
+
+        TEST_METHOD(GetPatternSpans);
 
         TEST_METHOD(AddHyperlink);
         TEST_METHOD(AddHyperlinkCustomId);
@@ -258,6 +265,75 @@ void TerminalApiTest::CheckDoubleWidthCursor()
     VERIFY_IS_TRUE(term.IsCursorDoubleWidth());
 }
 
+void TerminalApiTest::PrintStringPastBottomOfBuffer()
+{
+    DummyRenderTarget renderTarget;
+    Terminal term;
+    term.Create({ 10, 5 }, 0, renderTarget);
+
+    auto& tbi = *(term._buffer);
+    auto& cursor = tbi.GetCursor();
+
+    // Seven full rows and a partial one don't fit into a buffer of five rows,
+    // so the buffer has to cycle while the string is being written.
+    std::wstring text;
+    for (size_t i = 0; i < 7; ++i)
+    {
+        text.append(L"0123456789");
+    }
+    text.append(L"abc");
+    term.PrintString(text);
+
+    for (SHORT y = 0; y < 4; ++y)
+    {
+        TestUtils::VerifyExpectedString(tbi, L"0123456789", { 0, y });
+    }
+    TestUtils::VerifyExpectedString(tbi, L"abc       ", { 0, 4 });
+    VERIFY_ARE_EQUAL(COORD({ 3, 4 }), cursor.GetPosition());
+    VERIFY_ARE_EQUAL(0, term.GetScrollOffset());
+}
+
+void TerminalApiTest::GetPatternSpans()
+{
+    DummyRenderTarget renderTarget;
+    Terminal term;
+    term.Create({ 10, 5 }, 0, renderTarget);
+
+    // Pattern 0 covers columns 2-5 of the first row. Pattern 1 starts in
+    // the middle of it and continues up to the first cell of the third row.
+    PointTree::interval_vector intervals;
+    intervals.push_back(PointTree::interval(til::point{ 2, 0 }, til::point{ 6, 0 }, 0));
+    intervals.push_back(PointTree::interval(til::point{ 4, 0 }, til::point{ 1, 2 }, 1));
+    term._patternIntervalTree = PointTree{ std::move(intervals) };
+
+    std::vector<Microsoft::Console::Render::PatternSpan> spans;
+
+    term.GetPatternSpans(0, spans);
+    VERIFY_ARE_EQUAL(3u, spans.size());
+    VERIFY_ARE_EQUAL(2, spans.at(0).start);
+    VERIFY_ARE_EQUAL(4, spans.at(0).end);
+    VERIFY_IS_TRUE(spans.at(0).patternIds == std::vector<size_t>{ 0 });
+    VERIFY_ARE_EQUAL(4, spans.at(1).start);
+    VERIFY_ARE_EQUAL(6, spans.at(1).end);
+    VERIFY_IS_TRUE((spans.at(1).patternIds == std::vector<size_t>{ 0, 1 }));
+    VERIFY_ARE_EQUAL(6, spans.at(2).start);
+    VERIFY_ARE_EQUAL(10, spans.at(2).end);
+    VERIFY_IS_TRUE(spans.at(2).patternIds == std::vector<size_t>{ 1 });
+
+    term.GetPatternSpans(1, spans);
+    VERIFY_ARE_EQUAL(1u, spans.size());
+    VERIFY_ARE_EQUAL(0, spans.at(0).start);
+    VERIFY_ARE_EQUAL(10, spans.at(0).end);
+
+    term.GetPatternSpans(2, spans);
+    VERIFY_ARE_EQUAL(1u, spans.size());
+    VERIFY_ARE_EQUAL(0, spans.at(0).start);
+    VERIFY_ARE_EQUAL(1, spans.at(0).end);
+
+    term.GetPatternSpans(3, spans);
+    VERIFY_ARE_EQUAL(0u, spans.size());
+}
+
 void TerminalCoreUnitTests::TerminalApiTest::AddHyperlink()
 {
     // This is a nearly literal copy-paste of ScreenBufferTests::TestAddHyperlink, adapted for the Terminal
@@ -52,6 +52,7 @@ public:
     bool GetInheritCursor() const;
     bool IsResizeQuirkEnabled() const;
     bool IsWin32InputModeEnabled() const;
+    bool IsPassthroughModeEnabled() const;
 
     void SetExpectedSize(COORD dimensions) noexcept;
 
@@ -72,6 +73,7 @@ public:
     static const std::wstring_view INHERIT_CURSOR_ARG;
     static const std::wstring_view RESIZE_QUIRK;
     static const std::wstring_view WIN32_INPUT_MODE;
+    static const std::wstring_view PASSTHROUGH_MODE;
     static const std::wstring_view FEATURE_ARG;
     static const std::wstring_view FEATURE_PTY_ARG;
 
@@ -134,6 +136,7 @@ private:
     bool _inheritCursor;
     bool _resizeQuirk{ false };
     bool _win32InputMode{ false };
+    bool _passthroughMode{ false };
 
     bool _receivedEarlySizeChange;
     short _originalWidth;
@@ -110,3 +110,14 @@ void ScreenBufferRenderTarget::TriggerTitleChange()
         pRenderer->TriggerTitleChange();
     }
 }
+
+void ScreenBufferRenderTarget::SetSynchronizedOutput(const bool enabled)
+{
+    // Synchronized output is a mode of the terminal, not of a buffer, so it
+    // carries on when the application switches to another buffer.
+    auto* pRenderer = ServiceLocator::LocateGlobals().pRender;
+    if (pRenderer != nullptr)
+    {
+        pRenderer->SetSynchronizedOutput(enabled);
+    }
+}
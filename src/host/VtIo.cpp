@@ -9,6 +9,7 @@
 #include "../renderer/vt/Xterm256Engine.hpp"
 
 #include "../renderer/base/renderer.hpp"
+#include "../terminal/parser/OutputStateMachineEngine.hpp"
 #include "../types/inc/utils.hpp"
 #include "input.h" // ProcessCtrlEvents
 #include "output.h" // CloseConsoleProcessState
@@ -70,6 +71,7 @@ VtIo::VtIo() :
     _lookingForCursorPosition = pArgs->GetInheritCursor();
     _resizeQuirk = pArgs->IsResizeQuirkEnabled();
     _win32InputMode = pArgs->IsWin32InputModeEnabled();
+    _passthroughMode = pArgs->IsPassthroughModeEnabled();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
@@ -455,6 +457,102 @@ bool VtIo::IsResizeQuirkEnabled() const
     return _resizeQuirk;
 }
 
+// Method Description:
+// - Returns true if client output should be passed through to the terminal.
+//   In passthrough mode, the VT output of the client is still parsed by the
+//   state machine, and the buffer is updated so that API callers can read it
+//   back, but the text and sequences are written to the terminal as-is instead
+//   of being re-rendered from the buffer on the next frame.
+// - Only the xterm-256color renderer supports this, because the others would
+//   need to translate the client's colors.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we were started with the `--passthrough` flag enabled.
+bool VtIo::IsPassthroughModeEnabled() const
+{
+    return _passthroughMode && _IoMode == VtIoMode::XTERM_256 && _pVtRenderEngine != nullptr;
+}
+
+// Method Description:
+// - Processes a string of VT output from the client in passthrough mode. See
+//   IsPassthroughModeEnabled.
+// - Console lock must be held when calling this routine.
+// Arguments:
+// - screenInfo: the active screen buffer the string was written to.
+// - string: the VT output of the client.
+// Return Value:
+// - <none>
+void VtIo::WritePassthrough(SCREEN_INFORMATION& screenInfo, const std::wstring_view string)
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+
+    // Anything that was invalidated before this write (API calls, a resize)
+    // has to reach the terminal before the text that follows it.
+    if (g.pRender)
+    {
+        LOG_IF_FAILED(g.pRender->PaintFrame());
+    }
+
+    StateMachine& machine = screenInfo.GetStateMachine();
+    OutputStateMachineEngine& engine = reinterpret_cast<OutputStateMachineEngine&>(machine.Engine());
+
+    // The sequences that the terminal can't be relied on to handle like we do
+    // are only executed on our buffer. Leave passthrough while they are, so
+    // that the renderer paints what they changed, right after the output
+    // that was passed through before them.
+    auto suspendPassthrough = [this, &g](const bool suspended) {
+        if (suspended)
+        {
+            _EndPassthrough();
+        }
+        else
+        {
+            if (g.pRender)
+            {
+                LOG_IF_FAILED(g.pRender->PaintFrame());
+            }
+            _pVtRenderEngine->BeginPassthrough();
+        }
+    };
+
+    _pVtRenderEngine->BeginPassthrough();
+    engine.SetPassthroughMode(true, g.getConsoleInformation().IsReturnOnNewlineAutomatic(), suspendPassthrough);
+
+    auto endPassthrough = wil::scope_exit([&]() {
+        engine.SetPassthroughMode(false);
+        _EndPassthrough();
+    });
+
+    machine.ProcessString(string);
+}
+
+// Method Description:
+// - Takes the renderer out of passthrough mode. The terminal's state was
+//   changed by the output that was passed through, so the renderer adopts the
+//   state of the buffer as the one it last wrote.
+// - Console lock must be held when calling this routine.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtIo::_EndPassthrough()
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+
+    // The client might have switched to the alternate buffer, so
+    // synchronize the renderer with whichever buffer is active now.
+    const SCREEN_INFORMATION& activeInfo = g.getConsoleInformation().GetActiveOutputBuffer();
+    const Cursor& cursor = activeInfo.GetTextBuffer().GetCursor();
+    COORD cursorPosition = cursor.GetPosition();
+    activeInfo.GetViewport().ConvertToOrigin(&cursorPosition);
+
+    LOG_IF_FAILED(_pVtRenderEngine->EndPassthrough(cursorPosition,
+                                                   cursor.IsDelayedEOLWrap(),
+                                                   cursor.IsVisible(),
+                                                   activeInfo.GetAttributes()));
+}
+
 // Method Description:
 // - Manually tell the renderer that it should emit a "Erase Scrollback"
 //   sequence to the connected terminal. We need to do this in certain cases
@@ -10,6 +10,7 @@
 #include "PtySignalInputThread.hpp"
 
 class ConsoleArguments;
+class SCREEN_INFORMATION;
 
 namespace Microsoft::Console::VirtualTerminal
 {
@@ -44,6 +45,9 @@ namespace Microsoft::Console::VirtualTerminal
 #endif
 
         bool IsResizeQuirkEnabled() const;
+        bool IsPassthroughModeEnabled() const;
+
+        void WritePassthrough(SCREEN_INFORMATION& screenInfo, const std::wstring_view string);
 
         [[nodiscard]] HRESULT ManuallyClearScrollback() const noexcept;
 
@@ -63,6 +67,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _resizeQuirk{ false };
         bool _win32InputMode{ false };
+        bool _passthroughMode{ false };
 
         std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
         std::unique_ptr<Microsoft::Console::VtInputThread> _pVtInputThread;
@@ -71,6 +76,7 @@ namespace Microsoft::Console::VirtualTerminal
         [[nodiscard]] HRESULT _Initialize(const HANDLE InHandle, const HANDLE OutHandle, const std::wstring& VtMode, _In_opt_ const HANDLE SignalHandle);
 
         void _ShutdownIfNeeded();
+        void _EndPassthrough();
 
 #ifdef UNIT_TESTING
         friend class VtIoTests;
@@ -25,6 +25,7 @@
 using namespace Microsoft::Console::Types;
 using Microsoft::Console::Interactivity::ServiceLocator;
 using Microsoft::Console::VirtualTerminal::StateMachine;
+using Microsoft::Console::VirtualTerminal::VtIo;
 // Used by WriteCharsLegacy.
 #define IS_GLYPH_CHAR(wch) (((wch) >= L' ') && ((wch) != 0x007F))
 
@@ -939,7 +940,19 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
                 StateMachine& machine = screenInfo.GetStateMachine();
                 size_t const cch = BufferSize / sizeof(WCHAR);
 
-                machine.ProcessString({ pwchRealUnicode, cch });
+                // In conpty passthrough mode, the output goes straight to the
+                // terminal as it's parsed, instead of being rendered again from
+                // the buffer. Only the active buffer is ever painted.
+                CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+                VtIo* const pVtIo = gci.GetVtIo();
+                if (gci.IsInVtIoMode() && pVtIo->IsPassthroughModeEnabled() && screenInfo.IsActiveScreenBuffer())
+                {
+                    pVtIo->WritePassthrough(screenInfo, { pwchRealUnicode, cch });
+                }
+                else
+                {
+                    machine.ProcessString({ pwchRealUnicode, cch });
+                }
                 *pcb += BufferSize;
             }
         }
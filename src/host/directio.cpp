@@ -185,13 +185,15 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         {
             return STATUS_INTEGER_OVERFLOW;
         }
-        std::deque<std::unique_ptr<IInputEvent>> readEvents;
-        NTSTATUS Status = inputBuffer.Read(readEvents,
-                                           amountToRead,
+        std::vector<INPUT_RECORD> records(std::min(amountToRead, inputBuffer.GetNumberOfReadyEvents()));
+        size_t eventsRead;
+        NTSTATUS Status = inputBuffer.Read(records,
+                                           eventsRead,
                                            IsPeek,
                                            true,
                                            IsUnicode,
                                            false);
+        auto readEvents = IInputEvent::Create(gsl::span<const INPUT_RECORD>{ records.data(), eventsRead });
 
         if (CONSOLE_STATUS_WAIT == Status)
         {
@@ -527,9 +529,9 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
     try
     {
-        auto events = IInputEvent::Create(buffer);
-
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        // The records are stored as they are, without creating an event for each.
+        written = append ? context.Write(buffer) : context.Prepend(buffer);
+        return S_OK;
     }
     CATCH_RETURN();
 }
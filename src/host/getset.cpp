@@ -1572,6 +1572,19 @@ void DoSrvPrivateEnableAlternateScroll(const bool fEnable)
     gci.GetActiveInputBuffer()->GetTerminalInput().EnableAlternateScroll(fEnable);
 }
 
+// Routine Description:
+// - A private API call for enabling synchronized output mode
+// Parameters:
+// - screenInfo - the screen buffer the application is writing to.
+// - enabled - true to hold back painting until the application's frame is
+//      done, false to paint it.
+// Return value:
+// None
+void DoSrvPrivateEnableSynchronizedOutput(SCREEN_INFORMATION& screenInfo, const bool enabled)
+{
+    screenInfo.GetRenderTarget().SetSynchronizedOutput(enabled);
+}
+
 // Routine Description:
 // - A private API call for performing a VT-style erase all operation on the buffer.
 //      See SCREEN_INFORMATION::VtEraseAll's description for details.
@@ -2250,3 +2263,94 @@ void DoSrvPrivateMoveToBottom(SCREEN_INFORMATION& screenInfo)
     }
     CATCH_RETURN();
 }
+
+// Routine Description:
+// - A private API call for copying a rectangular area of the screen buffer to
+//    another place in it. Unlike PrivateScrollRegion, the source is left as
+//    it is, and nothing is filled.
+// Arguments:
+// - screenInfo - Reference to screen buffer info.
+// - sourceRect - Region to copy, inclusive.
+// - targetOrigin - Upper left corner of the target region.
+// Return value:
+// - S_OK or failure code from thrown exception
+[[nodiscard]] HRESULT DoSrvPrivateCopyRectangularArea(SCREEN_INFORMATION& screenInfo,
+                                                      const SMALL_RECT sourceRect,
+                                                      const COORD targetOrigin) noexcept
+{
+    try
+    {
+        LockConsole();
+        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+        const auto source = Viewport::FromInclusive(sourceRect);
+        screenInfo.GetTextBuffer().CopyRect(source, targetOrigin);
+
+        // Notify accessibility
+        const auto target = Viewport::Intersect(screenInfo.GetBufferSize(),
+                                                Viewport::FromDimensions(targetOrigin, source.Dimensions()));
+        if (target.IsValid())
+        {
+            screenInfo.NotifyAccessibilityEventing(target.Left(), target.Top(), target.RightInclusive(), target.BottomInclusive());
+        }
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
+// Routine Description:
+// - A private API call for filling a rectangular area of the screen buffer.
+// Arguments:
+// - screenInfo - Reference to screen buffer info.
+// - fillRect - Region to fill, inclusive.
+// - fillChar - Character to fill the region with.
+// - fillAttrs - Attributes to fill the region with. If not given, the region
+//               keeps its attributes.
+// Return value:
+// - S_OK or failure code from thrown exception
+[[nodiscard]] HRESULT DoSrvPrivateFillRectangularArea(SCREEN_INFORMATION& screenInfo,
+                                                      const SMALL_RECT fillRect,
+                                                      const wchar_t fillChar,
+                                                      const std::optional<TextAttribute> fillAttrs) noexcept
+{
+    try
+    {
+        LockConsole();
+        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+        screenInfo.GetTextBuffer().FillRect(Viewport::FromInclusive(fillRect), fillChar, fillAttrs);
+
+        // Notify accessibility
+        const auto area = Viewport::Intersect(screenInfo.GetBufferSize(), Viewport::FromInclusive(fillRect));
+        if (area.IsValid())
+        {
+            screenInfo.NotifyAccessibilityEventing(area.Left(), area.Top(), area.RightInclusive(), area.BottomInclusive());
+        }
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
+// Routine Description:
+// - A private API call for changing the attributes of a rectangular area of
+//    the screen buffer, without touching its text.
+// Arguments:
+// - screenInfo - Reference to screen buffer info.
+// - changeRect - Region to change, inclusive.
+// - change - Changes the attributes given to it in place.
+// Return value:
+// - S_OK or failure code from thrown exception
+[[nodiscard]] HRESULT DoSrvPrivateChangeAttributesInArea(SCREEN_INFORMATION& screenInfo,
+                                                         const SMALL_RECT changeRect,
+                                                         const std::function<void(TextAttribute&)>& change) noexcept
+{
+    try
+    {
+        LockConsole();
+        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+        screenInfo.GetTextBuffer().ChangeAttrsInRect(Viewport::FromInclusive(changeRect), change);
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
@@ -41,6 +41,7 @@ void DoSrvPrivateEnableSGRExtendedMouseMode(const bool fEnable);
 void DoSrvPrivateEnableButtonEventMouseMode(const bool fEnable);
 void DoSrvPrivateEnableAnyEventMouseMode(const bool fEnable);
 void DoSrvPrivateEnableAlternateScroll(const bool fEnable);
+void DoSrvPrivateEnableSynchronizedOutput(SCREEN_INFORMATION& screenInfo, const bool enabled);
 
 [[nodiscard]] HRESULT DoSrvPrivateEraseAll(SCREEN_INFORMATION& screenInfo);
 
@@ -87,3 +88,16 @@ void DoSrvPrivateMoveToBottom(SCREEN_INFORMATION& screenInfo);
                                                const std::optional<SMALL_RECT> clipRect,
                                                const COORD destinationOrigin,
                                                const bool standardFillAttrs) noexcept;
+
+[[nodiscard]] HRESULT DoSrvPrivateCopyRectangularArea(SCREEN_INFORMATION& screenInfo,
+                                                      const SMALL_RECT sourceRect,
+                                                      const COORD targetOrigin) noexcept;
+
+[[nodiscard]] HRESULT DoSrvPrivateFillRectangularArea(SCREEN_INFORMATION& screenInfo,
+                                                      const SMALL_RECT fillRect,
+                                                      const wchar_t fillChar,
+                                                      const std::optional<TextAttribute> fillAttrs) noexcept;
+
+[[nodiscard]] HRESULT DoSrvPrivateChangeAttributesInArea(SCREEN_INFORMATION& screenInfo,
+                                                         const SMALL_RECT changeRect,
+                                                         const std::function<void(TextAttribute&)>& change) noexcept;
@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inputRecordRing.hpp"
+
+InputRecordRing::InputRecordRing() noexcept :
+    _records{},
+    _capacity{ 0 },
+    _head{ 0 },
+    _count{ 0 }
+{
+}
+
+bool InputRecordRing::empty() const noexcept
+{
+    return _count == 0;
+}
+
+size_t InputRecordRing::size() const noexcept
+{
+    return _count;
+}
+
+// Routine Description:
+// - Accesses a record in the ring.
+// Arguments:
+// - index - The record to access. 0 is the oldest record in the ring.
+// Note:
+// - The index must be less than size().
+INPUT_RECORD& InputRecordRing::operator[](const size_t index) noexcept
+{
+    FAIL_FAST_IF(index >= _count);
+    return _records[(_head + index) & (_capacity - 1)];
+}
+
+const INPUT_RECORD& InputRecordRing::operator[](const size_t index) const noexcept
+{
+    FAIL_FAST_IF(index >= _count);
+    return _records[(_head + index) & (_capacity - 1)];
+}
+
+INPUT_RECORD& InputRecordRing::front() noexcept
+{
+    return (*this)[0];
+}
+
+INPUT_RECORD& InputRecordRing::back() noexcept
+{
+    return (*this)[_count - 1];
+}
+
+// Routine Description:
+// - Appends a record as the newest record of the ring.
+// Note:
+// - will throw if the ring has to grow and can't
+void InputRecordRing::push_back(const INPUT_RECORD& record)
+{
+    if (_count == _capacity)
+    {
+        _Grow();
+    }
+    ++_count;
+    back() = record;
+}
+
+// Routine Description:
+// - Inserts a record in front of all the records in the ring.
+// Note:
+// - will throw if the ring has to grow and can't
+void InputRecordRing::push_front(const INPUT_RECORD& record)
+{
+    if (_count == _capacity)
+    {
+        _Grow();
+    }
+    _head = (_head + _capacity - 1) & (_capacity - 1);
+    ++_count;
+    front() = record;
+}
+
+// Routine Description:
+// - Removes the oldest record from the ring.
+void InputRecordRing::pop_front() noexcept
+{
+    FAIL_FAST_IF(_count == 0);
+    _head = (_head + 1) & (_capacity - 1);
+    --_count;
+}
+
+// Routine Description:
+// - Removes the newest record from the ring.
+void InputRecordRing::pop_back() noexcept
+{
+    FAIL_FAST_IF(_count == 0);
+    --_count;
+}
+
+// Routine Description:
+// - Removes every record. The memory is kept for the next records written.
+void InputRecordRing::clear() noexcept
+{
+    _head = 0;
+    _count = 0;
+}
+
+// Routine Description:
+// - Moves the oldest records behind all the others, in place.
+// Arguments:
+// - count - The number of records to move. Must not exceed size().
+void InputRecordRing::rotate(const size_t count) noexcept
+{
+    FAIL_FAST_IF(count > _count);
+    _Reverse(0, count);
+    _Reverse(count, _count);
+    _Reverse(0, _count);
+}
+
+// Routine Description:
+// - Doubles the capacity of the ring, unwrapping the records so that the
+//   oldest one is at the start of the new allocation.
+// Note:
+// - will throw on failure
+void InputRecordRing::_Grow()
+{
+    const auto capacity = _capacity == 0 ? s_initialCapacity : _capacity * 2;
+    auto records = std::make_unique<INPUT_RECORD[]>(capacity);
+    for (size_t i = 0; i < _count; ++i)
+    {
+        records[i] = (*this)[i];
+    }
+
+    _records = std::move(records);
+    _capacity = capacity;
+    _head = 0;
+}
+
+// Routine Description:
+// - Reverses the order of the records in [begin, end).
+void InputRecordRing::_Reverse(size_t begin, size_t end) noexcept
+{
+    for (; begin + 1 < end; ++begin)
+    {
+        --end;
+        std::swap((*this)[begin], (*this)[end]);
+    }
+}
@@ -0,0 +1,70 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- inputRecordRing.hpp
+
+Abstract:
+- A growable ring buffer of INPUT_RECORDs that backs the input buffer.
+- INPUT_RECORD is already a tagged union of every event type the console
+  knows about and owns no memory of its own, so events are stored by value
+  in one contiguous allocation. Once the ring has grown to fit the input
+  that's in flight, writing and reading events doesn't allocate anymore.
+--*/
+
+#pragma once
+
+class InputRecordRing final
+{
+public:
+    InputRecordRing() noexcept;
+
+    bool empty() const noexcept;
+    size_t size() const noexcept;
+
+    INPUT_RECORD& operator[](const size_t index) noexcept;
+    const INPUT_RECORD& operator[](const size_t index) const noexcept;
+    INPUT_RECORD& front() noexcept;
+    INPUT_RECORD& back() noexcept;
+
+    void push_back(const INPUT_RECORD& record);
+    void push_front(const INPUT_RECORD& record);
+    void pop_front() noexcept;
+    void pop_back() noexcept;
+    void clear() noexcept;
+
+    // Moves the oldest count records behind all the others, keeping the
+    // order within both parts.
+    void rotate(const size_t count) noexcept;
+
+    // Removes the records the predicate returns true for, keeping the order
+    // of the remaining ones.
+    template<typename Predicate>
+    void remove_if(Predicate&& predicate)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _count; ++i)
+        {
+            const auto& record = (*this)[i];
+            if (!predicate(record))
+            {
+                (*this)[kept++] = record;
+            }
+        }
+        _count = kept;
+    }
+
+private:
+    // The capacity of the ring when the first record is written. It's
+    // always a power of two, so wrapping around is a mask.
+    static constexpr size_t s_initialCapacity = 64;
+
+    void _Grow();
+    void _Reverse(size_t begin, size_t end) noexcept;
+
+    std::unique_ptr<INPUT_RECORD[]> _records;
+    size_t _capacity;
+    size_t _head;
+    size_t _count;
+};
@@ -9,6 +9,8 @@
 #include "getset.h"
 #include "directio.h"
 
+#include "../types/inc/GlyphWidth.hpp"
+
 #include "../interactivity/inc/ServiceLocator.hpp"
 
 #pragma hdrstop
@@ -44,6 +46,60 @@ void WriteBuffer::PrintString(const std::wstring_view string)
     _DefaultStringCase(string);
 }
 
+// Routine Description:
+// - Prints a run of the same character, like the REP sequence asks for.
+//      For a narrow character, the cells from the cursor up to the last
+//      column of its row are filled in one go. Only the character that lands
+//      in the last column goes through the regular write path, which takes
+//      care of wrapping it, scrolling the buffer, and the delayed EOL wrap.
+// Arguments:
+// - wch - The character to be printed.
+// - count - How many times to print it.
+// Return Value:
+// - <none>
+void WriteBuffer::PrintRepeated(const wchar_t wch, const size_t count)
+{
+    auto& screenInfo = _io.GetActiveOutputBuffer();
+    auto& cursor = screenInfo.GetTextBuffer().GetCursor();
+
+    if (IsGlyphFullWidth(wch) || (wch >= 0xD800 && wch <= 0xDFFF))
+    {
+        _DefaultStringCase(std::wstring(count, wch));
+        return;
+    }
+
+    const auto bufferWidth = screenInfo.GetBufferSize().Width();
+    const bool wrapAtEOL = WI_IsFlagSet(screenInfo.OutputMode, ENABLE_WRAP_AT_EOL_OUTPUT);
+
+    cursor.SetIsOn(true);
+    _ntstatus = STATUS_SUCCESS;
+
+    size_t remaining = count;
+    while (remaining > 0 && NT_SUCCESS(_ntstatus))
+    {
+        COORD position = cursor.GetPosition();
+        const auto cellsBeforeLast = cursor.IsDelayedEOLWrap() ? 0 : std::max(0, bufferWidth - 1 - position.X);
+        const auto fillLength = std::min(remaining, gsl::narrow_cast<size_t>(cellsBeforeLast));
+        if (fillLength > 0)
+        {
+            screenInfo.Write(OutputCellIterator{ wch, screenInfo.GetAttributes(), fillLength }, position, std::nullopt);
+            screenInfo.NotifyAccessibilityEventing(position.X, position.Y, gsl::narrow_cast<SHORT>(position.X + fillLength - 1), position.Y);
+
+            position.X += gsl::narrow_cast<SHORT>(fillLength);
+            _ntstatus = AdjustCursorPosition(screenInfo, position, false, nullptr);
+            remaining -= fillLength;
+        }
+
+        // Without autowrap, the rest of the run would only overwrite the
+        // last column again and again, so it's enough to print it once.
+        if (remaining > 0)
+        {
+            _DefaultCase(wch);
+            remaining = wrapAtEOL ? remaining - 1 : 0;
+        }
+    }
+}
+
 // Routine Description:
 // - Handles the execute action from the state machine
 // Arguments:
@@ -500,6 +556,20 @@ bool ConhostInternalGetSet::PrivateEnableAlternateScroll(const bool enabled)
     return true;
 }
 
+// Routine Description:
+// - Connects the PrivateEnableSynchronizedOutput call directly into our Driver Message servicing call inside Conhost.exe
+//   PrivateEnableSynchronizedOutput is an internal-only "API" call that the vt commands can execute,
+//     but it is not represented as a function call on our public API surface.
+// Arguments:
+// - enabled - set to true to hold back painting until the application's frame is done, false to paint it
+// Return Value:
+// - true if successful (see DoSrvPrivateEnableSynchronizedOutput). false otherwise.
+bool ConhostInternalGetSet::PrivateEnableSynchronizedOutput(const bool enabled)
+{
+    DoSrvPrivateEnableSynchronizedOutput(_io.GetActiveOutputBuffer(), enabled);
+    return true;
+}
+
 // Routine Description:
 // - Connects the PrivateEraseAll call directly into our Driver Message servicing call inside Conhost.exe
 //   PrivateEraseAll is an internal-only "API" call that the vt commands can execute,
@@ -755,6 +825,64 @@ bool ConhostInternalGetSet::PrivateScrollRegion(const SMALL_RECT scrollRect,
                                               standardFillAttrs));
 }
 
+// Routine Description:
+// - Connects the PrivateCopyRectangularArea call directly into our Driver Message servicing
+//    call inside Conhost.exe
+//   PrivateCopyRectangularArea is an internal-only "API" call that the vt commands can execute,
+//    but it is not represented as a function call on our public API surface.
+// Arguments:
+// - sourceRect - Region to copy, inclusive.
+// - targetOrigin - Upper left corner of the target region.
+// Return value:
+// - true if successful (see DoSrvPrivateCopyRectangularArea). false otherwise.
+bool ConhostInternalGetSet::PrivateCopyRectangularArea(const SMALL_RECT sourceRect,
+                                                       const COORD targetOrigin) noexcept
+{
+    return SUCCEEDED(DoSrvPrivateCopyRectangularArea(_io.GetActiveOutputBuffer(),
+                                                     sourceRect,
+                                                     targetOrigin));
+}
+
+// Routine Description:
+// - Connects the PrivateFillRectangularArea call directly into our Driver Message servicing
+//    call inside Conhost.exe
+//   PrivateFillRectangularArea is an internal-only "API" call that the vt commands can execute,
+//    but it is not represented as a function call on our public API surface.
+// Arguments:
+// - fillRect - Region to fill, inclusive.
+// - fillChar - Character to fill the region with.
+// - fillAttrs - Attributes to fill the region with. If not given, the region
+//               keeps its attributes.
+// Return value:
+// - true if successful (see DoSrvPrivateFillRectangularArea). false otherwise.
+bool ConhostInternalGetSet::PrivateFillRectangularArea(const SMALL_RECT fillRect,
+                                                       const wchar_t fillChar,
+                                                       const std::optional<TextAttribute> fillAttrs) noexcept
+{
+    return SUCCEEDED(DoSrvPrivateFillRectangularArea(_io.GetActiveOutputBuffer(),
+                                                     fillRect,
+                                                     fillChar,
+                                                     fillAttrs));
+}
+
+// Routine Description:
+// - Connects the PrivateChangeAttributesInArea call directly into our Driver Message servicing
+//    call inside Conhost.exe
+//   PrivateChangeAttributesInArea is an internal-only "API" call that the vt commands can execute,
+//    but it is not represented as a function call on our public API surface.
+// Arguments:
+// - changeRect - Region to change, inclusive.
+// - change - Changes the attributes given to it in place.
+// Return value:
+// - true if successful (see DoSrvPrivateChangeAttributesInArea). false otherwise.
+bool ConhostInternalGetSet::PrivateChangeAttributesInArea(const SMALL_RECT changeRect,
+                                                          const std::function<void(TextAttribute&)>& change) noexcept
+{
+    return SUCCEEDED(DoSrvPrivateChangeAttributesInArea(_io.GetActiveOutputBuffer(),
+                                                        changeRect,
+                                                        change));
+}
+
 // Routine Description:
 // - Checks if the InputBuffer is willing to accept VT Input directly
 //   PrivateIsVtInputEnabled is an internal-only "API" call that the vt commands can execute,
@@ -30,6 +30,7 @@ public:
     // Implement Adapter callbacks for default cases (non-escape sequences)
     void Print(const wchar_t wch) override;
     void PrintString(const std::wstring_view string) override;
+    void PrintRepeated(const wchar_t wch, const size_t count) override;
     void Execute(const wchar_t wch) override;
 
     [[nodiscard]] NTSTATUS GetResult() { return _ntstatus; };
@@ -102,6 +103,7 @@ public:
     bool PrivateEnableButtonEventMouseMode(const bool enabled) override;
     bool PrivateEnableAnyEventMouseMode(const bool enabled) override;
     bool PrivateEnableAlternateScroll(const bool enabled) override;
+    bool PrivateEnableSynchronizedOutput(const bool enabled) override;
     bool PrivateEraseAll() override;
 
     bool GetUserDefaultCursorStyle(CursorType& style) override;
@@ -141,6 +143,16 @@ public:
                              const COORD destinationOrigin,
                              const bool standardFillAttrs) noexcept override;
 
+    bool PrivateCopyRectangularArea(const SMALL_RECT sourceRect,
+                                    const COORD targetOrigin) noexcept override;
+
+    bool PrivateFillRectangularArea(const SMALL_RECT fillRect,
+                                    const wchar_t fillChar,
+                                    const std::optional<TextAttribute> fillAttrs) noexcept override;
+
+    bool PrivateChangeAttributesInArea(const SMALL_RECT changeRect,
+                                       const std::function<void(TextAttribute&)>& change) noexcept override;
+
     bool PrivateIsVtInputEnabled() const override;
 
     bool PrivateAddHyperlink(const std::wstring_view uri, const std::wstring_view params) const override;
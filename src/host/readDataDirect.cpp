@@ -132,12 +132,15 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
             return retVal;
         }
 
-        *pReplyStatus = _pInputBuffer->Read(readEvents,
-                                            amountToRead,
+        std::vector<INPUT_RECORD> records(std::min(amountToRead, _pInputBuffer->GetNumberOfReadyEvents()));
+        size_t eventsRead;
+        *pReplyStatus = _pInputBuffer->Read(records,
+                                            eventsRead,
                                             false,
                                             false,
                                             fIsUnicode,
                                             false);
+        readEvents = IInputEvent::Create(gsl::span<const INPUT_RECORD>{ records.data(), eventsRead });
 
         if (*pReplyStatus == CONSOLE_STATUS_WAIT)
         {
@@ -60,6 +60,7 @@ public:
     const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept override;
 
     const std::vector<size_t> GetPatternId(const COORD location) const noexcept override;
+    void GetPatternSpans(const SHORT row, std::vector<Microsoft::Console::Render::PatternSpan>& spans) const override;
 #pragma endregion
 
 #pragma region IUiaData
@@ -455,6 +455,26 @@ void Telemetry::WriteFinalTraceLog()
                                     TelemetryPrivacyDataTag(PDT_ProductAndServiceUsage));
             static_assert(sizeof(UINT32) == sizeof(gci.Get16ColorTable()[0]), "gci.Get16ColorTable()");
 
+            // How quickly the output of the applications showed up on the screen.
+            if (const auto pRender = Microsoft::Console::Interactivity::ServiceLocator::LocateGlobals().pRender)
+            {
+                using namespace std::chrono;
+                const auto frameStatistics = pRender->GetFrameStatistics();
+                // clang-format off
+#pragma prefast(suppress: __WARNING_NONCONST_LOCAL, "Activity can't be const, since it's set to a random value on startup.")
+                // clang-format on
+                TraceLoggingWriteTagged(_activity,
+                                        "FrameStatistics",
+                                        TraceLoggingUInt64(frameStatistics.frames, "Frames"),
+                                        TraceLoggingUInt64(frameStatistics.coalescedRequests, "CoalescedRequests"),
+                                        TraceLoggingInt64(duration_cast<microseconds>(frameStatistics.averagePaintTime).count(), "AveragePaintTimeMicroseconds"),
+                                        TraceLoggingInt64(duration_cast<microseconds>(frameStatistics.maxPaintTime).count(), "MaxPaintTimeMicroseconds"),
+                                        TraceLoggingInt64(duration_cast<microseconds>(frameStatistics.maxLatency).count(), "MaxLatencyMicroseconds"),
+                                        TraceLoggingUInt64Array(frameStatistics.latencyHistogram.data(), static_cast<UINT16>(frameStatistics.latencyHistogram.size()), "LatencyHistogram"),
+                                        TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
+                                        TelemetryPrivacyDataTag(PDT_ProductAndServiceUsage));
+            }
+
             // I could use the TraceLoggingUIntArray, but then we would have to know the order of the enums on the backend.
             // So just log each enum count separately with its string representation which makes it more human readable.
             // clang-format off
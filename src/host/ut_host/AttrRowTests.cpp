@@ -103,12 +103,12 @@ class AttrRowTests
 
         // Create the chain
         pChain = new ATTR_ROW(_sDefaultLength, _DefaultAttr);
-        pChain->_list.resize(sChainSegmentsNeeded);
+        std::vector<TextAttributeRun> chain(sChainSegmentsNeeded);
 
         // Attach all chain segments that are even multiples of the row length
         for (short iChain = 0; iChain < _sDefaultChainLength; iChain++)
         {
-            TextAttributeRun* pRun = &pChain->_list[iChain];
+            TextAttributeRun* pRun = &chain[iChain];
 
             pRun->SetAttributes(TextAttribute{ gsl::narrow_cast<WORD>(iChain) }); // Just use the chain position as the value
             pRun->SetLength(sChainSegLength);
@@ -118,12 +118,14 @@ class AttrRowTests
         {
             // If we had a leftover, then this chain is one longer than we expected (the default length)
             // So use it as the index (because indices start at 0)
-            TextAttributeRun* pRun = &pChain->_list[_sDefaultChainLength];
+            TextAttributeRun* pRun = &chain[_sDefaultChainLength];
 
             pRun->SetAttributes(_DefaultChainAttr);
             pRun->SetLength(sChainLeftover);
         }
 
+        SetRuns(*pChain, chain);
+
         return true;
     }
 
@@ -136,6 +138,32 @@ class AttrRowTests
         return true;
     }
 
+    // Routine Description:
+    // - Replaces all runs of the row with the given ones and makes the row as wide as they are.
+    static void SetRuns(ATTR_ROW& row, const std::vector<TextAttributeRun>& runs)
+    {
+        size_t width = 0;
+        for (const auto& run : runs)
+        {
+            width += run.GetLength();
+        }
+
+        row._cchRowWidth = width;
+        VERIFY_SUCCEEDED(row.InsertAttrRuns(runs, 0, width - 1, width));
+    }
+
+    // Routine Description:
+    // - Unpacks the runs the row stores internally for inspection.
+    static std::vector<TextAttributeRun> GetRuns(const ATTR_ROW& row)
+    {
+        std::vector<TextAttributeRun> runs;
+        for (const auto& run : row._list)
+        {
+            runs.emplace_back(run.length, row._attrs.at(run.attrIndex));
+        }
+        return runs;
+    }
+
     TEST_METHOD(TestInitialize)
     {
         // Properties needed for test
@@ -151,9 +179,11 @@ class AttrRowTests
 
             pUnderTest->Reset(attr);
 
-            VERIFY_ARE_EQUAL(pUnderTest->_list.size(), 1u);
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetAttributes(), attr);
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetLength(), (unsigned int)_sDefaultLength);
+            const auto runs = GetRuns(*pUnderTest);
+            VERIFY_ARE_EQUAL(runs.size(), 1u);
+            VERIFY_ARE_EQUAL(runs[0].GetAttributes(), attr);
+            VERIFY_ARE_EQUAL(runs[0].GetLength(), (unsigned int)_sDefaultLength);
+            VERIFY_ARE_EQUAL(pUnderTest->_attrs.size(), 1u);
         }
     }
 
@@ -230,31 +260,13 @@ class AttrRowTests
         return HRESULT_FROM_NT(status);
     }
 
-    NoThrowString LogRunElement(_In_ TextAttributeRun& run)
+    NoThrowString LogRunElement(const TextAttributeRun& run)
     {
         return NoThrowString().Format(L"%wc%d", run.GetAttributes().GetLegacyAttributes(), run.GetLength());
     }
 
     void LogChain(_In_ PCWSTR pwszPrefix,
-                  boost::container::small_vector_base<TextAttributeRun>& chain)
-    {
-        NoThrowString str(pwszPrefix);
-
-        if (chain.size() > 0)
-        {
-            str.Append(LogRunElement(chain[0]));
-
-            for (size_t i = 1; i < chain.size(); i++)
-            {
-                str.AppendFormat(L"->%s", (const wchar_t*)(LogRunElement(chain[i])));
-            }
-        }
-
-        Log::Comment(str);
-    }
-
-    void LogChain(_In_ PCWSTR pwszPrefix,
-                  std::vector<TextAttributeRun>& chain)
+                  const std::vector<TextAttributeRun>& chain)
     {
         NoThrowString str(pwszPrefix);
 
@@ -285,15 +297,8 @@ class AttrRowTests
         // Set up our "original row" that we are going to try to insert into.
         // This will represent a 10 column run of R3->B5->G2 that we will use for all tests.
         ATTR_ROW originalRow{ static_cast<UINT>(_sDefaultLength), _DefaultAttr };
-        originalRow._list.resize(3);
-        originalRow._cchRowWidth = 10;
-        originalRow._list[0].SetAttributes(TextAttribute{ 'R' });
-        originalRow._list[0].SetLength(3);
-        originalRow._list[1].SetAttributes(TextAttribute{ 'B' });
-        originalRow._list[1].SetLength(5);
-        originalRow._list[2].SetAttributes(TextAttribute{ 'G' });
-        originalRow._list[2].SetLength(2);
-        LogChain(L"Original: ", originalRow._list);
+        SetRuns(originalRow, { { 3, TextAttribute{ 'R' } }, { 5, TextAttribute{ 'B' } }, { 2, TextAttribute{ 'G' } } });
+        LogChain(L"Original: ", GetRuns(originalRow));
 
         // Set up our "insertion run"
         size_t cInsertRow = 1;
@@ -365,17 +370,27 @@ class AttrRowTests
         VERIFY_SUCCEEDED(originalRow.InsertAttrRuns({ insertRow.data(), insertRow.size() }, uiStartPos, uiEndPos, (UINT)originalRow._cchRowWidth));
 
         // Compare and ensure that the expected and actual match.
-        VERIFY_ARE_EQUAL(cPackedRun, originalRow._list.size(), L"Ensure that number of array elements required for RLE are the same.");
+        const auto actualRuns = GetRuns(originalRow);
+        VERIFY_ARE_EQUAL(cPackedRun, actualRuns.size(), L"Ensure that number of array elements required for RLE are the same.");
 
         std::vector<TextAttributeRun> packedRunExpected;
         std::copy_n(packedRun.get(), cPackedRun, std::back_inserter(packedRunExpected));
 
         LogChain(L"Expected: ", packedRunExpected);
-        LogChain(L"Actual: ", originalRow._list);
+        LogChain(L"Actual: ", actualRuns);
 
         for (size_t testIndex = 0; testIndex < cPackedRun; testIndex++)
         {
-            VERIFY_ARE_EQUAL(packedRun[testIndex], originalRow._list[testIndex]);
+            VERIFY_ARE_EQUAL(packedRun[testIndex], actualRuns[testIndex]);
+        }
+
+        // No attribute should be kept around more than once.
+        for (size_t i = 0; i < originalRow._attrs.size(); i++)
+        {
+            for (size_t j = i + 1; j < originalRow._attrs.size(); j++)
+            {
+                VERIFY_ARE_NOT_EQUAL(originalRow._attrs[i], originalRow._attrs[j]);
+            }
         }
     }
 
@@ -559,29 +574,19 @@ class AttrRowTests
             // Create attr row representing a buffer that's 121 wide.
             auto chain = std::make_unique<ATTR_ROW>(121, _DefaultAttr);
 
-            // The repro case had 4 chain segments.
-            chain->_list.resize(4);
-
+            // The repro case had 4 chain segments:
             // The color 10 went for the first 18.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(18);
-
             // Default color for the next 1
-            chain->_list[1].SetAttributes(TextAttribute());
-            chain->_list[1].SetLength(1);
-
             // Color 12 for the next 29
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(29);
-
             // Then default color to end the run
-            chain->_list[3].SetAttributes(TextAttribute());
-            chain->_list[3].SetLength(73);
+            SetRuns(*chain, { { 18, TextAttribute(0xA) }, { 1, TextAttribute() }, { 29, TextAttribute(0xC) }, { 73, TextAttribute() } });
+            const auto runs = GetRuns(*chain);
 
             // The sum of the lengths should be 121.
-            VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength + chain->_list[3]._cchLength);
+            VERIFY_ARE_EQUAL(121u, chain->_cchRowWidth);
+            VERIFY_ARE_EQUAL(chain->_cchRowWidth, runs[0].GetLength() + runs[1].GetLength() + runs[2].GetLength() + runs[3].GetLength());
 
-            auto index = chain->_list[0].GetLength();
+            auto index = runs[0].GetLength();
             auto stepSize = 1;
             testWalk(chain.get(), index, stepSize);
         }
@@ -591,23 +596,15 @@ class AttrRowTests
             // Create attr row representing a buffer that's 3 wide.
             auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr);
 
-            // The repro case had 3 chain segments.
-            chain->_list.resize(3);
-
+            // The repro case had 3 chain segments:
             // The color 10 went for the first 1.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(1);
-
             // The color 11 for the next 1
-            chain->_list[1].SetAttributes(TextAttribute(0xB));
-            chain->_list[1].SetLength(1);
-
             // Color 12 for the next 1
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(1);
+            SetRuns(*chain, { { 1, TextAttribute(0xA) }, { 1, TextAttribute(0xB) }, { 1, TextAttribute(0xC) } });
+            const auto runs = GetRuns(*chain);
 
             // The sum of the lengths should be 3.
-            VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength);
+            VERIFY_ARE_EQUAL(chain->_cchRowWidth, runs[0].GetLength() + runs[1].GetLength() + runs[2].GetLength());
 
             // on 'ABC', step from B to A
             auto index = 1;
@@ -620,23 +617,15 @@ class AttrRowTests
             // Create attr row representing a buffer that's 3 wide.
             auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr);
 
-            // The repro case had 3 chain segments.
-            chain->_list.resize(3);
-
+            // The repro case had 3 chain segments:
             // The color 10 went for the first 1.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(1);
-
             // The color 11 for the next 1
-            chain->_list[1].SetAttributes(TextAttribute(0xB));
-            chain->_list[1].SetLength(1);
-
             // Color 12 for the next 1
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(1);
+            SetRuns(*chain, { { 1, TextAttribute(0xA) }, { 1, TextAttribute(0xB) }, { 1, TextAttribute(0xC) } });
+            const auto runs = GetRuns(*chain);
 
             // The sum of the lengths should be 3.
-            VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength);
+            VERIFY_ARE_EQUAL(chain->_cchRowWidth, runs[0].GetLength() + runs[1].GetLength() + runs[2].GetLength());
 
             // on 'ABC', step from C to A
             auto index = 2;
@@ -658,35 +647,37 @@ class AttrRowTests
         pSingle->SetAttrToEnd(iTestIndex, TestAttr);
 
         // Was 1 (single), should now have 2 segments
-        VERIFY_ARE_EQUAL(pSingle->_list.size(), 2u);
+        const auto singleRuns = GetRuns(*pSingle);
+        VERIFY_ARE_EQUAL(singleRuns.size(), 2u);
 
-        VERIFY_ARE_EQUAL(pSingle->_list[0].GetAttributes(), _DefaultAttr);
-        VERIFY_ARE_EQUAL(pSingle->_list[0].GetLength(), (unsigned int)(_sDefaultLength - (_sDefaultLength - iTestIndex)));
+        VERIFY_ARE_EQUAL(singleRuns[0].GetAttributes(), _DefaultAttr);
+        VERIFY_ARE_EQUAL(singleRuns[0].GetLength(), (unsigned int)(_sDefaultLength - (_sDefaultLength - iTestIndex)));
 
-        VERIFY_ARE_EQUAL(pSingle->_list[1].GetAttributes(), TestAttr);
-        VERIFY_ARE_EQUAL(pSingle->_list[1].GetLength(), (unsigned int)(_sDefaultLength - iTestIndex));
+        VERIFY_ARE_EQUAL(singleRuns[1].GetAttributes(), TestAttr);
+        VERIFY_ARE_EQUAL(singleRuns[1].GetLength(), (unsigned int)(_sDefaultLength - iTestIndex));
 
         Log::Comment(L"SetAttrToEnd for existing chain of multiple colors.");
         pChain->SetAttrToEnd(iTestIndex, TestAttr);
 
         // From 7 segments down to 5.
-        VERIFY_ARE_EQUAL(pChain->_list.size(), 5u);
+        const auto chainRuns = GetRuns(*pChain);
+        VERIFY_ARE_EQUAL(chainRuns.size(), 5u);
 
         // Verify chain colors and lengths
-        VERIFY_ARE_EQUAL(TextAttribute(0), pChain->_list[0].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[0].GetLength(), (unsigned int)13);
+        VERIFY_ARE_EQUAL(TextAttribute(0), chainRuns[0].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[0].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(1), pChain->_list[1].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[1].GetLength(), (unsigned int)13);
+        VERIFY_ARE_EQUAL(TextAttribute(1), chainRuns[1].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[1].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(2), pChain->_list[2].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[2].GetLength(), (unsigned int)13);
+        VERIFY_ARE_EQUAL(TextAttribute(2), chainRuns[2].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[2].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(3), pChain->_list[3].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[3].GetLength(), (unsigned int)11);
+        VERIFY_ARE_EQUAL(TextAttribute(3), chainRuns[3].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[3].GetLength(), (unsigned int)11);
 
-        VERIFY_ARE_EQUAL(TestAttr, pChain->_list[4].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[4].GetLength(), (unsigned int)30);
+        VERIFY_ARE_EQUAL(TestAttr, chainRuns[4].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[4].GetLength(), (unsigned int)30);
 
         Log::Comment(L"SECOND: Set index to 0 to test replacing anything with a single");
 
@@ -699,14 +690,48 @@ class AttrRowTests
             pUnderTest->SetAttrToEnd(0, TestAttr);
 
             // should be down to 1 attribute set from beginning to end of string
-            VERIFY_ARE_EQUAL(pUnderTest->_list.size(), 1u);
+            const auto runs = GetRuns(*pUnderTest);
+            VERIFY_ARE_EQUAL(runs.size(), 1u);
 
             // singular pair should contain the color
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetAttributes(), TestAttr);
+            VERIFY_ARE_EQUAL(runs[0].GetAttributes(), TestAttr);
 
             // and its length should be the length of the whole string
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetLength(), (unsigned int)_sDefaultLength);
+            VERIFY_ARE_EQUAL(runs[0].GetLength(), (unsigned int)_sDefaultLength);
+        }
+    }
+
+    TEST_METHOD(TestAttributesAreShared)
+    {
+        const TextAttribute red{ FOREGROUND_RED };
+        const TextAttribute blue{ FOREGROUND_BLUE };
+
+        Log::Comment(L"Runs with the same attribute share one copy of it.");
+        SetRuns(*pSingle, { { 20, red }, { 20, blue }, { 20, red }, { 20, blue } });
+        VERIFY_ARE_EQUAL(4u, pSingle->GetNumberOfRuns());
+        VERIFY_ARE_EQUAL(2u, pSingle->_attrs.size());
+        VERIFY_ARE_EQUAL(red, pSingle->GetAttrByColumn(40));
+        VERIFY_ARE_EQUAL(blue, pSingle->GetAttrByColumn(79));
+
+        Log::Comment(L"Replacing an attribute with one that's already used keeps a single copy.");
+        pSingle->ReplaceAttrs(red, blue);
+        VERIFY_ARE_EQUAL(blue, pSingle->GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(blue, pSingle->GetAttrByColumn(40));
+        VERIFY_ARE_EQUAL(blue, pSingle->_attrs.at(pSingle->_list.at(0).attrIndex));
+        VERIFY_ARE_EQUAL(pSingle->_list.at(0).attrIndex, pSingle->_list.at(1).attrIndex);
+
+        Log::Comment(L"Recoloring a single cell over and over doesn't accumulate attributes.");
+        SetRuns(*pSingle, { { 40, red }, { 1, blue }, { 39, red } });
+        for (WORD i = 0; i < 1000; i++)
+        {
+            const TextAttribute attr{ gsl::narrow_cast<WORD>(i % 0xFF) };
+            const TextAttributeRun run{ 1, attr };
+            VERIFY_SUCCEEDED(pSingle->InsertAttrRuns({ &run, 1 }, 40, 40, 80));
+            VERIFY_ARE_EQUAL(attr, pSingle->GetAttrByColumn(40));
+            VERIFY_IS_LESS_THAN_OR_EQUAL(pSingle->_attrs.size(), 2 * pSingle->_list.size());
         }
+        VERIFY_ARE_EQUAL(red, pSingle->GetAttrByColumn(39));
+        VERIFY_ARE_EQUAL(red, pSingle->GetAttrByColumn(41));
     }
 
     TEST_METHOD(TestTotalLength)
@@ -9,6 +9,7 @@
 #include "../types/inc/CodepointWidthDetector.hpp"
 
 using namespace WEX::Logging;
+using namespace WEX::Common;
 
 static constexpr std::wstring_view emoji = L"\xD83E\xDD22"; // U+1F922 nauseated face
 
@@ -62,6 +63,51 @@ class CodepointWidthDetectorTests
         }
     }
 
+    static std::wstring EncodeCodepoint(const unsigned int codepoint)
+    {
+        if (codepoint < 0x10000)
+        {
+            return { static_cast<wchar_t>(codepoint) };
+        }
+        const auto bits = codepoint - 0x10000;
+        return { static_cast<wchar_t>(0xD800 + (bits >> 10)), static_cast<wchar_t>(0xDC00 + (bits & 0x3FF)) };
+    }
+
+    TEST_METHOD(LookupMatchesRanges)
+    {
+        // This test spews out a lot of verify logging by default because of
+        // the loop, so suppress that to only show the failures.
+        WEX::TestExecution::SetVerifyOutput settings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+
+        CodepointWidthDetector widthDetector;
+        for (unsigned int codepoint = 0; codepoint < 0x110000; ++codepoint)
+        {
+            const auto glyph = EncodeCodepoint(codepoint);
+            VERIFY_ARE_EQUAL(CodepointWidthDetector::_lookupCodepointWidthInRanges(codepoint), widthDetector._lookupGlyphWidth(glyph));
+        }
+    }
+
+    TEST_METHOD(CanMeasureColumns)
+    {
+        CodepointWidthDetector widthDetector;
+        VERIFY_ARE_EQUAL(0u, widthDetector.MeasureColumns(L""));
+        VERIFY_ARE_EQUAL(5u, widthDetector.MeasureColumns(L"hello"));
+        VERIFY_ARE_EQUAL(13u, widthDetector.MeasureColumns(L"\tplain ASCII\r"));
+
+        // Put the wide glyphs at every position of a block of 8 code units,
+        // so they're found both by the vectorized and the scalar scan.
+        for (size_t prefix = 0; prefix < 17; ++prefix)
+        {
+            std::wstring text(prefix, L'a');
+            text.append(L"\x306A");
+            text.append(emoji);
+            text.append(prefix, L'b');
+            text.append(ambiguous);
+            text.append(L"\xD83D"); // lone leading surrogate
+            VERIFY_ARE_EQUAL(2 * prefix + 6, widthDetector.MeasureColumns(text));
+        }
+    }
+
     static bool FallbackMethod(const std::wstring_view glyph)
     {
         if (glyph.size() < 1)
@@ -91,7 +137,7 @@ class CodepointWidthDetectorTests
 
         // Cached item should match what we expect
         const auto it = widthDetector._fallbackCache.begin();
-        VERIFY_ARE_EQUAL(ambiguous, it->first);
+        VERIFY_ARE_EQUAL(0x414u, it->first);
         VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), it->second);
 
         // Cache should empty when font changes.
@@ -78,7 +78,8 @@ class ConptyOutputTests
         VERIFY_SUCCEEDED(currentBuffer.SetViewportOrigin(true, { 0, 0 }, true));
         VERIFY_ARE_EQUAL(COORD({ 0, 0 }), currentBuffer.GetTextBuffer().GetCursor().GetPosition());
 
-        g.pRender = new Renderer(&gci.renderData, nullptr, 0, nullptr);
+        // The renderer tells the time from _now, so tests can move it along.
+        g.pRender = new Renderer(&gci.renderData, nullptr, 0, nullptr, [this]() { return _now; });
 
         // Set up an xterm-256 renderer for conpty
         wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
@@ -119,11 +120,27 @@ class ConptyOutputTests
     TEST_METHOD(WriteTwoLinesUsesNewline);
     TEST_METHOD(WriteAFewSimpleLines);
     TEST_METHOD(InvalidateUntilOneBeforeEnd);
+    TEST_METHOD(SynchronizedOutputHoldsBackFrames);
+    TEST_METHOD(SynchronizedOutputTimesOut);
+    TEST_METHOD(PassthroughLineFeedsAndSurrogates);
+    TEST_METHOD(PassthroughPaintsCopyRectangularArea);
+    TEST_METHOD(PassthroughPaintsFillRectangularArea);
+    TEST_METHOD(PassthroughPaintsEraseRectangularArea);
+    TEST_METHOD(PassthroughPaintsSelectiveEraseRectangularArea);
+    TEST_METHOD(PassthroughPaintsChangeAttributesRectangularArea);
+    TEST_METHOD(PassthroughPaintsReverseAttributesRectangularArea);
+    TEST_METHOD(PassthroughAppliesSelectAttributeChangeExtent);
 
 private:
     bool _writeCallback(const char* const pch, size_t const cch);
     void _flushFirstFrame();
+    std::string _capturePassthrough(const std::wstring_view string);
+    void _writeRectangleTestContent();
+    void _verifyRowText(const COORD at, const std::wstring_view expected);
     std::deque<std::string> expectedOutput;
+    bool captureOutput = false;
+    std::string capturedOutput;
+    std::chrono::steady_clock::time_point _now;
     std::unique_ptr<CommonState> m_state;
 };
 
@@ -133,6 +150,12 @@ bool ConptyOutputTests::_writeCallback(const char* const pch, size_t const cch)
     // we need to rely on VERIFY's return codes instead of exceptions.
     const WEX::TestExecution::DisableVerifyExceptions disableExceptionsScope;
 
+    if (captureOutput)
+    {
+        capturedOutput.append(pch, cch);
+        return true;
+    }
+
     std::string actualString = std::string(pch, cch);
     RETURN_BOOL_IF_FALSE(VERIFY_IS_GREATER_THAN(expectedOutput.size(),
                                                 static_cast<size_t>(0),
@@ -163,6 +186,50 @@ void ConptyOutputTests::_flushFirstFrame()
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 }
 
+// Function Description:
+// - Writes the given string in passthrough mode, collecting everything the VT
+//   engine writes in the meantime instead of checking it against expectedOutput.
+// Arguments:
+// - string: The string to write
+// Return Value:
+// - Everything that was written to the terminal.
+std::string ConptyOutputTests::_capturePassthrough(const std::wstring_view string)
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    capturedOutput.clear();
+    captureOutput = true;
+    auto stopCapture = wil::scope_exit([&]() { captureOutput = false; });
+
+    gci.GetVtIo()->WritePassthrough(gci.GetActiveOutputBuffer(), string);
+    return capturedOutput;
+}
+
+// Function Description:
+// - Paints the first frame and writes the two rows the rectangular area tests
+//   operate on:
+//      ABC
+//      DEF
+void ConptyOutputTests::_writeRectangleTestContent()
+{
+    _flushFirstFrame();
+    _capturePassthrough(L"ABC\r\nDEF");
+}
+
+// Function Description:
+// - Validates that the buffer contains the given text, starting at the given
+//   position.
+void ConptyOutputTests::_verifyRowText(const COORD at, const std::wstring_view expected)
+{
+    const auto& tb = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer().GetTextBuffer();
+    auto iter = tb.GetTextDataAt(at);
+    for (const auto wch : expected)
+    {
+        VERIFY_ARE_EQUAL(std::wstring_view{ &wch, 1 }, *iter);
+        iter++;
+    }
+}
+
 // Function Description:
 // - Helper function to validate that a number of characters in a row are all
 //   the same. Validates that the next end-start characters are all equal to the
@@ -364,3 +431,235 @@ void ConptyOutputTests::InvalidateUntilOneBeforeEnd()
 
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 }
+
+void ConptyOutputTests::SynchronizedOutputHoldsBackFrames()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Output written while synchronized output is enabled is only painted "
+        L"once it's disabled again, and then in a single frame"));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    _flushFirstFrame();
+
+    sm.ProcessString(L"\x1b[?2026h");
+    sm.ProcessString(L"Hello");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+    sm.ProcessString(L" World");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    expectedOutput.push_back("Hello World");
+    sm.ProcessString(L"\x1b[?2026l");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+}
+
+void ConptyOutputTests::SynchronizedOutputTimesOut()
+{
+    Log::Comment(NoThrowString().Format(
+        L"An application that doesn't disable synchronized output within "
+        L"150ms gets its output painted anyway"));
+
+    using namespace std::chrono_literals;
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    _flushFirstFrame();
+
+    sm.ProcessString(L"\x1b[?2026h");
+    sm.ProcessString(L"Hello");
+    _now += 149ms;
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(NoThrowString().Format(
+        L"Enabling the mode again doesn't extend the deadline"));
+    sm.ProcessString(L"\x1b[?2026h");
+    _now += 1ms;
+    expectedOutput.push_back("Hello");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(NoThrowString().Format(
+        L"Once timed out, output is painted as usual"));
+    sm.ProcessString(L" World");
+    expectedOutput.push_back(" World");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    sm.ProcessString(L"\x1b[?2026l");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+}
+
+void ConptyOutputTests::PassthroughLineFeedsAndSurrogates()
+{
+    Log::Comment(NoThrowString().Format(
+        L"In passthrough mode, a line feed that also returned the cursor in the "
+        L"buffer has to return it in the terminal too, which treats it as a "
+        L"plain line feed"));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& tb = si.GetTextBuffer();
+    VtIo* const vtIo = gci.GetVtIo();
+
+    _flushFirstFrame();
+
+    const bool autoReturn = gci.IsReturnOnNewlineAutomatic();
+    auto restoreAutoReturn = wil::scope_exit([&]() { gci.SetAutomaticReturnOnNewline(autoReturn); });
+
+    gci.SetAutomaticReturnOnNewline(true);
+    expectedOutput.push_back("AAA");
+    expectedOutput.push_back("\r\n");
+    expectedOutput.push_back("BBB");
+    vtIo->WritePassthrough(si, L"AAA\nBBB");
+    VERIFY_ARE_EQUAL(COORD({ 3, 1 }), tb.GetCursor().GetPosition());
+
+    Log::Comment(NoThrowString().Format(
+        L"With DISABLE_NEWLINE_AUTO_RETURN, the line feed is forwarded as-is"));
+    gci.SetAutomaticReturnOnNewline(false);
+    expectedOutput.push_back("\n");
+    expectedOutput.push_back("CCC");
+    vtIo->WritePassthrough(si, L"\nCCC");
+    VERIFY_ARE_EQUAL(COORD({ 6, 2 }), tb.GetCursor().GetPosition());
+
+    Log::Comment(NoThrowString().Format(
+        L"A surrogate pair split across two writes reaches the terminal as one "
+        L"character, instead of two replacement characters"));
+    vtIo->WritePassthrough(si, L"\xD83D");
+    VERIFY_ARE_EQUAL(0u, expectedOutput.size());
+    expectedOutput.push_back("\xF0\x9F\x98\x80");
+    vtIo->WritePassthrough(si, L"\xDE00");
+}
+
+void ConptyOutputTests::PassthroughPaintsCopyRectangularArea()
+{
+    Log::Comment(NoThrowString().Format(
+        L"DECCRA isn't forwarded in passthrough mode. The copy is executed on "
+        L"the buffer and the destination is painted from there"));
+
+    _writeRectangleTestContent();
+
+    const auto output = _capturePassthrough(L"\x1b[1;1;2;3;1;1;5;1$v");
+    VERIFY_ARE_EQUAL(std::string::npos, output.find("$v"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("ABC"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("DEF"));
+
+    _verifyRowText({ 0, 0 }, L"ABC ABC");
+    _verifyRowText({ 0, 1 }, L"DEF DEF");
+}
+
+void ConptyOutputTests::PassthroughPaintsFillRectangularArea()
+{
+    Log::Comment(NoThrowString().Format(
+        L"DECFRA isn't forwarded in passthrough mode. The fill is executed on "
+        L"the buffer and the area is painted from there"));
+
+    _writeRectangleTestContent();
+
+    const auto output = _capturePassthrough(L"\x1b[88;1;2;2;3$x");
+    VERIFY_ARE_EQUAL(std::string::npos, output.find("$x"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("XX"));
+
+    _verifyRowText({ 0, 0 }, L"AXX");
+    _verifyRowText({ 0, 1 }, L"DXX");
+}
+
+void ConptyOutputTests::PassthroughPaintsEraseRectangularArea()
+{
+    Log::Comment(NoThrowString().Format(
+        L"DECERA isn't forwarded in passthrough mode. The erase is executed on "
+        L"the buffer and the area is painted from there"));
+
+    _writeRectangleTestContent();
+
+    const auto output = _capturePassthrough(L"\x1b[1;2;2;3$z");
+    VERIFY_ARE_EQUAL(std::string::npos, output.find("$z"));
+    VERIFY_IS_FALSE(output.empty());
+
+    _verifyRowText({ 0, 0 }, L"A  ");
+    _verifyRowText({ 0, 1 }, L"D  ");
+}
+
+void ConptyOutputTests::PassthroughPaintsSelectiveEraseRectangularArea()
+{
+    Log::Comment(NoThrowString().Format(
+        L"DECSERA isn't forwarded in passthrough mode. The erase is executed "
+        L"on the buffer and the area is painted from there"));
+
+    _writeRectangleTestContent();
+
+    const auto output = _capturePassthrough(L"\x1b[1;1;1;2${");
+    VERIFY_ARE_EQUAL(std::string::npos, output.find("${"));
+    VERIFY_IS_FALSE(output.empty());
+
+    _verifyRowText({ 0, 0 }, L"  C");
+    _verifyRowText({ 0, 1 }, L"DEF");
+}
+
+void ConptyOutputTests::PassthroughPaintsChangeAttributesRectangularArea()
+{
+    Log::Comment(NoThrowString().Format(
+        L"DECCARA isn't forwarded in passthrough mode. The attributes are "
+        L"changed in the buffer and the area is painted from there"));
+
+    auto& tb = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer().GetTextBuffer();
+
+    _writeRectangleTestContent();
+
+    const auto output = _capturePassthrough(L"\x1b[1;1;1;2;1$r");
+    VERIFY_ARE_EQUAL(std::string::npos, output.find("$r"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("AB"));
+
+    VERIFY_IS_TRUE(tb.GetCellDataAt({ 0, 0 })->TextAttr().IsBold());
+    VERIFY_IS_TRUE(tb.GetCellDataAt({ 1, 0 })->TextAttr().IsBold());
+    VERIFY_IS_FALSE(tb.GetCellDataAt({ 2, 0 })->TextAttr().IsBold());
+}
+
+void ConptyOutputTests::PassthroughPaintsReverseAttributesRectangularArea()
+{
+    Log::Comment(NoThrowString().Format(
+        L"DECRARA isn't forwarded in passthrough mode. The attributes are "
+        L"reversed in the buffer and the area is painted from there"));
+
+    auto& tb = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer().GetTextBuffer();
+
+    _writeRectangleTestContent();
+
+    const auto output = _capturePassthrough(L"\x1b[1;1;1;2;7$t");
+    VERIFY_ARE_EQUAL(std::string::npos, output.find("$t"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("AB"));
+
+    VERIFY_IS_TRUE(tb.GetCellDataAt({ 0, 0 })->TextAttr().IsReverseVideo());
+    VERIFY_IS_TRUE(tb.GetCellDataAt({ 1, 0 })->TextAttr().IsReverseVideo());
+    VERIFY_IS_FALSE(tb.GetCellDataAt({ 2, 0 })->TextAttr().IsReverseVideo());
+}
+
+void ConptyOutputTests::PassthroughAppliesSelectAttributeChangeExtent()
+{
+    Log::Comment(NoThrowString().Format(
+        L"DECSACE isn't forwarded in passthrough mode, since the terminal "
+        L"doesn't execute the DECCARA it applies to"));
+
+    auto& tb = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer().GetTextBuffer();
+
+    _writeRectangleTestContent();
+    auto resetExtent = wil::scope_exit([&]() { _capturePassthrough(L"\x1b[*x"); });
+
+    const auto output = _capturePassthrough(L"\x1b[2*x");
+    VERIFY_ARE_EQUAL(std::string::npos, output.find("*x"));
+
+    Log::Comment(NoThrowString().Format(
+        L"With the rectangle extent, DECCARA leaves the start of the second "
+        L"row alone, which the stream extent would have changed"));
+    _capturePassthrough(L"\x1b[1;2;2;3;4$r");
+    VERIFY_IS_FALSE(tb.GetCellDataAt({ 0, 1 })->TextAttr().IsUnderlined());
+    VERIFY_IS_TRUE(tb.GetCellDataAt({ 1, 1 })->TextAttr().IsUnderlined());
+    VERIFY_IS_TRUE(tb.GetCellDataAt({ 2, 1 })->TextAttr().IsUnderlined());
+    VERIFY_IS_FALSE(tb.GetCellDataAt({ 3, 0 })->TextAttr().IsUnderlined());
+}
@@ -0,0 +1,160 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+#include <numeric>
+
+#include "../../renderer/base/FramePacer.hpp"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace std::chrono_literals;
+
+using Microsoft::Console::Render::FramePacer;
+
+class FramePacerTests
+{
+    TEST_CLASS(FramePacerTests);
+
+    std::chrono::steady_clock::time_point _now;
+
+    FramePacer _CreatePacer()
+    {
+        return FramePacer{ [this]() { return _now; } };
+    }
+
+    // Paints a frame that takes the given time, and repaints the given
+    // fraction of the viewport.
+    void _PaintFrame(FramePacer& pacer, const std::chrono::nanoseconds paintTime, const double dirtyFraction)
+    {
+        pacer.FrameStarted();
+        _now += paintTime;
+        pacer.FrameCompleted(dirtyFraction);
+    }
+
+    TEST_METHOD(PaintsImmediatelyAfterIdle)
+    {
+        auto pacer = _CreatePacer();
+
+        Log::Comment(L"The first frame is painted right away.");
+        VERIFY_IS_TRUE(pacer.NextFrameDelay() == 0ns);
+
+        _PaintFrame(pacer, 1ms, 1.0);
+
+        Log::Comment(L"Once the console was idle for long enough, so is the next one.");
+        _now += FramePacer::MaxFrameInterval;
+        VERIFY_IS_TRUE(pacer.NextFrameDelay() == 0ns);
+    }
+
+    TEST_METHOD(WaitsBetweenSmallFrames)
+    {
+        auto pacer = _CreatePacer();
+
+        _PaintFrame(pacer, 1ms, 0.0);
+        _now += 2ms;
+
+        Log::Comment(L"Frames that repaint nothing are painted every MinFrameInterval.");
+        VERIFY_IS_TRUE(pacer.NextFrameDelay() == FramePacer::MinFrameInterval - 3ms);
+    }
+
+    TEST_METHOD(CoalescesLargeFrames)
+    {
+        auto pacer = _CreatePacer();
+
+        Log::Comment(L"A frame that repainted all of the viewport waits for MaxFrameInterval.");
+        _PaintFrame(pacer, 1ms, 1.0);
+        VERIFY_IS_TRUE(pacer.NextFrameDelay() == FramePacer::MaxFrameInterval - 1ms);
+
+        Log::Comment(L"A frame that repainted half of it waits for half as much longer.");
+        _now += FramePacer::MaxFrameInterval;
+        _PaintFrame(pacer, 1ms, 0.5);
+        VERIFY_IS_TRUE(pacer.NextFrameDelay() == (FramePacer::MinFrameInterval + FramePacer::MaxFrameInterval) / 2 - 1ms);
+    }
+
+    TEST_METHOD(CoalescesExpensiveFrames)
+    {
+        auto pacer = _CreatePacer();
+
+        Log::Comment(L"A frame that took long to paint waits for twice as long as it took.");
+        _PaintFrame(pacer, 12ms, 0.0);
+        VERIFY_IS_TRUE(pacer.NextFrameDelay() == 12ms);
+
+        Log::Comment(L"But never for longer than MaxFrameInterval.");
+        _now += 12ms;
+        _PaintFrame(pacer, 100ms, 0.0);
+        _now += 100ms;
+        _PaintFrame(pacer, 1ms, 0.0);
+        VERIFY_IS_TRUE(pacer.GetStatistics().averagePaintTime * 2 > FramePacer::MaxFrameInterval);
+        VERIFY_IS_TRUE(pacer.NextFrameDelay() == FramePacer::MaxFrameInterval - 1ms);
+    }
+
+    TEST_METHOD(Statistics)
+    {
+        auto pacer = _CreatePacer();
+
+        pacer.FrameRequested();
+        _now += 5ms;
+        pacer.RequestCoalesced();
+        _PaintFrame(pacer, 1ms, 0.0);
+
+        _now += 10ms;
+        _PaintFrame(pacer, 20ms, 1.0);
+
+        const auto statistics = pacer.GetStatistics();
+        VERIFY_ARE_EQUAL(uint64_t{ 2 }, statistics.frames);
+        VERIFY_ARE_EQUAL(uint64_t{ 1 }, statistics.coalescedRequests);
+        VERIFY_IS_TRUE(statistics.lastPaintTime == 20ms);
+        VERIFY_IS_TRUE(statistics.maxPaintTime == 20ms);
+        VERIFY_IS_TRUE(statistics.averagePaintTime == 1ms + 19000us / 4);
+
+        VERIFY_IS_TRUE(statistics.maxLatency == 20ms);
+        VERIFY_IS_TRUE(statistics.lastLatency == 20ms);
+
+        Log::Comment(L"The latency of the first frame includes the time its request waited for it.");
+        VERIFY_ARE_EQUAL(uint64_t{ 1 }, til::at(statistics.latencyHistogram, 1));
+        VERIFY_ARE_EQUAL(uint64_t{ 1 }, til::at(statistics.latencyHistogram, 3));
+        VERIFY_ARE_EQUAL(uint64_t{ 2 }, std::accumulate(statistics.latencyHistogram.begin(), statistics.latencyHistogram.end(), uint64_t{ 0 }));
+    }
+
+    TEST_METHOD(HeldBackFramesArentPresented)
+    {
+        auto pacer = _CreatePacer();
+
+        pacer.FrameRequested();
+        _now += 2ms;
+        pacer.FrameStarted();
+        _now += 1ms;
+        pacer.FrameHeldBack();
+
+        Log::Comment(L"A frame held back by synchronized output isn't counted.");
+        VERIFY_ARE_EQUAL(uint64_t{ 0 }, pacer.GetStatistics().frames);
+
+        Log::Comment(L"The frame that presents the output counts from the first request.");
+        _now += 10ms;
+        pacer.FrameRequested();
+        _PaintFrame(pacer, 1ms, 0.0);
+
+        const auto statistics = pacer.GetStatistics();
+        VERIFY_ARE_EQUAL(uint64_t{ 1 }, statistics.frames);
+        VERIFY_IS_TRUE(statistics.lastLatency == 14ms);
+    }
+
+    TEST_METHOD(RequestsWhilePaintingWaitForTheNextFrame)
+    {
+        auto pacer = _CreatePacer();
+
+        pacer.FrameStarted();
+        _now += 1ms;
+        pacer.FrameRequested();
+        _now += 1ms;
+        pacer.FrameCompleted(0.0);
+        VERIFY_IS_TRUE(pacer.GetStatistics().lastLatency == 2ms);
+
+        Log::Comment(L"A request made during a frame counts towards the next one.");
+        _now += 5ms;
+        _PaintFrame(pacer, 1ms, 0.0);
+        VERIFY_IS_TRUE(pacer.GetStatistics().lastLatency == 7ms);
+    }
+};
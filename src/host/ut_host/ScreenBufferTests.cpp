@@ -185,6 +185,7 @@ class ScreenBufferTests
     TEST_METHOD(SetScreenMode);
     TEST_METHOD(SetOriginMode);
     TEST_METHOD(SetAutoWrapMode);
+    TEST_METHOD(RepeatCharacterFillsRows);
 
     TEST_METHOD(HardResetBuffer);
 
@@ -4690,6 +4691,105 @@ void ScreenBufferTests::SetAutoWrapMode()
     VERIFY_ARE_EQUAL(COORD({ 3, startLine + 1 }), cursor.GetPosition());
 }
 
+void ScreenBufferTests::RepeatCharacterFillsRows()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    auto& cursor = si.GetTextBuffer().GetCursor();
+    const auto attributes = si.GetAttributes();
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+
+    const auto view = Viewport::FromDimensions({ 0, 0 }, { 80, 25 });
+    si.SetViewport(view, true);
+
+    Log::Comment(L"A run that ends in the last column waits there to wrap.");
+    cursor.SetPosition({ 80 - 10, 0 });
+    stateMachine.ProcessString(L"a\x1b[9b");
+    VERIFY_IS_TRUE(_ValidateLineContains({ 80 - 10, 0 }, L"aaaaaaaaaa", attributes));
+    VERIFY_ARE_EQUAL(COORD({ 79, 0 }), cursor.GetPosition());
+    VERIFY_IS_TRUE(cursor.IsDelayedEOLWrap());
+    VERIFY_IS_TRUE(_ValidateLineContains(1, L' ', attributes));
+
+    Log::Comment(L"A run that starts while the cursor waits to wrap continues on the next line.");
+    cursor.SetPosition({ 79, 2 });
+    stateMachine.ProcessString(L"c");
+    VERIFY_IS_TRUE(cursor.IsDelayedEOLWrap());
+    stateMachine.ProcessString(L"\x1b[3b");
+    VERIFY_IS_TRUE(_ValidateLineContains({ 79, 2 }, L"c", attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, 3 }, L"ccc", attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 3, 3 }, L' ', attributes));
+    VERIFY_ARE_EQUAL(COORD({ 3, 3 }), cursor.GetPosition());
+    VERIFY_IS_FALSE(cursor.IsDelayedEOLWrap());
+
+    Log::Comment(L"A run longer than a row fills whole rows.");
+    cursor.SetPosition({ 80 - 5, 5 });
+    stateMachine.ProcessString(L"d\x1b[168b");
+    VERIFY_IS_TRUE(_ValidateLineContains({ 80 - 5, 5 }, L"ddddd", attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains(6, L'd', attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains(7, L'd', attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, 8 }, L"dddd", attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 4, 8 }, L' ', attributes));
+    VERIFY_ARE_EQUAL(COORD({ 4, 8 }), cursor.GetPosition());
+
+    Log::Comment(L"Without ENABLE_WRAP_AT_EOL_OUTPUT, the rest of the run stays in the last column.");
+    WI_ClearFlag(si.OutputMode, ENABLE_WRAP_AT_EOL_OUTPUT);
+    cursor.SetPosition({ 80 - 3, 10 });
+    stateMachine.ProcessString(L"e\x1b[5b");
+    WI_SetFlag(si.OutputMode, ENABLE_WRAP_AT_EOL_OUTPUT);
+    VERIFY_IS_TRUE(_ValidateLineContains({ 80 - 3, 10 }, L"eee", attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains(11, L' ', attributes));
+    VERIFY_ARE_EQUAL(COORD({ 79, 10 }), cursor.GetPosition());
+
+    Log::Comment(L"Wide characters are repeated through the regular write path.");
+    cursor.SetPosition({ 80 - 3, 12 });
+    stateMachine.ProcessString(L"\x3042\x1b[1b");
+    VERIFY_IS_TRUE(_ValidateLineContains({ 80 - 3, 12 }, L"\x3042", attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, 13 }, L"\x3042", attributes));
+    VERIFY_ARE_EQUAL(COORD({ 2, 13 }), cursor.GetPosition());
+
+    Log::Comment(L"So are surrogates, which end up just like printing them.");
+    cursor.SetPosition({ 0, 14 });
+    stateMachine.ProcessString(L"\xDE00\xDE00\xDE00");
+    const auto printedEnd = cursor.GetPosition();
+    cursor.SetPosition({ 0, 15 });
+    stateMachine.ProcessString(L"\xDE00\x1b[2b");
+    VERIFY_ARE_EQUAL(printedEnd.X, cursor.GetPosition().X);
+    VERIFY_ARE_EQUAL(15, cursor.GetPosition().Y);
+    {
+        auto printed = si.GetCellLineDataAt({ 0, 14 });
+        auto repeated = si.GetCellLineDataAt({ 0, 15 });
+        while (printed && repeated)
+        {
+            SetVerifyOutput settings(VerifyOutputSettings::LogOnlyFailures);
+            VERIFY_ARE_EQUAL(String(printed->Chars().data(), gsl::narrow<int>(printed->Chars().size())),
+                             String(repeated->Chars().data(), gsl::narrow<int>(repeated->Chars().size())));
+            ++printed;
+            ++repeated;
+        }
+    }
+
+    Log::Comment(L"Wrapping at the bottom margin scrolls the margins, and nothing outside of them.");
+    // The margins are lines 19 to 22, and the run starts two columns from
+    // the end of line 22.
+    _FillLine(18, L'm', attributes);
+    _FillLine(19, L'n', attributes);
+    _FillLine(22, L'o', attributes);
+    _FillLine(23, L'p', attributes);
+    stateMachine.ProcessString(L"\x1b[20;23r");
+    stateMachine.ProcessString(L"\x1b[23;79H");
+    stateMachine.ProcessString(L"f\x1b[3b");
+    VERIFY_IS_TRUE(_ValidateLineContains(18, L'm', attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains(19, L' ', attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, 21 }, std::wstring(78, L'o'), attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 78, 21 }, L"ff", attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 0, 22 }, L"ff", attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains({ 2, 22 }, L' ', attributes));
+    VERIFY_IS_TRUE(_ValidateLineContains(23, L'p', attributes));
+    VERIFY_ARE_EQUAL(COORD({ 2, 22 }), cursor.GetPosition());
+    stateMachine.ProcessString(L"\x1b[r");
+}
+
 void ScreenBufferTests::HardResetBuffer()
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -156,4 +156,75 @@ class SearchTests
         Search s(gci.renderData, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    TEST_METHOD(FindAllMatchesFindNext)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        for (const auto needle : { L"AB", L"ab", L"\x304b", L"C\x304d" })
+        {
+            Log::Comment(NoThrowString().Format(L"Searching for '%s'", needle));
+
+            Search s(gci.renderData, needle, Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+            const auto all = s.FindAll();
+            VERIFY_ARE_EQUAL(4u, all.size());
+
+            for (const auto& match : all)
+            {
+                VERIFY_IS_TRUE(s.FindNext());
+                VERIFY_ARE_EQUAL(match.first, s._coordSelStart);
+                VERIFY_ARE_EQUAL(match.second, s._coordSelEnd);
+            }
+            VERIFY_IS_FALSE(s.FindNext());
+        }
+    }
+
+    TEST_METHOD(FindAllInRange)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Search s(gci.renderData, L"AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+
+        Log::Comment(L"Only matches starting within the range are returned.");
+        const auto all = s.FindAll({ 1, 1 }, { 0, 3 });
+        VERIFY_ARE_EQUAL(2u, all.size());
+        VERIFY_ARE_EQUAL((COORD{ 0, 2 }), all.at(0).first);
+        VERIFY_ARE_EQUAL((COORD{ 1, 2 }), all.at(0).second);
+        VERIFY_ARE_EQUAL((COORD{ 0, 3 }), all.at(1).first);
+        VERIFY_ARE_EQUAL((COORD{ 1, 3 }), all.at(1).second);
+
+        Log::Comment(L"Case sensitive searches don't match the other case.");
+        Search lower(gci.renderData, L"ab", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(0u, lower.FindAll().size());
+    }
+
+    TEST_METHOD(FindAllInHistoryReadsArchivedRows)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+        textBuffer.SetArchiveCapacity(10);
+
+        Log::Comment(L"Scroll the first two rows into the archive.");
+        VERIFY_IS_TRUE(textBuffer.IncrementCircularBuffer());
+        VERIFY_IS_TRUE(textBuffer.IncrementCircularBuffer());
+        VERIFY_ARE_EQUAL(2u, textBuffer.GetArchive().size());
+
+        const std::array<std::pair<std::wstring, SHORT>, 3> needles{ { { L"AB", 0 }, { L"\x304b", 2 }, { L"C\x304d", 4 } } };
+        for (const auto& [needle, column] : needles)
+        {
+            Log::Comment(NoThrowString().Format(L"Searching for '%s'", needle.c_str()));
+
+            Search s(gci.renderData, needle, Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+            VERIFY_ARE_EQUAL(2u, s.FindAll().size());
+
+            const auto all = s.FindAllInHistory();
+            VERIFY_ARE_EQUAL(4u, all.size());
+            for (size_t i = 0; i < all.size(); ++i)
+            {
+                VERIFY_ARE_EQUAL(gsl::narrow_cast<int64_t>(i) - 2, all.at(i).first);
+                VERIFY_ARE_EQUAL(column, all.at(i).second);
+            }
+        }
+    }
+
 };
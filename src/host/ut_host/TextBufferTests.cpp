@@ -106,6 +106,10 @@ class TextBufferTests
     TEST_METHOD(TestSetWrapOnCurrentRow);
 
     TEST_METHOD(TestIncrementCircularBuffer);
+    TEST_METHOD(TestIncrementCircularBufferArchivesRows);
+    TEST_METHOD(TestGetTextReadsArchivedRows);
+
+    TEST_METHOD(TestGetPatterns);
 
     TEST_METHOD(TestMixedRgbAndLegacyForeground);
     TEST_METHOD(TestMixedRgbAndLegacyBackground);
@@ -140,6 +144,16 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollRowsKeepsRowsInPlace);
+    TEST_METHOD(ScrollRowsRotatesContentsAndIds);
+
+    std::wstring CellsOfRow(const TextBuffer& buffer, const SHORT row);
+    TEST_METHOD(CopyRectOverlapping);
+    TEST_METHOD(CopyRectMovesStoredGlyphs);
+    TEST_METHOD(CopyRectClearsSplitWideGlyphs);
+    TEST_METHOD(CopyRectCopiesAttrRuns);
+    TEST_METHOD(FillRectClearsSplitWideGlyphs);
+    TEST_METHOD(ChangeAttrsInRectChangesRuns);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
@@ -156,6 +170,7 @@ class TextBufferTests
 
     TEST_METHOD(HyperlinkTrim);
     TEST_METHOD(NoHyperlinkTrim);
+    TEST_METHOD(HyperlinkRemovedWithLastReference);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -634,6 +649,153 @@ void TextBufferTests::TestIncrementCircularBuffer()
     }
 }
 
+void TextBufferTests::TestIncrementCircularBufferArchivesRows()
+{
+    const COORD bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    Log::Comment(L"Rows aren't archived until the archive is given a capacity.");
+    buffer->WriteLine(OutputCellIterator{ L"row 0" }, { 0, 0 });
+    buffer->IncrementCircularBuffer();
+    VERIFY_IS_TRUE(buffer->GetArchive().empty());
+
+    buffer->SetArchiveCapacity(4);
+
+    Log::Comment(L"Scroll six rows with different colors out of the buffer.");
+    for (auto i = 1; i <= 6; ++i)
+    {
+        TextAttribute rowAttr{ gsl::narrow_cast<WORD>(i) };
+        buffer->WriteLine(OutputCellIterator{ fmt::format(L"row {}", i), rowAttr }, { 0, 0 });
+        buffer->GetRowByOffset(0).GetCharRow().SetWrapForced(i % 2 == 0);
+        VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+    }
+
+    Log::Comment(L"Only the four newest rows are retained, oldest first.");
+    const auto& archive = buffer->GetArchive();
+    VERIFY_ARE_EQUAL(4u, archive.size());
+    for (auto i = 0; i < 4; ++i)
+    {
+        VERIFY_ARE_EQUAL(fmt::format(L"row {}", i + 3), std::wstring{ archive.GetText(i) });
+        VERIFY_ARE_EQUAL((i + 3) % 2 == 0, archive.WasWrapForced(i));
+
+        const auto runs = archive.GetAttrRuns(i);
+        VERIFY_ARE_EQUAL(2u, runs.size());
+        VERIFY_ARE_EQUAL(5u, runs.at(0).GetLength());
+        VERIFY_ARE_EQUAL(TextAttribute{ gsl::narrow_cast<WORD>(i + 3) }, runs.at(0).GetAttributes());
+        VERIFY_ARE_EQUAL(attr, runs.at(1).GetAttributes());
+    }
+    VERIFY_THROWS_SPECIFIC(archive.GetText(4), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+
+    Log::Comment(L"An archived row can be materialized again.");
+    auto& row = buffer->GetRowByOffset(1);
+    archive.Restore(1, row);
+    VERIFY_ARE_EQUAL(L"row 4     ", row.GetText());
+    VERIFY_IS_TRUE(row.GetCharRow().WasWrapForced());
+    VERIFY_ARE_EQUAL(TextAttribute{ 4 }, row.GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(attr, row.GetAttrRow().GetAttrByColumn(9));
+
+    Log::Comment(L"Shrinking the capacity drops the oldest rows.");
+    buffer->SetArchiveCapacity(1);
+    VERIFY_ARE_EQUAL(1u, archive.size());
+    VERIFY_ARE_EQUAL(L"row 6", std::wstring{ archive.GetText(0) });
+
+    buffer->ClearArchive();
+    VERIFY_IS_TRUE(archive.empty());
+}
+
+void TextBufferTests::TestGetTextReadsArchivedRows()
+{
+    const COORD bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    buffer->SetArchiveCapacity(10);
+
+    Log::Comment(L"Print five rows at the bottom, so the first three scroll into the archive.");
+    for (auto i = 0; i < 5; ++i)
+    {
+        TextAttribute rowAttr{ gsl::narrow_cast<WORD>(i + 1) };
+        buffer->WriteLine(OutputCellIterator{ fmt::format(L"row {}", i), rowAttr }, { 0, 2 });
+        buffer->GetRowByOffset(2).GetCharRow().SetWrapForced(i == 1);
+        VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+    }
+    VERIFY_ARE_EQUAL(3u, buffer->GetArchive().size());
+
+    Log::Comment(L"Archived rows are addressed above the top of the buffer.");
+    ROW scratch{ 0, gsl::narrow_cast<unsigned short>(bufferSize.X), attr, nullptr };
+    VERIFY_ARE_EQUAL(L"row 2     ", buffer->GetHistoryRow(-1, scratch).GetText());
+    VERIFY_ARE_EQUAL(L"row 3     ", buffer->GetHistoryRow(0, scratch).GetText());
+    VERIFY_ARE_EQUAL(&buffer->GetRowByOffset(0), &buffer->GetHistoryRow(0, scratch));
+    VERIFY_THROWS_SPECIFIC(buffer->GetHistoryRow(-4, scratch), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+
+    Log::Comment(L"GetText reads through the archive into the buffer.");
+    std::vector<SMALL_RECT> textRects;
+    for (SHORT row = -3; row < 2; ++row)
+    {
+        textRects.push_back({ 0, row, bufferSize.X - 1, row });
+    }
+    const auto data = buffer->GetText(true, true, textRects, [](const TextAttribute& attr) {
+        return std::pair<COLORREF, COLORREF>{ attr.GetLegacyAttributes(), 0 };
+    });
+
+    const std::array<std::wstring, 5> expected{ L"row 0\r\n", L"row 1     ", L"row 2\r\n", L"row 3\r\n", L"row 4" };
+
+    VERIFY_ARE_EQUAL(expected.size(), data.text.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        VERIFY_ARE_EQUAL(expected.at(i), data.text.at(i));
+        VERIFY_ARE_EQUAL(static_cast<COLORREF>(i + 1), data.FgAttr.at(i).at(0));
+    }
+}
+
+
+void TextBufferTests::TestGetPatterns()
+{
+    const COORD bufferSize{ 20, 4 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    const auto patternId = buffer->AddPatternRecognizer(LR"(https://[^ ]+)");
+
+    const auto verifyMatches = [&](const std::vector<std::pair<til::point, til::point>>& expected) {
+        const auto tree = buffer->GetPatterns(0, bufferSize.Y - 1);
+        auto found = tree.findOverlapping(til::point{ 0, 0 }, til::point{ bufferSize.X, bufferSize.Y });
+        std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.start < b.start; });
+
+        VERIFY_ARE_EQUAL(expected.size(), found.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(expected.at(i).first, found.at(i).start);
+            VERIFY_ARE_EQUAL(expected.at(i).second, found.at(i).stop);
+            VERIFY_ARE_EQUAL(patternId, found.at(i).value);
+        }
+    };
+
+    Log::Comment(L"A match that wraps onto the next row is found in full.");
+    buffer->Write(OutputCellIterator{ L"go https://example.com/x now" }, { 0, 0 });
+    verifyMatches({ { til::point{ 3, 0 }, til::point{ 4, 1 } } });
+
+    Log::Comment(L"Searching the same text again gives the same result.");
+    verifyMatches({ { til::point{ 3, 0 }, til::point{ 4, 1 } } });
+
+    Log::Comment(L"A row that changed is searched again.");
+    buffer->WriteLine(OutputCellIterator{ L"https://a.b" }, { 0, 3 });
+    verifyMatches({ { til::point{ 3, 0 }, til::point{ 4, 1 } },
+                    { til::point{ 0, 3 }, til::point{ 11, 3 } } });
+
+    buffer->WriteLine(OutputCellIterator{ L' ', 11 }, { 0, 3 });
+    verifyMatches({ { til::point{ 3, 0 }, til::point{ 4, 1 } } });
+
+    Log::Comment(L"A match doesn't continue past a row that wasn't wrapped.");
+    buffer->WriteLine(OutputCellIterator{ L"     https://aaaaaaa" }, { 0, 2 });
+    buffer->WriteLine(OutputCellIterator{ L"bbb" }, { 0, 3 });
+    verifyMatches({ { til::point{ 3, 0 }, til::point{ 4, 1 } },
+                    { til::point{ 5, 2 }, til::point{ 0, 3 } } });
+}
+
 void TextBufferTests::TestMixedRgbAndLegacyForeground()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -1910,6 +2072,360 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// This tests that scrolling a region reorders the rows that are seen at each position,
+// even when the region wraps around the end of the circular buffer, but leaves the
+// ROWs themselves where they were.
+void TextBufferTests::ScrollRowsKeepsRowsInPlace()
+{
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // Make the rows from 3 on wrap around the end of the circular buffer.
+    _buffer->_SetFirstRowIndex(7);
+
+    // Mark every row with its number, and remember where it lives.
+    std::vector<const ROW*> rows;
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        auto glyph = _buffer->GetRowByOffset(y).GetCharRow().GlyphAt(0);
+        glyph = std::wstring(1, static_cast<wchar_t>(L'0' + y));
+        rows.push_back(&_buffer->GetRowByOffset(y));
+    }
+
+    const auto verifyRows = [&](const std::wstring_view expected) {
+        for (SHORT y = 0; y < bufferSize.Y; ++y)
+        {
+            const auto number = gsl::narrow_cast<size_t>(til::at(expected, y) - L'0');
+            const auto text = *_buffer->GetTextDataAt({ 0, y });
+            VERIFY_ARE_EQUAL(String(expected.substr(y, 1).data(), 1), String(text.data(), gsl::narrow<int>(text.size())));
+            VERIFY_ARE_EQUAL(til::at(rows, number), &_buffer->GetRowByOffset(y));
+        }
+    };
+
+    Log::Comment(L"Scroll rows 2 to 4 down by 4.");
+    _buffer->ScrollRows(2, 3, 4);
+    verifyRows(L"0156782349");
+
+    Log::Comment(L"Scroll them back up.");
+    _buffer->ScrollRows(6, 3, -4);
+    verifyRows(L"0123456789");
+}
+
+// This tests that scrolling a region moves the contents and the IDs of its rows
+// together, wherever the region lies relative to the end of the circular buffer.
+void TextBufferTests::ScrollRowsRotatesContentsAndIds()
+{
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+
+    // firstRow, size, delta
+    const std::tuple<SHORT, SHORT, SHORT> scrolls[] = {
+        { 2, 3, 4 },
+        { 6, 3, -4 },
+        { 1, 8, 1 },
+        { 1, 8, -1 },
+        { 5, 1, -5 },
+    };
+
+    for (SHORT firstRowIndex = 0; firstRowIndex < bufferSize.Y; ++firstRowIndex)
+    {
+        for (const auto& [firstRow, size, delta] : scrolls)
+        {
+            Log::Comment(NoThrowString().Format(L"Scroll %d rows from %d by %d, with the buffer starting at row %d.",
+                                                size,
+                                                firstRow,
+                                                delta,
+                                                firstRowIndex));
+
+            auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+            _buffer->_SetFirstRowIndex(firstRowIndex);
+
+            // Mark every row with its number, and remember its ID.
+            std::vector<wchar_t> expectedText;
+            std::vector<SHORT> expectedIds;
+            for (SHORT y = 0; y < bufferSize.Y; ++y)
+            {
+                auto glyph = _buffer->GetRowByOffset(y).GetCharRow().GlyphAt(0);
+                glyph = std::wstring(1, static_cast<wchar_t>(L'0' + y));
+                expectedText.push_back(static_cast<wchar_t>(L'0' + y));
+                expectedIds.push_back(_buffer->GetRowByOffset(y).GetId());
+            }
+
+            // The rows of the region move by delta, and the rows they move
+            // over fill the space they left behind.
+            const auto moveRows = [&](auto& rows) {
+                const auto begin = rows.begin() + firstRow;
+                const auto end = begin + size;
+                if (delta < 0)
+                {
+                    std::rotate(begin + delta, begin, end);
+                }
+                else
+                {
+                    std::rotate(begin, end, end + delta);
+                }
+            };
+            moveRows(expectedText);
+            moveRows(expectedIds);
+
+            _buffer->ScrollRows(firstRow, size, delta);
+
+            for (SHORT y = 0; y < bufferSize.Y; ++y)
+            {
+                const auto text = *_buffer->GetTextDataAt({ 0, y });
+                VERIFY_ARE_EQUAL(String(&til::at(expectedText, y), 1), String(text.data(), gsl::narrow<int>(text.size())));
+                VERIFY_ARE_EQUAL(til::at(expectedIds, y), _buffer->GetRowByOffset(y).GetId());
+            }
+        }
+    }
+}
+
+// Reads the glyph of every cell of the given row, so a wide glyph shows up
+// once for each of its halves.
+std::wstring TextBufferTests::CellsOfRow(const TextBuffer& buffer, const SHORT row)
+{
+    std::wstring cells;
+    for (SHORT column = 0; column < buffer.GetSize().Width(); ++column)
+    {
+        cells += *buffer.GetTextDataAt({ column, row });
+    }
+    return cells;
+}
+
+void TextBufferTests::CopyRectOverlapping()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"Data:direction", L"{0, 1, 2, 3}")
+    END_TEST_METHOD_PROPERTIES();
+
+    int direction;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"direction", direction), L"Get 'direction' variant");
+
+    // Right, left, down and up, each by less than the size of the rectangle.
+    const std::array<COORD, 4> targets{ COORD{ 3, 1 }, COORD{ 0, 1 }, COORD{ 1, 2 }, COORD{ 1, 0 } };
+    const auto targetOrigin = targets.at(gsl::narrow<size_t>(direction));
+
+    COORD bufferSize{ 8, 6 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    const std::vector<std::wstring> bufferText = { L"abcdefgh",
+                                                   L"ijklmnop",
+                                                   L"qrstuvwx",
+                                                   L"yzABCDEF",
+                                                   L"GHIJKLMN",
+                                                   L"OPQRSTUV" };
+    WriteLinesToBuffer(bufferText, *_buffer);
+
+    const auto source = Viewport::FromInclusive({ 1, 1, 4, 3 });
+    Log::Comment(NoThrowString().Format(L"Copying %s to (%d, %d)",
+                                        VerifyOutputTraits<SMALL_RECT>::ToString(source.ToInclusive()).ToCStrWithFallbackTo(L"Fail"),
+                                        targetOrigin.X,
+                                        targetOrigin.Y));
+
+    auto expected = bufferText;
+    for (SHORT y = 0; y < source.Height(); ++y)
+    {
+        for (SHORT x = 0; x < source.Width(); ++x)
+        {
+            expected.at(targetOrigin.Y + y).at(targetOrigin.X + x) = bufferText.at(source.Top() + y).at(source.Left() + x);
+        }
+    }
+
+    _buffer->CopyRect(source, targetOrigin);
+
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        VERIFY_ARE_EQUAL(String(expected.at(y).c_str()), String(CellsOfRow(*_buffer, y).c_str()));
+    }
+}
+
+void TextBufferTests::CopyRectMovesStoredGlyphs()
+{
+    COORD bufferSize{ 8, 2 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    WriteLinesToBuffer({ L"abcdefgh" }, *_buffer);
+
+    // This is the eggplant emoji: 🍆
+    // It's put into a single cell, so it has to live in the unicode storage.
+    const auto emoji = L"\xD83C\xDF46";
+    _buffer->GetRowByOffset(0).GetCharRow().GlyphAt(2) = emoji;
+    const auto& storage = _buffer->GetRowByOffset(0).GetCharRow().GetUnicodeStorage();
+
+    Log::Comment(L"Copying to the right over the stored glyph has to read it before it's overwritten.");
+    _buffer->CopyRect(Viewport::FromInclusive({ 0, 0, 3, 0 }), { 2, 0 });
+    VERIFY_ARE_EQUAL(String(L"ab"
+                            L"ab\xD83C\xDF46"
+                            L"dgh"),
+                     String(CellsOfRow(*_buffer, 0).c_str()));
+    VERIFY_ARE_EQUAL(1u, storage.size());
+
+    Log::Comment(L"Copying to the left over the stored glyph moves it, too.");
+    _buffer->CopyRect(Viewport::FromInclusive({ 3, 0, 6, 0 }), { 1, 0 });
+    VERIFY_ARE_EQUAL(String(L"ab\xD83C\xDF46"
+                            L"dgdgh"),
+                     String(CellsOfRow(*_buffer, 0).c_str()));
+    VERIFY_ARE_EQUAL(1u, storage.size());
+
+    Log::Comment(L"Copying to another row stores the glyph there, and keeps the original.");
+    _buffer->CopyRect(Viewport::FromInclusive({ 0, 0, 7, 0 }), { 0, 1 });
+    VERIFY_ARE_EQUAL(String(CellsOfRow(*_buffer, 0).c_str()), String(CellsOfRow(*_buffer, 1).c_str()));
+    VERIFY_ARE_EQUAL(1u, storage.size());
+    VERIFY_ARE_EQUAL(1u, _buffer->GetRowByOffset(1).GetCharRow().GetUnicodeStorage().size());
+
+    Log::Comment(L"Copying plain text over it takes it out of the storage.");
+    _buffer->CopyRect(Viewport::FromInclusive({ 4, 0, 6, 0 }), { 1, 0 });
+    VERIFY_ARE_EQUAL(String(L"agdggdgh"), String(CellsOfRow(*_buffer, 0).c_str()));
+    VERIFY_ARE_EQUAL(0u, storage.size());
+}
+
+void TextBufferTests::CopyRectClearsSplitWideGlyphs()
+{
+    COORD bufferSize{ 8, 2 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // Row 0: a, あ in columns 1-2, b, い in columns 4-5, c, d
+    // Row 1: う in columns 0-1, え in columns 2-3, then x's
+    WriteLinesToBuffer({ L"a\x3042"
+                         L"b\x3044"
+                         L"cd",
+                         L"\x3046\x3048"
+                         L"xxxx" },
+                       *_buffer);
+    VERIFY_ARE_EQUAL(String(L"a\x3042\x3042"
+                            L"b\x3044\x3044"
+                            L"cd"),
+                     String(CellsOfRow(*_buffer, 0).c_str()));
+
+    Log::Comment(L"The copied halves of あ and い are cleared, and so is the half of う that's left outside of the target.");
+    _buffer->CopyRect(Viewport::FromInclusive({ 2, 0, 4, 0 }), { 1, 1 });
+    VERIFY_ARE_EQUAL(String(L"  b xxxx"), String(CellsOfRow(*_buffer, 1).c_str()));
+
+    const auto& charRow = _buffer->GetRowByOffset(1).GetCharRow();
+    for (size_t column = 0; column < charRow.size(); ++column)
+    {
+        VERIFY_IS_TRUE(charRow.DbcsAttrAt(column).IsSingle());
+    }
+
+    Log::Comment(L"The source row is left as it was.");
+    VERIFY_ARE_EQUAL(String(L"a\x3042\x3042"
+                            L"b\x3044\x3044"
+                            L"cd"),
+                     String(CellsOfRow(*_buffer, 0).c_str()));
+}
+
+void TextBufferTests::CopyRectCopiesAttrRuns()
+{
+    COORD bufferSize{ 10, 1 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    const TextAttribute red{ FOREGROUND_RED };
+    const TextAttribute green{ FOREGROUND_GREEN };
+
+    // Columns 0-2 are red, 3-5 green, the rest keeps the default.
+    auto& attrRow = _buffer->GetRowByOffset(0).GetAttrRow();
+    VERIFY_IS_TRUE(attrRow.SetAttrToEnd(0, red));
+    VERIFY_IS_TRUE(attrRow.SetAttrToEnd(3, green));
+    VERIFY_IS_TRUE(attrRow.SetAttrToEnd(6, attr));
+
+    Log::Comment(L"Copying the runs to the right, over themselves.");
+    _buffer->CopyRect(Viewport::FromInclusive({ 0, 0, 5, 0 }), { 2, 0 });
+
+    const std::array<TextAttribute, 10> expected{ red, red, red, red, red, green, green, green, attr, attr };
+    for (size_t column = 0; column < expected.size(); ++column)
+    {
+        VERIFY_ARE_EQUAL(til::at(expected, column), attrRow.GetAttrByColumn(column));
+    }
+    VERIFY_ARE_EQUAL(3u, attrRow.GetNumberOfRuns());
+}
+
+void TextBufferTests::FillRectClearsSplitWideGlyphs()
+{
+    COORD bufferSize{ 8, 3 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    WriteLinesToBuffer({ L"a\x3042"
+                         L"bcdef",
+                         L"abcdefgh",
+                         L"abcdefgh" },
+                       *_buffer);
+
+    const auto emoji = L"\xD83C\xDF46";
+    _buffer->GetRowByOffset(1).GetCharRow().GlyphAt(3) = emoji;
+
+    Log::Comment(L"Filling with attributes clears the half of あ outside of the rectangle, and the stored glyph.");
+    const TextAttribute red{ FOREGROUND_RED };
+    _buffer->FillRect(Viewport::FromInclusive({ 2, 0, 4, 1 }), L'x', red);
+    VERIFY_ARE_EQUAL(String(L"a xxxdef"), String(CellsOfRow(*_buffer, 0).c_str()));
+    VERIFY_ARE_EQUAL(String(L"abxxxfgh"), String(CellsOfRow(*_buffer, 1).c_str()));
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(1).GetCharRow().GetUnicodeStorage().empty());
+    for (SHORT y = 0; y < 2; ++y)
+    {
+        const auto& attrRow = _buffer->GetRowByOffset(y).GetAttrRow();
+        VERIFY_ARE_EQUAL(attr, attrRow.GetAttrByColumn(1));
+        VERIFY_ARE_EQUAL(red, attrRow.GetAttrByColumn(2));
+        VERIFY_ARE_EQUAL(red, attrRow.GetAttrByColumn(4));
+        VERIFY_ARE_EQUAL(attr, attrRow.GetAttrByColumn(5));
+    }
+
+    Log::Comment(L"Filling without attributes keeps them.");
+    _buffer->FillRect(Viewport::FromInclusive({ 3, 1, 5, 2 }), L' ', std::nullopt);
+    VERIFY_ARE_EQUAL(String(L"abx   gh"), String(CellsOfRow(*_buffer, 1).c_str()));
+    VERIFY_ARE_EQUAL(String(L"abc   gh"), String(CellsOfRow(*_buffer, 2).c_str()));
+    VERIFY_ARE_EQUAL(red, _buffer->GetRowByOffset(1).GetAttrRow().GetAttrByColumn(4));
+    VERIFY_ARE_EQUAL(attr, _buffer->GetRowByOffset(1).GetAttrRow().GetAttrByColumn(5));
+    VERIFY_ARE_EQUAL(attr, _buffer->GetRowByOffset(2).GetAttrRow().GetAttrByColumn(4));
+}
+
+void TextBufferTests::ChangeAttrsInRectChangesRuns()
+{
+    COORD bufferSize{ 10, 2 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    WriteLinesToBuffer({ L"abcdefghij" }, *_buffer);
+
+    const TextAttribute red{ FOREGROUND_RED };
+    const TextAttribute green{ FOREGROUND_GREEN };
+    auto& attrRow = _buffer->GetRowByOffset(0).GetAttrRow();
+    VERIFY_IS_TRUE(attrRow.SetAttrToEnd(0, red));
+    VERIFY_IS_TRUE(attrRow.SetAttrToEnd(4, green));
+
+    Log::Comment(L"Underlining columns 2-6 changes both runs, but only inside the rectangle.");
+    _buffer->ChangeAttrsInRect(Viewport::FromInclusive({ 2, 0, 6, 0 }), [](TextAttribute& attributes) {
+        attributes.SetUnderlined(true);
+    });
+
+    auto redUnderlined = red;
+    redUnderlined.SetUnderlined(true);
+    auto greenUnderlined = green;
+    greenUnderlined.SetUnderlined(true);
+    const std::array<TextAttribute, 10> expected{ red, red, redUnderlined, redUnderlined, greenUnderlined, greenUnderlined, greenUnderlined, green, green, green };
+    for (size_t column = 0; column < expected.size(); ++column)
+    {
+        VERIFY_ARE_EQUAL(til::at(expected, column), attrRow.GetAttrByColumn(column));
+    }
+    VERIFY_ARE_EQUAL(4u, attrRow.GetNumberOfRuns());
+
+    Log::Comment(L"The text and the other rows are left alone.");
+    VERIFY_ARE_EQUAL(String(L"abcdefghij"), String(CellsOfRow(*_buffer, 0).c_str()));
+    VERIFY_ARE_EQUAL(1u, _buffer->GetRowByOffset(1).GetAttrRow().GetNumberOfRuns());
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
@@ -1935,14 +2451,17 @@ void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetCharRow().GetUnicodeStorage().size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the row of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X, bufferSize.Y - 1 };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    for (const auto& row : _buffer->_storage)
+    {
+        VERIFY_IS_TRUE(row.GetCharRow().GetUnicodeStorage().empty(), L"The storage of the remaining rows should be empty.");
+    }
 }
 
 // This tests that columns removed from the buffer while resizing traditionally will also drop the high unicode
@@ -1970,14 +2489,14 @@ void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetCharRow().GetUnicodeStorage().size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the column of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X - 1, bufferSize.Y };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    VERIFY_IS_TRUE(_buffer->_storage[pos.Y].GetCharRow().GetUnicodeStorage().empty(), L"The row's storage should now be empty.");
 }
 
 void TextBufferTests::TestBurrito()
@@ -2660,3 +3179,39 @@ void TextBufferTests::NoHyperlinkTrim()
     VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
     VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalCustomId], id);
 }
+
+// This tests that a hyperlink is removed from the map as soon as the last row that refers to it
+// is overwritten, without the row having to scroll out of the buffer
+void TextBufferTests::HyperlinkRemovedWithLastReference()
+{
+    // Set up a text buffer for us
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    const auto url = L"test.url";
+
+    // Set the same hyperlink id in two rows in the middle of the buffer
+    const auto id = _buffer->GetHyperlinkId(url, {});
+    TextAttribute newAttr{ 0x7f };
+    newAttr.SetHyperlinkId(id);
+    _buffer->GetRowByOffset(3).GetAttrRow().SetAttrToEnd(70, newAttr);
+    _buffer->GetRowByOffset(5).GetAttrRow().SetAttrToEnd(70, newAttr);
+    _buffer->AddHyperlinkToMap(url, id);
+
+    Log::Comment(L"Overwriting one of the rows keeps the hyperlink around.");
+    _buffer->GetRowByOffset(3).GetAttrRow().SetAttrToEnd(0, attr);
+    VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
+
+    Log::Comment(L"The current attributes keep it around as well.");
+    _buffer->SetCurrentAttributes(newAttr);
+    _buffer->GetRowByOffset(5).Reset(attr);
+    VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
+
+    Log::Comment(L"Once neither of them refers to it, it's gone.");
+    _buffer->GetRowByOffset(5).GetAttrRow().SetAttrToEnd(70, newAttr);
+    _buffer->SetCurrentAttributes(attr);
+    _buffer->GetRowByOffset(5).Reset(attr);
+    VERIFY_ARE_EQUAL(_buffer->_hyperlinkMap.find(id), _buffer->_hyperlinkMap.end());
+}
@@ -30,15 +30,13 @@ class Utf8ToWideCharParserTests
         const unsigned char wideHello[10] = { 0x48, 0x00, 0x65, 0x00, 0x6c, 0x00, 0x6c, 0x00, 0x6f, 0x00 };
         unsigned int count = 5;
         unsigned int consumed = 0;
-        unsigned int generated = 0;
-        unique_ptr<wchar_t[]> output{ nullptr };
+        std::wstring_view output;
 
-        VERIFY_SUCCEEDED(parser.Parse(hello, count, consumed, output, generated));
+        VERIFY_SUCCEEDED(parser.Parse(hello, count, consumed, output));
         VERIFY_ARE_EQUAL(consumed, (unsigned int)5);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)5);
-        VERIFY_ARE_NOT_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)5);
 
-        unsigned char* pReturnedBytes = reinterpret_cast<unsigned char*>(output.get());
+        const unsigned char* pReturnedBytes = reinterpret_cast<const unsigned char*>(output.data());
         for (int i = 0; i < ARRAYSIZE(wideHello); ++i)
         {
             VERIFY_ARE_EQUAL(wideHello[i], pReturnedBytes[i]);
@@ -54,15 +52,13 @@ class Utf8ToWideCharParserTests
         const unsigned char wideSushi[4] = { 0x59, 0x30, 0x57, 0x30 };
         unsigned int count = 6;
         unsigned int consumed = 0;
-        unsigned int generated = 0;
-        unique_ptr<wchar_t[]> output{ nullptr };
+        std::wstring_view output;
 
-        VERIFY_SUCCEEDED(parser.Parse(sushi, count, consumed, output, generated));
+        VERIFY_SUCCEEDED(parser.Parse(sushi, count, consumed, output));
         VERIFY_ARE_EQUAL(consumed, (unsigned int)6);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)2);
-        VERIFY_ARE_NOT_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)2);
 
-        unsigned char* pReturnedBytes = reinterpret_cast<unsigned char*>(output.get());
+        const unsigned char* pReturnedBytes = reinterpret_cast<const unsigned char*>(output.data());
         for (int i = 0; i < ARRAYSIZE(wideSushi); ++i)
         {
             VERIFY_ARE_EQUAL(wideSushi[i], pReturnedBytes[i]);
@@ -78,24 +74,21 @@ class Utf8ToWideCharParserTests
         auto parser = Utf8ToWideCharParser{ utf8CodePage };
         unsigned int count = 1;
         unsigned int consumed = 0;
-        unsigned int generated = 0;
-        unique_ptr<wchar_t[]> output{ nullptr };
+        std::wstring_view output;
 
         for (int i = 0; i < 2; ++i)
         {
-            VERIFY_SUCCEEDED(parser.Parse(shi + i, count, consumed, output, generated));
+            VERIFY_SUCCEEDED(parser.Parse(shi + i, count, consumed, output));
             VERIFY_ARE_EQUAL(consumed, (unsigned int)1);
-            VERIFY_ARE_EQUAL(generated, (unsigned int)0);
-            VERIFY_ARE_EQUAL(output.get(), nullptr);
+            VERIFY_ARE_EQUAL(output.size(), (size_t)0);
             count = 1;
         }
 
-        VERIFY_SUCCEEDED(parser.Parse(shi + 2, count, consumed, output, generated));
+        VERIFY_SUCCEEDED(parser.Parse(shi + 2, count, consumed, output));
         VERIFY_ARE_EQUAL(consumed, (unsigned int)1);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)1);
-        VERIFY_ARE_NOT_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)1);
 
-        unsigned char* pReturnedBytes = reinterpret_cast<unsigned char*>(output.get());
+        const unsigned char* pReturnedBytes = reinterpret_cast<const unsigned char*>(output.data());
         for (int i = 0; i < ARRAYSIZE(wideShi); ++i)
         {
             VERIFY_ARE_EQUAL(wideShi[i], pReturnedBytes[i]);
@@ -110,17 +103,15 @@ class Utf8ToWideCharParserTests
         const unsigned char wideSushi[4] = { 0x59, 0x30, 0x57, 0x30 };
         unsigned int count = 4;
         unsigned int consumed = 0;
-        unsigned int generated = 0;
-        unique_ptr<wchar_t[]> output{ nullptr };
+        std::wstring_view output;
         auto parser = Utf8ToWideCharParser{ utf8CodePage };
 
-        VERIFY_SUCCEEDED(parser.Parse(sushi, count, consumed, output, generated));
+        VERIFY_SUCCEEDED(parser.Parse(sushi, count, consumed, output));
         // check that we got the first wide char back
         VERIFY_ARE_EQUAL(consumed, (unsigned int)4);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)1);
-        VERIFY_ARE_NOT_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)1);
 
-        unsigned char* pReturnedBytes = reinterpret_cast<unsigned char*>(output.get());
+        const unsigned char* pReturnedBytes = reinterpret_cast<const unsigned char*>(output.data());
         for (int i = 0; i < 2; ++i)
         {
             VERIFY_ARE_EQUAL(wideSushi[i], pReturnedBytes[i]);
@@ -129,24 +120,20 @@ class Utf8ToWideCharParserTests
         // add byte 2 of 3 to parser
         count = 1;
         consumed = 0;
-        generated = 0;
-        output.reset(nullptr);
-        VERIFY_SUCCEEDED(parser.Parse(sushi + 4, count, consumed, output, generated));
+        output = {};
+        VERIFY_SUCCEEDED(parser.Parse(sushi + 4, count, consumed, output));
         VERIFY_ARE_EQUAL(consumed, (unsigned int)1);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)0);
-        VERIFY_ARE_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)0);
 
         // add last byte
         count = 1;
         consumed = 0;
-        generated = 0;
-        output.reset(nullptr);
-        VERIFY_SUCCEEDED(parser.Parse(sushi + 5, count, consumed, output, generated));
+        output = {};
+        VERIFY_SUCCEEDED(parser.Parse(sushi + 5, count, consumed, output));
         VERIFY_ARE_EQUAL(consumed, (unsigned int)1);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)1);
-        VERIFY_ARE_NOT_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)1);
 
-        pReturnedBytes = reinterpret_cast<unsigned char*>(output.get());
+        pReturnedBytes = reinterpret_cast<const unsigned char*>(output.data());
         for (int i = 0; i < 2; ++i)
         {
             VERIFY_ARE_EQUAL(wideSushi[i + 2], pReturnedBytes[i]);
@@ -184,16 +171,14 @@ class Utf8ToWideCharParserTests
         // send first 4 bytes
         unsigned int count = 4;
         unsigned int consumed = 0;
-        unsigned int generated = 0;
-        unique_ptr<wchar_t[]> output{ nullptr };
+        std::wstring_view output;
         auto parser = Utf8ToWideCharParser{ utf8CodePage };
 
-        VERIFY_SUCCEEDED(parser.Parse(doomoArigatoo, count, consumed, output, generated));
+        VERIFY_SUCCEEDED(parser.Parse(doomoArigatoo, count, consumed, output));
         VERIFY_ARE_EQUAL(consumed, (unsigned int)4);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)1);
-        VERIFY_ARE_NOT_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)1);
 
-        unsigned char* pReturnedBytes = reinterpret_cast<unsigned char*>(output.get());
+        const unsigned char* pReturnedBytes = reinterpret_cast<const unsigned char*>(output.data());
         for (int i = 0; i < 2; ++i)
         {
             VERIFY_ARE_EQUAL(wideDoomoArigatoo[i], pReturnedBytes[i]);
@@ -202,14 +187,12 @@ class Utf8ToWideCharParserTests
         // send next 16 bytes
         count = 16;
         consumed = 0;
-        generated = 0;
-        output.reset(nullptr);
-        VERIFY_SUCCEEDED(parser.Parse(doomoArigatoo + 4, count, consumed, output, generated));
+        output = {};
+        VERIFY_SUCCEEDED(parser.Parse(doomoArigatoo + 4, count, consumed, output));
         VERIFY_ARE_EQUAL(consumed, (unsigned int)16);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)5);
-        VERIFY_ARE_NOT_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)5);
 
-        pReturnedBytes = reinterpret_cast<unsigned char*>(output.get());
+        pReturnedBytes = reinterpret_cast<const unsigned char*>(output.data());
         for (int i = 0; i < 10; ++i)
         {
             VERIFY_ARE_EQUAL(wideDoomoArigatoo[i + 2], pReturnedBytes[i]);
@@ -218,14 +201,12 @@ class Utf8ToWideCharParserTests
         // send last 4 bytes
         count = 4;
         consumed = 0;
-        generated = 0;
-        output.reset(nullptr);
-        VERIFY_SUCCEEDED(parser.Parse(doomoArigatoo + 20, count, consumed, output, generated));
+        output = {};
+        VERIFY_SUCCEEDED(parser.Parse(doomoArigatoo + 20, count, consumed, output));
         VERIFY_ARE_EQUAL(consumed, (unsigned int)4);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)2);
-        VERIFY_ARE_NOT_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)2);
 
-        pReturnedBytes = reinterpret_cast<unsigned char*>(output.get());
+        pReturnedBytes = reinterpret_cast<const unsigned char*>(output.data());
         for (int i = 0; i < 4; ++i)
         {
             VERIFY_ARE_EQUAL(wideDoomoArigatoo[i + 12], pReturnedBytes[i]);
@@ -248,16 +229,14 @@ class Utf8ToWideCharParserTests
         const unsigned char wideSushi[4] = { 0x59, 0x30, 0x57, 0x30 };
         unsigned int count = 9;
         unsigned int consumed = 0;
-        unsigned int generated = 0;
-        unique_ptr<wchar_t[]> output{ nullptr };
+        std::wstring_view output;
         auto parser = Utf8ToWideCharParser{ utf8CodePage };
 
-        VERIFY_SUCCEEDED(parser.Parse(sushi, count, consumed, output, generated));
+        VERIFY_SUCCEEDED(parser.Parse(sushi, count, consumed, output));
         VERIFY_ARE_EQUAL(consumed, (unsigned int)9);
-        VERIFY_ARE_EQUAL(generated, (unsigned int)2);
-        VERIFY_ARE_NOT_EQUAL(output.get(), nullptr);
+        VERIFY_ARE_EQUAL(output.size(), (size_t)2);
 
-        unsigned char* pReturnedBytes = reinterpret_cast<unsigned char*>(output.get());
+        const unsigned char* pReturnedBytes = reinterpret_cast<const unsigned char*>(output.data());
         for (int i = 0; i < ARRAYSIZE(wideSushi); ++i)
         {
             VERIFY_ARE_EQUAL(wideSushi[i], pReturnedBytes[i]);
@@ -286,9 +265,9 @@ class Utf8ToWideCharParserTests
             0x0060, 0x0012, 0x0008, 0x007f,
             0xfffd, 0xfffd, // The number of replacements per invalid sequence is not intended to be load-bearing
             0x0041, 0x0048, 0x0006, 0x0055,
-            0xfffd, 0xfffd, // It is just representative of what it looked like when fixing this for GH#3380
+            0xfffd, 0xfffd, 0xfffd, // It is one per maximal subpart, as produced by til::u8u16
             0x0018, 0x0077, 0x0040, 0x0031,
-            0xfffd, 0xfffd, 0xfffd, // Change if necessary when completing GH#3378
+            0xfffd, 0xfffd, 0xfffd, 0xfffd, // Change if necessary when completing GH#3378
             0x0059, 0x001f, 0x0068, 0x0020
         };
 
@@ -297,17 +276,15 @@ class Utf8ToWideCharParserTests
         const unsigned int count = gsl::narrow_cast<unsigned int>(ARRAYSIZE(data));
         const unsigned int wideCount = gsl::narrow_cast<unsigned int>(ARRAYSIZE(wideData));
         unsigned int consumed = 0;
-        unsigned int generated = 0;
-        unique_ptr<wchar_t[]> output{ nullptr };
+        std::wstring_view output;
         auto parser = Utf8ToWideCharParser{ utf8CodePage };
 
-        VERIFY_SUCCEEDED(parser.Parse(data, count, consumed, output, generated));
+        VERIFY_SUCCEEDED(parser.Parse(data, count, consumed, output));
         VERIFY_ARE_EQUAL(count, consumed);
-        VERIFY_ARE_EQUAL(wideCount, generated);
-        VERIFY_IS_NOT_NULL(output.get());
+        VERIFY_ARE_EQUAL(size_t{ wideCount }, output.size());
 
         const auto expected = WEX::Common::String(wideData, wideCount);
-        const auto actual = WEX::Common::String(output.get(), generated);
+        const auto actual = WEX::Common::String(output.data(), gsl::narrow_cast<int>(output.size()));
         VERIFY_ARE_EQUAL(expected, actual);
     }
 
@@ -320,9 +297,8 @@ class Utf8ToWideCharParserTests
         const unsigned char partialSequence[inputSize] = { 0xF0, 0x80 };
         unsigned int count = inputSize;
         unsigned int consumed = 0;
-        unsigned int generated = 0;
-        unique_ptr<wchar_t[]> output{ nullptr };
-        VERIFY_SUCCEEDED(parser.Parse(partialSequence, count, consumed, output, generated));
+        std::wstring_view output;
+        VERIFY_SUCCEEDED(parser.Parse(partialSequence, count, consumed, output));
         VERIFY_ARE_EQUAL(parser._currentState, Utf8ToWideCharParser::_State::BeginPartialParse);
         VERIFY_ARE_EQUAL(parser._bytesStored, inputSize);
         // set the codepage to the same one it currently is, ensure
@@ -406,6 +406,11 @@ public:
     {
         return {};
     }
+
+    void GetPatternSpans(const SHORT /*row*/, std::vector<PatternSpan>& spans) const
+    {
+        spans.clear();
+    }
 };
 
 void VtIoTests::RendererDtorAndThread()
@@ -8,6 +8,7 @@
 
 #include "../../renderer/vt/Xterm256Engine.hpp"
 #include "../../renderer/vt/XtermEngine.hpp"
+#include "../../renderer/vt/VtPipeWriter.hpp"
 #include "../Settings.hpp"
 
 using namespace WEX::Common;
@@ -83,6 +84,14 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestCursorVisibility);
 
+    TEST_METHOD(TestPassthrough);
+
+    TEST_METHOD(TestSkipUnchangedText);
+
+    TEST_METHOD(TestRepeatCharacter);
+
+    TEST_METHOD(TestPipeWriter);
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -416,8 +425,7 @@ void VtRendererTest::Xterm256TestColors()
     Log::Comment(NoThrowString().Format(
         L"Begin by setting some test values - FG,BG = (1,2,3), (4,5,6) to start"
         L"These values were picked for ease of formatting raw COLORREF values."));
-    qExpectedInput.push_back("\x1b[38;2;1;2;3m");
-    qExpectedInput.push_back("\x1b[48;2;5;6;7m");
+    qExpectedInput.push_back("\x1b[38;2;1;2;3;48;2;5;6;7m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({ 0x00030201, 0x00070605 },
                                                   &renderData,
                                                   false));
@@ -679,57 +687,75 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
     VERIFY_SUCCEEDED(TestData::TryGetValue(L"crossedOut", crossedOut));
 
     TextAttribute desiredAttrs;
-    std::vector<std::string> onSequences, offSequences;
+    std::vector<std::string> onParameters, offParameters;
 
     // Collect up a VT sequence to set the state given the method properties
     if (faint)
     {
         desiredAttrs.SetFaint(true);
-        onSequences.push_back("\x1b[2m");
-        offSequences.push_back("\x1b[22m");
+        onParameters.push_back("2");
+        offParameters.push_back("22");
     }
     if (underlined)
     {
         desiredAttrs.SetUnderlined(true);
-        onSequences.push_back("\x1b[4m");
-        offSequences.push_back("\x1b[24m");
+        onParameters.push_back("4");
+        offParameters.push_back("24");
     }
     if (doublyUnderlined)
     {
         desiredAttrs.SetDoublyUnderlined(true);
-        onSequences.push_back("\x1b[21m");
+        onParameters.push_back("21");
         // The two underlines share the same off sequence, so we
         // only add it here if that hasn't already been done.
         if (!underlined)
         {
-            offSequences.push_back("\x1b[24m");
+            offParameters.push_back("24");
         }
     }
     if (italics)
     {
         desiredAttrs.SetItalic(true);
-        onSequences.push_back("\x1b[3m");
-        offSequences.push_back("\x1b[23m");
+        onParameters.push_back("3");
+        offParameters.push_back("23");
     }
     if (blink)
     {
         desiredAttrs.SetBlinking(true);
-        onSequences.push_back("\x1b[5m");
-        offSequences.push_back("\x1b[25m");
+        onParameters.push_back("5");
+        offParameters.push_back("25");
     }
     if (invisible)
     {
         desiredAttrs.SetInvisible(true);
-        onSequences.push_back("\x1b[8m");
-        offSequences.push_back("\x1b[28m");
+        onParameters.push_back("8");
+        offParameters.push_back("28");
     }
     if (crossedOut)
     {
         desiredAttrs.SetCrossedOut(true);
-        onSequences.push_back("\x1b[9m");
-        offSequences.push_back("\x1b[29m");
+        onParameters.push_back("9");
+        offParameters.push_back("29");
     }
 
+    // All of the changed attributes are written in a single sequence.
+    const auto joinParameters = [](const std::vector<std::string>& parameters) {
+        std::vector<std::string> sequences;
+        if (!parameters.empty())
+        {
+            std::string sequence = "\x1b[";
+            for (const auto& parameter : parameters)
+            {
+                sequence += parameter + ";";
+            }
+            sequence.back() = 'm';
+            sequences.push_back(sequence);
+        }
+        return sequences;
+    };
+    const auto onSequences = joinParameters(onParameters);
+    const auto offSequences = joinParameters(offParameters);
+
     wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
     std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
     auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
@@ -753,6 +779,7 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
         // Merge the "on" sequences into expected input.
         std::copy(onSequences.cbegin(), onSequences.cend(), std::back_inserter(qExpectedInput));
         VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs(desiredAttrs));
+        VERIFY_SUCCEEDED(engine->_WriteGraphicsRendition());
     });
 
     Log::Comment(NoThrowString().Format(
@@ -760,6 +787,7 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
     TestPaint(*engine, [&]() {
         std::copy(offSequences.cbegin(), offSequences.cend(), std::back_inserter(qExpectedInput));
         VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs({}));
+        VERIFY_SUCCEEDED(engine->_WriteGraphicsRendition());
     });
 
     Log::Comment(NoThrowString().Format(
@@ -767,6 +795,7 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
     TestPaint(*engine, [&]() {
         std::copy(onSequences.cbegin(), onSequences.cend(), std::back_inserter(qExpectedInput));
         VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs(desiredAttrs));
+        VERIFY_SUCCEEDED(engine->_WriteGraphicsRendition());
     });
 
     VerifyExpectedInputsDrained();
@@ -784,6 +813,11 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
     std::stringstream renditionSequence;
     renditionSequence << "\x1b[" << renditionAttribute << "m";
 
+    // Resetting the colors also resets the rendition, so it's reapplied in the
+    // same sequence.
+    std::stringstream resetSequence;
+    resetSequence << "\x1b[0;" << renditionAttribute << "m";
+
     wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
     std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
     auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
@@ -850,8 +884,7 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Foreground and Retain Rendition----");
     textAttributes.SetDefaultForeground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back(resetSequence.str());
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, &renderData, false));
 
     Log::Comment(L"----Set Green Background----");
@@ -861,8 +894,7 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Background and Retain Rendition----");
     textAttributes.SetDefaultBackground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back(resetSequence.str());
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, &renderData, false));
 
     VerifyExpectedInputsDrained();
@@ -1121,8 +1153,7 @@ void VtRendererTest::XtermTestColors()
         Log::Comment(NoThrowString().Format(
             L"----Change only the BG to the 'Default' background----"));
         textAttributes.SetDefaultBackground();
-        qExpectedInput.push_back("\x1b[m"); // Both foreground and background default
-        qExpectedInput.push_back("\x1b[33m"); // Reapply foreground DARK_YELLOW
+        qExpectedInput.push_back("\x1b[0;33m"); // Both foreground and background default, then reapply foreground DARK_YELLOW
         VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes,
                                                       &renderData,
                                                       false));
@@ -1146,8 +1177,7 @@ void VtRendererTest::XtermTestColors()
         Log::Comment(NoThrowString().Format(
             L"----Change only the FG to the 'Default' foreground----"));
         textAttributes.SetDefaultForeground();
-        qExpectedInput.push_back("\x1b[m"); // Both foreground and background default
-        qExpectedInput.push_back("\x1b[41m"); // Reapply background DARK_RED
+        qExpectedInput.push_back("\x1b[0;41m"); // Both foreground and background default, then reapply background DARK_RED
         VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes,
                                                       &renderData,
                                                       false));
@@ -1293,6 +1323,11 @@ void VtRendererTest::XtermTestAttributesAcrossReset()
     std::stringstream renditionSequence;
     renditionSequence << "\x1b[" << renditionAttribute << "m";
 
+    // Resetting the colors also resets the rendition, so it's reapplied in the
+    // same sequence.
+    std::stringstream resetSequence;
+    resetSequence << "\x1b[0;" << renditionAttribute << "m";
+
     wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
     std::unique_ptr<XtermEngine> engine = std::make_unique<XtermEngine>(std::move(hFile), SetUpViewport(), false);
     auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
@@ -1331,8 +1366,7 @@ void VtRendererTest::XtermTestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Foreground and Retain Rendition----");
     textAttributes.SetDefaultForeground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back(resetSequence.str());
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, &renderData, false));
 
     Log::Comment(L"----Set Green Background----");
@@ -1342,8 +1376,7 @@ void VtRendererTest::XtermTestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Background and Retain Rendition----");
     textAttributes.SetDefaultBackground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back(resetSequence.str());
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, &renderData, false));
 
     VerifyExpectedInputsDrained();
@@ -1554,6 +1587,217 @@ void VtRendererTest::TestCursorVisibility()
     VERIFY_IS_FALSE(engine->_needToDisableCursor);
 }
 
+void VtRendererTest::TestPassthrough()
+{
+    Viewport view = SetUpViewport();
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), view);
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    VERIFY_SUCCEEDED(engine->UpdateViewport(view.ToInclusive()));
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Passed through strings should be held until the end of the write, "
+        L"and invalidations in the meantime ignored. The test callback sees "
+        L"every string as it's written, since it stands in for the buffer."));
+    engine->BeginPassthrough();
+
+    qExpectedInput.push_back("foo");
+    qExpectedInput.push_back("\x1b[31m");
+    qExpectedInput.push_back("bar");
+    VERIFY_SUCCEEDED(engine->WriteTerminalW(L"foo"));
+    VERIFY_SUCCEEDED(engine->WriteTerminalW(L"\x1b[31m"));
+    VERIFY_SUCCEEDED(engine->WriteTerminalW(L"bar"));
+
+    const SMALL_RECT invalid = { 1, 1, 2, 2 };
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    VERIFY_SUCCEEDED(engine->InvalidateAll());
+    const COORD cursor = { 6, 0 };
+    VERIFY_SUCCEEDED(engine->InvalidateCursor(&cursor));
+    const COORD scrollDelta = { 0, -1 };
+    VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
+    VERIFY_IS_TRUE(engine->_invalidMap.none());
+    VERIFY_IS_FALSE(engine->_cursorMoved);
+
+    bool forcePaint = true;
+    VERIFY_SUCCEEDED(engine->InvalidateCircling(&forcePaint));
+    VERIFY_IS_FALSE(forcePaint);
+
+    TextAttribute attributes{};
+    attributes.SetIndexedForeground(FOREGROUND_RED);
+    VERIFY_SUCCEEDED(engine->EndPassthrough(cursor, false, true, attributes));
+
+    Log::Comment(NoThrowString().Format(
+        L"The engine should now agree with the terminal about the cursor and attributes."));
+    VERIFY_ARE_EQUAL(cursor, engine->_lastText);
+    VERIFY_ARE_EQUAL(attributes, engine->_lastTextAttributes);
+    VERIFY_IS_TRUE(engine->_lastCursorIsVisible);
+    VERIFY_IS_FALSE(engine->_delayedEolWrap);
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestSkipUnchangedText()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    const auto makeClusters = [](const std::wstring_view line) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < line.size(); i++)
+        {
+            clusters.emplace_back(line.substr(i, 1), 1u);
+        }
+        return clusters;
+    };
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"The terminal's contents are unknown, so the whole line is painted."));
+        qExpectedInput.push_back("\x1b[H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 0 }));
+
+        qExpectedInput.push_back("0123456789");
+        const auto clusters = makeClusters(L"0123456789");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Jumping over the unchanged start of the line is shorter than writing it."));
+        qExpectedInput.push_back("\b");
+        qExpectedInput.push_back("X");
+        const auto clusters = makeClusters(L"012345678X");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"The unchanged end of the line isn't written at all."));
+        qExpectedInput.push_back("\r");
+        qExpectedInput.push_back("A");
+        const auto clusters = makeClusters(L"A12345678X");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+        VERIFY_ARE_EQUAL((COORD{ 1, 0 }), engine->_lastText);
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"A long run of spaces is erased, and jumped over."));
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("ab");
+        qExpectedInput.push_back("\x1b[20X");
+        qExpectedInput.push_back("\x1b[20C");
+        qExpectedInput.push_back("cd");
+        const auto clusters = makeClusters(L"ab                    cd");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 1 }, false, false));
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestRepeatCharacter()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    const auto makeClusters = [](const std::wstring_view line) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < line.size(); i++)
+        {
+            clusters.emplace_back(line.substr(i, 1), 1u);
+        }
+        return clusters;
+    };
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"A long run of the same glyph is written once, then repeated. "
+            L"A short one is written as it is."));
+        qExpectedInput.push_back("\x1b[H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 0 }));
+
+        qExpectedInput.push_back("x=");
+        qExpectedInput.push_back("\x1b[9b");
+        qExpectedInput.push_back("y=====");
+        const auto clusters = makeClusters(L"x==========y=====");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+        VERIFY_ARE_EQUAL((COORD{ 17, 0 }), engine->_lastText);
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"A run of a glyph outside of ASCII may fill the row up to its last column."));
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("\xe2\x94\x80");
+        qExpectedInput.push_back("\x1b[79b");
+        const auto clusters = makeClusters(std::wstring(80, L'\x2500'));
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 1 }, false, false));
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestPipeWriter()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 0));
+
+    auto writer = std::make_unique<VtPipeWriter>(writePipe.get());
+
+    Log::Comment(L"The buffer we hand over is swapped for an empty one.");
+    std::string buffer = "foo";
+    VERIFY_SUCCEEDED(writer->Write(buffer));
+    VERIFY_IS_TRUE(buffer.empty());
+
+    buffer = "bar";
+    VERIFY_SUCCEEDED(writer->Write(buffer));
+    VERIFY_IS_TRUE(buffer.empty());
+
+    Log::Comment(L"Everything is written in order once the writer is drained.");
+    VERIFY_SUCCEEDED(writer->Drain());
+
+    std::array<char, 16> output{};
+    DWORD read = 0;
+    VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(readPipe.get(), output.data(), gsl::narrow_cast<DWORD>(output.size()), &read, nullptr));
+    VERIFY_ARE_EQUAL(std::string{ "foobar" }, std::string(output.data(), read));
+
+    const auto statistics = writer->GetStatistics();
+    VERIFY_ARE_EQUAL(uint64_t{ 2 }, statistics.writes);
+    VERIFY_ARE_EQUAL(uint64_t{ 6 }, statistics.bytesWritten);
+    VERIFY_IS_LESS_THAN_OR_EQUAL(statistics.coalescedWrites, uint64_t{ 1 });
+
+    Log::Comment(L"Once the terminal is gone, the failure is reported.");
+    readPipe.reset();
+    buffer = "baz";
+    VERIFY_SUCCEEDED(writer->Write(buffer));
+    VERIFY_FAILED(writer->Drain());
+
+    buffer = "qux";
+    VERIFY_FAILED(writer->Write(buffer));
+    VERIFY_IS_TRUE(buffer.empty());
+}
+
 void VtRendererTest::FormattedString()
 {
     // This test works with a static cache variable that
@@ -28,8 +28,7 @@ const byte MostSignificantBitMask = 0x80;
 Utf8ToWideCharParser::Utf8ToWideCharParser(const unsigned int codePage) :
     _currentCodePage{ codePage },
     _bytesStored{ 0 },
-    _currentState{ _State::Ready },
-    _convertedWideChars{ nullptr }
+    _currentState{ _State::Ready }
 {
     std::fill_n(_utf8CodePointPieces, _UTF8_BYTE_SEQUENCE_MAX, 0ui8);
 }
@@ -58,21 +57,20 @@ void Utf8ToWideCharParser::SetCodePage(const unsigned int codePage)
 // - Parses the input multi-byte sequence.
 // Arguments:
 // - pBytes - The byte sequence to parse.
-// - cchBuffer - The amount of bytes in pBytes. This will contain the
-// number of wide chars contained by converted after this function is
-// run, or 0 if an error occurs (or if pBytes is 0).
-// - converted - a valid unique_ptr to store the parsed wide chars
-// in. On error this will contain nullptr instead of an array.
+// - cchBuffer - The amount of bytes in pBytes.
+// - cchConsumed - The amount of bytes of pBytes that were consumed.
+// - converted - Receives the parsed wide chars. It points into a buffer
+// of the parser that is reused, so it's only valid until the next call.
+// On error, or if no wide chars could be formed yet, it's empty.
 // Return Value:
 // - <none>
 [[nodiscard]] HRESULT Utf8ToWideCharParser::Parse(_In_reads_(cchBuffer) const byte* const pBytes,
                                                   _In_ unsigned int const cchBuffer,
                                                   _Out_ unsigned int& cchConsumed,
-                                                  _Inout_ std::unique_ptr<wchar_t[]>& converted,
-                                                  _Out_ unsigned int& cchConverted)
+                                                  _Out_ std::wstring_view& converted)
 {
     cchConsumed = 0;
-    cchConverted = 0;
+    converted = {};
 
     // we can't parse anything if we weren't given any data to parse
     if (cchBuffer == 0)
@@ -89,7 +87,7 @@ void Utf8ToWideCharParser::SetCodePage(const unsigned int codePage)
     {
         bool loop = true;
         unsigned int wideCharCount = 0;
-        _convertedWideChars.reset(nullptr);
+        _convertedWideChars.clear();
         while (loop)
         {
             switch (_currentState)
@@ -121,8 +119,10 @@ void Utf8ToWideCharParser::SetCodePage(const unsigned int codePage)
                 break;
             }
         }
-        converted.swap(_convertedWideChars);
-        cchConverted = wideCharCount;
+        if (wideCharCount != 0)
+        {
+            converted = { _convertedWideChars.data(), wideCharCount };
+        }
     }
     catch (...)
     {
@@ -313,22 +313,8 @@ unsigned int Utf8ToWideCharParser::_ParseFullRange(_In_reads_(cb) const byte* co
     }
     else
     {
-        _convertedWideChars = std::make_unique<wchar_t[]>(bufferSize);
-        bufferSize = MultiByteToWideChar(_currentCodePage,
-                                         0,
-                                         reinterpret_cast<LPCCH>(pInputChars),
-                                         cb,
-                                         _convertedWideChars.get(),
-                                         bufferSize);
-        if (bufferSize == 0)
-        {
-            LOG_LAST_ERROR();
-            _currentState = _State::Error;
-        }
-        else
-        {
-            _currentState = _State::Finished;
-        }
+        bufferSize = gsl::narrow_cast<int>(_ConvertToWide({ reinterpret_cast<const char*>(pInputChars), cb }));
+        _currentState = bufferSize == 0 ? _State::Error : _State::Finished;
     }
     return bufferSize;
 }
@@ -363,85 +349,95 @@ unsigned int Utf8ToWideCharParser::_InvolvedParse(_In_reads_(cb) const byte* con
         return 0;
     }
 
-    // Allocate space and copy.
-    std::unique_ptr<byte[]> combinedInputBytes = std::make_unique<byte[]>(count);
-    std::copy(_utf8CodePointPieces, _utf8CodePointPieces + _bytesStored, combinedInputBytes.get());
-    std::copy(pInputChars, pInputChars + cb, combinedInputBytes.get() + _bytesStored);
+    // Gather the saved partial and the new bytes in a buffer that is reused across calls.
+    _combinedBytes.assign(_utf8CodePointPieces, _utf8CodePointPieces + _bytesStored);
+    _combinedBytes.insert(_combinedBytes.end(), pInputChars, pInputChars + cb);
     _bytesStored = 0;
-    std::pair<std::unique_ptr<byte[]>, unsigned int> validSequence = _RemoveInvalidSequences(combinedInputBytes.get(), count);
+    const unsigned int validCount = _RemoveInvalidSequences(_combinedBytes.data(), count);
     // the input may have only been a partial sequence so we need to
     // check that there are actually any bytes that we can convert
     // right now
-    if (validSequence.second == 0 && _bytesStored > 0)
+    if (validCount == 0 && _bytesStored > 0)
     {
         _currentState = _State::AwaitingMoreBytes;
         return 0;
     }
 
     // By this point, all obviously invalid sequences have been removed.
-    // But non-minimal forms of sequences might still exist.
-    // MB2WC will fail non-minimal forms with MB_ERR_INVALID_CHARS at this point.
-    // So we call with flags = 0 such that non-minimal forms get the U+FFFD
-    // replacement character treatment.
+    // But non-minimal forms of sequences might still exist. These get the
+    // U+FFFD replacement character treatment from the transcoder.
     // This issue and related concerns are fully captured in future work item GH#3378
     // for future cleanup and reconciliation.
     // The original issue introducing this was GH#3320.
-    int bufferSize = MultiByteToWideChar(_currentCodePage,
-                                         0,
-                                         reinterpret_cast<LPCCH>(validSequence.first.get()),
-                                         validSequence.second,
-                                         nullptr,
-                                         0);
-    if (bufferSize == 0)
+    const unsigned int bufferSize = _ConvertToWide({ reinterpret_cast<const char*>(_combinedBytes.data()), validCount });
+    if (bufferSize == 0 && validCount > 0)
     {
-        LOG_LAST_ERROR();
         _currentState = _State::Error;
     }
+    else if (_bytesStored > 0)
+    {
+        _currentState = _State::AwaitingMoreBytes;
+    }
     else
     {
-        _convertedWideChars = std::make_unique<wchar_t[]>(bufferSize);
-        bufferSize = MultiByteToWideChar(_currentCodePage,
-                                         0,
-                                         reinterpret_cast<LPCCH>(validSequence.first.get()),
-                                         validSequence.second,
-                                         _convertedWideChars.get(),
-                                         bufferSize);
-        if (bufferSize == 0)
-        {
-            LOG_LAST_ERROR();
-            _currentState = _State::Error;
-        }
-        else if (_bytesStored > 0)
-        {
-            _currentState = _State::AwaitingMoreBytes;
-        }
-        else
-        {
-            _currentState = _State::Finished;
-        }
+        _currentState = _State::Finished;
     }
     return bufferSize;
 }
 
+// Routine Description:
+// - Converts bytes of the current code page to wide chars. The bytes must
+// not end in a partial sequence. Sequences that are ill-formed nonetheless
+// are replaced with U+FFFD.
+// Arguments:
+// - bytes - The byte sequence to convert.
+// Return Value:
+// - The amount of wide chars that are stored in _convertedWideChars, or 0
+// if the bytes cannot be converted.
+unsigned int Utf8ToWideCharParser::_ConvertToWide(const std::string_view bytes)
+{
+    if (_currentCodePage == CP_UTF8)
+    {
+        // A UTF-8 sequence never produces more UTF-16 code units than it has bytes.
+        _convertedWideChars.resize(bytes.size());
+        const auto size = til::details::utf8_to_utf16(bytes, _convertedWideChars.data());
+        _convertedWideChars.resize(size);
+        return gsl::narrow_cast<unsigned int>(size);
+    }
+
+    const int cb = gsl::narrow<int>(bytes.size());
+    int bufferSize = MultiByteToWideChar(_currentCodePage, 0, bytes.data(), cb, nullptr, 0);
+    if (bufferSize != 0)
+    {
+        _convertedWideChars.resize(gsl::narrow_cast<size_t>(bufferSize));
+        bufferSize = MultiByteToWideChar(_currentCodePage, 0, bytes.data(), cb, _convertedWideChars.data(), bufferSize);
+    }
+    if (bufferSize == 0)
+    {
+        LOG_LAST_ERROR();
+        _convertedWideChars.clear();
+    }
+    return gsl::narrow_cast<unsigned int>(bufferSize);
+}
+
 // Routine Description:
 // - Reads pInputChars byte by byte, removing any invalid UTF8
-// multi-byte sequences.
+// multi-byte sequences. The valid bytes are compacted in place to the
+// front of pInputChars.
 // Arguments:
 // - pInputChars - The byte sequence to fix.
 // - cb - The amount of bytes in pInputChars.
 // Return Value:
-// - A std::pair containing the corrected byte sequence and the number
-// of bytes in the sequence.
-std::pair<std::unique_ptr<byte[]>, unsigned int> Utf8ToWideCharParser::_RemoveInvalidSequences(_In_reads_(cb) const byte* const pInputChars, const unsigned int cb)
+// - The number of valid bytes at the front of pInputChars.
+unsigned int Utf8ToWideCharParser::_RemoveInvalidSequences(_Inout_updates_(cb) byte* const pInputChars, const unsigned int cb)
 {
-    std::unique_ptr<byte[]> validSequence = std::make_unique<byte[]>(cb);
-    unsigned int validSequenceLocation = 0; // index into validSequence
+    unsigned int validSequenceLocation = 0; // index of the next valid byte, never ahead of currentByteInput
     unsigned int currentByteInput = 0; // index into pInputChars
     while (currentByteInput < cb)
     {
         if (_IsAsciiByte(pInputChars[currentByteInput]))
         {
-            validSequence[validSequenceLocation] = pInputChars[currentByteInput];
+            pInputChars[validSequenceLocation] = pInputChars[currentByteInput];
             ++validSequenceLocation;
             ++currentByteInput;
         }
@@ -461,7 +457,7 @@ std::pair<std::unique_ptr<byte[]>, unsigned int> Utf8ToWideCharParser::_RemoveIn
                 const unsigned int limit = std::min(sequenceSize, cb - currentByteInput);
                 for (unsigned int i = 0; i < limit; ++i)
                 {
-                    validSequence[validSequenceLocation] = pInputChars[currentByteInput];
+                    pInputChars[validSequenceLocation] = pInputChars[currentByteInput];
                     ++validSequenceLocation;
                     ++currentByteInput;
                 }
@@ -486,7 +482,7 @@ std::pair<std::unique_ptr<byte[]>, unsigned int> Utf8ToWideCharParser::_RemoveIn
             ++currentByteInput;
         }
     }
-    return std::make_pair<std::unique_ptr<byte[]>, unsigned int>(std::move(validSequence), std::move(validSequenceLocation));
+    return validSequenceLocation;
 }
 
 // Routine Description:
@@ -516,5 +512,5 @@ void Utf8ToWideCharParser::_Reset()
 {
     _currentState = _State::Ready;
     _bytesStored = 0;
-    _convertedWideChars.reset(nullptr);
+    _convertedWideChars.clear();
 }
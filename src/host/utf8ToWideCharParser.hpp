@@ -24,8 +24,7 @@ public:
     [[nodiscard]] HRESULT Parse(_In_reads_(cchBuffer) const byte* const pBytes,
                                 _In_ unsigned int const cchBuffer,
                                 _Out_ unsigned int& cchConsumed,
-                                _Inout_ std::unique_ptr<wchar_t[]>& converted,
-                                _Out_ unsigned int& cchConverted);
+                                _Out_ std::wstring_view& converted);
 
 private:
     enum class _State
@@ -45,8 +44,8 @@ private:
     unsigned int _Utf8SequenceSize(_In_ byte ch);
     unsigned int _ParseFullRange(_In_reads_(cb) const byte* const _InputChars, const unsigned int cb);
     unsigned int _InvolvedParse(_In_reads_(cb) const byte* const pInputChars, const unsigned int cb);
-    std::pair<std::unique_ptr<byte[]>, unsigned int> _RemoveInvalidSequences(_In_reads_(cb) const byte* const pInputChars,
-                                                                             const unsigned int cb);
+    unsigned int _ConvertToWide(const std::string_view bytes);
+    unsigned int _RemoveInvalidSequences(_Inout_updates_(cb) byte* const pInputChars, const unsigned int cb);
     void _StorePartialSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb);
     void _Reset();
 
@@ -55,7 +54,8 @@ private:
     byte _utf8CodePointPieces[_UTF8_BYTE_SEQUENCE_MAX];
     unsigned int _bytesStored; // bytes stored in utf8CodePointPieces
     unsigned int _currentCodePage;
-    std::unique_ptr<wchar_t[]> _convertedWideChars;
+    std::vector<byte> _combinedBytes; // saved partial plus new input, reused across calls
+    std::vector<wchar_t> _convertedWideChars; // output of the last Parse, reused across calls
     _State _currentState;
 
 #ifdef UNIT_TESTING
@@ -9,11 +9,11 @@ Abstract:
 - Defines classes which hold the status of the current partials handling.
 - Defines functions for converting between UTF-8 and UTF-16 strings.
 
-Tests have been made in order to investigate whether or not own algorithms
-could overcome disadvantages of syscalls. Test results can be read up
-in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
-Based on the results the decision was made to keep using the platform
-functions MultiByteToWideChar and WideCharToMultiByte.
+The conversions used to go through MultiByteToWideChar and WideCharToMultiByte
+(see PR #4093). They are now done by a self-contained validating transcoder
+that widens/narrows ASCII runs with SSE2 and replaces ill-formed input with
+U+FFFD without allocating anything but the result. The throughput comparison
+lives in src\tools\U8U16Test.
 
 Author(s):
 - Steffen Illhardt (german-one) 2020
@@ -21,6 +21,11 @@ Author(s):
 
 #pragma once
 
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#include <emmintrin.h>
+#endif
+
 namespace til // Terminal Implementation Library. Also: "Today I Learned"
 {
     template<class charT>
@@ -252,6 +257,207 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     typedef u8u16state<char> u8state;
     typedef u8u16state<wchar_t> u16state;
 
+    namespace details
+    {
+        // The replacement for ill-formed input, encoded in either direction.
+        inline constexpr wchar_t u16Replacement{ 0xFFFD };
+        inline constexpr std::array<char, 3> u8Replacement{ '\xEF', '\xBF', '\xBD' };
+
+        // Routine Description:
+        // - Converts UTF-8 to UTF-16. Ill-formed subsequences are replaced with U+FFFD following the
+        //   "maximal subpart" practice of the Unicode standard (chapter 3.9).
+        //   Runs of ASCII are widened 16 bytes at a time.
+        // Arguments:
+        // - in - UTF-8 string to be converted
+        // - out - buffer of at least in.size() UTF-16 code units
+        // Return Value:
+        // - the number of UTF-16 code units written to out
+        inline size_t utf8_to_utf16(const std::string_view in, wchar_t* const out) noexcept
+        {
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+            auto it{ reinterpret_cast<const uint8_t*>(in.data()) };
+            const auto end{ it + in.size() };
+            auto dst{ out };
+
+            while (it != end)
+            {
+#if defined(_M_X64) || defined(_M_IX86)
+                const auto zero{ _mm_setzero_si128() };
+                while (end - it >= 16)
+                {
+                    const auto chunk{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(it)) };
+                    const auto nonAscii{ _mm_movemask_epi8(chunk) };
+                    if (nonAscii != 0)
+                    {
+                        unsigned long index;
+                        _BitScanForward(&index, gsl::narrow_cast<unsigned long>(nonAscii));
+                        for (const auto stop{ it + index }; it != stop; ++it, ++dst)
+                        {
+                            *dst = *it;
+                        }
+                        break;
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi8(chunk, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpackhi_epi8(chunk, zero));
+                    it += 16;
+                    dst += 16;
+                }
+
+                if (it == end)
+                {
+                    break;
+                }
+#endif
+
+                const auto lead{ *it++ };
+                if (lead < 0x80)
+                {
+                    *dst++ = lead;
+                    continue;
+                }
+
+                // The valid range of the second byte depends on the lead byte (Unicode Table 3-7).
+                // Anything following it has to be a plain continuation byte.
+                uint32_t codepoint;
+                size_t trailing;
+                uint8_t lower{ 0x80 };
+                uint8_t upper{ 0xBF };
+                if (lead >= 0xC2 && lead <= 0xDF)
+                {
+                    codepoint = lead & 0x1Fu;
+                    trailing = 1;
+                }
+                else if (lead >= 0xE0 && lead <= 0xEF)
+                {
+                    codepoint = lead & 0x0Fu;
+                    trailing = 2;
+                    lower = lead == 0xE0 ? uint8_t{ 0xA0 } : lower; // overlong
+                    upper = lead == 0xED ? uint8_t{ 0x9F } : upper; // surrogates
+                }
+                else if (lead >= 0xF0 && lead <= 0xF4)
+                {
+                    codepoint = lead & 0x07u;
+                    trailing = 3;
+                    lower = lead == 0xF0 ? uint8_t{ 0x90 } : lower; // overlong
+                    upper = lead == 0xF4 ? uint8_t{ 0x8F } : upper; // > U+10FFFF
+                }
+                else
+                {
+                    *dst++ = u16Replacement;
+                    continue;
+                }
+
+                for (; trailing != 0; --trailing)
+                {
+                    if (it == end || *it < lower || *it > upper)
+                    {
+                        break;
+                    }
+                    codepoint = (codepoint << 6) | (*it++ & 0x3Fu);
+                    lower = 0x80;
+                    upper = 0xBF;
+                }
+
+                if (trailing != 0)
+                {
+                    // The consumed bytes are the maximal subpart of an ill-formed sequence.
+                    *dst++ = u16Replacement;
+                }
+                else if (codepoint < 0x10000)
+                {
+                    *dst++ = gsl::narrow_cast<wchar_t>(codepoint);
+                }
+                else
+                {
+                    codepoint -= 0x10000;
+                    *dst++ = gsl::narrow_cast<wchar_t>(0xD800 | (codepoint >> 10));
+                    *dst++ = gsl::narrow_cast<wchar_t>(0xDC00 | (codepoint & 0x3FF));
+                }
+            }
+
+            return gsl::narrow_cast<size_t>(dst - out);
+#pragma warning(pop)
+        }
+
+        // Routine Description:
+        // - Converts UTF-16 to UTF-8. Unpaired surrogates are replaced with U+FFFD, which matches WideCharToMultiByte.
+        //   Runs of ASCII are narrowed 16 code units at a time.
+        // Arguments:
+        // - in - UTF-16 string to be converted
+        // - out - buffer of at least in.size() * 3 UTF-8 code units
+        // Return Value:
+        // - the number of UTF-8 code units written to out
+        inline size_t utf16_to_utf8(const std::wstring_view in, char* const out) noexcept
+        {
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+            auto it{ in.data() };
+            const auto end{ it + in.size() };
+            auto dst{ out };
+
+            while (it != end)
+            {
+#if defined(_M_X64) || defined(_M_IX86)
+                const auto zero{ _mm_setzero_si128() };
+                const auto nonAsciiBits{ _mm_set1_epi16(-0x80) };
+                while (end - it >= 16)
+                {
+                    const auto lo{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(it)) };
+                    const auto hi{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 8)) };
+                    const auto nonAscii{ _mm_and_si128(_mm_or_si128(lo, hi), nonAsciiBits) };
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, zero)) != 0xFFFF)
+                    {
+                        break;
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(lo, hi));
+                    it += 16;
+                    dst += 16;
+                }
+
+                if (it == end)
+                {
+                    break;
+                }
+#endif
+
+                const auto ch{ gsl::narrow_cast<uint32_t>(*it++) };
+                if (ch < 0x80)
+                {
+                    *dst++ = gsl::narrow_cast<char>(ch);
+                }
+                else if (ch < 0x800)
+                {
+                    *dst++ = gsl::narrow_cast<char>(0xC0 | (ch >> 6));
+                    *dst++ = gsl::narrow_cast<char>(0x80 | (ch & 0x3F));
+                }
+                else if (ch < 0xD800 || ch > 0xDFFF)
+                {
+                    *dst++ = gsl::narrow_cast<char>(0xE0 | (ch >> 12));
+                    *dst++ = gsl::narrow_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                    *dst++ = gsl::narrow_cast<char>(0x80 | (ch & 0x3F));
+                }
+                else if (ch <= 0xDBFF && it != end && *it >= 0xDC00 && *it <= 0xDFFF)
+                {
+                    const auto codepoint{ 0x10000 + ((ch - 0xD800) << 10) + (*it++ - 0xDC00u) };
+                    *dst++ = gsl::narrow_cast<char>(0xF0 | (codepoint >> 18));
+                    *dst++ = gsl::narrow_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+                    *dst++ = gsl::narrow_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+                    *dst++ = gsl::narrow_cast<char>(0x80 | (codepoint & 0x3F));
+                }
+                else
+                {
+                    dst = std::copy(u8Replacement.begin(), u8Replacement.end(), dst);
+                }
+            }
+
+            return gsl::narrow_cast<size_t>(dst - out);
+#pragma warning(pop)
+        }
+    }
+
     // Routine Description:
     // - Takes a UTF-8 string and performs the conversion to UTF-16. NOTE: The function relies on getting complete UTF-8 characters at the string boundaries.
     // Arguments:
@@ -260,7 +466,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // Return Value:
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
-    // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
+    // - E_ABORT       - the resulting string length would exceed the max_size and thus, the conversion was aborted before the conversion has been completed
     // - E_UNEXPECTED  - an unexpected error occurred
     template<class inT, class outT>
     [[nodiscard]] typename std::enable_if<std::is_same<typename inT::value_type, char>::value && std::is_same<typename outT::value_type, wchar_t>::value, HRESULT>::type
@@ -275,14 +481,12 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 return S_OK;
             }
 
-            int lengthRequired{};
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
-            RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
-            out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(gsl::narrow_cast<UINT>(CP_UTF8), 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
+            RETURN_HR_IF(E_ABORT, in.length() > out.max_size());
+            out.resize(in.length()); // avoid a separate pass only to get the required size
+            out.resize(details::utf8_to_utf16({ in.data(), in.length() }, out.data()));
 
-            return lengthOut == 0 ? E_UNEXPECTED : S_OK;
+            return S_OK;
         }
         catch (std::length_error&)
         {
@@ -307,7 +511,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // Return Value:
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
-    // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
+    // - E_ABORT       - the resulting string length would exceed the max_size and thus, the conversion was aborted before the conversion has been completed
     // - E_UNEXPECTED  - an unexpected error occurred
     template<class inT, class outT>
     [[nodiscard]] typename std::enable_if<std::is_same<typename inT::value_type, char>::value && std::is_same<typename outT::value_type, wchar_t>::value, HRESULT>::type
@@ -326,7 +530,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // Return Value:
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
-    // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
+    // - E_ABORT       - the resulting string length would exceed the max_size and thus, the conversion was aborted before the conversion has been completed
     // - E_UNEXPECTED  - an unexpected error occurred
     template<class inT, class outT>
     [[nodiscard]] typename std::enable_if<std::is_same<typename inT::value_type, wchar_t>::value && std::is_same<typename outT::value_type, char>::value, HRESULT>::type
@@ -341,17 +545,15 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 return S_OK;
             }
 
-            int lengthIn{};
-            int lengthRequired{};
+            size_t lengthRequired{};
             // Code Point U+0000..U+FFFF: 1 UTF-16 code unit --> 1..3 UTF-8 code units.
             // Code Points >U+FFFF: 2 UTF-16 code units --> 4 UTF-8 code units.
             // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
-            RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthIn) || !base::CheckMul(lengthIn, 3).AssignIfValid(&lengthRequired));
-            out.resize(gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
-            const int lengthOut = WideCharToMultiByte(gsl::narrow_cast<UINT>(CP_UTF8), 0ul, in.data(), lengthIn, out.data(), lengthRequired, nullptr, nullptr);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
+            RETURN_HR_IF(E_ABORT, !base::CheckMul(in.length(), 3).AssignIfValid(&lengthRequired) || lengthRequired > out.max_size());
+            out.resize(lengthRequired); // avoid a separate pass only to get the required size
+            out.resize(details::utf16_to_utf8({ in.data(), in.length() }, out.data()));
 
-            return lengthOut == 0 ? E_UNEXPECTED : S_OK;
+            return S_OK;
         }
         catch (std::length_error&)
         {
@@ -376,7 +578,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // Return Value:
     // - S_OK          - the conversion succeeded without any change of the represented code points
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
-    // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
+    // - E_ABORT       - the resulting string length would exceed the max_size and thus, the conversion was aborted before the conversion has been completed
     // - E_UNEXPECTED  - an unexpected error occurred
     template<class inT, class outT>
     [[nodiscard]] typename std::enable_if<std::is_same<typename inT::value_type, wchar_t>::value && std::is_same<typename outT::value_type, char>::value, HRESULT>::type
@@ -171,9 +171,9 @@ class UiaTextRangeTests
         {
             ROW& row = _pTextBuffer->GetRowByOffset(i);
             auto& charRow = row.GetCharRow();
-            for (auto& cell : charRow)
+            for (size_t column = 0; column < charRow.size(); ++column)
             {
-                cell.Char() = L' ';
+                charRow.ClearGlyph(column);
             }
         }
 
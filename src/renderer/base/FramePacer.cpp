@@ -0,0 +1,167 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "FramePacer.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates a new pacer.
+// Arguments:
+// - clock - tells the current time. Tests pass a fake one.
+FramePacer::FramePacer(Clock clock) :
+    _clock{ std::move(clock) }
+{
+}
+
+// Routine Description:
+// - Notes that the render thread was asked to paint. Only the first request
+//      since the last frame started counts, since it's the one waiting the
+//      longest. Called on the thread that made the request.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void FramePacer::FrameRequested() noexcept
+{
+    std::lock_guard<std::mutex> lock{ _lock };
+    if (!_requestTime)
+    {
+        _requestTime = _clock();
+    }
+}
+
+// Routine Description:
+// - Notes that a paint request arrived while the render thread waited for the
+//      next frame, so the frame will paint it as well.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void FramePacer::RequestCoalesced() noexcept
+{
+    std::lock_guard<std::mutex> lock{ _lock };
+    ++_statistics.coalescedRequests;
+}
+
+// Routine Description:
+// - Tells how long the render thread should wait before it paints the next
+//      frame. If the last frame started long enough ago, which is always the
+//      case after the console was idle, that's not at all.
+// Arguments:
+// - <none>
+// Return Value:
+// - The time to wait.
+std::chrono::nanoseconds FramePacer::NextFrameDelay() const noexcept
+{
+    if (!_frameStart)
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+
+    const auto elapsed = _clock() - *_frameStart;
+    const auto interval = _FrameInterval();
+    return elapsed < interval ? interval - elapsed : std::chrono::nanoseconds::zero();
+}
+
+// Routine Description:
+// - Notes that the render thread started to paint a frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void FramePacer::FrameStarted() noexcept
+{
+    _frameStart = _clock();
+
+    // Requests that arrive from now on are presented by the next frame.
+    std::lock_guard<std::mutex> lock{ _lock };
+    _frameRequestTime = _requestTime.value_or(*_frameStart);
+    _requestTime.reset();
+}
+
+// Routine Description:
+// - Notes that the frame wasn't presented, because the application is drawing
+//      a frame in synchronized output mode. The requests it should have
+//      presented keep waiting for the next frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void FramePacer::FrameHeldBack() noexcept
+{
+    std::lock_guard<std::mutex> lock{ _lock };
+    _requestTime = _frameRequestTime;
+}
+
+// Routine Description:
+// - Notes that the render thread finished painting the frame, and measures it.
+// Arguments:
+// - dirtyFraction - how much of the viewport the frame repainted, from 0 to 1.
+// Return Value:
+// - <none>
+void FramePacer::FrameCompleted(const double dirtyFraction) noexcept
+{
+    if (!_frameStart)
+    {
+        return;
+    }
+
+    const auto now = _clock();
+    const auto paintTime = now - *_frameStart;
+    const auto latency = now - _frameRequestTime;
+    _dirtyFraction = std::clamp(dirtyFraction, 0.0, 1.0);
+
+    const auto bucket = std::find_if(LatencyBuckets.begin(), LatencyBuckets.end(), [&](const auto bound) { return latency <= bound; });
+
+    std::lock_guard<std::mutex> lock{ _lock };
+
+    // The average follows the recent frames, so that it catches up quickly
+    // when the output of an application changes.
+    auto& average = _statistics.averagePaintTime;
+    average = _statistics.frames == 0 ? paintTime : average + (paintTime - average) / 4;
+
+    ++_statistics.frames;
+    _statistics.lastPaintTime = paintTime;
+    _statistics.maxPaintTime = std::max(_statistics.maxPaintTime, paintTime);
+    _statistics.lastLatency = latency;
+    _statistics.maxLatency = std::max(_statistics.maxLatency, latency);
+    ++til::at(_statistics.latencyHistogram, gsl::narrow_cast<size_t>(std::distance(LatencyBuckets.begin(), bucket)));
+}
+
+// Routine Description:
+// - Returns the statistics of the frames painted so far.
+// Arguments:
+// - <none>
+// Return Value:
+// - The statistics of the frames.
+FramePacer::Statistics FramePacer::GetStatistics() const noexcept
+{
+    std::lock_guard<std::mutex> lock{ _lock };
+    return _statistics;
+}
+
+// Routine Description:
+// - Tells how far apart the starts of two frames should be at least.
+// - Frames that repaint little of the viewport, like the echo of a key press or
+//      a moving cursor, are painted as often as MinFrameInterval allows, to
+//      keep the latency low. The more of the viewport a frame repaints, like
+//      when an application prints a lot of output and the viewport scrolls,
+//      the more of the following output we fold into the next frame instead.
+// - Either way, the render thread shouldn't be painting for more than half of
+//      the time, since it holds the console lock while it paints and would
+//      otherwise slow down the application writing the output.
+// Arguments:
+// - <none>
+// Return Value:
+// - The interval between the frames.
+std::chrono::nanoseconds FramePacer::_FrameInterval() const noexcept
+{
+    const auto range = std::chrono::duration_cast<std::chrono::nanoseconds>(MaxFrameInterval - MinFrameInterval);
+    const auto interval = MinFrameInterval + std::chrono::nanoseconds{ static_cast<int64_t>(range.count() * _dirtyFraction) };
+    return std::min<std::chrono::nanoseconds>(std::max(interval, _statistics.averagePaintTime * 2), MaxFrameInterval);
+}
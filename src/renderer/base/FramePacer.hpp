@@ -0,0 +1,64 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- FramePacer.hpp
+
+Abstract:
+- Decides how long the render thread waits before painting the next frame.
+- The first frame after the console was idle is painted right away. Under
+    sustained output, the render thread waits between frames so that it folds
+    the following output into a single frame. The more of the viewport the
+    last frame repainted and the longer it took to paint, the longer it waits.
+- Also keeps the statistics of the frames, to tell how long the output of an
+    application takes to show up on the screen.
+--*/
+
+#pragma once
+
+#include "../inc/IRenderThread.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class FramePacer final
+    {
+    public:
+        using Clock = std::function<std::chrono::steady_clock::time_point()>;
+
+        using Statistics = FrameStatistics;
+        static constexpr auto& LatencyBuckets = FrameStatistics::LatencyBuckets;
+
+        // Frames that repaint next to nothing are painted at most this often.
+        static constexpr std::chrono::milliseconds MinFrameInterval{ 8 };
+        // Frames are never held back for longer than this.
+        static constexpr std::chrono::milliseconds MaxFrameInterval{ 32 };
+
+        FramePacer(Clock clock = std::chrono::steady_clock::now);
+
+        void FrameRequested() noexcept;
+        void RequestCoalesced() noexcept;
+        [[nodiscard]] std::chrono::nanoseconds NextFrameDelay() const noexcept;
+        void FrameStarted() noexcept;
+        void FrameHeldBack() noexcept;
+        void FrameCompleted(const double dirtyFraction) noexcept;
+
+        Statistics GetStatistics() const noexcept;
+
+    private:
+        std::chrono::nanoseconds _FrameInterval() const noexcept;
+
+        const Clock _clock;
+
+        std::optional<std::chrono::steady_clock::time_point> _frameStart;
+        // The oldest request the frame being painted presents.
+        std::chrono::steady_clock::time_point _frameRequestTime;
+        double _dirtyFraction{ 0 };
+
+        mutable std::mutex _lock;
+        // The oldest request that no frame started to paint yet. Requests are
+        // made on any thread, so it's guarded by _lock.
+        std::optional<std::chrono::steady_clock::time_point> _requestTime;
+        Statistics _statistics{};
+    };
+}
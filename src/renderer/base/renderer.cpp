@@ -15,23 +15,30 @@ using PointTree = interval_tree::IntervalTree<til::point, size_t>;
 static constexpr auto maxRetriesForRenderEngine = 3;
 // The renderer will wait this number of milliseconds * how many tries have elapsed before trying again.
 static constexpr auto renderBackoffBaseTimeMilliseconds{ 150 };
+// An application that enabled synchronized output gets this long to finish its frame
+// before we paint it anyway, in case it never disables it, like when it crashed.
+static constexpr auto synchronizedOutputTimeout = std::chrono::milliseconds{ 150 };
 
 // Routine Description:
 // - Creates a new renderer controller for a console.
 // Arguments:
 // - pData - The interface to console data structures required for rendering
 // - pEngine - The output engine for targeting each rendering frame
+// - clock - Tells the time. Tests pass their own, to control the time.
 // Return Value:
 // - An instance of a Renderer.
 // NOTE: CAN THROW IF MEMORY ALLOCATION FAILS.
 Renderer::Renderer(IRenderData* pData,
                    _In_reads_(cEngines) IRenderEngine** const rgpEngines,
                    const size_t cEngines,
-                   std::unique_ptr<IRenderThread> thread) :
+                   std::unique_ptr<IRenderThread> thread,
+                   FramePacer::Clock clock) :
     _pData(THROW_HR_IF_NULL(E_INVALIDARG, pData)),
     _pThread{ std::move(thread) },
     _destructing{ false },
+    _clock{ std::move(clock) },
     _clusterBuffer{},
+    _patternSpans{},
     _viewport{ pData->GetViewport() }
 {
     for (size_t i = 0; i < cEngines; i++)
@@ -67,6 +74,9 @@ Renderer::~Renderer()
         return S_FALSE;
     }
 
+    _lastFrameDirtyFraction = 0;
+    _lastFrameHeldBack = false;
+
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         auto tries = maxRetriesForRenderEngine;
@@ -106,6 +116,43 @@ Renderer::~Renderer()
     return S_OK;
 }
 
+// Routine Description:
+// - Tells how much of the viewport the last frame repainted, so that the render
+//      thread can wait longer for the next frame when it repaints a lot.
+// Arguments:
+// - <none>
+// Return Value:
+// - The repainted fraction of the viewport, from 0 to 1, for the engine that
+//      repainted the most of it.
+double Renderer::GetLastFrameDirtyFraction() const noexcept
+{
+    return _lastFrameDirtyFraction;
+}
+
+// Routine Description:
+// - Tells whether the last frame was held back, because the application is
+//      drawing a frame in synchronized output mode. Nothing was presented then.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if the last frame wasn't presented.
+bool Renderer::WasLastFrameHeldBack() const noexcept
+{
+    return _lastFrameHeldBack;
+}
+
+// Routine Description:
+// - Returns how long the frames took to paint, and how long the output took
+//      to show up on the screen.
+// Arguments:
+// - <none>
+// Return Value:
+// - The statistics of the render thread, or empty ones if there is none.
+FrameStatistics Renderer::GetFrameStatistics() const noexcept
+{
+    return _pThread ? _pThread->GetFrameStatistics() : FrameStatistics{};
+}
+
 [[nodiscard]] HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept
 try
 {
@@ -116,6 +163,17 @@ try
         _pData->UnlockConsole();
     });
 
+    // While the application draws a frame in synchronized output mode, the
+    // engine keeps collecting what it invalidates, so that the whole frame is
+    // painted at once when the application is done. Come back later to check
+    // whether it took too long.
+    if (_IsSynchronizingOutput())
+    {
+        _lastFrameHeldBack = true;
+        _NotifyPaintFrame();
+        return S_OK;
+    }
+
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
@@ -141,6 +199,17 @@ try
     // B. Perform Scroll Operations
     RETURN_IF_FAILED(_PerformScrolling(pEngine));
 
+    // Measure how much of the viewport we're about to repaint.
+    if (const auto viewportArea = til::size{ _viewport.Dimensions() }.area(); viewportArea > 0)
+    {
+        ptrdiff_t dirtyArea = 0;
+        for (const auto& rect : pEngine->GetDirtyArea())
+        {
+            dirtyArea += rect.size().area();
+        }
+        _lastFrameDirtyFraction = std::max(_lastFrameDirtyFraction, std::min(1.0, static_cast<double>(dirtyArea) / viewportArea));
+    }
+
     // C. Prepare the engine with additional information before we start drawing.
     RETURN_IF_FAILED(_PrepareRenderInfo(pEngine));
 
@@ -186,6 +255,24 @@ void Renderer::_NotifyPaintFrame()
     }
 }
 
+// Routine Description:
+// - Tells whether the application is drawing a frame in synchronized output
+//      mode. If it's been at it for longer than synchronizedOutputTimeout, it
+//      isn't anymore.
+// - NOTE: Must be called with the console locked.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if painting should wait for the application to finish its frame.
+bool Renderer::_IsSynchronizingOutput() noexcept
+{
+    if (_synchronizedOutputStart && _clock() - *_synchronizedOutputStart >= synchronizedOutputTimeout)
+    {
+        _synchronizedOutputStart.reset();
+    }
+    return _synchronizedOutputStart.has_value();
+}
+
 // Routine Description:
 // - Called when the system has requested we redraw a portion of the console.
 // Arguments:
@@ -295,6 +382,9 @@ void Renderer::TriggerTeardown()
     // We need to shut down the paint thread on teardown.
     _pThread->WaitForPaintCompletionAndDisable(INFINITE);
 
+    // The final frame can't wait for the application anymore.
+    _synchronizedOutputStart.reset();
+
     // Then walk through and do one final paint on the caller's thread.
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
@@ -467,6 +557,34 @@ void Renderer::TriggerTitleChange()
     _NotifyPaintFrame();
 }
 
+// Routine Description:
+// - Called when the application enables or disables synchronized output
+//      (DECSET 2026). While it's enabled, invalidations pile up in the engines
+//      without being painted. Once it's disabled, everything the application
+//      drew in the meantime is painted in a single frame.
+// - NOTE: Must be called with the console locked.
+// Arguments:
+// - enabled - true when the application starts drawing a frame, false when
+//      it's done.
+// Return Value:
+// - <none>
+void Renderer::SetSynchronizedOutput(const bool enabled)
+{
+    if (enabled)
+    {
+        // Enabling it again doesn't buy the application more time.
+        if (!_synchronizedOutputStart)
+        {
+            _synchronizedOutputStart = _clock();
+        }
+    }
+    else if (_synchronizedOutputStart)
+    {
+        _synchronizedOutputStart.reset();
+        _NotifyPaintFrame();
+    }
+}
+
 // Routine Description:
 // - Update the title for a particular engine.
 // Arguments:
@@ -654,18 +772,18 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
                 // This means that we need 14,27 out of the backing buffer to fill in the 1,1 cell of the screen.
                 const auto screenLine = Viewport::Offset(bufferLine, -view.Origin());
 
-                // Retrieve the cell information iterator limited to just this line we want to redraw.
-                auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
+                // Retrieve the row of the buffer we want to redraw part of.
+                const auto& bufferRow = buffer.GetRowByOffset(bufferLine.Origin().Y);
 
                 // Calculate if two things are true:
                 // 1. this row wrapped
                 // 2. We're painting the last col of the row.
                 // In that case, set lineWrapped=true for the _PaintBufferOutputHelper call.
-                const auto lineWrapped = (buffer.GetRowByOffset(bufferLine.Origin().Y).GetCharRow().WasWrapForced()) &&
+                const auto lineWrapped = (bufferRow.GetCharRow().WasWrapForced()) &&
                                          (bufferLine.RightExclusive() == buffer.GetSize().Width());
 
                 // Ask the helper to paint through this specific line.
-                _PaintBufferOutputHelper(pEngine, it, screenLine.Origin(), lineWrapped);
+                _PaintBufferOutputHelper(pEngine, bufferRow, bufferLine.Left(), bufferLine.RightExclusive(), screenLine.Origin(), lineWrapped);
             }
         }
     }
@@ -677,32 +795,81 @@ static bool _IsAllSpaces(const std::wstring_view v)
     return v.find_first_not_of(L" ") == decltype(v)::npos;
 }
 
+// Routine Description:
+// - Paint helper for one line of the buffer. Splits the given columns of the
+//      row into runs that can be drawn with the same brushes, and hands each
+//      run to the engine as clusters.
+// - The clusters are sliced out of a snapshot of the row, so that building
+//      them doesn't need to go through the cells of the row one view at a time.
+// Arguments:
+// - row - the row of the text buffer to paint
+// - startColumn - the first column of the row to paint
+// - endColumn - the column of the row to stop painting at (exclusive)
+// - target - the position on the screen to paint the first column at
+// - lineWrapped - whether the row wrapped, and we're painting its last column
+// Return Value:
+// - <none>
 void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
+                                        const ROW& row,
+                                        const size_t startColumn,
+                                        const size_t endColumn,
                                         const COORD target,
                                         const bool lineWrapped)
 {
     auto globalInvert{ _pData->IsScreenReversed() };
 
+    const auto snapshot = row.GetSnapshot();
+    const auto end = std::min(endColumn, snapshot.chars.size());
+
     // If we have valid data, let's figure out how to draw it.
-    if (it)
+    if (startColumn < end)
     {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
+        // Walk the attribute runs of the row alongside the columns. The
+        // columns never go backwards, so we never have to start over.
+        auto attrRun = snapshot.attrRuns.begin();
+        size_t attrRunEnd = attrRun->length;
+        const auto attrAt = [&](const size_t index) -> const TextAttribute& {
+            while (attrRunEnd <= index && attrRun + 1 != snapshot.attrRuns.end())
+            {
+                ++attrRun;
+                attrRunEnd += attrRun->length;
+            }
+            return til::at(snapshot.attrs, attrRun->attrIndex);
+        };
+
+        size_t bufferColumn = startColumn;
         size_t cols = 0;
 
         // Retrieve the first color.
-        auto color = it->TextAttr();
-        // Retrieve the first pattern id
-        auto patternIds = _pData->GetPatternId(target);
+        auto color = attrAt(bufferColumn);
+        // Retrieve the pattern spans of this row once, then walk them
+        // alongside the cells. Columns only go backwards when we back up to
+        // paint the trailing half of a wide character, so we rarely need to
+        // start over from the first span.
+        _pData->GetPatternSpans(target.Y, _patternSpans);
+        auto span = _patternSpans.cbegin();
+        auto lastColumn = target.X;
+        const auto patternSpanAt = [&](const SHORT column) -> const PatternSpan* {
+            if (column < lastColumn)
+            {
+                span = _patternSpans.cbegin();
+            }
+            lastColumn = column;
+            while (span != _patternSpans.cend() && span->end <= column)
+            {
+                ++span;
+            }
+            return span != _patternSpans.cend() && span->start <= column ? &*span : nullptr;
+        };
+
+        // Retrieve the first pattern span
+        auto patternSpan = patternSpanAt(target.X);
 
         // And hold the point where we should start drawing.
         auto screenPoint = target;
 
         // This outer loop will continue until we reach the end of the text we are trying to draw.
-        while (it)
+        while (bufferColumn < end)
         {
             // Hold onto the current run color right here for the length of the outer loop.
             // We'll be changing the persistent one as we run through the inner loops to detect
@@ -710,9 +877,6 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // when we go to draw gridlines for the length of the run.
             const auto currentRunColor = color;
 
-            // Hold onto the current pattern id as well
-            const auto currentPatternId = patternIds;
-
             // Update the drawing brushes with our color.
             THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, false));
 
@@ -720,9 +884,11 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             screenPoint.X += gsl::narrow<SHORT>(cols);
             cols = 0;
 
-            // Hold onto the start of this run iterator and the target location where we started
+            // Hold onto the start of this run and the target location where we started
             // in case we need to do some special work to paint the line drawing characters.
-            const auto currentRunItStart = it;
+            const auto currentRunColumnStart = bufferColumn;
+            const auto currentRunAttrRun = attrRun;
+            const auto currentRunAttrRunEnd = attrRunEnd;
             const auto currentRunTargetStart = screenPoint;
 
             // Ensure that our cluster vector is clear.
@@ -741,54 +907,51 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // We also accumulate clusters according to regex patterns
             do
             {
-                COORD thisPoint{ screenPoint.X + gsl::narrow<SHORT>(cols), screenPoint.Y };
-                const auto thisPointPatterns = _pData->GetPatternId(thisPoint);
-                if (color != it->TextAttr() || patternIds != thisPointPatterns)
+                const auto thisPointPatterns = patternSpanAt(screenPoint.X + gsl::narrow<SHORT>(cols));
+                const auto& attr = attrAt(bufferColumn);
+                const auto glyph = snapshot.GlyphAt(bufferColumn);
+                if (color != attr || patternSpan != thisPointPatterns)
                 {
-                    auto newAttr{ it->TextAttr() };
                     // foreground doesn't matter for runs of spaces (!)
                     // if we trick it . . . we call Paint far fewer times for cmatrix
-                    if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || patternIds != thisPointPatterns)
+                    if (!_IsAllSpaces(glyph) || !attr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || patternSpan != thisPointPatterns)
                     {
-                        color = newAttr;
-                        patternIds = thisPointPatterns;
+                        color = attr;
+                        patternSpan = thisPointPatterns;
                         break; // vend this run
                     }
                 }
 
-                // Walk through the text data and turn it into rendering clusters.
+                // Turn the cell into a rendering cluster.
                 // Keep the columnCount as we go to improve performance over digging it out of the vector at the end.
-                size_t columnCount = 0;
+                const auto dbcsAttr = til::at(snapshot.dbcsAttrs, bufferColumn);
+                const size_t columns = dbcsAttr.IsLeading() ? 2 : 1;
+                size_t columnCount = columns;
 
                 // If we're on the first cluster to be added and it's marked as "trailing"
                 // (a.k.a. the right half of a two column character), then we need some special handling.
-                if (_clusterBuffer.empty() && it->DbcsAttr().IsTrailing())
+                if (_clusterBuffer.empty() && dbcsAttr.IsTrailing())
                 {
                     // Move left to the one so the whole character can be struck correctly.
                     --screenPoint.X;
                     // And tell the next function to trim off the left half of it.
                     trimLeft = true;
                     // And add one to the number of columns we expect it to take as we insert it.
-                    columnCount = it->Columns() + 1;
-                    _clusterBuffer.emplace_back(it->Chars(), columnCount);
-                }
-                // Otherwise if it's not a special case, just insert it as is.
-                else
-                {
-                    columnCount = it->Columns();
-                    _clusterBuffer.emplace_back(it->Chars(), columnCount);
+                    columnCount = columns + 1;
                 }
 
+                _clusterBuffer.emplace_back(glyph, columnCount);
+
                 if (columnCount > 1)
                 {
                     containsWideCharacter = true;
                 }
 
-                // Advance the cluster and column counts.
-                it += std::max<size_t>(it->Columns(), 1); // prevent infinite loop for no visible columns
+                // Advance the column and the column count.
+                bufferColumn += columns;
                 cols += columnCount;
 
-            } while (it);
+            } while (bufferColumn < end);
 
             // Do the painting.
             THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped));
@@ -802,22 +965,24 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 // attribute that could have contained different line information than the left half.
                 if (containsWideCharacter)
                 {
-                    // Start from the original position in this run.
-                    auto lineIt = currentRunItStart;
-                    // Start from the original target in this run.
-                    auto lineTarget = currentRunTargetStart;
-
-                    // We need to go through the iterators again to ensure we get the lines associated with each
-                    // exact column. The code above will condense two-column characters into one, but it is possible
+                    // The code above condenses two-column characters into one, but it is possible
                     // (like with the IME) that the line drawing characters will vary from the left to right half
-                    // of a wider character.
-                    // We could theoretically pre-pass for this in the loop above to be more efficient about walking
-                    // the iterator, but I fear it would make the code even more confusing than it already is.
-                    // Do that in the future if some WPR trace points you to this spot as super bad.
-                    for (auto colsPainted = 0u; colsPainted < cols; ++colsPainted, ++lineIt, ++lineTarget.X)
+                    // of a wider character. So paint the lines of every attribute run the columns of this
+                    // run overlap in bulk, starting over from the attribute run we started this run in.
+                    auto lineRun = currentRunAttrRun;
+                    auto lineRunEnd = currentRunAttrRunEnd;
+                    const auto lineEnd = std::min(currentRunColumnStart + cols, end);
+                    for (auto lineColumn = currentRunColumnStart; lineColumn < lineEnd;)
                     {
-                        auto lines = lineIt->TextAttr();
-                        _PaintBufferOutputGridLineHelper(pEngine, lines, 1, lineTarget);
+                        while (lineRunEnd <= lineColumn && lineRun + 1 != snapshot.attrRuns.end())
+                        {
+                            ++lineRun;
+                            lineRunEnd += lineRun->length;
+                        }
+                        const auto lineCount = std::min(lineRunEnd, lineEnd) - lineColumn;
+                        const COORD lineTarget{ currentRunTargetStart.X + gsl::narrow<SHORT>(lineColumn - currentRunColumnStart), currentRunTargetStart.Y };
+                        _PaintBufferOutputGridLineHelper(pEngine, til::at(snapshot.attrs, lineRun->attrIndex), lineCount, lineTarget);
+                        lineColumn += lineCount;
                     }
                 }
                 else
@@ -1051,9 +1216,9 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
                     const COORD target{ viewDirty.Left(), iRow };
                     const auto source = target - overlay.origin;
 
-                    auto it = overlay.buffer.GetCellLineDataAt(source);
+                    const auto& row = overlay.buffer.GetRowByOffset(source.Y);
 
-                    _PaintBufferOutputHelper(&engine, it, target, false);
+                    _PaintBufferOutputHelper(&engine, row, source.X, row.size(), target, false);
                 }
             }
         }
@@ -33,7 +33,8 @@ namespace Microsoft::Console::Render
         Renderer(IRenderData* pData,
                  _In_reads_(cEngines) IRenderEngine** const pEngine,
                  const size_t cEngines,
-                 std::unique_ptr<IRenderThread> thread);
+                 std::unique_ptr<IRenderThread> thread,
+                 FramePacer::Clock clock = std::chrono::steady_clock::now);
 
         [[nodiscard]] static HRESULT s_CreateInstance(IRenderData* pData,
                                                       _In_reads_(cEngines) IRenderEngine** const rgpEngines,
@@ -46,6 +47,9 @@ namespace Microsoft::Console::Render
         virtual ~Renderer() override;
 
         [[nodiscard]] HRESULT PaintFrame();
+        double GetLastFrameDirtyFraction() const noexcept override;
+        bool WasLastFrameHeldBack() const noexcept override;
+        FrameStatistics GetFrameStatistics() const noexcept override;
 
         void TriggerSystemRedraw(const RECT* const prcDirtyClient) override;
         void TriggerRedraw(const Microsoft::Console::Types::Viewport& region) override;
@@ -60,6 +64,7 @@ namespace Microsoft::Console::Render
 
         void TriggerCircling() override;
         void TriggerTitleChange() override;
+        void SetSynchronizedOutput(const bool enabled) override;
 
         void TriggerFontChange(const int iDpi,
                                const FontInfoDesired& FontInfoDesired,
@@ -89,10 +94,18 @@ namespace Microsoft::Console::Render
 
         std::unique_ptr<IRenderThread> _pThread;
         bool _destructing = false;
+        double _lastFrameDirtyFraction = 0;
+        bool _lastFrameHeldBack = false;
+
+        // Tells the time for the synchronized output timeout.
+        const FramePacer::Clock _clock;
+        // When the application enabled synchronized output, if it's enabled.
+        std::optional<std::chrono::steady_clock::time_point> _synchronizedOutputStart;
 
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _hoveredInterval;
 
         void _NotifyPaintFrame();
+        bool _IsSynchronizingOutput() noexcept;
 
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
 
@@ -103,7 +116,9 @@ namespace Microsoft::Console::Render
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
 
         void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                      TextBufferCellIterator it,
+                                      const ROW& row,
+                                      const size_t startColumn,
+                                      const size_t endColumn,
                                       const COORD target,
                                       const bool lineWrapped);
 
@@ -128,6 +143,7 @@ namespace Microsoft::Console::Render
 
         static constexpr float _shrinkThreshold = 0.8f;
         std::vector<Cluster> _clusterBuffer;
+        std::vector<PatternSpan> _patternSpans;
 
         std::vector<SMALL_RECT> _GetSelectionRects() const;
         void _ScrollPreviousSelection(const til::point delta);
@@ -199,18 +199,40 @@ DWORD WINAPI RenderThread::_ThreadProc()
             ResetEvent(_hEvent);
         }
 
+        // If we painted only just now, give the application a moment to write
+        // more output, so that we paint all of it in a single frame. After the
+        // console was idle, we don't wait at all.
+        const auto delay = _pacer.NextFrameDelay();
+        if (delay > std::chrono::nanoseconds::zero() && _fKeepRunning)
+        {
+            Sleep(gsl::narrow_cast<DWORD>(std::chrono::ceil<std::chrono::milliseconds>(delay).count()));
+
+            // Painting may have been disabled while we waited.
+            WaitForSingleObject(_hPaintEnabledEvent, INFINITE);
+        }
+
         ResetEvent(_hPaintCompletedEvent);
 
         _pRenderer->WaitUntilCanRender();
-        LOG_IF_FAILED(_pRenderer->PaintFrame());
 
-        SetEvent(_hPaintCompletedEvent);
+        // This frame paints everything that was requested while we waited.
+        if (_fNextFrameRequested.exchange(false, std::memory_order_acq_rel))
+        {
+            _pacer.RequestCoalesced();
+        }
 
-        // extra check before we sleep since it's a "long" activity, relatively speaking.
-        if (_fKeepRunning)
+        _pacer.FrameStarted();
+        LOG_IF_FAILED(_pRenderer->PaintFrame());
+        if (_pRenderer->WasLastFrameHeldBack())
         {
-            Sleep(s_FrameLimitMilliseconds);
+            _pacer.FrameHeldBack();
         }
+        else
+        {
+            _pacer.FrameCompleted(_pRenderer->GetLastFrameDirtyFraction());
+        }
+
+        SetEvent(_hPaintCompletedEvent);
     }
 
     return S_OK;
@@ -218,6 +240,9 @@ DWORD WINAPI RenderThread::_ThreadProc()
 
 void RenderThread::NotifyPaint()
 {
+    // The latency of a frame counts from the time the output was written.
+    _pacer.FrameRequested();
+
     if (_fWaiting.load(std::memory_order_acquire))
     {
         SetEvent(_hEvent);
@@ -228,6 +253,18 @@ void RenderThread::NotifyPaint()
     }
 }
 
+// Method Description:
+// - Returns how long the frames took to paint, and how long the output took
+//      to show up on the screen.
+// Arguments:
+// - <none>
+// Return Value:
+// - The statistics of the frames painted so far.
+FrameStatistics RenderThread::GetFrameStatistics() const noexcept
+{
+    return _pacer.GetStatistics();
+}
+
 void RenderThread::EnablePainting()
 {
     SetEvent(_hPaintEnabledEvent);
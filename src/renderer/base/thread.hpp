@@ -16,6 +16,7 @@ Author(s):
 
 #include "../inc/IRenderer.hpp"
 #include "../inc/IRenderThread.hpp"
+#include "FramePacer.hpp"
 
 namespace Microsoft::Console::Render
 {
@@ -33,12 +34,12 @@ namespace Microsoft::Console::Render
         void DisablePainting() override;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) override;
 
+        FrameStatistics GetFrameStatistics() const noexcept override;
+
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
 
-        static DWORD const s_FrameLimitMilliseconds = 8;
-
         HANDLE _hThread;
         HANDLE _hEvent;
 
@@ -50,5 +51,7 @@ namespace Microsoft::Console::Render
         bool _fKeepRunning;
         std::atomic<bool> _fNextFrameRequested;
         std::atomic<bool> _fWaiting;
+
+        FramePacer _pacer;
     };
 }
@@ -37,6 +37,16 @@ namespace Microsoft::Console::Render
         const Microsoft::Console::Types::Viewport region;
     };
 
+    // A run of cells within a row that are all covered by the same regex patterns.
+    struct PatternSpan final
+    {
+        // The first column of the run, and the column right after it.
+        SHORT start;
+        SHORT end;
+
+        std::vector<size_t> patternIds;
+    };
+
     class IRenderData : public Microsoft::Console::Types::IBaseData
     {
     public:
@@ -70,6 +80,7 @@ namespace Microsoft::Console::Render
         virtual const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept = 0;
 
         virtual const std::vector<size_t> GetPatternId(const COORD location) const noexcept = 0;
+        virtual void GetPatternSpans(const SHORT row, std::vector<PatternSpan>& spans) const = 0;
 
     protected:
         IRenderData() = default;
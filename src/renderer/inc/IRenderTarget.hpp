@@ -45,6 +45,11 @@ namespace Microsoft::Console::Render
         virtual void TriggerScroll(const COORD* const pcoordDelta) = 0;
         virtual void TriggerCircling() = 0;
         virtual void TriggerTitleChange() = 0;
+
+        // While synchronized output is enabled, the output is only painted
+        // once it's disabled again, so that the application's frames aren't
+        // painted half-finished.
+        virtual void SetSynchronizedOutput(const bool enabled) = 0;
     };
 
     inline Microsoft::Console::Render::IRenderTarget::~IRenderTarget() {}
@@ -15,6 +15,36 @@ Author(s):
 #pragma once
 namespace Microsoft::Console::Render
 {
+    // How long the frames took to paint, and how long the output took to show
+    // up on the screen.
+    struct FrameStatistics
+    {
+        // The frames are sorted into these buckets by their latency. The last
+        // bucket of the histogram holds all frames slower than the last bound.
+        static constexpr std::array<std::chrono::milliseconds, 5> LatencyBuckets{
+            std::chrono::milliseconds{ 4 },
+            std::chrono::milliseconds{ 8 },
+            std::chrono::milliseconds{ 16 },
+            std::chrono::milliseconds{ 33 },
+            std::chrono::milliseconds{ 66 },
+        };
+
+        // The frames that were presented. Frames held back by synchronized
+        // output don't count.
+        uint64_t frames;
+        // The number of paint requests that arrived while the render
+        // thread waited for the next frame, and were painted with it.
+        uint64_t coalescedRequests;
+        std::chrono::nanoseconds lastPaintTime;
+        std::chrono::nanoseconds averagePaintTime;
+        std::chrono::nanoseconds maxPaintTime;
+        // The time from a paint request to the end of the frame that
+        // presented it.
+        std::chrono::nanoseconds lastLatency;
+        std::chrono::nanoseconds maxLatency;
+        std::array<uint64_t, LatencyBuckets.size() + 1> latencyHistogram;
+    };
+
     class IRenderThread
     {
     public:
@@ -28,6 +58,7 @@ namespace Microsoft::Console::Render
         virtual void EnablePainting() = 0;
         virtual void DisablePainting() = 0;
         virtual void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) = 0;
+        virtual FrameStatistics GetFrameStatistics() const noexcept = 0;
 
     protected:
         IRenderThread() = default;
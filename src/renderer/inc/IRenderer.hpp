@@ -17,6 +17,7 @@ Author(s):
 #include "FontInfoDesired.hpp"
 #include "IRenderEngine.hpp"
 #include "IRenderTarget.hpp"
+#include "IRenderThread.hpp"
 #include "../types/inc/viewport.hpp"
 
 namespace Microsoft::Console::Render
@@ -31,6 +32,9 @@ namespace Microsoft::Console::Render
         IRenderer& operator=(IRenderer&&) = default;
 
         [[nodiscard]] virtual HRESULT PaintFrame() = 0;
+        virtual double GetLastFrameDirtyFraction() const noexcept = 0;
+        virtual bool WasLastFrameHeldBack() const noexcept = 0;
+        virtual FrameStatistics GetFrameStatistics() const noexcept = 0;
 
         virtual void TriggerSystemRedraw(const RECT* const prcDirtyClient) = 0;
 
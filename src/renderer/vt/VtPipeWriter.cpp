@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "VtPipeWriter.hpp"
+
+#pragma hdrstop
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates a new writer for the given pipe, and starts its thread.
+// - NOTE: Will throw if the thread can't be started. Caller must catch.
+// Arguments:
+// - pipe - the pipe to write to. The caller keeps ownership of it, and must
+//      keep it open for the lifetime of the writer.
+VtPipeWriter::VtPipeWriter(const HANDLE pipe) :
+    _pipe{ pipe },
+    _thread{ [this]() { _Run(); } }
+{
+}
+
+// Routine Description:
+// - Writes all of the output that's still waiting for the pipe, then stops the
+//      thread of the writer.
+VtPipeWriter::~VtPipeWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock{ _lock };
+        _stopping = true;
+    }
+    _pendingChanged.notify_one();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+// Routine Description:
+// - Hands the given output over to the thread of the writer. The buffer is
+//      swapped for an empty one when possible, so the output isn't copied.
+//      Only if the previous output is still waiting for the pipe, the new
+//      output is appended to it.
+// - If too much output is waiting for the pipe already, this waits for the
+//      terminal to catch up first.
+// Arguments:
+// - buffer - the output to write. It's empty when this returns.
+// Return Value:
+// - S_OK, or the error that writing the pipe failed with before.
+[[nodiscard]] HRESULT VtPipeWriter::Write(std::string& buffer) noexcept
+try
+{
+    if (buffer.empty())
+    {
+        return S_OK;
+    }
+
+    std::unique_lock<std::mutex> lock{ _lock };
+
+    if (_pending.size() >= MaxPendingBytes && SUCCEEDED(_result))
+    {
+        const auto start = std::chrono::steady_clock::now();
+        _writeCompleted.wait(lock, [&]() { return _pending.size() < MaxPendingBytes || FAILED(_result); });
+        _statistics.blockedTime += std::chrono::steady_clock::now() - start;
+    }
+
+    if (FAILED(_result))
+    {
+        buffer.clear();
+        return _result;
+    }
+
+    ++_statistics.writes;
+    if (_pending.empty())
+    {
+        // What we get back is the buffer the thread wrote last, which is
+        // empty but likely large enough for our next frame already.
+        _pending.swap(buffer);
+    }
+    else
+    {
+        ++_statistics.coalescedWrites;
+        _pending.append(buffer);
+        buffer.clear();
+    }
+    _statistics.maxPendingBytes = std::max(_statistics.maxPendingBytes, _pending.size());
+
+    lock.unlock();
+    _pendingChanged.notify_one();
+
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Waits until all of the output that was handed to the writer so far has
+//      been written to the pipe.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or the error that writing the pipe failed with.
+[[nodiscard]] HRESULT VtPipeWriter::Drain() noexcept
+try
+{
+    std::unique_lock<std::mutex> lock{ _lock };
+
+    const auto start = std::chrono::steady_clock::now();
+    _writeCompleted.wait(lock, [&]() { return (_pending.empty() && !_writing) || FAILED(_result); });
+    _statistics.blockedTime += std::chrono::steady_clock::now() - start;
+
+    return _result;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Returns how much the terminal held up our output so far.
+// Arguments:
+// - <none>
+// Return Value:
+// - The statistics of the writer.
+VtPipeWriter::Statistics VtPipeWriter::GetStatistics() const noexcept
+{
+    std::lock_guard<std::mutex> lock{ _lock };
+    return _statistics;
+}
+
+// Routine Description:
+// - The thread of the writer. Writes the pending output to the pipe, until
+//      we're asked to stop and there's nothing left to write, or writing the
+//      pipe fails.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtPipeWriter::_Run() noexcept
+{
+    std::string writing;
+
+    std::unique_lock<std::mutex> lock{ _lock };
+    while (true)
+    {
+        _pendingChanged.wait(lock, [&]() { return !_pending.empty() || _stopping; });
+        if (_pending.empty())
+        {
+            break;
+        }
+
+        // Take the pending output, and leave our empty buffer in its place.
+        writing.swap(_pending);
+        _writing = true;
+        lock.unlock();
+
+        DWORD written = 0;
+        const auto hr = WriteFile(_pipe, writing.data(), gsl::narrow_cast<DWORD>(writing.size()), &written, nullptr) ?
+                            S_OK :
+                            HRESULT_FROM_WIN32(GetLastError());
+        writing.clear();
+
+        lock.lock();
+        _writing = false;
+        if (SUCCEEDED(hr))
+        {
+            _statistics.bytesWritten += written;
+        }
+        else
+        {
+            // Nobody is going to read anything we write from now on.
+            _result = hr;
+            _pending.clear();
+        }
+        _writeCompleted.notify_all();
+
+        if (FAILED(hr))
+        {
+            break;
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- VtPipeWriter.hpp
+
+Abstract:
+- Writes the output of the VT renderer to its pipe on a thread of its own.
+    The render thread holds the console lock while it paints, so it mustn't
+    wait for a terminal that's slow to read its input.
+- The render thread hands over its whole buffer at once, by swapping it with
+    the writer's empty one. If the previous output is still waiting for the
+    pipe when the next one arrives, the two are coalesced into a single write.
+    Only once too much output is waiting, the render thread waits for the
+    terminal to catch up.
+--*/
+
+#pragma once
+
+#include <condition_variable>
+
+namespace Microsoft::Console::Render
+{
+    class VtPipeWriter final
+    {
+    public:
+        // How much the terminal is holding up our output.
+        struct Statistics
+        {
+            // The number of buffers handed to the writer.
+            uint64_t writes;
+            // The number of those buffers that were appended to output that
+            // was still waiting for the pipe.
+            uint64_t coalescedWrites;
+            uint64_t bytesWritten;
+            // The most output that was ever waiting for the pipe.
+            size_t maxPendingBytes;
+            // The time the render thread spent waiting for the pipe.
+            std::chrono::nanoseconds blockedTime;
+        };
+
+        // Once this much output is waiting for the pipe, Write waits for it.
+        static constexpr size_t MaxPendingBytes = 1024 * 1024;
+
+        VtPipeWriter(const HANDLE pipe);
+        ~VtPipeWriter();
+
+        VtPipeWriter(const VtPipeWriter&) = delete;
+        VtPipeWriter& operator=(const VtPipeWriter&) = delete;
+
+        [[nodiscard]] HRESULT Write(std::string& buffer) noexcept;
+        [[nodiscard]] HRESULT Drain() noexcept;
+
+        Statistics GetStatistics() const noexcept;
+
+    private:
+        void _Run() noexcept;
+
+        const HANDLE _pipe;
+
+        mutable std::mutex _lock;
+        std::condition_variable _pendingChanged;
+        std::condition_variable _writeCompleted;
+        std::string _pending;
+        bool _writing{ false };
+        bool _stopping{ false };
+        HRESULT _result{ S_OK };
+        Statistics _statistics{};
+
+        std::thread _thread;
+    };
+}
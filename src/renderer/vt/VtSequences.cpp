@@ -85,6 +85,19 @@ using namespace Microsoft::Console::Render;
     return _WriteFormattedString(&format, chars);
 }
 
+// Method Description:
+// - Repeats the last character we printed a number of times. The terminal
+//      prints it with the current attributes, as if we had written it again.
+// Arguments:
+// - chars: the number of times to repeat the character.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_RepeatCharacter(const short chars) noexcept
+{
+    static const std::string format = "\x1b[%db";
+    return _WriteFormattedString(&format, chars);
+}
+
 // Method Description:
 // - Moves the cursor forward (right) a number of characters.
 // Arguments:
@@ -193,18 +206,20 @@ using namespace Microsoft::Console::Render;
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the current text attributes to the default.
+// - Adds the parameter that resets the current text attributes to the default
+//      to the SGR sequence we're building.
 // Arguments:
 // <none>
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsDefault() noexcept
 {
-    return _Write("\x1b[m");
+    return _AppendGraphicsRendition(0);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the current text attributes.
+// - Adds the parameter that changes the current text color to the SGR sequence
+//      we're building.
 // Arguments:
 // - wAttr: Windows color table index to emit as a VT sequence
 // - fIsForeground: true if we should emit the foreground sequence, false for background
@@ -213,8 +228,6 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsRendition16Color(const WORD wAttr,
                                                              const bool fIsForeground) noexcept
 {
-    static const std::string fmt = "\x1b[%dm";
-
     // Always check using the foreground flags, because the bg flags constants
     //  are a higher byte
     // Foreground sequences are in [30,37] U [90,97]
@@ -227,19 +240,19 @@ using namespace Microsoft::Console::Render;
     //      terminals display the bright color when displaying bolded text.
     // By specifying the boldness and brightness separately, we'll make sure the
     //      terminal has an accurate representation of our buffer.
-    const int vtIndex = 30 +
-                        (fIsForeground ? 0 : 10) +
-                        ((WI_IsFlagSet(wAttr, FOREGROUND_INTENSITY)) ? 60 : 0) +
-                        (WI_IsFlagSet(wAttr, FOREGROUND_RED) ? 1 : 0) +
-                        (WI_IsFlagSet(wAttr, FOREGROUND_GREEN) ? 2 : 0) +
-                        (WI_IsFlagSet(wAttr, FOREGROUND_BLUE) ? 4 : 0);
+    const unsigned int vtIndex = 30 +
+                                 (fIsForeground ? 0 : 10) +
+                                 ((WI_IsFlagSet(wAttr, FOREGROUND_INTENSITY)) ? 60 : 0) +
+                                 (WI_IsFlagSet(wAttr, FOREGROUND_RED) ? 1 : 0) +
+                                 (WI_IsFlagSet(wAttr, FOREGROUND_GREEN) ? 2 : 0) +
+                                 (WI_IsFlagSet(wAttr, FOREGROUND_BLUE) ? 4 : 0);
 
-    return _WriteFormattedString(&fmt, vtIndex);
+    return _AppendGraphicsRendition(vtIndex);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the current text attributes to an
-//      indexed color from the 256-color table.
+// - Adds the parameters that change the current text color to an indexed color
+//      from the 256-color table to the SGR sequence we're building.
 // Arguments:
 // - wAttr: Windows color table index to emit as a VT sequence
 // - fIsForeground: true if we should emit the foreground sequence, false for background
@@ -248,16 +261,14 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsRendition256Color(const WORD index,
                                                               const bool fIsForeground) noexcept
 {
-    const std::string fmt = fIsForeground ?
-                                "\x1b[38;5;%dm" :
-                                "\x1b[48;5;%dm";
-
-    return _WriteFormattedString(&fmt, ::Xterm256ToWindowsIndex(index));
+    RETURN_IF_FAILED(_AppendGraphicsRendition(fIsForeground ? 38 : 48));
+    RETURN_IF_FAILED(_AppendGraphicsRendition(5));
+    return _AppendGraphicsRendition(::Xterm256ToWindowsIndex(index));
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the current text attributes to an
-//      RGB color.
+// - Adds the parameters that change the current text color to an RGB color to
+//      the SGR sequence we're building.
 // Arguments:
 // - color: The color to emit a VT sequence for
 // - fIsForeground: true if we should emit the foreground sequence, false for background
@@ -266,29 +277,94 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsRenditionRGBColor(const COLORREF color,
                                                               const bool fIsForeground) noexcept
 {
-    const std::string fmt = fIsForeground ?
-                                "\x1b[38;2;%d;%d;%dm" :
-                                "\x1b[48;2;%d;%d;%dm";
-
-    DWORD const r = GetRValue(color);
-    DWORD const g = GetGValue(color);
-    DWORD const b = GetBValue(color);
-
-    return _WriteFormattedString(&fmt, r, g, b);
+    RETURN_IF_FAILED(_AppendGraphicsRendition(fIsForeground ? 38 : 48));
+    RETURN_IF_FAILED(_AppendGraphicsRendition(2));
+    RETURN_IF_FAILED(_AppendGraphicsRendition(GetRValue(color)));
+    RETURN_IF_FAILED(_AppendGraphicsRendition(GetGValue(color)));
+    return _AppendGraphicsRendition(GetBValue(color));
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the current text attributes to the
-//      default foreground or background. Does not affect the boldness of text.
+// - Adds the parameter that changes the current text color to the default
+//      foreground or background to the SGR sequence we're building. Does not
+//      affect the boldness of text.
 // Arguments:
 // - fIsForeground: true if we should emit the foreground sequence, false for background
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsRenditionDefaultColor(const bool fIsForeground) noexcept
 {
-    const std::string_view fmt = fIsForeground ? ("\x1b[39m") : ("\x1b[49m");
+    return _AppendGraphicsRendition(fIsForeground ? 39 : 49);
+}
+
+// Method Description:
+// - Adds a parameter to the SGR sequence we're building. The callers collect
+//      every attribute and color that changed this way, and then write them
+//      all at once as a single sequence with _WriteGraphicsRendition.
+//   The parameters are formatted right into a fixed buffer, there's no need
+//      to go through a printf-style format string for them.
+// Arguments:
+// - parameter: the numeric parameter to add
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_AppendGraphicsRendition(const unsigned int parameter) noexcept
+{
+    const fmt::format_int digits{ parameter };
+
+    // The buffer fits every attribute and both colors. If we ever run out of
+    // space anyways, write what we have so far as a sequence of its own.
+    if (_renditionLength + digits.size() + 1 > _renditionBuffer.size())
+    {
+        RETURN_IF_FAILED(_WriteGraphicsRendition());
+    }
+
+    if (_renditionLength != 0)
+    {
+        til::at(_renditionBuffer, _renditionLength++) = ';';
+    }
+    for (const auto ch : std::string_view{ digits.data(), digits.size() })
+    {
+        til::at(_renditionBuffer, _renditionLength++) = ch;
+    }
+
+    return S_OK;
+}
+
+// Method Description:
+// - Writes the SGR sequence with all of the parameters we've collected with
+//      _AppendGraphicsRendition, if there are any.
+// Arguments:
+// <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_WriteGraphicsRendition() noexcept
+{
+    const std::string_view parameters{ _renditionBuffer.data(), _renditionLength };
+    _renditionLength = 0;
+
+    if (parameters.empty())
+    {
+        return S_OK;
+    }
+
+    // A lone reset doesn't need its parameter.
+    if (parameters == "0")
+    {
+        return _Write("\x1b[m");
+    }
+
+    // The parameters, plus the CSI and the final character.
+    std::array<char, std::tuple_size_v<decltype(_renditionBuffer)> + 3> sequence{};
+    auto length = 0u;
+    til::at(sequence, length++) = '\x1b';
+    til::at(sequence, length++) = '[';
+    for (const auto ch : parameters)
+    {
+        til::at(sequence, length++) = ch;
+    }
+    til::at(sequence, length++) = 'm';
 
-    return _Write(fmt);
+    return _Write({ sequence.data(), length });
 }
 
 // Method Description:
@@ -334,113 +410,123 @@ using namespace Microsoft::Console::Render;
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the boldness of the following text.
+// - Adds the parameter that changes the boldness of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isBold: If true, we'll embolden the text. Otherwise we'll debolden the text.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetBold(const bool isBold) noexcept
 {
-    return _Write(isBold ? "\x1b[1m" : "\x1b[22m");
+    return _AppendGraphicsRendition(isBold ? 1 : 22);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the faintness of the following text.
+// - Adds the parameter that changes the faintness of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isFaint: If true, we'll make the text faint. Otherwise we'll remove the faintness.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetFaint(const bool isFaint) noexcept
 {
-    return _Write(isFaint ? "\x1b[2m" : "\x1b[22m");
+    return _AppendGraphicsRendition(isFaint ? 2 : 22);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the underline of the following text.
+// - Adds the parameter that changes the underline of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isUnderlined: If true, we'll underline the text. Otherwise we'll remove the underline.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetUnderlined(const bool isUnderlined) noexcept
 {
-    return _Write(isUnderlined ? "\x1b[4m" : "\x1b[24m");
+    return _AppendGraphicsRendition(isUnderlined ? 4 : 24);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the double underline of the following text.
+// - Adds the parameter that changes the double underline of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isUnderlined: If true, we'll doubly underline the text. Otherwise we'll remove the underline.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetDoublyUnderlined(const bool isUnderlined) noexcept
 {
-    return _Write(isUnderlined ? "\x1b[21m" : "\x1b[24m");
+    return _AppendGraphicsRendition(isUnderlined ? 21 : 24);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the overline of the following text.
+// - Adds the parameter that changes the overline of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isOverlined: If true, we'll overline the text. Otherwise we'll remove the overline.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetOverlined(const bool isOverlined) noexcept
 {
-    return _Write(isOverlined ? "\x1b[53m" : "\x1b[55m");
+    return _AppendGraphicsRendition(isOverlined ? 53 : 55);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the italics of the following text.
+// - Adds the parameter that changes the italics of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isItalic: If true, we'll italicize the text. Otherwise we'll remove the italics.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetItalic(const bool isItalic) noexcept
 {
-    return _Write(isItalic ? "\x1b[3m" : "\x1b[23m");
+    return _AppendGraphicsRendition(isItalic ? 3 : 23);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the blinking of the following text.
+// - Adds the parameter that changes the blinking of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isBlinking: If true, we'll start the text blinking. Otherwise we'll stop the blinking.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetBlinking(const bool isBlinking) noexcept
 {
-    return _Write(isBlinking ? "\x1b[5m" : "\x1b[25m");
+    return _AppendGraphicsRendition(isBlinking ? 5 : 25);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the visibility of the following text.
+// - Adds the parameter that changes the visibility of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isInvisible: If true, we'll make the text invisible. Otherwise we'll make it visible.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetInvisible(const bool isInvisible) noexcept
 {
-    return _Write(isInvisible ? "\x1b[8m" : "\x1b[28m");
+    return _AppendGraphicsRendition(isInvisible ? 8 : 28);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the crossed out state of the following text.
+// - Adds the parameter that changes the crossed out state of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isCrossedOut: If true, we'll cross out the text. Otherwise we'll stop crossing out.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetCrossedOut(const bool isCrossedOut) noexcept
 {
-    return _Write(isCrossedOut ? "\x1b[9m" : "\x1b[29m");
+    return _AppendGraphicsRendition(isCrossedOut ? 9 : 29);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the reversed state of the following text.
+// - Adds the parameter that changes the reversed state of the following text to
+//      the SGR sequence we're building.
 // Arguments:
 // - isReversed: If true, we'll reverse the text. Otherwise we'll remove the reversed state.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetReverseVideo(const bool isReversed) noexcept
 {
-    return _Write(isReversed ? "\x1b[7m" : "\x1b[27m");
+    return _AppendGraphicsRendition(isReversed ? 7 : 27);
 }
 
 // Method Description:
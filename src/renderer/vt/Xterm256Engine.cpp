@@ -30,14 +30,18 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
 {
     RETURN_IF_FAILED(VtEngine::_RgbUpdateDrawingBrushes(textAttributes));
 
-    RETURN_IF_FAILED(_UpdateHyperlinkAttr(textAttributes, pData));
-
     // Only do extended attributes in xterm-256color, as to not break telnet.exe.
-    return _UpdateExtendedAttrs(textAttributes);
+    RETURN_IF_FAILED(_UpdateExtendedAttrs(textAttributes));
+
+    // Everything that changed above is written as a single SGR sequence.
+    RETURN_IF_FAILED(_WriteGraphicsRendition());
+
+    return _UpdateHyperlinkAttr(textAttributes, pData);
 }
 
 // Routine Description:
-// - Write a VT sequence to update the character rendition attributes.
+// - Collect the SGR parameters to update the character rendition attributes.
+//      They're written by _WriteGraphicsRendition, together with the colors.
 // Arguments:
 // - textAttributes - text attributes (bold, italic, underline, etc.) to use.
 // Return Value:
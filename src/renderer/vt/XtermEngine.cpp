@@ -54,6 +54,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         RETURN_IF_FAILED(_ClearScreen());
         _clearedAllThisFrame = true;
         _firstPaint = false;
+        _shadowStale = true;
     }
     else
     {
@@ -159,7 +160,8 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         _lastTextAttributes.SetUnderlined(textAttributes.IsUnderlined());
     }
 
-    return S_OK;
+    // Everything that changed above is written as a single SGR sequence.
+    return _WriteGraphicsRendition();
 }
 
 // Routine Description:
@@ -383,6 +385,7 @@ try
         RETURN_IF_FAILED(_MoveCursor({ 0, bottom }));
         // Emit some number of newlines to create space in the buffer.
         RETURN_IF_FAILED(_Write(std::string(absDy, '\n')));
+        _ScrollShadow(dy);
     }
     else if (dy > 0)
     {
@@ -390,6 +393,7 @@ try
         // buffer, and insert some newlines using the InsertLines VT sequence
         RETURN_IF_FAILED(_MoveCursor({ 0, 0 }));
         RETURN_IF_FAILED(_InsertLine(absDy));
+        _ScrollShadow(dy);
     }
 
     // Restore our wrap state.
@@ -469,6 +473,12 @@ try
 {
     const til::point delta{ *pcoordDelta };
 
+    // The terminal scrolled by itself while we were passing output through.
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
+
     if (delta != til::point{ 0, 0 })
     {
         _trace.TraceInvalidateScroll(delta);
@@ -520,6 +530,10 @@ CATCH_RETURN();
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
+
+    // We don't know what the string did to the contents of the terminal.
+    _shadowStale = true;
+
     // GH#4106, GH#2011 - WriteTerminalW is only ever called by the
     // StateMachine, when we've encountered a string we don't understand. When
     // this happens, we usually don't actually trigger another frame, but we
@@ -530,10 +544,37 @@ CATCH_RETURN();
     //
     // To fix this, flush here, so this string is sent to the connected terminal
     // application.
+    //
+    // In passthrough mode, everything the client writes comes through here, so
+    // we hold on to it until EndPassthrough flushes the whole write at once.
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
 
     return _Flush();
 }
 
+// Method Description:
+// - Leave passthrough mode. See VtEngine::EndPassthrough. The client may have
+//   shown or hidden the cursor itself, so also remember what the terminal's
+//   cursor visibility is now.
+// Arguments:
+// - cursorPosition: the position of the cursor, relative to the viewport.
+// - delayedEolWrap: true if the cursor is waiting to wrap at the end of the line.
+// - cursorVisible: true if the cursor is visible.
+// - attributes: the attributes that the client is now writing with.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to write.
+[[nodiscard]] HRESULT XtermEngine::EndPassthrough(const COORD cursorPosition,
+                                                  const bool delayedEolWrap,
+                                                  const bool cursorVisible,
+                                                  const TextAttribute& attributes) noexcept
+{
+    _lastCursorIsVisible = cursorVisible;
+    return VtEngine::EndPassthrough(cursorPosition, delayedEolWrap, cursorVisible, attributes);
+}
+
 // Method Description:
 // - Updates the window's title string. Emits the VT sequence to SetWindowTitle.
 // Arguments:
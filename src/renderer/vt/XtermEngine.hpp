@@ -51,6 +51,11 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT WriteTerminalW(const std::wstring_view str) noexcept override;
 
+        [[nodiscard]] HRESULT EndPassthrough(const COORD cursorPosition,
+                                             const bool delayedEolWrap,
+                                             const bool cursorVisible,
+                                             const TextAttribute& attributes) noexcept override;
+
     protected:
         const bool _fUseAsciiOnly;
         bool _needToDisableCursor;
@@ -49,6 +49,12 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
 try
 {
+    // The terminal already has whatever was passed through.
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
+
     const til::rectangle rect{ Viewport::FromExclusive(*psrRegion).ToInclusive() };
     _trace.TraceInvalidate(rect);
     _invalidMap.set(rect);
@@ -64,6 +70,13 @@ CATCH_RETURN();
 // - S_OK
 [[nodiscard]] HRESULT VtEngine::InvalidateCursor(const COORD* const pcoordCursor) noexcept
 {
+    // The terminal moves its own cursor while we're passing output through.
+    //      EndPassthrough will tell us where it ended up.
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
+
     // If we just inherited the cursor, we're going to get an InvalidateCursor
     //      for both where the old cursor was, and where the new cursor is
     //      (the inherited location). (See Cursor.cpp:Cursor::SetPosition)
@@ -91,6 +104,11 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateAll() noexcept
 try
 {
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
+
     _trace.TraceInvalidateAll(_lastViewport.ToOrigin().ToInclusive());
     _invalidMap.set_all();
     return S_OK;
@@ -112,6 +130,17 @@ CATCH_RETURN();
     {
         *pForcePaint = false;
     }
+    else if (_inPassthrough)
+    {
+        // There's nothing to paint before the buffer circles, the terminal
+        //      already has all of the text. Just move our virtual top up, the
+        //      way EndPaint would have.
+        *pForcePaint = false;
+        if (_virtualTop > 0)
+        {
+            _virtualTop--;
+        }
+    }
     else
     {
         *pForcePaint = true;
@@ -133,9 +162,14 @@ CATCH_RETURN();
 // Arguments:
 // - Receives a bool indicating if we should force the repaint.
 // Return Value:
-// - S_OK
+// - S_OK, or a suitable HRESULT error from writing the pipe.
 [[nodiscard]] HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     *pForcePaint = true;
-    return S_OK;
+
+    // The process exits right after we're torn down. From now on, wait for
+    // everything we write to actually make it to the terminal, starting with
+    // anything that's still on its way.
+    _tearingDown = true;
+    return _Flush();
 }
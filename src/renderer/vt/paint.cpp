@@ -72,6 +72,9 @@ using namespace Microsoft::Console::Types;
         {
             _virtualTop--;
         }
+
+        // The contents are about to move in a way we don't track.
+        _shadowStale = true;
     }
     _circled = false;
 
@@ -485,11 +488,49 @@ using namespace Microsoft::Console::Types;
         _trace.TraceClearWrapped();
     }
 
-    // Move the cursor to the start of this run.
-    RETURN_IF_FAILED(_MoveCursor(coord));
+    // If we're going to erase the spaces at the end of the line, the cursor
+    // needs to be right after the text.
+    const bool cursorAtEnd = useEraseChar || (_newBottomLine && printingBottomLine);
+
+    if (cchActual == 0)
+    {
+        // Move the cursor to the start of this run.
+        RETURN_IF_FAILED(_MoveCursor(coord));
+
+        // Write the actual text string
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8({ _bufferLine.data(), cchActual }));
+    }
+    else
+    {
+        // The spaces we removed are always single clusters at the end.
+        const size_t clustersActual = clusters.size() - (cchLine - cchActual);
+
+        // If the previous line wrapped into this one, we have to print its
+        // first character to keep it wrapped in the terminal, even if it's
+        // unchanged. The same goes for the last character of a wrapped line.
+        const bool keepFirst = coord.X == 0 &&
+                               _wrappedRow.has_value() &&
+                               coord.Y == _wrappedRow.value() + 1;
+
+        RETURN_IF_FAILED(_PaintUtf8Run(clusters.first(clustersActual),
+                                       { _bufferLine.data(), cchActual },
+                                       coord,
+                                       keepFirst,
+                                       lineWrapped,
+                                       cursorAtEnd));
+    }
 
-    // Write the actual text string
-    RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8({ _bufferLine.data(), cchActual }));
+    // We don't know which attributes the cells of the removed spaces have in
+    // the terminal, so we'll have to paint them if they change.
+    if (ShadowCell* const shadowRow = _GetShadowRow(coord.Y))
+    {
+        const auto first = gsl::narrow_cast<ptrdiff_t>(coord.X + columnsActual);
+        const auto last = std::min<ptrdiff_t>(coord.X + totalWidth, _lastViewport.Width());
+        for (auto x = first; x < last; ++x)
+        {
+            shadowRow[x] = ShadowCell{};
+        }
+    }
 
     // GH#4415, GH#5181
     // If the renderer told us that this was a wrapped line, then mark
@@ -503,26 +544,6 @@ using namespace Microsoft::Console::Types;
         _trace.TraceSetWrapped(coord.Y);
     }
 
-    // Update our internal tracker of the cursor's position.
-    // See MSFT:20266233 (which is also GH#357)
-    // If the cursor is at the rightmost column of the terminal, and we write a
-    //      space, the cursor won't actually move to the next cell (which would
-    //      be {0, _lastText.Y++}). The cursor will stay visibly in that last
-    //      cell until then next character is output.
-    // If in that case, we increment the cursor position here (such that the X
-    //      position would be one past the right of the terminal), when we come
-    //      back through to MoveCursor in the last PaintCursor of the frame,
-    //      we'll determine that we need to emit a \b to put the cursor in the
-    //      right position. This is wrong, and will cause us to move the cursor
-    //      back one character more than we wanted.
-    //
-    // GH#1245: This needs to be RightExclusive, _not_ inclusive. Otherwise, we
-    // won't update our internal cursor position tracker correctly at the last
-    // character of the row.
-    if (_lastText.X < _lastViewport.RightExclusive())
-    {
-        _lastText.X += static_cast<short>(columnsActual);
-    }
     // GH#1245: If we wrote the exactly last char of the row, then we're in the
     // "delayed EOL wrap" state. Different terminals (conhost, gnome-terminal,
     // wt) all behave differently with how the cursor behaves at an end of line.
@@ -589,6 +610,382 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Writes a run of clusters with the current attributes to the pipe, picking
+//      the cheapest encoding for each part of it:
+//      - Spans that the terminal already displays, according to our shadow of
+//        the previous frames, are jumped over with the cursor, if that's
+//        shorter than writing them again.
+//      - Long runs of spaces are erased with ECH, then jumped over.
+//      - Long runs of any other glyph are written once, then repeated with REP.
+//      - Everything else is written as UTF-8.
+//   Updates our internal tracker of the cursor's position, and the shadow of
+//      this row.
+// Arguments:
+// - clusters - text and column widths to be written
+// - text - the text of all of the clusters, concatenated
+// - coord - character coordinate of the first cluster within the viewport
+// - keepFirst - if true, the first cluster is written even if it's unchanged.
+// - keepLast - if true, the last cluster is written even if it's unchanged.
+// - cursorAtEnd - if true, the cursor is left after the last cluster, even if
+//      that needs another cursor movement.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_PaintUtf8Run(gsl::span<const Cluster> const clusters,
+                                              const std::wstring_view text,
+                                              const COORD coord,
+                                              const bool keepFirst,
+                                              const bool keepLast,
+                                              const bool cursorAtEnd) noexcept
+try
+{
+    ShadowCell* const shadowRow = _GetShadowRow(coord.Y);
+    const short width = _lastViewport.Width();
+    const size_t count = clusters.size();
+
+    // A full repaint is our chance to get the terminal back in sync with the
+    // buffer, in case we got anything wrong. Don't skip anything then.
+    const bool canSkip = shadowRow != nullptr && !_invalidMap.all();
+
+    // ECH erases with the current background color, but not with the other
+    // renditions that are visible on a space.
+    const bool canErase = !(_lastTextAttributes.IsUnderlined() ||
+                            _lastTextAttributes.IsDoublyUnderlined() ||
+                            _lastTextAttributes.IsOverlined() ||
+                            _lastTextAttributes.IsCrossedOut() ||
+                            _lastTextAttributes.IsReverseVideo() ||
+                            _lastTextAttributes.IsHyperlink());
+
+    // REP repeats the last graphic character the terminal printed. Spaces are
+    // left to ECH and to the trimming of the line, and anything that isn't a
+    // single printable code unit is written as it is.
+    const auto canRepeat = [](const wchar_t glyph) noexcept {
+        return glyph > L' ' && glyph != L'\x7f' &&
+               !(glyph >= 0x80 && glyph < 0xa0) &&
+               !(glyph >= 0xd800 && glyph <= 0xdfff);
+    };
+
+    const auto isUnchanged = [&](const size_t index, const short x) noexcept {
+        if (!canSkip || (keepFirst && index == 0) || (keepLast && index == count - 1))
+        {
+            return false;
+        }
+        const auto glyph = _GetShadowGlyph(til::at(clusters, index));
+        return glyph != UNICODE_NULL &&
+               x >= 0 && x < width &&
+               shadowRow[x].glyph == glyph &&
+               shadowRow[x].attributes == _lastTextAttributes;
+    };
+
+    const auto writeText = [&](const short x, const std::wstring_view str, const short columns) {
+        if (str.empty())
+        {
+            return S_OK;
+        }
+
+        RETURN_IF_FAILED(_MoveCursor({ x, coord.Y }));
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(str));
+
+        // Update our internal tracker of the cursor's position.
+        // See MSFT:20266233 (which is also GH#357)
+        // If the cursor is at the rightmost column of the terminal, and we write a
+        //      space, the cursor won't actually move to the next cell (which would
+        //      be {0, _lastText.Y++}). The cursor will stay visibly in that last
+        //      cell until then next character is output.
+        // If in that case, we increment the cursor position here (such that the X
+        //      position would be one past the right of the terminal), when we come
+        //      back through to MoveCursor in the last PaintCursor of the frame,
+        //      we'll determine that we need to emit a \b to put the cursor in the
+        //      right position. This is wrong, and will cause us to move the cursor
+        //      back one character more than we wanted.
+        //
+        // GH#1245: This needs to be RightExclusive, _not_ inclusive. Otherwise, we
+        // won't update our internal cursor position tracker correctly at the last
+        // character of the row.
+        if (_lastText.X < _lastViewport.RightExclusive())
+        {
+            _lastText.X += columns;
+        }
+        return S_OK;
+    };
+
+    // Writes the clusters [begin, end), erasing long runs of spaces and
+    // repeating long runs of the same glyph instead of writing them, when
+    // that's shorter.
+    const auto writeClusters = [&](size_t begin, const size_t end, size_t offset, short x) {
+        size_t textBegin = offset;
+        short textX = x;
+        while (begin < end)
+        {
+            size_t spaces = 0;
+            if (canErase)
+            {
+                while (begin + spaces < end &&
+                       !(keepLast && begin + spaces == count - 1) &&
+                       _GetShadowGlyph(til::at(clusters, begin + spaces)) == L' ')
+                {
+                    ++spaces;
+                }
+            }
+
+            // ECH doesn't move the cursor, so we'll need a CUF after it, which
+            // can't move the cursor past the last column.
+            if (spaces != 0 &&
+                2 * _SingleParameterSequenceLength(spaces) < spaces &&
+                x + gsl::narrow_cast<short>(spaces) <= _lastViewport.RightInclusive())
+            {
+                RETURN_IF_FAILED(writeText(textX, text.substr(textBegin, offset - textBegin), gsl::narrow_cast<short>(x - textX)));
+                RETURN_IF_FAILED(_MoveCursor({ x, coord.Y }));
+                RETURN_IF_FAILED(_EraseCharacter(gsl::narrow_cast<short>(spaces)));
+
+                begin += spaces;
+                offset += spaces;
+                x += gsl::narrow_cast<short>(spaces);
+                textBegin = offset;
+                textX = x;
+                continue;
+            }
+
+            // A run of the same glyph is written once, then repeated with REP.
+            const auto glyph = _GetShadowGlyph(til::at(clusters, begin));
+            size_t repeats = 0;
+            if (canRepeat(glyph))
+            {
+                while (begin + 1 + repeats < end &&
+                       _GetShadowGlyph(til::at(clusters, begin + 1 + repeats)) == glyph)
+                {
+                    ++repeats;
+                }
+            }
+
+            if (repeats != 0 &&
+                _SingleParameterSequenceLength(repeats) < repeats * _Utf8Length({ &glyph, 1 }))
+            {
+                // The glyphs are a single column wide and a single code unit long.
+                ++begin;
+                ++offset;
+                ++x;
+                RETURN_IF_FAILED(writeText(textX, text.substr(textBegin, offset - textBegin), gsl::narrow_cast<short>(x - textX)));
+                RETURN_IF_FAILED(_RepeatCharacter(gsl::narrow_cast<short>(repeats)));
+
+                // REP moves the cursor just like writing the glyphs would.
+                if (_lastText.X < _lastViewport.RightExclusive())
+                {
+                    _lastText.X += gsl::narrow_cast<short>(repeats);
+                }
+
+                begin += repeats;
+                offset += repeats;
+                x += gsl::narrow_cast<short>(repeats);
+                textBegin = offset;
+                textX = x;
+                continue;
+            }
+
+            const auto& cluster = til::at(clusters, begin);
+            offset += cluster.GetText().size();
+            x += gsl::narrow_cast<short>(cluster.GetColumns());
+            ++begin;
+        }
+        return writeText(textX, text.substr(textBegin, offset - textBegin), gsl::narrow_cast<short>(x - textX));
+    };
+
+    // Collect the clusters to write until we find a span of unchanged
+    // clusters that's worth skipping.
+    size_t pendingBegin = 0;
+    size_t pendingOffset = 0;
+    short pendingX = coord.X;
+
+    size_t index = 0;
+    size_t offset = 0;
+    short x = coord.X;
+    while (index < count)
+    {
+        size_t skipEnd = index;
+        size_t skipOffset = offset;
+        short skipX = x;
+        size_t skipBytes = 0;
+        while (skipEnd < count && isUnchanged(skipEnd, skipX))
+        {
+            const auto& cluster = til::at(clusters, skipEnd);
+            skipBytes += _Utf8Length(cluster.GetText());
+            skipOffset += cluster.GetText().size();
+            skipX += gsl::narrow_cast<short>(cluster.GetColumns());
+            ++skipEnd;
+        }
+
+        if (skipEnd == index)
+        {
+            const auto& cluster = til::at(clusters, index);
+            offset += cluster.GetText().size();
+            x += gsl::narrow_cast<short>(cluster.GetColumns());
+            ++index;
+            continue;
+        }
+
+        // Skipping the end of the run is free, unless we need the cursor there.
+        const bool trailing = skipEnd == count;
+        const size_t jumpLength = trailing && !cursorAtEnd ?
+                                      0 :
+                                      _SingleParameterSequenceLength(gsl::narrow_cast<size_t>(skipX - x));
+        if (jumpLength < skipBytes)
+        {
+            RETURN_IF_FAILED(writeClusters(pendingBegin, index, pendingOffset, pendingX));
+            pendingBegin = skipEnd;
+            pendingOffset = skipOffset;
+            pendingX = skipX;
+        }
+
+        index = skipEnd;
+        offset = skipOffset;
+        x = skipX;
+    }
+    RETURN_IF_FAILED(writeClusters(pendingBegin, count, pendingOffset, pendingX));
+
+    if (cursorAtEnd)
+    {
+        RETURN_IF_FAILED(_MoveCursor({ x, coord.Y }));
+    }
+
+    // Remember what the terminal displays now.
+    if (shadowRow != nullptr)
+    {
+        short column = coord.X;
+        for (const auto& cluster : clusters)
+        {
+            const auto glyph = _GetShadowGlyph(cluster);
+            for (size_t i = 0; i < cluster.GetColumns() && column < width; ++i, ++column)
+            {
+                if (column >= 0)
+                {
+                    shadowRow[column] = ShadowCell{ glyph, _lastTextAttributes };
+                }
+            }
+        }
+    }
+
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Returns the glyph we remember for a cluster in the shadow of the terminal.
+//      Only clusters of a single UTF-16 code unit that take a single column are
+//      remembered, anything else is always painted again.
+// Arguments:
+// - cluster - the cluster to get the glyph of
+// Return Value:
+// - The glyph, or UNICODE_NULL if the cluster can't be remembered.
+wchar_t VtEngine::_GetShadowGlyph(const Cluster& cluster) noexcept
+{
+    const auto& text = cluster.GetText();
+    return text.size() == 1 && cluster.GetColumns() == 1 ? til::at(text, 0) : UNICODE_NULL;
+}
+
+// Routine Description:
+// - Returns how many bytes the given text takes once it's encoded as UTF-8.
+// Arguments:
+// - text - the UTF-16 text to measure
+// Return Value:
+// - The length of the text in UTF-8.
+size_t VtEngine::_Utf8Length(const std::wstring_view text) noexcept
+{
+    size_t length = 0;
+    for (const auto wch : text)
+    {
+        // A surrogate pair takes 4 bytes, 2 for each half.
+        length += wch < 0x80 ? 1 : wch < 0x800 || (wch >= 0xD800 && wch <= 0xDFFF) ? 2 : 3;
+    }
+    return length;
+}
+
+// Routine Description:
+// - Returns how many bytes a control sequence with a single numeric parameter
+//      takes, like the ECH or CUF sequence: ESC [ %d C
+// Arguments:
+// - parameter - the value of the parameter
+// Return Value:
+// - The length of the sequence.
+size_t VtEngine::_SingleParameterSequenceLength(size_t parameter) noexcept
+{
+    // ESC, [, and the final character, then the digits.
+    size_t length = 3;
+    do
+    {
+        ++length;
+        parameter /= 10;
+    } while (parameter != 0);
+    return length;
+}
+
+// Routine Description:
+// - Returns the row of our shadow of the terminal that's at the given row of
+//      the viewport. If anything happened that we couldn't keep track of since
+//      we last used it, the whole shadow is forgotten first.
+// Arguments:
+// - row - the row within the viewport
+// Return Value:
+// - A pointer to the first of the cells of the row, or nullptr if the row isn't
+//      in the viewport.
+VtEngine::ShadowCell* VtEngine::_GetShadowRow(const short row) noexcept
+{
+    const auto width = gsl::narrow_cast<size_t>(_lastViewport.Width());
+    const auto height = gsl::narrow_cast<size_t>(_lastViewport.Height());
+
+    if (_shadowStale)
+    {
+        try
+        {
+            _shadow.assign(width * height, ShadowCell{});
+            _shadowStale = false;
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            _shadow.clear();
+        }
+    }
+
+    if (row < 0 || gsl::narrow_cast<size_t>(row) >= height || _shadow.size() != width * height)
+    {
+        return nullptr;
+    }
+    return _shadow.data() + row * width;
+}
+
+// Routine Description:
+// - Moves the rows of our shadow of the terminal when we scrolled the terminal.
+//      The rows that were scrolled into view are blank, but we don't know with
+//      which attributes, so they're forgotten.
+// Arguments:
+// - dy - the number of rows the contents moved down. Negative if they moved up.
+// Return Value:
+// - <none>
+void VtEngine::_ScrollShadow(const short dy) noexcept
+{
+    const auto width = gsl::narrow_cast<size_t>(_lastViewport.Width());
+    const auto height = gsl::narrow_cast<size_t>(_lastViewport.Height());
+    const auto rows = gsl::narrow_cast<size_t>(std::abs(dy));
+
+    if (_shadowStale || _shadow.size() != width * height || rows >= height)
+    {
+        _shadowStale = true;
+        return;
+    }
+
+    const auto shift = gsl::narrow_cast<ptrdiff_t>(rows * width);
+    if (dy < 0)
+    {
+        std::move(_shadow.begin() + shift, _shadow.end(), _shadow.begin());
+        std::fill(_shadow.end() - shift, _shadow.end(), ShadowCell{});
+    }
+    else
+    {
+        std::move_backward(_shadow.begin(), _shadow.end() - shift, _shadow.end());
+        std::fill(_shadow.begin(), _shadow.begin() + shift, ShadowCell{});
+    }
+}
+
 // Method Description:
 // - Updates the window's title string. Emits the VT sequence to SetWindowTitle.
 //      Because wintelnet does not understand these sequences by default, we
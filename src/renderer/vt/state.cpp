@@ -59,6 +59,11 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
 #endif
+
+    if (_hFile.get() != INVALID_HANDLE_VALUE)
+    {
+        _pipeWriter = std::make_unique<VtPipeWriter>(_hFile.get());
+    }
 }
 
 // Method Description:
@@ -111,11 +116,24 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 
     if (!_pipeBroken)
     {
-        bool fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), static_cast<DWORD>(_buffer.size()), nullptr, nullptr);
-        _buffer.clear();
-        if (!fSuccess)
+        // The pipe writer writes the buffer on a thread of its own, so that a
+        // terminal that's slow to read doesn't hold up the render thread. It
+        // only reports a failure to write on the flush after it happened.
+        auto hr = _pipeWriter->Write(_buffer);
+
+        // The process exits right after we're torn down, so then we have to
+        // wait for all of our output to actually make it to the terminal.
+        if (SUCCEEDED(hr) && _tearingDown)
+        {
+            hr = _pipeWriter->Drain();
+        }
+
+        _trace.TracePipeStatistics(*_pipeWriter);
+
+        if (FAILED(hr))
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
+            _buffer.clear();
+            _exitResult = hr;
             _pipeBroken = true;
             if (_terminalOwner)
             {
@@ -288,6 +306,9 @@ CATCH_RETURN();
 
     if ((oldView.Height() != newView.Height()) || (oldView.Width() != newView.Width()))
     {
+        // The terminal might reflow its contents, we can't know what it displays.
+        _shadowStale = true;
+
         // Don't emit a resize event if we've requested it be suppressed
         if (!_suppressResizeRepaint)
         {
@@ -490,6 +511,50 @@ void VtEngine::SetResizeQuirk(const bool resizeQuirk)
     _resizeQuirk = resizeQuirk;
 }
 
+// Method Description:
+// - Tell the vt renderer that the client's output is about to be written
+//   straight to the terminal by the state machine. Until EndPassthrough is
+//   called, we ignore invalidations of the buffer, because the terminal
+//   already received whatever caused them, and we stop flushing after every
+//   passed through string.
+// - See also: VtIo::WritePassthrough
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::BeginPassthrough() noexcept
+{
+    _inPassthrough = true;
+}
+
+// Method Description:
+// - Leave passthrough mode. The terminal has moved its cursor and changed its
+//   rendition on its own, so adopt the buffer's state as the state we last
+//   wrote, then send everything that was passed through in a single write.
+// Arguments:
+// - cursorPosition: the position of the cursor, relative to the viewport.
+// - delayedEolWrap: true if the cursor is waiting to wrap at the end of the line.
+// - cursorVisible: true if the cursor is visible.
+// - attributes: the attributes that the client is now writing with.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to write.
+[[nodiscard]] HRESULT VtEngine::EndPassthrough(const COORD cursorPosition,
+                                               const bool delayedEolWrap,
+                                               const bool /*cursorVisible*/,
+                                               const TextAttribute& attributes) noexcept
+{
+    _inPassthrough = false;
+
+    _lastText = cursorPosition;
+    _delayedEolWrap = delayedEolWrap;
+    _wrappedRow = std::nullopt;
+    _deferredCursorPos = INVALID_COORDS;
+    _lastTextAttributes = attributes;
+    _shadowStale = true;
+
+    return _Flush();
+}
+
 // Method Description:
 // - Manually emit a "Erase Scrollback" sequence to the connected terminal. We
 //   need to do this in certain cases that we've identified where we believe the
@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "tracing.hpp"
+#include "VtPipeWriter.hpp"
 #include <sstream>
 
 TRACELOGGING_DEFINE_PROVIDER(g_hConsoleVtRendererTraceProvider,
@@ -322,3 +323,24 @@ void RenderTracing::TracePaintCursor(const til::point coordCursor) const
     UNREFERENCED_PARAMETER(coordCursor);
 #endif UNIT_TESTING
 }
+
+void RenderTracing::TracePipeStatistics(const Microsoft::Console::Render::VtPipeWriter& writer) const
+{
+#ifndef UNIT_TESTING
+    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, 0))
+    {
+        const auto statistics = writer.GetStatistics();
+        const auto blockedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(statistics.blockedTime).count();
+        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                          "VtEngine_TracePipeStatistics",
+                          TraceLoggingValue(statistics.writes, "writes"),
+                          TraceLoggingValue(statistics.coalescedWrites, "coalescedWrites"),
+                          TraceLoggingValue(statistics.bytesWritten, "bytesWritten"),
+                          TraceLoggingValue(statistics.maxPendingBytes, "maxPendingBytes"),
+                          TraceLoggingValue(blockedMicroseconds, "blockedMicroseconds"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+    }
+#else
+    UNREFERENCED_PARAMETER(writer);
+#endif UNIT_TESTING
+}
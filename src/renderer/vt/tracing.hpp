@@ -19,6 +19,11 @@ Abstract:
 
 TRACELOGGING_DECLARE_PROVIDER(g_hConsoleVtRendererTraceProvider);
 
+namespace Microsoft::Console::Render
+{
+    class VtPipeWriter;
+}
+
 namespace Microsoft::Console::VirtualTerminal
 {
     class RenderTracing final
@@ -45,5 +50,6 @@ namespace Microsoft::Console::VirtualTerminal
                              const bool cursorMoved,
                              const std::optional<short>& wrappedRow) const;
         void TraceEndPaint() const;
+        void TracePipeStatistics(const Microsoft::Console::Render::VtPipeWriter& writer) const;
     };
 }
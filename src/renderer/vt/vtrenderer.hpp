@@ -20,6 +20,7 @@ Author(s):
 #include "../../inc/ITerminalOwner.hpp"
 #include "../../types/inc/Viewport.hpp"
 #include "tracing.hpp"
+#include "VtPipeWriter.hpp"
 #include <string>
 #include <functional>
 
@@ -104,16 +105,28 @@ namespace Microsoft::Console::Render
 
         void SetResizeQuirk(const bool resizeQuirk);
 
+        void BeginPassthrough() noexcept;
+        [[nodiscard]] virtual HRESULT EndPassthrough(const COORD cursorPosition,
+                                                     const bool delayedEolWrap,
+                                                     const bool cursorVisible,
+                                                     const TextAttribute& attributes) noexcept;
+
         [[nodiscard]] virtual HRESULT ManuallyClearScrollback() noexcept;
 
         [[nodiscard]] HRESULT RequestWin32Input() noexcept;
 
     protected:
         wil::unique_hfile _hFile;
+        std::unique_ptr<VtPipeWriter> _pipeWriter;
         std::string _buffer;
 
         std::string _formatBuffer;
 
+        // The parameters of the SGR sequence we're collecting, separated by
+        // semicolons. See _AppendGraphicsRendition.
+        std::array<char, 64> _renditionBuffer{};
+        size_t _renditionLength{ 0 };
+
         TextAttribute _lastTextAttributes;
 
         Microsoft::Console::Types::Viewport _lastViewport;
@@ -149,6 +162,8 @@ namespace Microsoft::Console::Render
         bool _delayedEolWrap{ false };
 
         bool _resizeQuirk{ false };
+        bool _inPassthrough{ false };
+        bool _tearingDown{ false };
         std::optional<TextColor> _newBottomLineBG{ std::nullopt };
 
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
@@ -168,6 +183,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _InsertLine(const short sLines) noexcept;
         [[nodiscard]] HRESULT _CursorForward(const short chars) noexcept;
         [[nodiscard]] HRESULT _EraseCharacter(const short chars) noexcept;
+        [[nodiscard]] HRESULT _RepeatCharacter(const short chars) noexcept;
         [[nodiscard]] HRESULT _CursorPosition(const COORD coord) noexcept;
         [[nodiscard]] HRESULT _CursorHome() noexcept;
         [[nodiscard]] HRESULT _ClearScreen() noexcept;
@@ -182,6 +198,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _SetGraphicsRenditionDefaultColor(const bool fIsForeground) noexcept;
 
         [[nodiscard]] HRESULT _SetGraphicsDefault() noexcept;
+        [[nodiscard]] HRESULT _AppendGraphicsRendition(const unsigned int parameter) noexcept;
+        [[nodiscard]] HRESULT _WriteGraphicsRendition() noexcept;
 
         [[nodiscard]] HRESULT _ResizeWindow(const short sWidth, const short sHeight) noexcept;
 
@@ -219,6 +237,30 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(gsl::span<const Cluster> const clusters,
                                                     const COORD coord) noexcept;
 
+        [[nodiscard]] HRESULT _PaintUtf8Run(gsl::span<const Cluster> const clusters,
+                                            const std::wstring_view text,
+                                            const COORD coord,
+                                            const bool keepFirst,
+                                            const bool keepLast,
+                                            const bool cursorAtEnd) noexcept;
+
+        // What we believe the terminal displays in each cell of the viewport,
+        // so that repainting a row can skip over the parts that didn't change.
+        // A cell with a NUL glyph is one we don't know.
+        struct ShadowCell
+        {
+            wchar_t glyph{ UNICODE_NULL };
+            TextAttribute attributes{};
+        };
+        std::vector<ShadowCell> _shadow;
+        bool _shadowStale{ true };
+
+        [[nodiscard]] ShadowCell* _GetShadowRow(const short row) noexcept;
+        void _ScrollShadow(const short dy) noexcept;
+        static wchar_t _GetShadowGlyph(const Cluster& cluster) noexcept;
+        static size_t _Utf8Length(const std::wstring_view text) noexcept;
+        static size_t _SingleParameterSequenceLength(size_t parameter) noexcept;
+
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
 
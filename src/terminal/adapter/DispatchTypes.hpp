@@ -168,7 +168,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         VTParameters subspan(const size_t offset) const noexcept
         {
-            const auto subValues = _values.subspan(offset);
+            const auto subValues = _values.subspan(std::min(offset, _values.size()));
             return { subValues.data(), subValues.size() };
         }
 
@@ -338,6 +338,7 @@ namespace Microsoft::Console::VirtualTerminal::DispatchTypes
         SGR_EXTENDED_MODE = DECPrivateMode(1006),
         ALTERNATE_SCROLL = DECPrivateMode(1007),
         ASB_AlternateScreenBuffer = DECPrivateMode(1049),
+        SO_SynchronizedOutput = DECPrivateMode(2026),
         W32IM_Win32InputMode = DECPrivateMode(9001),
     };
 
@@ -383,6 +384,13 @@ namespace Microsoft::Console::VirtualTerminal::DispatchTypes
         Solicited = 1
     };
 
+    enum class ChangeExtent : size_t
+    {
+        Default = 0,
+        Stream = 1,
+        Rectangle = 2
+    };
+
     enum class LineFeedType : unsigned int
     {
         WithReturn,
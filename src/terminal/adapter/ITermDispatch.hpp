@@ -78,6 +78,7 @@ public:
     virtual bool EnableButtonEventMouseMode(const bool enabled) = 0; // ?1002
     virtual bool EnableAnyEventMouseMode(const bool enabled) = 0; // ?1003
     virtual bool EnableAlternateScroll(const bool enabled) = 0; // ?1007
+    virtual bool EnableSynchronizedOutput(const bool enabled) = 0; // ?2026
     virtual bool SetColorTableEntry(const size_t tableIndex, const DWORD color) = 0; // OSCColorTable
     virtual bool SetDefaultForeground(const DWORD color) = 0; // OSCDefaultForeground
     virtual bool SetDefaultBackground(const DWORD color) = 0; // OSCDefaultBackground
@@ -85,6 +86,38 @@ public:
     virtual bool EraseInDisplay(const DispatchTypes::EraseType eraseType) = 0; // ED
     virtual bool EraseInLine(const DispatchTypes::EraseType eraseType) = 0; // EL
     virtual bool EraseCharacters(const size_t numChars) = 0; // ECH
+    virtual bool RepeatCharacter(const wchar_t wch, const size_t count) = 0; // REP
+
+    virtual bool CopyRectangularArea(const size_t top,
+                                     const size_t left,
+                                     const size_t bottom,
+                                     const size_t right,
+                                     const size_t dstTop,
+                                     const size_t dstLeft) = 0; // DECCRA
+    virtual bool FillRectangularArea(const size_t ch,
+                                     const size_t top,
+                                     const size_t left,
+                                     const size_t bottom,
+                                     const size_t right) = 0; // DECFRA
+    virtual bool EraseRectangularArea(const size_t top,
+                                      const size_t left,
+                                      const size_t bottom,
+                                      const size_t right) = 0; // DECERA
+    virtual bool SelectiveEraseRectangularArea(const size_t top,
+                                               const size_t left,
+                                               const size_t bottom,
+                                               const size_t right) = 0; // DECSERA
+    virtual bool SelectAttributeChangeExtent(const DispatchTypes::ChangeExtent changeExtent) = 0; // DECSACE
+    virtual bool ChangeAttributesRectangularArea(const size_t top,
+                                                 const size_t left,
+                                                 const size_t bottom,
+                                                 const size_t right,
+                                                 const VTParameters attrs) = 0; // DECCARA
+    virtual bool ReverseAttributesRectangularArea(const size_t top,
+                                                  const size_t left,
+                                                  const size_t bottom,
+                                                  const size_t right,
+                                                  const VTParameters attrs) = 0; // DECRARA
 
     virtual bool SetGraphicsRendition(const VTParameters options) = 0; // SGR
 
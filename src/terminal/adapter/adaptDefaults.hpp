@@ -25,6 +25,7 @@ namespace Microsoft::Console::VirtualTerminal
         virtual void Print(const wchar_t wch) = 0;
         // These characters need to be mutable so that they can be processed by the TerminalInput translater.
         virtual void PrintString(const std::wstring_view string) = 0;
+        virtual void PrintRepeated(const wchar_t wch, const size_t count) = 0;
         virtual void Execute(const wchar_t wch) = 0;
     };
 }
@@ -32,6 +32,7 @@ AdaptDispatch::AdaptDispatch(std::unique_ptr<ConGetSet> pConApi,
     _usingAltBuffer(false),
     _isOriginModeRelative(false), // by default, the DECOM origin mode is absolute.
     _isDECCOLMAllowed(false), // by default, DECCOLM is not allowed.
+    _changeExtent(DispatchTypes::ChangeExtent::Stream), // by default, DECCARA changes a stream of characters.
     _termOutput()
 {
     THROW_HR_IF_NULL(E_INVALIDARG, _pConApi.get());
@@ -572,6 +573,26 @@ bool AdaptDispatch::EraseCharacters(const size_t numChars)
     return success;
 }
 
+// Routine Description:
+// - REP - Prints the given character a number of times. The character is
+//      translated once, and the whole run is handed to the buffer in one go,
+//      so that it can be filled a row at a time.
+// Arguments:
+// - wch - The last graphic character that was printed.
+// - count - The number of times to repeat it.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::RepeatCharacter(const wchar_t wch, const size_t count)
+{
+    const auto wchTranslated = _termOutput.TranslateKey(wch);
+    // As with Print, a DEL is only output if it was translated to something else.
+    if (wchTranslated != AsciiChars::DEL && count > 0)
+    {
+        _pDefaults->PrintRepeated(wchTranslated, count);
+    }
+    return true;
+}
+
 // Routine Description:
 // - ED - Erases a portion of the current viewable area (viewport) of the console.
 // Arguments:
@@ -1099,6 +1120,9 @@ bool AdaptDispatch::_ModeParamsHelper(const DispatchTypes::ModeParams param, con
     case DispatchTypes::ModeParams::ASB_AlternateScreenBuffer:
         success = enable ? UseAlternateScreenBuffer() : UseMainScreenBuffer();
         break;
+    case DispatchTypes::ModeParams::SO_SynchronizedOutput:
+        success = EnableSynchronizedOutput(enable);
+        break;
     case DispatchTypes::ModeParams::W32IM_Win32InputMode:
         success = EnableWin32InputMode(enable);
         break;
@@ -1897,6 +1921,9 @@ bool AdaptDispatch::HardReset()
     // Delete all current tab stops and reapply
     _ResetTabStops();
 
+    // DECCARA and DECRARA go back to changing a stream of characters.
+    _changeExtent = DispatchTypes::ChangeExtent::Stream;
+
     // GH#2715 - If all this succeeded, but we're in a conpty, return `false` to
     // make the state machine propagate this RIS sequence to the connected
     // terminal application. We've reset our state, but the connected terminal
@@ -1949,6 +1976,397 @@ bool AdaptDispatch::ScreenAlignmentPattern()
     return success;
 }
 
+// Routine Description:
+// - Works out the area of the buffer that the parameters of a rectangular
+//    area operation refer to. The coordinates are relative to the page, or
+//    to the margins if the origin mode is relative, and are clamped to them.
+// Arguments:
+// - top, left, bottom, right - The corners of the area, where 0 stands for
+//    the default, which is the corresponding edge of the page.
+// - csbiex - The screen buffer info.
+// Return Value:
+// - The area in buffer coordinates, inclusive. Its bottom right corner may be
+//    above or left of its top left one, in which case the area is empty.
+SMALL_RECT AdaptDispatch::_CalculateRectArea(const size_t top,
+                                             const size_t left,
+                                             const size_t bottom,
+                                             const size_t right,
+                                             const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex) const noexcept
+{
+    // srWindow is exclusive so we need to subtract 1 from the bottom.
+    int pageTop = csbiex.srWindow.Top;
+    int pageBottom = csbiex.srWindow.Bottom - 1;
+    const int pageRight = csbiex.dwSize.X - 1;
+
+    const int topMargin = pageTop + _scrollMargins.Top;
+    const int bottomMargin = pageTop + _scrollMargins.Bottom;
+    if (_isOriginModeRelative && topMargin < bottomMargin)
+    {
+        pageTop = topMargin;
+        pageBottom = bottomMargin;
+    }
+
+    // VT origin is at 1,1 so we need to subtract 1 from the parameters.
+    const auto toOffset = [](const size_t value, const int defaultOffset, const int maxOffset) noexcept {
+        const auto offset = value == 0 ? defaultOffset : gsl::narrow_cast<int>(std::min<size_t>(value, SHORT_MAX)) - 1;
+        return std::min(offset, maxOffset);
+    };
+    const auto maxRowOffset = pageBottom - pageTop;
+
+    SMALL_RECT area;
+    area.Top = gsl::narrow_cast<SHORT>(pageTop + toOffset(top, 0, maxRowOffset));
+    area.Left = gsl::narrow_cast<SHORT>(toOffset(left, 0, pageRight));
+    area.Bottom = gsl::narrow_cast<SHORT>(pageTop + toOffset(bottom, maxRowOffset, maxRowOffset));
+    area.Right = gsl::narrow_cast<SHORT>(toOffset(right, pageRight, pageRight));
+    return area;
+}
+
+// Routine Description:
+// - DECCRA - Copies a rectangular area of the page to another place on it.
+//    The part of the copy that would fall outside of the page is clipped.
+//    Since we only have the one page, the page numbers of the sequence are
+//    ignored.
+// Arguments:
+// - top, left, bottom, right - The corners of the area to copy.
+// - dstTop, dstLeft - The top left corner of the place to copy it to.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::CopyRectangularArea(const size_t top,
+                                        const size_t left,
+                                        const size_t bottom,
+                                        const size_t right,
+                                        const size_t dstTop,
+                                        const size_t dstLeft)
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    // Make sure to reset the viewport (with MoveToBottom )to where it was
+    //      before the user scrolled the console output
+    RETURN_BOOL_IF_FALSE(_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+
+    const auto source = _CalculateRectArea(top, left, bottom, right, csbiex);
+    // The bottom right corner of the destination is the end of the page, so
+    // that it tells us how much of the source fits.
+    const auto destination = _CalculateRectArea(dstTop, dstLeft, 0, 0, csbiex);
+    if (source.Top > source.Bottom || source.Left > source.Right)
+    {
+        return true;
+    }
+
+    auto clipped = source;
+    clipped.Bottom = std::min(source.Bottom, gsl::narrow_cast<SHORT>(source.Top + destination.Bottom - destination.Top));
+    clipped.Right = std::min(source.Right, gsl::narrow_cast<SHORT>(source.Left + destination.Right - destination.Left));
+    return _pConApi->PrivateCopyRectangularArea(clipped, { destination.Left, destination.Top });
+}
+
+// Routine Description:
+// - DECFRA - Fills a rectangular area of the page with the given character,
+//    using the current rendition. Like a printed character, the fill
+//    character is taken from the character set mapped into GL or GR.
+// Arguments:
+// - ch - The code of the character to fill the area with. Anything but the
+//    printable characters of GL and GR is ignored.
+// - top, left, bottom, right - The corners of the area to fill.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::FillRectangularArea(const size_t ch,
+                                        const size_t top,
+                                        const size_t left,
+                                        const size_t bottom,
+                                        const size_t right)
+{
+    const auto isPrintable = (ch >= 32 && ch <= 126) || (ch >= 160 && ch <= 255);
+    if (!isPrintable)
+    {
+        return true;
+    }
+
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    RETURN_BOOL_IF_FALSE(_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+
+    TextAttribute attr;
+    RETURN_BOOL_IF_FALSE(_pConApi->PrivateGetTextAttributes(attr));
+
+    const auto area = _CalculateRectArea(top, left, bottom, right, csbiex);
+    if (area.Top > area.Bottom || area.Left > area.Right)
+    {
+        return true;
+    }
+
+    const auto fillChar = _termOutput.TranslateKey(gsl::narrow_cast<wchar_t>(ch));
+    return _pConApi->PrivateFillRectangularArea(area, fillChar, attr);
+}
+
+// Routine Description:
+// - DECERA - Erases a rectangular area of the page, by replacing its
+//    characters with spaces. The area is filled with the standard erase
+//    attributes.
+// Arguments:
+// - top, left, bottom, right - The corners of the area to erase.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::EraseRectangularArea(const size_t top,
+                                         const size_t left,
+                                         const size_t bottom,
+                                         const size_t right)
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    RETURN_BOOL_IF_FALSE(_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+
+    TextAttribute attr;
+    RETURN_BOOL_IF_FALSE(_pConApi->PrivateGetTextAttributes(attr));
+    attr.SetStandardErase();
+
+    const auto area = _CalculateRectArea(top, left, bottom, right, csbiex);
+    if (area.Top > area.Bottom || area.Left > area.Right)
+    {
+        return true;
+    }
+
+    return _pConApi->PrivateFillRectangularArea(area, L' ', attr);
+}
+
+// Routine Description:
+// - DECSERA - Erases the characters of a rectangular area of the page that
+//    aren't protected from selective erasing. Since we don't support the
+//    protection attribute (DECSCA), that's all of them. Unlike DECERA, this
+//    leaves the attributes of the area as they are.
+// Arguments:
+// - top, left, bottom, right - The corners of the area to erase.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::SelectiveEraseRectangularArea(const size_t top,
+                                                  const size_t left,
+                                                  const size_t bottom,
+                                                  const size_t right)
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    RETURN_BOOL_IF_FALSE(_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+
+    const auto area = _CalculateRectArea(top, left, bottom, right, csbiex);
+    if (area.Top > area.Bottom || area.Left > area.Right)
+    {
+        return true;
+    }
+
+    return _pConApi->PrivateFillRectangularArea(area, L' ', std::nullopt);
+}
+
+// Routine Description:
+// - DECSACE - Selects whether DECCARA and DECRARA change the characters from
+//    the start position to the end position in reading order (a stream), or
+//    the rectangle that the two positions are the corners of.
+// Arguments:
+// - changeExtent - Stream or Rectangle. Default is the same as Stream.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::SelectAttributeChangeExtent(const DispatchTypes::ChangeExtent changeExtent) noexcept
+{
+    switch (changeExtent)
+    {
+    case DispatchTypes::ChangeExtent::Default:
+    case DispatchTypes::ChangeExtent::Stream:
+        _changeExtent = DispatchTypes::ChangeExtent::Stream;
+        return true;
+    case DispatchTypes::ChangeExtent::Rectangle:
+        _changeExtent = DispatchTypes::ChangeExtent::Rectangle;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Routine Description:
+// - DECCARA - Changes the attributes of a rectangular area of the page,
+//    without changing its characters. The attributes are given as a list of
+//    SGR options, of which only the ones that turn bold, underline, blink,
+//    negative and invisible on or off are applied. 0 turns them all off.
+// Arguments:
+// - top, left, bottom, right - The corners of the area to change.
+// - attrs - The SGR options to apply, in order.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::ChangeAttributesRectangularArea(const size_t top,
+                                                    const size_t left,
+                                                    const size_t bottom,
+                                                    const size_t right,
+                                                    const VTParameters attrs)
+{
+    unsigned int setAttrs = 0;
+    unsigned int clearAttrs = 0;
+    const auto setAttr = [&](const unsigned int attr) noexcept {
+        setAttrs |= attr;
+        clearAttrs &= ~attr;
+    };
+    const auto clearAttr = [&](const unsigned int attr) noexcept {
+        clearAttrs |= attr;
+        setAttrs &= ~attr;
+    };
+
+    attrs.for_each([&](const DispatchTypes::GraphicsOptions option) {
+        switch (option)
+        {
+        case DispatchTypes::GraphicsOptions::Off:
+            clearAttr(AllAttributes);
+            break;
+        case DispatchTypes::GraphicsOptions::BoldBright:
+            setAttr(Bold);
+            break;
+        case DispatchTypes::GraphicsOptions::Underline:
+            setAttr(Underlined);
+            break;
+        case DispatchTypes::GraphicsOptions::BlinkOrXterm256Index:
+            setAttr(Blinking);
+            break;
+        case DispatchTypes::GraphicsOptions::Negative:
+            setAttr(ReverseVideo);
+            break;
+        case DispatchTypes::GraphicsOptions::Invisible:
+            setAttr(Invisible);
+            break;
+        case DispatchTypes::GraphicsOptions::NotBoldOrFaint:
+            clearAttr(Bold);
+            break;
+        case DispatchTypes::GraphicsOptions::NoUnderline:
+            clearAttr(Underlined);
+            break;
+        case DispatchTypes::GraphicsOptions::Steady:
+            clearAttr(Blinking);
+            break;
+        case DispatchTypes::GraphicsOptions::Positive:
+            clearAttr(ReverseVideo);
+            break;
+        case DispatchTypes::GraphicsOptions::Visible:
+            clearAttr(Invisible);
+            break;
+        default:
+            // Any other option is ignored.
+            break;
+        }
+        return true;
+    });
+
+    return _ChangeAttributesHelper(top, left, bottom, right, setAttrs, clearAttrs, 0);
+}
+
+// Routine Description:
+// - DECRARA - Reverses the attributes of a rectangular area of the page,
+//    without changing its characters. The attributes are given as a list of
+//    SGR options, of which only bold, underline, blink, negative and
+//    invisible are applied. 0 reverses them all.
+// Arguments:
+// - top, left, bottom, right - The corners of the area to change.
+// - attrs - The SGR options of the attributes to reverse.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::ReverseAttributesRectangularArea(const size_t top,
+                                                     const size_t left,
+                                                     const size_t bottom,
+                                                     const size_t right,
+                                                     const VTParameters attrs)
+{
+    unsigned int reverseAttrs = 0;
+
+    attrs.for_each([&](const DispatchTypes::GraphicsOptions option) {
+        switch (option)
+        {
+        case DispatchTypes::GraphicsOptions::Off:
+            reverseAttrs ^= AllAttributes;
+            break;
+        case DispatchTypes::GraphicsOptions::BoldBright:
+            reverseAttrs ^= Bold;
+            break;
+        case DispatchTypes::GraphicsOptions::Underline:
+            reverseAttrs ^= Underlined;
+            break;
+        case DispatchTypes::GraphicsOptions::BlinkOrXterm256Index:
+            reverseAttrs ^= Blinking;
+            break;
+        case DispatchTypes::GraphicsOptions::Negative:
+            reverseAttrs ^= ReverseVideo;
+            break;
+        case DispatchTypes::GraphicsOptions::Invisible:
+            reverseAttrs ^= Invisible;
+            break;
+        default:
+            // Any other option is ignored.
+            break;
+        }
+        return true;
+    });
+
+    return _ChangeAttributesHelper(top, left, bottom, right, 0, 0, reverseAttrs);
+}
+
+// Routine Description:
+// - Helper for DECCARA and DECRARA. Applies the change of the attributes to
+//    the area, which is either a stream of characters or a rectangle,
+//    depending on the extent selected with DECSACE.
+// Arguments:
+// - top, left, bottom, right - The corners of the area to change.
+// - setAttrs - The RectangularAttributes to turn on.
+// - clearAttrs - The RectangularAttributes to turn off.
+// - reverseAttrs - The RectangularAttributes to reverse.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::_ChangeAttributesHelper(const size_t top,
+                                            const size_t left,
+                                            const size_t bottom,
+                                            const size_t right,
+                                            const unsigned int setAttrs,
+                                            const unsigned int clearAttrs,
+                                            const unsigned int reverseAttrs)
+{
+    if ((setAttrs | clearAttrs | reverseAttrs) == 0)
+    {
+        return true;
+    }
+
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    RETURN_BOOL_IF_FALSE(_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+
+    const auto change = [=](TextAttribute& attr) noexcept {
+        const auto apply = [&](const unsigned int mask, const bool isSet) noexcept {
+            const auto isOn = (setAttrs & mask) != 0 || (isSet && (clearAttrs & mask) == 0);
+            return isOn != ((reverseAttrs & mask) != 0);
+        };
+        attr.SetBold(apply(Bold, attr.IsBold()));
+        attr.SetUnderlined(apply(Underlined, attr.IsUnderlined()));
+        attr.SetBlinking(apply(Blinking, attr.IsBlinking()));
+        attr.SetReverseVideo(apply(ReverseVideo, attr.IsReverseVideo()));
+        attr.SetInvisible(apply(Invisible, attr.IsInvisible()));
+    };
+
+    const auto area = _CalculateRectArea(top, left, bottom, right, csbiex);
+    if (area.Top > area.Bottom)
+    {
+        return true;
+    }
+
+    // A rectangle, or a stream on a single row, is changed as a whole.
+    if (_changeExtent == DispatchTypes::ChangeExtent::Rectangle || area.Top == area.Bottom)
+    {
+        return area.Left > area.Right || _pConApi->PrivateChangeAttributesInArea(area, change);
+    }
+
+    // Otherwise the stream runs from the start position to the end of its
+    // row, through the full rows in between, to the end position.
+    const auto pageRight = gsl::narrow_cast<SHORT>(csbiex.dwSize.X - 1);
+    bool success = _pConApi->PrivateChangeAttributesInArea({ area.Left, area.Top, pageRight, area.Top }, change);
+    if (area.Bottom - area.Top > 1)
+    {
+        const auto firstFullRow = gsl::narrow_cast<SHORT>(area.Top + 1);
+        const auto lastFullRow = gsl::narrow_cast<SHORT>(area.Bottom - 1);
+        success = _pConApi->PrivateChangeAttributesInArea({ 0, firstFullRow, pageRight, lastFullRow }, change) && success;
+    }
+    success = _pConApi->PrivateChangeAttributesInArea({ 0, area.Bottom, area.Right, area.Bottom }, change) && success;
+    return success;
+}
+
 //Routine Description:
 //  - Erase Scrollback (^[[3J - ED extension by xterm)
 //    Because conhost doesn't exactly have a scrollback, We have to be tricky here.
@@ -2165,6 +2583,21 @@ bool AdaptDispatch::EnableAlternateScroll(const bool enabled)
     return success;
 }
 
+//Routine Description:
+// Synchronized Output Mode - While enabled, the output is not painted, so that
+//      an application drawing its screen in many writes doesn't have its
+//      frames painted half-finished. Everything it drew is painted at once
+//      when the mode is disabled. This isn't passed through to a connected
+//      terminal, as our own renderer holds the frame back already.
+//Arguments:
+// - enabled - true to enable, false to disable.
+// Return value:
+// True if handled successfully. False otherwise.
+bool AdaptDispatch::EnableSynchronizedOutput(const bool enabled)
+{
+    return _pConApi->PrivateEnableSynchronizedOutput(enabled);
+}
+
 //Routine Description:
 // Set Cursor Style - Changes the cursor's style to match the given Dispatch
 //      cursor style. Unix styles are a combination of the shape and the blinking state.
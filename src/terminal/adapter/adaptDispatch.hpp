@@ -53,6 +53,37 @@ namespace Microsoft::Console::VirtualTerminal
         bool EraseInDisplay(const DispatchTypes::EraseType eraseType) override; // ED
         bool EraseInLine(const DispatchTypes::EraseType eraseType) override; // EL
         bool EraseCharacters(const size_t numChars) override; // ECH
+        bool RepeatCharacter(const wchar_t wch, const size_t count) override; // REP
+        bool CopyRectangularArea(const size_t top,
+                                 const size_t left,
+                                 const size_t bottom,
+                                 const size_t right,
+                                 const size_t dstTop,
+                                 const size_t dstLeft) override; // DECCRA
+        bool FillRectangularArea(const size_t ch,
+                                 const size_t top,
+                                 const size_t left,
+                                 const size_t bottom,
+                                 const size_t right) override; // DECFRA
+        bool EraseRectangularArea(const size_t top,
+                                  const size_t left,
+                                  const size_t bottom,
+                                  const size_t right) override; // DECERA
+        bool SelectiveEraseRectangularArea(const size_t top,
+                                           const size_t left,
+                                           const size_t bottom,
+                                           const size_t right) override; // DECSERA
+        bool SelectAttributeChangeExtent(const DispatchTypes::ChangeExtent changeExtent) noexcept override; // DECSACE
+        bool ChangeAttributesRectangularArea(const size_t top,
+                                             const size_t left,
+                                             const size_t bottom,
+                                             const size_t right,
+                                             const VTParameters attrs) override; // DECCARA
+        bool ReverseAttributesRectangularArea(const size_t top,
+                                              const size_t left,
+                                              const size_t bottom,
+                                              const size_t right,
+                                              const VTParameters attrs) override; // DECRARA
         bool InsertCharacter(const size_t count) override; // ICH
         bool DeleteCharacter(const size_t count) override; // DCH
         bool SetGraphicsRendition(const VTParameters options) override; // SGR
@@ -106,6 +137,7 @@ namespace Microsoft::Console::VirtualTerminal
         bool EnableButtonEventMouseMode(const bool enabled) override; // ?1002
         bool EnableAnyEventMouseMode(const bool enabled) override; // ?1003
         bool EnableAlternateScroll(const bool enabled) override; // ?1007
+        bool EnableSynchronizedOutput(const bool enabled) override; // ?2026
         bool SetCursorStyle(const DispatchTypes::CursorStyle cursorStyle) override; // DECSCUSR
         bool SetCursorColor(const COLORREF cursorColor) override;
 
@@ -140,6 +172,16 @@ namespace Microsoft::Console::VirtualTerminal
             TerminalOutput TermOutput = {};
             unsigned int CodePage = 0;
         };
+        // The attributes that DECCARA can change, and DECRARA can reverse.
+        enum RectangularAttributes : unsigned int
+        {
+            Bold = 0x1,
+            Underlined = 0x2,
+            Blinking = 0x4,
+            ReverseVideo = 0x8,
+            Invisible = 0x10,
+            AllAttributes = 0x1f
+        };
         struct Offset
         {
             int Value;
@@ -158,6 +200,18 @@ namespace Microsoft::Console::VirtualTerminal
         bool _EraseScrollback();
         bool _EraseAll();
         bool _InsertDeleteHelper(const size_t count, const bool isInsert) const;
+        SMALL_RECT _CalculateRectArea(const size_t top,
+                                      const size_t left,
+                                      const size_t bottom,
+                                      const size_t right,
+                                      const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex) const noexcept;
+        bool _ChangeAttributesHelper(const size_t top,
+                                     const size_t left,
+                                     const size_t bottom,
+                                     const size_t right,
+                                     const unsigned int setAttrs,
+                                     const unsigned int clearAttrs,
+                                     const unsigned int reverseAttrs);
         bool _ScrollMovement(const ScrollDirection dir, const size_t distance) const;
 
         bool _DoSetTopBottomScrollingMargins(const size_t topMargin,
@@ -198,6 +252,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _isDECCOLMAllowed;
 
+        DispatchTypes::ChangeExtent _changeExtent;
+
         size_t _SetRgbColorsHelper(const VTParameters options,
                                    TextAttribute& attr,
                                    const bool isForeground) noexcept;
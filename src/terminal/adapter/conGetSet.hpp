@@ -69,6 +69,7 @@ namespace Microsoft::Console::VirtualTerminal
         virtual bool PrivateEnableButtonEventMouseMode(const bool enabled) = 0;
         virtual bool PrivateEnableAnyEventMouseMode(const bool enabled) = 0;
         virtual bool PrivateEnableAlternateScroll(const bool enabled) = 0;
+        virtual bool PrivateEnableSynchronizedOutput(const bool enabled) = 0;
         virtual bool PrivateEraseAll() = 0;
         virtual bool GetUserDefaultCursorStyle(CursorType& style) = 0;
         virtual bool SetCursorStyle(const CursorType style) = 0;
@@ -102,6 +103,16 @@ namespace Microsoft::Console::VirtualTerminal
                                          const COORD destinationOrigin,
                                          const bool standardFillAttrs) = 0;
 
+        virtual bool PrivateCopyRectangularArea(const SMALL_RECT sourceRect,
+                                                const COORD targetOrigin) = 0;
+
+        virtual bool PrivateFillRectangularArea(const SMALL_RECT fillRect,
+                                                const wchar_t fillChar,
+                                                const std::optional<TextAttribute> fillAttrs) = 0;
+
+        virtual bool PrivateChangeAttributesInArea(const SMALL_RECT changeRect,
+                                                   const std::function<void(TextAttribute&)>& change) = 0;
+
         virtual bool PrivateAddHyperlink(const std::wstring_view uri, const std::wstring_view params) const = 0;
         virtual bool PrivateEndHyperlink() const = 0;
     };
@@ -72,6 +72,7 @@ public:
     bool EnableButtonEventMouseMode(const bool /*enabled*/) noexcept override { return false; } // ?1002
     bool EnableAnyEventMouseMode(const bool /*enabled*/) noexcept override { return false; } // ?1003
     bool EnableAlternateScroll(const bool /*enabled*/) noexcept override { return false; } // ?1007
+    bool EnableSynchronizedOutput(const bool /*enabled*/) noexcept override { return false; } // ?2026
     bool SetColorTableEntry(const size_t /*tableIndex*/, const DWORD /*color*/) noexcept override { return false; } // OSCColorTable
     bool SetDefaultForeground(const DWORD /*color*/) noexcept override { return false; } // OSCDefaultForeground
     bool SetDefaultBackground(const DWORD /*color*/) noexcept override { return false; } // OSCDefaultBackground
@@ -79,6 +80,15 @@ public:
     bool EraseInDisplay(const DispatchTypes::EraseType /* eraseType*/) noexcept override { return false; } // ED
     bool EraseInLine(const DispatchTypes::EraseType /* eraseType*/) noexcept override { return false; } // EL
     bool EraseCharacters(const size_t /*numChars*/) noexcept override { return false; } // ECH
+    bool RepeatCharacter(const wchar_t /*wch*/, const size_t /*count*/) noexcept override { return false; } // REP
+
+    bool CopyRectangularArea(const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/, const size_t /*dstTop*/, const size_t /*dstLeft*/) noexcept override { return false; } // DECCRA
+    bool FillRectangularArea(const size_t /*ch*/, const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/) noexcept override { return false; } // DECFRA
+    bool EraseRectangularArea(const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/) noexcept override { return false; } // DECERA
+    bool SelectiveEraseRectangularArea(const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/) noexcept override { return false; } // DECSERA
+    bool SelectAttributeChangeExtent(const DispatchTypes::ChangeExtent /*changeExtent*/) noexcept override { return false; } // DECSACE
+    bool ChangeAttributesRectangularArea(const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/, const VTParameters /*attrs*/) noexcept override { return false; } // DECCARA
+    bool ReverseAttributesRectangularArea(const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/, const VTParameters /*attrs*/) noexcept override { return false; } // DECRARA
 
     bool SetGraphicsRendition(const VTParameters /*options*/) noexcept override { return false; } // SGR
 
@@ -417,6 +417,16 @@ public:
         return _privateEnableAlternateScrollResult;
     }
 
+    bool PrivateEnableSynchronizedOutput(const bool enabled) override
+    {
+        Log::Comment(L"PrivateEnableSynchronizedOutput MOCK called...");
+        if (_privateEnableSynchronizedOutputResult)
+        {
+            VERIFY_ARE_EQUAL(_expectedSynchronizedOutputEnabled, enabled);
+        }
+        return _privateEnableSynchronizedOutputResult;
+    }
+
     bool PrivateEraseAll() override
     {
         Log::Comment(L"PrivateEraseAll MOCK called...");
@@ -572,6 +582,51 @@ public:
         return TRUE;
     }
 
+    bool PrivateCopyRectangularArea(const SMALL_RECT sourceRect,
+                                    const COORD targetOrigin) override
+    {
+        Log::Comment(L"PrivateCopyRectangularArea MOCK called...");
+        if (_privateRectangularAreaResult)
+        {
+            VERIFY_ARE_EQUAL(_expectedRectArea, sourceRect);
+            VERIFY_ARE_EQUAL(_expectedRectOrigin, targetOrigin);
+        }
+
+        return _privateRectangularAreaResult;
+    }
+
+    bool PrivateFillRectangularArea(const SMALL_RECT fillRect,
+                                    const wchar_t fillChar,
+                                    const std::optional<TextAttribute> fillAttrs) override
+    {
+        Log::Comment(L"PrivateFillRectangularArea MOCK called...");
+        if (_privateRectangularAreaResult)
+        {
+            VERIFY_ARE_EQUAL(_expectedRectArea, fillRect);
+            VERIFY_ARE_EQUAL(_expectedFillChar, fillChar);
+            VERIFY_ARE_EQUAL(_expectedFillAttrs.has_value(), fillAttrs.has_value());
+            if (fillAttrs.has_value())
+            {
+                VERIFY_ARE_EQUAL(_expectedFillAttrs.value(), fillAttrs.value());
+            }
+        }
+
+        return _privateRectangularAreaResult;
+    }
+
+    bool PrivateChangeAttributesInArea(const SMALL_RECT changeRect,
+                                       const std::function<void(TextAttribute&)>& change) override
+    {
+        Log::Comment(L"PrivateChangeAttributesInArea MOCK called...");
+        if (_privateRectangularAreaResult)
+        {
+            _changedRects.push_back(changeRect);
+            _attributeChange = change;
+        }
+
+        return _privateRectangularAreaResult;
+    }
+
     void PrepData()
     {
         PrepData(CursorDirection::UP); // if called like this, the cursor direction doesn't matter.
@@ -802,12 +857,21 @@ public:
     std::wstring_view _expectedWindowTitle{};
     bool _expectedMouseEnabled = false;
     bool _expectedAlternateScrollEnabled = false;
+    bool _expectedSynchronizedOutputEnabled = false;
     bool _privateEnableVT200MouseModeResult = false;
     bool _privateEnableUTF8ExtendedMouseModeResult = false;
     bool _privateEnableSGRExtendedMouseModeResult = false;
     bool _privateEnableButtonEventMouseModeResult = false;
     bool _privateEnableAnyEventMouseModeResult = false;
     bool _privateEnableAlternateScrollResult = false;
+    bool _privateEnableSynchronizedOutputResult = false;
+    bool _privateRectangularAreaResult = false;
+    SMALL_RECT _expectedRectArea = { 0, 0, 0, 0 };
+    COORD _expectedRectOrigin = { 0, 0 };
+    wchar_t _expectedFillChar = 0;
+    std::optional<TextAttribute> _expectedFillAttrs;
+    std::vector<SMALL_RECT> _changedRects;
+    std::function<void(TextAttribute&)> _attributeChange;
     bool _setCursorStyleResult = false;
     CursorType _expectedCursorStyle;
     bool _setCursorColorResult = false;
@@ -832,6 +896,7 @@ private:
 
 class DummyAdapter : public AdaptDefaults
 {
+public:
     void Print(const wchar_t /*wch*/) override
     {
     }
@@ -840,9 +905,18 @@ class DummyAdapter : public AdaptDefaults
     {
     }
 
+    void PrintRepeated(const wchar_t wch, const size_t count) override
+    {
+        _repeatedChar = wch;
+        _repeatCount = count;
+    }
+
     void Execute(const wchar_t /*wch*/) override
     {
     }
+
+    wchar_t _repeatedChar = 0;
+    size_t _repeatCount = 0;
 };
 
 class AdapterTest
@@ -862,6 +936,7 @@ public:
 
             // give AdaptDispatch ownership of _testGetSet
             _testGetSet = api.get(); // keep a copy for us but don't manage its lifetime anymore.
+            _testAdapter = adapter.get();
             _pDispatch = std::make_unique<AdaptDispatch>(std::move(api), std::move(adapter));
             fSuccess = _pDispatch != nullptr;
         }
@@ -872,6 +947,7 @@ public:
     {
         _pDispatch.reset();
         _testGetSet = nullptr;
+        _testAdapter = nullptr;
         return true;
     }
 
@@ -2112,6 +2188,111 @@ public:
         VERIFY_IS_TRUE(_pDispatch.get()->EnableAlternateScroll(false));
     }
 
+    TEST_METHOD(SynchronizedOutputModeTest)
+    {
+        Log::Comment(L"Starting test...");
+
+        Log::Comment(L"Test 1: Enable synchronized output with DECSET");
+        _testGetSet->_expectedSynchronizedOutputEnabled = true;
+        _testGetSet->_privateEnableSynchronizedOutputResult = TRUE;
+        VERIFY_IS_TRUE(_pDispatch.get()->SetMode(DispatchTypes::ModeParams::SO_SynchronizedOutput));
+
+        Log::Comment(L"Test 2: Disable synchronized output with DECRST");
+        _testGetSet->_expectedSynchronizedOutputEnabled = false;
+        VERIFY_IS_TRUE(_pDispatch.get()->ResetMode(DispatchTypes::ModeParams::SO_SynchronizedOutput));
+    }
+
+    TEST_METHOD(RepeatCharacterTest)
+    {
+        Log::Comment(L"Starting test...");
+
+        Log::Comment(L"Test 1: The whole run is handed over at once.");
+        VERIFY_IS_TRUE(_pDispatch.get()->RepeatCharacter(L'q', 5));
+        VERIFY_ARE_EQUAL(L'q', _testAdapter->_repeatedChar);
+        VERIFY_ARE_EQUAL(5u, _testAdapter->_repeatCount);
+
+        Log::Comment(L"Test 2: The character is translated by the active character set.");
+        VERIFY_IS_TRUE(_pDispatch.get()->Designate94Charset(0, DispatchTypes::CharacterSets::DecSpecialGraphics));
+        VERIFY_IS_TRUE(_pDispatch.get()->RepeatCharacter(L'q', 3));
+        VERIFY_ARE_EQUAL(L'\x2500', _testAdapter->_repeatedChar);
+        VERIFY_ARE_EQUAL(3u, _testAdapter->_repeatCount);
+    }
+
+    TEST_METHOD(RectangularAreaTests)
+    {
+        Log::Comment(L"Starting test...");
+
+        _testGetSet->PrepData();
+        _testGetSet->_privateRectangularAreaResult = true;
+
+        // The page is the viewport, rows 20 to 48 of a buffer that's 100 columns wide.
+        Log::Comment(L"Test 1: DECFRA fills the area with the character, using the current rendition.");
+        _testGetSet->_expectedRectArea = { 2, 21, 4, 23 };
+        _testGetSet->_expectedFillChar = L'X';
+        _testGetSet->_expectedFillAttrs = _testGetSet->_attribute;
+        VERIFY_IS_TRUE(_pDispatch.get()->FillRectangularArea(L'X', 2, 3, 4, 5));
+
+        Log::Comment(L"Test 2: DECFRA ignores characters that aren't printable.");
+        _testGetSet->_privateRectangularAreaResult = false;
+        VERIFY_IS_TRUE(_pDispatch.get()->FillRectangularArea(L'\x1b', 2, 3, 4, 5));
+        _testGetSet->_privateRectangularAreaResult = true;
+
+        Log::Comment(L"Test 3: DECERA erases the whole page by default, with the standard erase attributes.");
+        _testGetSet->_expectedRectArea = { 0, 20, 99, 48 };
+        _testGetSet->_expectedFillChar = L' ';
+        auto eraseAttrs = _testGetSet->_attribute;
+        eraseAttrs.SetStandardErase();
+        _testGetSet->_expectedFillAttrs = eraseAttrs;
+        VERIFY_IS_TRUE(_pDispatch.get()->EraseRectangularArea(0, 0, 0, 0));
+
+        Log::Comment(L"Test 4: DECSERA keeps the attributes, and the area is clamped to the page.");
+        _testGetSet->_expectedFillAttrs = std::nullopt;
+        VERIFY_IS_TRUE(_pDispatch.get()->SelectiveEraseRectangularArea(1, 1, 1000, 1000));
+
+        Log::Comment(L"Test 5: An area whose corners are swapped is empty.");
+        _testGetSet->_privateRectangularAreaResult = false;
+        VERIFY_IS_TRUE(_pDispatch.get()->EraseRectangularArea(5, 5, 4, 4));
+        _testGetSet->_privateRectangularAreaResult = true;
+
+        Log::Comment(L"Test 6: DECCRA clips the part of the copy that would fall off the page.");
+        _testGetSet->_expectedRectArea = { 0, 20, 1, 21 };
+        _testGetSet->_expectedRectOrigin = { 98, 47 };
+        VERIFY_IS_TRUE(_pDispatch.get()->CopyRectangularArea(1, 1, 3, 3, 28, 99));
+
+        Log::Comment(L"Test 7: DECCARA changes a stream of characters by default.");
+        VTParameter rgOptions[16];
+        rgOptions[0] = DispatchTypes::GraphicsOptions::BoldBright;
+        VERIFY_IS_TRUE(_pDispatch.get()->ChangeAttributesRectangularArea(2, 3, 4, 5, { rgOptions, 1 }));
+        VERIFY_ARE_EQUAL(3u, _testGetSet->_changedRects.size());
+        VERIFY_ARE_EQUAL((SMALL_RECT{ 2, 21, 99, 21 }), _testGetSet->_changedRects.at(0));
+        VERIFY_ARE_EQUAL((SMALL_RECT{ 0, 22, 99, 22 }), _testGetSet->_changedRects.at(1));
+        VERIFY_ARE_EQUAL((SMALL_RECT{ 0, 23, 4, 23 }), _testGetSet->_changedRects.at(2));
+        TextAttribute attr{};
+        _testGetSet->_attributeChange(attr);
+        VERIFY_IS_TRUE(attr.IsBold());
+
+        Log::Comment(L"Test 8: After DECSACE 2, DECCARA changes a rectangle, in the order the options are given.");
+        _testGetSet->_changedRects.clear();
+        VERIFY_IS_TRUE(_pDispatch.get()->SelectAttributeChangeExtent(DispatchTypes::ChangeExtent::Rectangle));
+        rgOptions[0] = DispatchTypes::GraphicsOptions::Off;
+        rgOptions[1] = DispatchTypes::GraphicsOptions::Underline;
+        VERIFY_IS_TRUE(_pDispatch.get()->ChangeAttributesRectangularArea(2, 3, 4, 5, { rgOptions, 2 }));
+        VERIFY_ARE_EQUAL(1u, _testGetSet->_changedRects.size());
+        VERIFY_ARE_EQUAL((SMALL_RECT{ 2, 21, 4, 23 }), _testGetSet->_changedRects.at(0));
+        _testGetSet->_attributeChange(attr);
+        VERIFY_IS_FALSE(attr.IsBold());
+        VERIFY_IS_TRUE(attr.IsUnderlined());
+
+        Log::Comment(L"Test 9: DECRARA reverses the attributes.");
+        _testGetSet->_changedRects.clear();
+        rgOptions[0] = DispatchTypes::GraphicsOptions::BoldBright;
+        rgOptions[1] = DispatchTypes::GraphicsOptions::Underline;
+        VERIFY_IS_TRUE(_pDispatch.get()->ReverseAttributesRectangularArea(2, 3, 4, 5, { rgOptions, 2 }));
+        _testGetSet->_attributeChange(attr);
+        VERIFY_IS_TRUE(attr.IsBold());
+        VERIFY_IS_FALSE(attr.IsUnderlined());
+    }
+
     TEST_METHOD(Xterm256ColorTest)
     {
         Log::Comment(L"Starting test...");
@@ -2233,5 +2414,6 @@ public:
 
 private:
     TestGetSet* _testGetSet; // non-ownership pointer
+    DummyAdapter* _testAdapter; // non-ownership pointer
     std::unique_ptr<AdaptDispatch> _pDispatch;
 };
@@ -18,7 +18,11 @@ OutputStateMachineEngine::OutputStateMachineEngine(std::unique_ptr<ITermDispatch
     _dispatch(std::move(pDispatch)),
     _pfnFlushToTerminal(nullptr),
     _pTtyConnection(nullptr),
-    _lastPrintedChar(AsciiChars::NUL)
+    _lastPrintedChar(AsciiChars::NUL),
+    _passthrough(false),
+    _lineFeedReturns(false),
+    _pfnSuspendPassthrough(nullptr),
+    _pendingHighSurrogate(AsciiChars::NUL)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, _dispatch.get());
 }
@@ -84,6 +88,27 @@ bool OutputStateMachineEngine::ActionExecute(const wchar_t wch)
         break;
     }
 
+    // In passthrough mode, the terminal gets the control character too. NUL
+    //      is dropped as above, and BEL was already flushed.
+    if (_passthrough && _pTtyConnection != nullptr &&
+        wch != AsciiChars::NUL && wch != AsciiChars::BEL)
+    {
+        _FlushPendingHighSurrogate();
+
+        // If the line feed returned our cursor to the left margin too, the
+        //      terminal has to be told to do the same, since it won't on its own.
+        const bool isLineFeed = wch == AsciiChars::LF || wch == AsciiChars::FF || wch == AsciiChars::VT;
+        if (isLineFeed && _lineFeedReturns)
+        {
+            const wchar_t lineFeed[] = { AsciiChars::CR, wch };
+            LOG_IF_FAILED(_pTtyConnection->WriteTerminalW({ lineFeed, ARRAYSIZE(lineFeed) }));
+        }
+        else
+        {
+            LOG_IF_FAILED(_pTtyConnection->WriteTerminalW({ &wch, 1 }));
+        }
+    }
+
     _ClearLastChar();
 
     return true;
@@ -121,6 +146,11 @@ bool OutputStateMachineEngine::ActionPrint(const wchar_t wch)
 
     _dispatch->Print(wch); // call print
 
+    if (_passthrough && _pTtyConnection != nullptr)
+    {
+        _PassThroughText({ &wch, 1 });
+    }
+
     return true;
 }
 
@@ -147,6 +177,11 @@ bool OutputStateMachineEngine::ActionPrintString(const std::wstring_view string)
 
     _dispatch->PrintString(string); // call print
 
+    if (_passthrough && _pTtyConnection != nullptr)
+    {
+        _PassThroughText(string);
+    }
+
     return true;
 }
 
@@ -167,6 +202,8 @@ bool OutputStateMachineEngine::ActionPassThroughString(const std::wstring_view s
     bool success = true;
     if (_pTtyConnection != nullptr)
     {
+        _FlushPendingHighSurrogate();
+
         const auto hr = _pTtyConnection->WriteTerminalW(string);
         LOG_IF_FAILED(hr);
         success = SUCCEEDED(hr);
@@ -306,6 +343,9 @@ bool OutputStateMachineEngine::ActionEscDispatch(const VTID id)
         }
     }
 
+    // In passthrough mode, forward what we handled to the terminal as well.
+    _PassThroughIfDispatched(success);
+
     // If we were unable to process the string, and there's a TTY attached to us,
     //      trigger the state machine to flush the string to the terminal.
     if (_pfnFlushToTerminal != nullptr && !success)
@@ -386,6 +426,10 @@ bool OutputStateMachineEngine::ActionVt52EscDispatch(const VTID id, const VTPara
         break;
     }
 
+    // In passthrough mode, forward what we handled to the terminal as well,
+    //      except for the identify request that we answer ourselves.
+    _PassThroughIfDispatched(success && id != Vt52ActionCodes::Identify);
+
     _ClearLastChar();
 
     return success;
@@ -404,6 +448,17 @@ bool OutputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParamete
 {
     bool success = false;
 
+    // In passthrough mode, the sequences that the terminal doesn't handle like
+    //      we do are only executed on our buffer. Passthrough is suspended
+    //      around them, so that whatever they change is painted instead.
+    const bool forward = _IsCsiForwardable(id);
+    const bool executeLocally = _passthrough && !forward && _pfnSuspendPassthrough != nullptr;
+    if (executeLocally)
+    {
+        _FlushPendingHighSurrogate();
+        _pfnSuspendPassthrough(true);
+    }
+
     switch (id)
     {
     case CsiActionCodes::CUU_CursorUp:
@@ -560,18 +615,9 @@ bool OutputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParamete
         TermTelemetry::Instance().Log(TermTelemetry::Codes::DTTERM_WM);
         break;
     case CsiActionCodes::REP_RepeatCharacter:
-        // Handled w/o the dispatch. This function is unique in that way
-        // If this were in the ITerminalDispatch, then each
-        // implementation would effectively be the same, calling only
-        // functions that are already part of the interface.
-        // Print the last graphical character a number of times.
-        if (_lastPrintedChar != AsciiChars::NUL)
-        {
-            const size_t repeatCount = parameters.at(0);
-            std::wstring wstr(repeatCount, _lastPrintedChar);
-            _dispatch->PrintString(wstr);
-        }
-        success = true;
+        // Print the last graphical character a number of times. We keep
+        // track of it here, since any other action we dispatch resets it.
+        success = _lastPrintedChar == AsciiChars::NUL || _dispatch->RepeatCharacter(_lastPrintedChar, parameters.at(0));
         TermTelemetry::Instance().Log(TermTelemetry::Codes::REP);
         break;
     case CsiActionCodes::DECSCUSR_SetCursorStyle:
@@ -582,12 +628,73 @@ bool OutputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParamete
         success = _dispatch->SoftReset();
         TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSTR);
         break;
+    case CsiActionCodes::DECCRA_CopyRectangularArea:
+        // We only have the one page, so the source page (4) and the
+        // destination page (7) are ignored.
+        success = _dispatch->CopyRectangularArea(parameters.at(0).value_or(0),
+                                                 parameters.at(1).value_or(0),
+                                                 parameters.at(2).value_or(0),
+                                                 parameters.at(3).value_or(0),
+                                                 parameters.at(5).value_or(0),
+                                                 parameters.at(6).value_or(0));
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECCRA);
+        break;
+    case CsiActionCodes::DECFRA_FillRectangularArea:
+        success = _dispatch->FillRectangularArea(parameters.at(0).value_or(0),
+                                                 parameters.at(1).value_or(0),
+                                                 parameters.at(2).value_or(0),
+                                                 parameters.at(3).value_or(0),
+                                                 parameters.at(4).value_or(0));
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECFRA);
+        break;
+    case CsiActionCodes::DECERA_EraseRectangularArea:
+        success = _dispatch->EraseRectangularArea(parameters.at(0).value_or(0),
+                                                  parameters.at(1).value_or(0),
+                                                  parameters.at(2).value_or(0),
+                                                  parameters.at(3).value_or(0));
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECERA);
+        break;
+    case CsiActionCodes::DECSERA_SelectiveEraseRectangularArea:
+        success = _dispatch->SelectiveEraseRectangularArea(parameters.at(0).value_or(0),
+                                                           parameters.at(1).value_or(0),
+                                                           parameters.at(2).value_or(0),
+                                                           parameters.at(3).value_or(0));
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSERA);
+        break;
+    case CsiActionCodes::DECCARA_ChangeAttributesRectangularArea:
+        success = _dispatch->ChangeAttributesRectangularArea(parameters.at(0).value_or(0),
+                                                             parameters.at(1).value_or(0),
+                                                             parameters.at(2).value_or(0),
+                                                             parameters.at(3).value_or(0),
+                                                             parameters.subspan(4));
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECCARA);
+        break;
+    case CsiActionCodes::DECRARA_ReverseAttributesRectangularArea:
+        success = _dispatch->ReverseAttributesRectangularArea(parameters.at(0).value_or(0),
+                                                              parameters.at(1).value_or(0),
+                                                              parameters.at(2).value_or(0),
+                                                              parameters.at(3).value_or(0),
+                                                              parameters.subspan(4));
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECRARA);
+        break;
+    case CsiActionCodes::DECSACE_SelectAttributeChangeExtent:
+        success = _dispatch->SelectAttributeChangeExtent(parameters.at(0));
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSACE);
+        break;
     default:
         // If no functions to call, overall dispatch was a failure.
         success = false;
         break;
     }
 
+    if (executeLocally)
+    {
+        _pfnSuspendPassthrough(false);
+    }
+
+    // In passthrough mode, forward what we handled to the terminal as well.
+    _PassThroughIfDispatched(success && forward);
+
     // If we were unable to process the string, and there's a TTY attached to us,
     //      trigger the state machine to flush the string to the terminal.
     if (_pfnFlushToTerminal != nullptr && !success)
@@ -744,6 +851,13 @@ bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
         break;
     }
 
+    // In passthrough mode, forward what we handled to the terminal as well.
+    //      The renderer still paints the title, so don't send that one twice.
+    const bool isTitle = parameter == OscActionCodes::SetIconAndWindowTitle ||
+                         parameter == OscActionCodes::SetWindowIcon ||
+                         parameter == OscActionCodes::SetWindowTitle;
+    _PassThroughIfDispatched(success && !isTitle);
+
     // If we were unable to process the string, and there's a TTY attached to us,
     //      trigger the state machine to flush the string to the terminal.
     if (_pfnFlushToTerminal != nullptr && !success)
@@ -1003,6 +1117,34 @@ void OutputStateMachineEngine::SetTerminalConnection(ITerminalOutputConnection*
     this->_pfnFlushToTerminal = pfnFlushToTerminal;
 }
 
+// Routine Description:
+// - Enables or disables passthrough mode. While it's enabled, everything we
+//      print or dispatch is also written to the attached terminal as-is, so
+//      the terminal doesn't need to be repainted from the buffer afterwards.
+//      The control sequences that the terminal can't be relied on to handle
+//      like we do, queries included, are never forwarded. Passthrough is
+//      suspended while we execute them, so that the renderer paints what
+//      they changed.
+//   Has no effect unless a terminal connection was set.
+// Arguments:
+// - passthrough: true to forward output to the terminal, false to stop.
+// - lineFeedReturns: true if a line feed also performs a carriage return in
+//      the buffer (DISABLE_NEWLINE_AUTO_RETURN is not set). The terminal
+//      always treats a line feed as just a line feed, so we forward a CR
+//      along with it.
+// - pfnSuspendPassthrough: called with true before we execute a sequence that
+//      isn't forwarded, and with false after it, to resume passthrough.
+// Return Value:
+// - <none>
+void OutputStateMachineEngine::SetPassthroughMode(const bool passthrough,
+                                                  const bool lineFeedReturns,
+                                                  std::function<void(bool)> pfnSuspendPassthrough)
+{
+    _passthrough = passthrough;
+    _lineFeedReturns = lineFeedReturns;
+    _pfnSuspendPassthrough = std::move(pfnSuspendPassthrough);
+}
+
 // Routine Description:
 // - Parse OscSetClipboard parameters with the format `Pc;Pd`. Currently the first parameter `Pc` is
 // ignored. The second parameter `Pd` should be a valid base64 string or character `?`.
@@ -1046,3 +1188,133 @@ void OutputStateMachineEngine::_ClearLastChar() noexcept
 {
     _lastPrintedChar = AsciiChars::NUL;
 }
+
+// Method Description:
+// - In passthrough mode, triggers the state machine to flush the sequence it
+//      just dispatched to the terminal. Sequences that failed to dispatch are
+//      already flushed by the callers, so they're skipped here.
+// Arguments:
+// - dispatched - true if the sequence was handled and should be forwarded.
+// Return Value:
+// - <none>
+void OutputStateMachineEngine::_PassThroughIfDispatched(const bool dispatched)
+{
+    if (_passthrough && dispatched && _pfnFlushToTerminal != nullptr)
+    {
+        _pfnFlushToTerminal();
+    }
+}
+
+// Method Description:
+// - In passthrough mode, writes printed text to the terminal. The text is
+//      converted to UTF-8 one call at a time, and a surrogate pair can be
+//      split across two calls (or two writes), which would turn each half
+//      into a U+FFFD of its own. So a trailing high surrogate is held back and
+//      sent in front of whatever comes next.
+// Arguments:
+// - string - the text that was printed.
+// Return Value:
+// - <none>
+void OutputStateMachineEngine::_PassThroughText(const std::wstring_view string)
+{
+    auto text = string;
+    wchar_t heldBack = AsciiChars::NUL;
+    if (!text.empty() && IS_HIGH_SURROGATE(text.back()))
+    {
+        heldBack = text.back();
+        text.remove_suffix(1);
+    }
+
+    if (_pendingHighSurrogate != AsciiChars::NUL && !text.empty())
+    {
+        std::wstring joined;
+        joined.reserve(text.size() + 1);
+        joined.push_back(_pendingHighSurrogate);
+        joined.append(text);
+        _pendingHighSurrogate = AsciiChars::NUL;
+        LOG_IF_FAILED(_pTtyConnection->WriteTerminalW(joined));
+    }
+    else if (!text.empty())
+    {
+        LOG_IF_FAILED(_pTtyConnection->WriteTerminalW(text));
+    }
+
+    if (heldBack != AsciiChars::NUL)
+    {
+        // Two high surrogates in a row: the first one is never going to be paired.
+        _FlushPendingHighSurrogate();
+        _pendingHighSurrogate = heldBack;
+    }
+}
+
+// Method Description:
+// - Writes a high surrogate that _PassThroughText held back, if there is one,
+//      so that it stays in front of the control characters and sequences that
+//      followed it. Since it wasn't followed by its pair, the terminal will
+//      get a replacement character for it, just as if it hadn't been held.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void OutputStateMachineEngine::_FlushPendingHighSurrogate()
+{
+    if (_pendingHighSurrogate != AsciiChars::NUL && _pTtyConnection != nullptr)
+    {
+        const wchar_t wch = std::exchange(_pendingHighSurrogate, AsciiChars::NUL);
+        LOG_IF_FAILED(_pTtyConnection->WriteTerminalW({ &wch, 1 }));
+    }
+}
+
+// Method Description:
+// - Returns true for the control sequences that every terminal we might be
+//      connected to handles the same way we do. Only those are forwarded in
+//      passthrough mode. Anything else, like the rectangular area operations
+//      that most terminals don't support, or the queries that we answer
+//      ourselves, is only executed on our buffer.
+// Arguments:
+// - id - Identifier of the control sequence.
+// Return Value:
+// - True iff the sequence can be forwarded to the terminal.
+bool OutputStateMachineEngine::_IsCsiForwardable(const VTID id) noexcept
+{
+    switch (id)
+    {
+    case CsiActionCodes::CUU_CursorUp:
+    case CsiActionCodes::CUD_CursorDown:
+    case CsiActionCodes::CUF_CursorForward:
+    case CsiActionCodes::CUB_CursorBackward:
+    case CsiActionCodes::CNL_CursorNextLine:
+    case CsiActionCodes::CPL_CursorPrevLine:
+    case CsiActionCodes::CHA_CursorHorizontalAbsolute:
+    case CsiActionCodes::HPA_HorizontalPositionAbsolute:
+    case CsiActionCodes::VPA_VerticalLinePositionAbsolute:
+    case CsiActionCodes::HPR_HorizontalPositionRelative:
+    case CsiActionCodes::VPR_VerticalPositionRelative:
+    case CsiActionCodes::CUP_CursorPosition:
+    case CsiActionCodes::HVP_HorizontalVerticalPosition:
+    case CsiActionCodes::DECSTBM_SetScrollingRegion:
+    case CsiActionCodes::ICH_InsertCharacter:
+    case CsiActionCodes::DCH_DeleteCharacter:
+    case CsiActionCodes::ED_EraseDisplay:
+    case CsiActionCodes::EL_EraseLine:
+    case CsiActionCodes::DECSET_PrivateModeSet:
+    case CsiActionCodes::DECRST_PrivateModeReset:
+    case CsiActionCodes::SGR_SetGraphicsRendition:
+    case CsiActionCodes::SU_ScrollUp:
+    case CsiActionCodes::SD_ScrollDown:
+    case CsiActionCodes::ANSISYSSC_CursorSave:
+    case CsiActionCodes::ANSISYSRC_CursorRestore:
+    case CsiActionCodes::IL_InsertLine:
+    case CsiActionCodes::DL_DeleteLine:
+    case CsiActionCodes::CHT_CursorForwardTab:
+    case CsiActionCodes::CBT_CursorBackTab:
+    case CsiActionCodes::TBC_TabClear:
+    case CsiActionCodes::ECH_EraseCharacters:
+    case CsiActionCodes::REP_RepeatCharacter:
+    case CsiActionCodes::DECSCUSR_SetCursorStyle:
+    case CsiActionCodes::DECSTR_SoftReset:
+        return true;
+    default:
+        return false;
+    }
+}
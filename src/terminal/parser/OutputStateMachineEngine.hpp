@@ -57,6 +57,10 @@ namespace Microsoft::Console::VirtualTerminal
         void SetTerminalConnection(Microsoft::Console::ITerminalOutputConnection* const pTtyConnection,
                                    std::function<bool()> pfnFlushToTerminal);
 
+        void SetPassthroughMode(const bool passthrough,
+                                const bool lineFeedReturns = false,
+                                std::function<void(bool)> pfnSuspendPassthrough = nullptr);
+
         const ITermDispatch& Dispatch() const noexcept;
         ITermDispatch& Dispatch() noexcept;
 
@@ -65,6 +69,10 @@ namespace Microsoft::Console::VirtualTerminal
         Microsoft::Console::ITerminalOutputConnection* _pTtyConnection;
         std::function<bool()> _pfnFlushToTerminal;
         wchar_t _lastPrintedChar;
+        bool _passthrough;
+        bool _lineFeedReturns;
+        std::function<void(bool)> _pfnSuspendPassthrough;
+        wchar_t _pendingHighSurrogate;
 
         enum EscActionCodes : uint64_t
         {
@@ -130,7 +138,14 @@ namespace Microsoft::Console::VirtualTerminal
             DECREQTPARM_RequestTerminalParameters = VTID("x"),
             DECSCUSR_SetCursorStyle = VTID(" q"),
             DECSTR_SoftReset = VTID("!p"),
-            DECSCPP_SetColumnsPerPage = VTID("$|")
+            DECCARA_ChangeAttributesRectangularArea = VTID("$r"),
+            DECRARA_ReverseAttributesRectangularArea = VTID("$t"),
+            DECCRA_CopyRectangularArea = VTID("$v"),
+            DECFRA_FillRectangularArea = VTID("$x"),
+            DECERA_EraseRectangularArea = VTID("$z"),
+            DECSERA_SelectiveEraseRectangularArea = VTID("${"),
+            DECSCPP_SetColumnsPerPage = VTID("$|"),
+            DECSACE_SelectAttributeChangeExtent = VTID("*x")
         };
 
         enum Vt52ActionCodes : uint64_t
@@ -190,5 +205,10 @@ namespace Microsoft::Console::VirtualTerminal
                              std::wstring& uri) const;
 
         void _ClearLastChar() noexcept;
+
+        void _PassThroughIfDispatched(const bool dispatched);
+        void _PassThroughText(const std::wstring_view string);
+        void _FlushPendingHighSurrogate();
+        static bool _IsCsiForwardable(const VTID id) noexcept;
     };
 }
@@ -7,6 +7,11 @@
 
 #include "ascii.hpp"
 
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#include <emmintrin.h>
+#endif
+
 using namespace Microsoft::Console::VirtualTerminal;
 
 //Takes ownership of the pEngine.
@@ -15,6 +20,7 @@ StateMachine::StateMachine(std::unique_ptr<IStateMachineEngine> engine) :
     _state(VTStates::Ground),
     _trace(Microsoft::Console::VirtualTerminal::ParserTracing()),
     _isInAnsiMode(true),
+    _isGroundScanVectorized(true),
     _parameters{},
     _parameterLimitReached(false),
     _oscString{},
@@ -29,6 +35,18 @@ void StateMachine::SetAnsiMode(bool ansiMode) noexcept
     _isInAnsiMode = ansiMode;
 }
 
+// Routine Description:
+// - Enables or disables the vectorized scan for printable runs in the ground
+//   state. Both paths dispatch exactly the same actions; this only exists so
+//   the scalar path can be compared against the vectorized one.
+// Arguments:
+// - enabled - True to scan blocks of characters at a time, false to inspect
+//   each character individually.
+void StateMachine::SetVectorizedGroundScan(bool enabled) noexcept
+{
+    _isGroundScanVectorized = enabled;
+}
+
 const IStateMachineEngine& StateMachine::Engine() const noexcept
 {
     return *_engine;
@@ -374,6 +392,67 @@ static constexpr bool _isActionableFromGround(const wchar_t wch) noexcept
 
 #pragma warning(pop)
 
+// Routine Description:
+// - Finds the next character that's actionable from the ground state, which
+//   is the end of the printable run that starts at the given offset.
+// - On x86/x64 this tests 8 characters at a time with SSE2, which is part of
+//   the baseline for both architectures. Everywhere else, and for the tail of
+//   the string, it falls back to testing one character at a time.
+// Arguments:
+// - string - Characters to scan.
+// - offset - Index of the first character to test.
+// Return Value:
+// - The index of the first actionable character at or after offset, or the
+//   size of the string if there isn't one.
+static size_t _findActionableFromGround(const std::wstring_view string, size_t offset) noexcept
+{
+    static_assert(sizeof(wchar_t) == sizeof(uint16_t), "The vectorized scan compares 16-bit code units");
+
+    const auto size = string.size();
+
+#if defined(_M_X64) || defined(_M_IX86)
+    const auto zero = _mm_setzero_si128();
+    const auto c0Last = _mm_set1_epi16(AsciiChars::US);
+    const auto del = _mm_set1_epi16(AsciiChars::DEL);
+    const auto c1First = _mm_set1_epi16(0x80);
+
+    for (; offset + 8 <= size; offset += 8)
+    {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. We're reading a block of 8 characters we already bounds checked.
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast. Required to load into an SSE register.
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string.data() + offset));
+
+        // SSE2 has no unsigned 16-bit comparison, but an unsigned saturating
+        // subtraction only yields zero when the left side is <= the right one.
+        // C0: wch <= 0x1F
+        const auto isC0 = _mm_cmpeq_epi16(_mm_subs_epu16(chars, c0Last), zero);
+        // DEL: wch == 0x7F
+        const auto isDel = _mm_cmpeq_epi16(chars, del);
+        // C1: wch - 0x80 <= 0x1F, where anything below 0x80 wraps around to a large value.
+        const auto isC1 = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(chars, c1First), c0Last), zero);
+
+        const auto mask = gsl::narrow_cast<unsigned long>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(isC0, isDel), isC1)));
+        if (mask != 0)
+        {
+            // The mask has two bits for every 16-bit character.
+            unsigned long index = 0;
+            _BitScanForward(&index, mask);
+            return offset + index / 2;
+        }
+    }
+#endif
+
+    for (; offset < size; ++offset)
+    {
+        if (_isActionableFromGround(til::at(string, offset)))
+        {
+            return offset;
+        }
+    }
+
+    return size;
+}
+
 // Routine Description:
 // - Triggers the Execute action to indicate that the listener should immediately respond to a C0 control character.
 // Arguments:
@@ -676,6 +755,27 @@ void StateMachine::_ActionDcsPassThrough(const wchar_t wch)
     // TODO:GH#7316: Send the DCS passthrough sequence to the engine
 }
 
+// Routine Description:
+// - Stores a parameter character of a VT52 Direct Cursor Address command, and
+//   dispatches the command once both of its parameters have been received.
+// Arguments:
+// - wch - Character to store.
+// Return Value:
+// - <none>
+void StateMachine::_ActionVt52Param(const wchar_t wch)
+{
+    _trace.TraceOnAction(L"Vt52Param");
+
+    _parameters.push_back(wch);
+    if (_parameters.size() == 2)
+    {
+        // The command character is processed before the parameter values,
+        // but it will always be 'Y', the Direct Cursor Address command.
+        _ActionVt52EscDispatch(L'Y');
+        _EnterGround();
+    }
+}
+
 // Routine Description:
 // - Moves the state machine into the Ground state.
 //   This state is entered:
@@ -988,28 +1088,6 @@ void StateMachine::_EnterSosPmApcTermination() noexcept
     _trace.TraceStateChange(L"SosPmApcStringTermination");
 }
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the Ground state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Print all other characters
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventGround(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"Ground");
-    if (_isC0Code(wch) || _isDelete(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else
-    {
-        _ActionPrint(wch);
-    }
-}
-
 // Routine Description:
 // - Processes a character event into an Action that occurs while in the Escape state.
 //   Events in this state will:
@@ -1136,592 +1214,611 @@ void StateMachine::_EventEscapeIntermediate(const wchar_t wch)
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiEntry state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Store parameter data
-//   6. Collect Control Sequence Private markers
-//   7. Dispatch a control sequence with parameters for action
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventCsiEntry(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiEntry");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiIntermediate();
-    }
-    else if (_isCsiInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterCsiParam();
-    }
-    else if (_isCsiPrivateMarker(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiParam();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiIntermediate state.
+// - Handle "Variable Length String" termination.
 //   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Dispatch a control sequence with parameters for action
+//   1. Trigger the corresponding action and enter ground if we see a string terminator,
+//   2. Otherwise treat this as a normal escape character event.
 // Arguments:
 // - wch - Character that triggered the event
 // Return Value:
 // - <none>
-void StateMachine::_EventCsiIntermediate(const wchar_t wch)
+void StateMachine::_EventVariableLengthStringTermination(const wchar_t wch)
 {
-    _trace.TraceOnEvent(L"CsiIntermediate");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediateInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
+    if (_isStringTerminatorIndicator(wch))
     {
-        _ActionCsiDispatch(wch);
+        if (_state == VTStates::OscTermination)
+        {
+            _ActionOscDispatch(wch);
+        }
+        else if (_state == VTStates::DcsTermination)
+        {
+            // TODO:GH#7316: The Dcs sequence has successfully terminated. This is where we'd be dispatching the DCS command.
+        }
+        else if (_state == VTStates::SosPmApcTermination)
+        {
+            // We don't support any SOS/PM/APC control string yet.
+        }
         _EnterGround();
     }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiIgnore state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Return to Ground
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventCsiIgnore(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiIgnore");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediateInvalid(wch))
-    {
-        _ActionIgnore();
-    }
     else
     {
-        _EnterGround();
+        _EnterEscape();
+        _EventEscape(wch);
     }
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiParam state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Store parameter data
-//   6. Dispatch a control sequence with parameters for action
+// - Sorts every character below 0x100 into its character class. Characters
+//   0x100 and above are all VTCharClass::Other.
 // Arguments:
-// - wch - Character that triggered the event
-// Return Value:
 // - <none>
-void StateMachine::_EventCsiParam(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiParam");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiIntermediate();
-    }
-    else if (_isParameterInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the OscParam state.
-//   Events in this state will:
-//   1. Collect numeric values into an Osc Param
-//   2. Move to the OscString state on a delimiter
-//   3. Ignore everything else.
-// Arguments:
-// - wch - Character that triggered the event
 // Return Value:
-// - <none>
-void StateMachine::_EventOscParam(const wchar_t wch) noexcept
+// - The class of each of the first 256 characters.
+constexpr StateMachine::VTCharClassTable StateMachine::_BuildCharClassTable() noexcept
 {
-    _trace.TraceOnEvent(L"OscParam");
-    if (_isOscTerminator(wch))
-    {
-        _EnterGround();
-    }
-    else if (_isNumericParamValue(wch))
-    {
-        _ActionOscParam(wch);
-    }
-    else if (_isOscDelimiter(wch))
+    VTCharClassTable charClasses{};
+    for (size_t i = 0; i < charClasses.size(); ++i)
     {
-        _EnterOscString();
-    }
-    else
-    {
-        _ActionIgnore();
+        const auto wch = gsl::narrow_cast<wchar_t>(i);
+        auto charClass = VTCharClass::Other;
+        if (wch == AsciiChars::CAN || wch == AsciiChars::SUB)
+        {
+            charClass = VTCharClass::CanSub;
+        }
+        else if (_isOscTerminator(wch))
+        {
+            charClass = VTCharClass::Bel;
+        }
+        else if (_isEscape(wch))
+        {
+            charClass = VTCharClass::Escape;
+        }
+        else if (_isC0Code(wch))
+        {
+            charClass = VTCharClass::C0;
+        }
+        else if (_isIntermediate(wch))
+        {
+            charClass = VTCharClass::Intermediate;
+        }
+        else if (_isNumericParamValue(wch))
+        {
+            charClass = VTCharClass::Digit;
+        }
+        else if (_isCsiInvalid(wch))
+        {
+            charClass = VTCharClass::Colon;
+        }
+        else if (_isParameterDelimiter(wch))
+        {
+            charClass = VTCharClass::Semicolon;
+        }
+        else if (_isCsiPrivateMarker(wch))
+        {
+            charClass = VTCharClass::PrivateMarker;
+        }
+        else if (_isDelete(wch))
+        {
+            charClass = VTCharClass::Delete;
+        }
+        else if (_isC1ControlCharacter(wch))
+        {
+            charClass = VTCharClass::C1;
+        }
+        else if (_isDcsPassThroughValid(wch))
+        {
+            charClass = VTCharClass::Final;
+        }
+        til::at(charClasses, i) = charClass;
     }
+    return charClasses;
 }
 
 // Routine Description:
-// - Processes a character event into a Action that occurs while in the OscParam state.
-//   Events in this state will:
-//   1. Trigger the OSC action associated with the param on an OscTerminator
-//   2. If we see a ESC, enter the OscTermination state. We'll wait for one
-//      more character before we dispatch the string.
-//   3. Ignore OscInvalid characters.
-//   4. Collect everything else into the OscString
+// - Determines what a state does with a character, for every state that can
+//   decide this from the character alone. This is only evaluated at compile
+//   time, to generate the transition table used by ProcessCharacter.
 // Arguments:
+// - state - The state the character is received in.
 // - wch - Character that triggered the event
 // Return Value:
-// - <none>
-void StateMachine::_EventOscString(const wchar_t wch)
+// - The action to take and the state to move to afterwards.
+constexpr StateMachine::VTTransition StateMachine::_GetTransition(const VTStates state, const wchar_t wch) noexcept
 {
-    _trace.TraceOnEvent(L"OscString");
-    if (_isOscTerminator(wch))
-    {
-        _ActionOscDispatch(wch);
-        _EnterGround();
-    }
-    else if (_isEscape(wch))
-    {
-        _EnterOscTermination();
-    }
-    else if (_isOscInvalid(wch))
-    {
-        _ActionIgnore();
-    }
-    else
+    switch (state)
     {
-        // add this character to our OSC string
-        _ActionOscPut(wch);
-    }
-}
-
-// Routine Description:
-// - Handle the two-character termination of a OSC sequence.
-//   Events in this state will:
-//   1. Trigger the OSC action associated with the param on an OscTerminator
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the Ss3Entry state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   4. Store parameter data
-//   5. Dispatch a control sequence with parameters for action
-//  SS3 sequences are structurally the same as CSI sequences, just with a
-//      different initiation. It's safe to reuse CSI's functions for
-//      determining if a character is a parameter, delimiter, or invalid.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventSs3Entry(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"Ss3Entry");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isCsiInvalid(wch))
-    {
-        // It's safe for us to go into the CSI ignore here, because both SS3 and
-        //      CSI sequences ignore characters the same way.
-        _EnterCsiIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterSs3Param();
-    }
-    else
-    {
-        _ActionSs3Dispatch(wch);
-        _EnterGround();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiParam state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   4. Store parameter data
-//   5. Dispatch a control sequence with parameters for action
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventSs3Param(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"Ss3Param");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-    }
-    else if (_isParameterInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
-        _ActionSs3Dispatch(wch);
-        _EnterGround();
+    case VTStates::Ground:
+        // 1. Execute C0 control characters
+        // 2. Print all other characters
+        if (_isC0Code(wch) || _isDelete(wch))
+        {
+            return { VTAction::Execute, state };
+        }
+        return { VTAction::Print, state };
+    case VTStates::CsiEntry:
+        // 1. Execute C0 control characters
+        // 2. Ignore Delete characters
+        // 3. Collect Intermediate characters
+        // 4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+        // 5. Store parameter data
+        // 6. Collect Control Sequence Private markers
+        // 7. Dispatch a control sequence with parameters for action
+        if (_isC0Code(wch))
+        {
+            return { VTAction::Execute, state };
+        }
+        else if (_isDelete(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        else if (_isIntermediate(wch))
+        {
+            return { VTAction::Collect, VTStates::CsiIntermediate };
+        }
+        else if (_isCsiInvalid(wch))
+        {
+            return { VTAction::None, VTStates::CsiIgnore };
+        }
+        else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { VTAction::Param, VTStates::CsiParam };
+        }
+        else if (_isCsiPrivateMarker(wch))
+        {
+            return { VTAction::Collect, VTStates::CsiParam };
+        }
+        return { VTAction::CsiDispatch, VTStates::Ground };
+    case VTStates::CsiIntermediate:
+        // 1. Execute C0 control characters
+        // 2. Ignore Delete characters
+        // 3. Collect Intermediate characters
+        // 4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+        // 5. Dispatch a control sequence with parameters for action
+        if (_isC0Code(wch))
+        {
+            return { VTAction::Execute, state };
+        }
+        else if (_isIntermediate(wch))
+        {
+            return { VTAction::Collect, state };
+        }
+        else if (_isDelete(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        else if (_isIntermediateInvalid(wch))
+        {
+            return { VTAction::None, VTStates::CsiIgnore };
+        }
+        return { VTAction::CsiDispatch, VTStates::Ground };
+    case VTStates::CsiIgnore:
+        // 1. Execute C0 control characters
+        // 2. Ignore Delete, Intermediate and parameter characters
+        // 3. Return to Ground on anything else
+        if (_isC0Code(wch))
+        {
+            return { VTAction::Execute, state };
+        }
+        else if (_isDelete(wch) || _isIntermediate(wch) || _isIntermediateInvalid(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        return { VTAction::None, VTStates::Ground };
+    case VTStates::CsiParam:
+        // 1. Execute C0 control characters
+        // 2. Ignore Delete characters
+        // 3. Store parameter data
+        // 4. Collect Intermediate characters
+        // 5. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+        // 6. Dispatch a control sequence with parameters for action
+        if (_isC0Code(wch))
+        {
+            return { VTAction::Execute, state };
+        }
+        else if (_isDelete(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { VTAction::Param, state };
+        }
+        else if (_isIntermediate(wch))
+        {
+            return { VTAction::Collect, VTStates::CsiIntermediate };
+        }
+        else if (_isParameterInvalid(wch))
+        {
+            return { VTAction::None, VTStates::CsiIgnore };
+        }
+        return { VTAction::CsiDispatch, VTStates::Ground };
+    case VTStates::OscParam:
+        // 1. Collect numeric values into an Osc Param
+        // 2. Move to the OscString state on a delimiter
+        // 3. Ignore everything else.
+        if (_isOscTerminator(wch))
+        {
+            return { VTAction::None, VTStates::Ground };
+        }
+        else if (_isNumericParamValue(wch))
+        {
+            return { VTAction::OscParam, state };
+        }
+        else if (_isOscDelimiter(wch))
+        {
+            return { VTAction::None, VTStates::OscString };
+        }
+        return { VTAction::Ignore, state };
+    case VTStates::OscString:
+        // 1. Trigger the OSC action associated with the param on an OscTerminator
+        // 2. If we see a ESC, enter the OscTermination state. We'll wait for one
+        //    more character before we dispatch the string.
+        // 3. Ignore OscInvalid characters.
+        // 4. Collect everything else into the OscString
+        if (_isOscTerminator(wch))
+        {
+            return { VTAction::OscDispatch, VTStates::Ground };
+        }
+        else if (_isEscape(wch))
+        {
+            return { VTAction::None, VTStates::OscTermination };
+        }
+        else if (_isOscInvalid(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        return { VTAction::OscPut, state };
+    case VTStates::Ss3Entry:
+        // 1. Execute C0 control characters
+        // 2. Ignore Delete characters
+        // 3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+        // 4. Store parameter data
+        // 5. Dispatch a control sequence with parameters for action
+        // SS3 sequences are structurally the same as CSI sequences, just with a
+        //    different initiation. It's safe to reuse CSI's functions for
+        //    determining if a character is a parameter, delimiter, or invalid.
+        if (_isC0Code(wch))
+        {
+            return { VTAction::Execute, state };
+        }
+        else if (_isDelete(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        else if (_isCsiInvalid(wch))
+        {
+            // It's safe for us to go into the CSI ignore here, because both SS3 and
+            //      CSI sequences ignore characters the same way.
+            return { VTAction::None, VTStates::CsiIgnore };
+        }
+        else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { VTAction::Param, VTStates::Ss3Param };
+        }
+        return { VTAction::Ss3Dispatch, VTStates::Ground };
+    case VTStates::Ss3Param:
+        // 1. Execute C0 control characters
+        // 2. Ignore Delete characters
+        // 3. Store parameter data
+        // 4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+        // 5. Dispatch a control sequence with parameters for action
+        if (_isC0Code(wch))
+        {
+            return { VTAction::Execute, state };
+        }
+        else if (_isDelete(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { VTAction::Param, state };
+        }
+        else if (_isParameterInvalid(wch))
+        {
+            return { VTAction::None, VTStates::CsiIgnore };
+        }
+        return { VTAction::Ss3Dispatch, VTStates::Ground };
+    case VTStates::Vt52Param:
+        // 1. Execute C0 control characters
+        // 2. Ignore Delete characters
+        // 3. Store exactly two parameter characters, then dispatch
+        if (_isC0Code(wch))
+        {
+            return { VTAction::Execute, state };
+        }
+        else if (_isDelete(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        return { VTAction::Vt52Param, state };
+    case VTStates::DcsEntry:
+        // 1. Ignore C0 control characters
+        // 2. Ignore Delete characters
+        // 3. Begin to ignore all remaining characters when an invalid character is detected (DcsIgnore)
+        // 4. Store parameter data
+        // 5. Collect Intermediate characters
+        // 6. Pass through everything else
+        // DCS sequences are structurally almost the same as CSI sequences, just with an
+        //    extra data string. It's safe to reuse CSI functions for
+        //    determining if a character is a parameter, delimiter, or invalid.
+        if (_isC0Code(wch) || _isDelete(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        else if (_isCsiInvalid(wch))
+        {
+            return { VTAction::None, VTStates::DcsIgnore };
+        }
+        else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { VTAction::Param, VTStates::DcsParam };
+        }
+        else if (_isIntermediate(wch))
+        {
+            return { VTAction::Collect, VTStates::DcsIntermediate };
+        }
+        return { VTAction::DcsPassThrough, VTStates::DcsPassThrough };
+    case VTStates::DcsIgnore:
+        // The entire DCS string is considered invalid and we will ignore everything.
+        // The termination state is handled outside when an ESC is seen.
+        return { VTAction::Ignore, state };
+    case VTStates::DcsIntermediate:
+        // 1. Ignore C0 control characters
+        // 2. Ignore Delete characters
+        // 3. Collect intermediate data.
+        // 4. Begin to ignore all remaining intermediates when an invalid character is detected (DcsIgnore)
+        // 5. Pass through everything else.
+        if (_isC0Code(wch) || _isDelete(wch))
+        {
+            return { VTAction::Ignore, state };
+        }
+        else if (_isIntermediate(wch))
+        {
+            return { VTAction::Collect, state };
+        }
+        else if (_isIntermediateInvalid(wch))
+        {
+            return { VTAction::None, VTStates::DcsIgnore };
+        }
+        return { VTAction::DcsPassThrough, VTStates::DcsPassThrough };
+    case VTStates::DcsParam:
+        // 1. Collect DCS parameter data
+        // 2. Enter DcsIntermediate if we see an intermediate
+        // 3. Begin to ignore all remaining parameters when an invalid character is detected (DcsIgnore)
+        // 4. Pass through everything else, including C0 control and Delete characters.
+        if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { VTAction::Param, state };
+        }
+        else if (_isIntermediate(wch))
+        {
+            return { VTAction::Collect, VTStates::DcsIntermediate };
+        }
+        else if (_isParameterInvalid(wch))
+        {
+            return { VTAction::None, VTStates::DcsIgnore };
+        }
+        return { VTAction::DcsPassThrough, VTStates::DcsPassThrough };
+    case VTStates::DcsPassThrough:
+        // 1. Pass through if character is valid.
+        // 2. If we see a ESC, enter the DcsTermination state.
+        // 3. Ignore everything else.
+        if (_isC0Code(wch) || _isDcsPassThroughValid(wch))
+        {
+            return { VTAction::DcsPassThrough, state };
+        }
+        else if (_isEscape(wch))
+        {
+            return { VTAction::None, VTStates::DcsTermination };
+        }
+        return { VTAction::Ignore, state };
+    case VTStates::SosPmApcString:
+        // 1. If we see a ESC, enter the SosPmApcTermination state.
+        // 2. Ignore everything else.
+        if (_isEscape(wch))
+        {
+            return { VTAction::None, VTStates::SosPmApcTermination };
+        }
+        return { VTAction::Ignore, state };
+    case VTStates::Escape:
+    case VTStates::EscapeIntermediate:
+    case VTStates::OscTermination:
+    case VTStates::DcsTermination:
+    case VTStates::SosPmApcTermination:
+        // These depend on the engine and the ANSI mode as well.
+        return { VTAction::Event, state };
+    default:
+        return { VTAction::None, state };
     }
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the Vt52Param state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Store exactly two parameter characters
-//   4. Dispatch a control sequence with parameters for action (always Direct Cursor Address)
+// - Generates the transition table from _GetTransition, with one entry for
+//   every combination of state and character class. Each class is evaluated
+//   with the first character that belongs to it, as all of its characters are
+//   treated the same way.
 // Arguments:
-// - wch - Character that triggered the event
+// - charClasses - The class of each of the first 256 characters.
 // Return Value:
-// - <none>
-void StateMachine::_EventVt52Param(const wchar_t wch)
+// - The transition table, indexed by state and then by character class.
+constexpr StateMachine::VTTransitionTable StateMachine::_BuildTransitionTable(const VTCharClassTable& charClasses) noexcept
 {
-    _trace.TraceOnEvent(L"Vt52Param");
-    if (_isC0Code(wch))
+    VTTransitionTable transitions{};
+    std::array<bool, static_cast<size_t>(VTCharClass::Count)> evaluated{};
+    for (size_t i = 0; i < charClasses.size(); ++i)
     {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else
-    {
-        _parameters.push_back(wch);
-        if (_parameters.size() == 2)
+        const auto charClass = static_cast<size_t>(til::at(charClasses, i));
+        if (til::at(evaluated, charClass))
         {
-            // The command character is processed before the parameter values,
-            // but it will always be 'Y', the Direct Cursor Address command.
-            _ActionVt52EscDispatch(L'Y');
-            _EnterGround();
+            continue;
         }
-    }
-}
+        til::at(evaluated, charClass) = true;
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsEntry state.
-//   Events in this state will:
-//   1. Ignore C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining characters when an invalid character is detected (DcsIgnore)
-//   4. Store parameter data
-//   5. Collect Intermediate characters
-//   6. Pass through everything else
-//  DCS sequences are structurally almost the same as CSI sequences, just with an
-//      extra data string. It's safe to reuse CSI functions for
-//      determining if a character is a parameter, delimiter, or invalid.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventDcsEntry(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"DcsEntry");
-    if (_isC0Code(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isCsiInvalid(wch))
-    {
-        _EnterDcsIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterDcsParam();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterDcsIntermediate();
-    }
-    else
-    {
-        _ActionDcsPassThrough(wch);
-        _EnterDcsPassThrough();
+        for (size_t state = 0; state < transitions.size(); ++state)
+        {
+            til::at(til::at(transitions, state), charClass) = _GetTransition(static_cast<VTStates>(state), gsl::narrow_cast<wchar_t>(i));
+        }
     }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsIgnore state.
-//   In this state the entire DCS string is considered invalid and we will ignore everything.
-//   The termination state is handled outside when an ESC is seen.
-// Arguments:
+    return transitions;
+}
+
+// The names of the states for tracing, in the order of VTStates.
+static constexpr std::array<std::wstring_view, 21> s_stateNames{
+    L"Ground",
+    L"Escape",
+    L"EscapeIntermediate",
+    L"CsiEntry",
+    L"CsiIntermediate",
+    L"CsiIgnore",
+    L"CsiParam",
+    L"OscParam",
+    L"OscString",
+    L"OscTermination",
+    L"Ss3Entry",
+    L"Ss3Param",
+    L"Vt52Param",
+    L"DcsEntry",
+    L"DcsIgnore",
+    L"DcsIntermediate",
+    L"DcsParam",
+    L"DcsPassThrough",
+    L"DcsTermination",
+    L"SosPmApcString",
+    L"SosPmApcTermination"
+};
+
+// Routine Description:
+// - Performs the action of a transition and then moves into its next state.
+// Arguments:
+// - transition - The entry of the transition table for the current state and
+//   the class of the character.
 // - wch - Character that triggered the event
 // Return Value:
 // - <none>
-void StateMachine::_EventDcsIgnore() noexcept
+void StateMachine::_TakeTransition(const VTTransition transition, const wchar_t wch)
 {
-    _trace.TraceOnEvent(L"DcsIgnore");
-    _ActionIgnore();
-}
+    static_assert(s_stateNames.size() == VTStateCount);
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsIntermediate state.
-//   Events in this state will:
-//   1. Ignore C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect intermediate data.
-//   4. Begin to ignore all remaining intermediates when an invalid character is detected (DcsIgnore)
-//   5. Enter DcsPassThrough if we see DCS pass through indicator
-//   6. Pass through everything else.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventDcsIntermediate(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"DcsIntermediate");
-    if (_isC0Code(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-    }
-    else if (_isIntermediateInvalid(wch))
-    {
-        _EnterDcsIgnore();
-    }
-    else
+    const auto state = _state;
+    if (transition.action == VTAction::Event)
     {
-        _ActionDcsPassThrough(wch);
-        _EnterDcsPassThrough();
+        switch (state)
+        {
+        case VTStates::Escape:
+            return _EventEscape(wch);
+        case VTStates::EscapeIntermediate:
+            return _EventEscapeIntermediate(wch);
+        default:
+            return _EventVariableLengthStringTermination(wch);
+        }
     }
-}
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsParam state.
-//   Events in this state will:
-//   1. Ignore C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect DCS parameter data
-//   4. Enter DcsIntermediate if we see an intermediate
-//   5. Begin to ignore all remaining parameters when an invalid character is detected (DcsIgnore)
-//   6. Pass through everything else.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventDcsParam(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"DcsParam");
-    if (_isC0Code(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isDelete(wch))
+    _trace.TraceOnEvent(til::at(s_stateNames, static_cast<size_t>(state)));
+    switch (transition.action)
     {
+    case VTAction::Ignore:
         _ActionIgnore();
-    }
-    if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-    }
-    else if (_isIntermediate(wch))
-    {
+        break;
+    case VTAction::Execute:
+        _ActionExecute(wch);
+        break;
+    case VTAction::Print:
+        _ActionPrint(wch);
+        break;
+    case VTAction::Collect:
         _ActionCollect(wch);
-        _EnterDcsIntermediate();
-    }
-    else if (_isParameterInvalid(wch))
-    {
-        _EnterDcsIgnore();
-    }
-    else
-    {
-        _ActionDcsPassThrough(wch);
-        _EnterDcsPassThrough();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsPassThrough state.
-//   Events in this state will:
-//   1. Pass through if character is valid.
-//   2. If we see a ESC, enter the DcsTermination state.
-//   3. Ignore everything else.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventDcsPassThrough(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"DcsPassThrough");
-    if (_isC0Code(wch) || _isDcsPassThroughValid(wch))
-    {
+        break;
+    case VTAction::Param:
+        _ActionParam(wch);
+        break;
+    case VTAction::CsiDispatch:
+        _ActionCsiDispatch(wch);
+        break;
+    case VTAction::Ss3Dispatch:
+        _ActionSs3Dispatch(wch);
+        break;
+    case VTAction::OscParam:
+        _ActionOscParam(wch);
+        break;
+    case VTAction::OscPut:
+        _ActionOscPut(wch);
+        break;
+    case VTAction::OscDispatch:
+        _ActionOscDispatch(wch);
+        break;
+    case VTAction::DcsPassThrough:
         _ActionDcsPassThrough(wch);
-    }
-    else if (_isEscape(wch))
-    {
-        _EnterDcsTermination();
-    }
-    else
-    {
-        _ActionIgnore();
-    }
-}
-
-// Routine Description:
-// - Handle SOS/PM/APC string.
-//   Events in this state will:
-//   1. If we see a ESC, enter the SosPmApcTermination state.
-//   2. Ignore everything else.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventSosPmApcString(const wchar_t wch) noexcept
-{
-    _trace.TraceOnEvent(L"SosPmApcString");
-    if (_isEscape(wch))
-    {
-        _EnterSosPmApcTermination();
-    }
-    else
-    {
-        _ActionIgnore();
-    }
-}
-
-// Routine Description:
-// - Handle "Variable Length String" termination.
-//   Events in this state will:
-//   1. Trigger the corresponding action and enter ground if we see a string terminator,
-//   2. Otherwise treat this as a normal escape character event.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventVariableLengthStringTermination(const wchar_t wch)
-{
-    if (_isStringTerminatorIndicator(wch))
-    {
-        if (_state == VTStates::OscTermination)
-        {
-            _ActionOscDispatch(wch);
-        }
-        else if (_state == VTStates::DcsTermination)
-        {
-            // TODO:GH#7316: The Dcs sequence has successfully terminated. This is where we'd be dispatching the DCS command.
-        }
-        else if (_state == VTStates::SosPmApcTermination)
-        {
-            // We don't support any SOS/PM/APC control string yet.
-        }
-        _EnterGround();
-    }
-    else
-    {
-        _EnterEscape();
-        _EventEscape(wch);
+        break;
+    case VTAction::Vt52Param:
+        _ActionVt52Param(wch);
+        break;
+    default:
+        break;
+    }
+
+    // Compare against the state we started in, as some dispatches flush to the
+    // terminal and may already have moved us on.
+    if (transition.next != state)
+    {
+        _EnterState(transition.next);
+    }
+}
+
+// Routine Description:
+// - Moves the state machine into the given state, using its _Enter function.
+// Arguments:
+// - state - The state to move into.
+// Return Value:
+// - <none>
+void StateMachine::_EnterState(const VTStates state)
+{
+    switch (state)
+    {
+    case VTStates::Ground:
+        return _EnterGround();
+    case VTStates::Escape:
+        return _EnterEscape();
+    case VTStates::EscapeIntermediate:
+        return _EnterEscapeIntermediate();
+    case VTStates::CsiEntry:
+        return _EnterCsiEntry();
+    case VTStates::CsiIntermediate:
+        return _EnterCsiIntermediate();
+    case VTStates::CsiIgnore:
+        return _EnterCsiIgnore();
+    case VTStates::CsiParam:
+        return _EnterCsiParam();
+    case VTStates::OscParam:
+        return _EnterOscParam();
+    case VTStates::OscString:
+        return _EnterOscString();
+    case VTStates::OscTermination:
+        return _EnterOscTermination();
+    case VTStates::Ss3Entry:
+        return _EnterSs3Entry();
+    case VTStates::Ss3Param:
+        return _EnterSs3Param();
+    case VTStates::Vt52Param:
+        return _EnterVt52Param();
+    case VTStates::DcsEntry:
+        return _EnterDcsEntry();
+    case VTStates::DcsIgnore:
+        return _EnterDcsIgnore();
+    case VTStates::DcsIntermediate:
+        return _EnterDcsIntermediate();
+    case VTStates::DcsParam:
+        return _EnterDcsParam();
+    case VTStates::DcsPassThrough:
+        return _EnterDcsPassThrough();
+    case VTStates::DcsTermination:
+        return _EnterDcsTermination();
+    case VTStates::SosPmApcString:
+        return _EnterSosPmApcString();
+    case VTStates::SosPmApcTermination:
+        return _EnterSosPmApcTermination();
+    default:
+        return;
     }
 }
 
@@ -1733,10 +1830,15 @@ void StateMachine::_EventVariableLengthStringTermination(const wchar_t wch)
 // - <none>
 void StateMachine::ProcessCharacter(const wchar_t wch)
 {
+    static constexpr auto charClasses = _BuildCharClassTable();
+    static constexpr auto transitions = _BuildTransitionTable(charClasses);
+
     _trace.TraceCharInput(wch);
 
+    const auto charClass = wch < charClasses.size() ? til::at(charClasses, wch) : VTCharClass::Other;
+
     // Process "from anywhere" events first.
-    const bool isFromAnywhereChar = (wch == AsciiChars::CAN || wch == AsciiChars::SUB);
+    const bool isFromAnywhereChar = charClass == VTCharClass::CanSub;
 
     // GH#4201 - If this sequence was ^[^X or ^[^Z, then we should
     // _ActionExecuteFromEscape, as to send a Ctrl+Alt+key key. We should only
@@ -1748,7 +1850,7 @@ void StateMachine::ProcessCharacter(const wchar_t wch)
         _EnterGround();
     }
     // Preprocess C1 control characters and treat them as ESC + their 7-bit equivalent.
-    else if (_isC1ControlCharacter(wch))
+    else if (charClass == VTCharClass::C1)
     {
         // When we are in "Variable Length String" state, a C1 control character
         // should effectively acts as an ESC and move us into the corresponding
@@ -1779,60 +1881,15 @@ void StateMachine::ProcessCharacter(const wchar_t wch)
     }
     // Don't go to escape from the "Variable Length String" state - ESC (and C1 String Terminator)
     // can be used to terminate variable length control string.
-    else if (_isEscape(wch) && !_IsVariableLengthStringState())
+    else if (charClass == VTCharClass::Escape && !_IsVariableLengthStringState())
     {
         _EnterEscape();
     }
     else
     {
         // Then pass to the current state as an event
-        switch (_state)
-        {
-        case VTStates::Ground:
-            return _EventGround(wch);
-        case VTStates::Escape:
-            return _EventEscape(wch);
-        case VTStates::EscapeIntermediate:
-            return _EventEscapeIntermediate(wch);
-        case VTStates::CsiEntry:
-            return _EventCsiEntry(wch);
-        case VTStates::CsiIntermediate:
-            return _EventCsiIntermediate(wch);
-        case VTStates::CsiIgnore:
-            return _EventCsiIgnore(wch);
-        case VTStates::CsiParam:
-            return _EventCsiParam(wch);
-        case VTStates::OscParam:
-            return _EventOscParam(wch);
-        case VTStates::OscString:
-            return _EventOscString(wch);
-        case VTStates::OscTermination:
-            return _EventVariableLengthStringTermination(wch);
-        case VTStates::Ss3Entry:
-            return _EventSs3Entry(wch);
-        case VTStates::Ss3Param:
-            return _EventSs3Param(wch);
-        case VTStates::Vt52Param:
-            return _EventVt52Param(wch);
-        case VTStates::DcsEntry:
-            return _EventDcsEntry(wch);
-        case VTStates::DcsIgnore:
-            return _EventDcsIgnore();
-        case VTStates::DcsIntermediate:
-            return _EventDcsIntermediate(wch);
-        case VTStates::DcsParam:
-            return _EventDcsParam(wch);
-        case VTStates::DcsPassThrough:
-            return _EventDcsPassThrough(wch);
-        case VTStates::DcsTermination:
-            return _EventVariableLengthStringTermination(wch);
-        case VTStates::SosPmApcString:
-            return _EventSosPmApcString(wch);
-        case VTStates::SosPmApcTermination:
-            return _EventVariableLengthStringTermination(wch);
-        default:
-            return;
-        }
+        const auto& stateTransitions = til::at(transitions, static_cast<size_t>(_state));
+        _TakeTransition(til::at(stateTransitions, static_cast<size_t>(charClass)), wch);
     }
 }
 // Method Description:
@@ -1924,6 +1981,11 @@ void StateMachine::ProcessString(const std::wstring_view string)
                 start = current;
                 continue;
             }
+            else if (_isGroundScanVectorized)
+            {
+                // Otherwise, add this char and every printable one after it to the current run to be printed.
+                current = _findActionableFromGround(string, current + 1);
+            }
             else
             {
                 ++current; // Otherwise, add this char to the current run to be printed.
@@ -43,6 +43,7 @@ namespace Microsoft::Console::VirtualTerminal
         StateMachine(std::unique_ptr<IStateMachineEngine> engine);
 
         void SetAnsiMode(bool ansiMode) noexcept;
+        void SetVectorizedGroundScan(bool enabled) noexcept;
 
         void ProcessCharacter(const wchar_t wch);
         void ProcessString(const std::wstring_view string);
@@ -68,6 +69,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _ActionOscDispatch(const wchar_t wch);
         void _ActionSs3Dispatch(const wchar_t wch);
         void _ActionDcsPassThrough(const wchar_t wch);
+        void _ActionVt52Param(const wchar_t wch);
 
         void _ActionClear();
         void _ActionIgnore() noexcept;
@@ -94,24 +96,8 @@ namespace Microsoft::Console::VirtualTerminal
         void _EnterSosPmApcString() noexcept;
         void _EnterSosPmApcTermination() noexcept;
 
-        void _EventGround(const wchar_t wch);
         void _EventEscape(const wchar_t wch);
         void _EventEscapeIntermediate(const wchar_t wch);
-        void _EventCsiEntry(const wchar_t wch);
-        void _EventCsiIntermediate(const wchar_t wch);
-        void _EventCsiIgnore(const wchar_t wch);
-        void _EventCsiParam(const wchar_t wch);
-        void _EventOscParam(const wchar_t wch) noexcept;
-        void _EventOscString(const wchar_t wch);
-        void _EventSs3Entry(const wchar_t wch);
-        void _EventSs3Param(const wchar_t wch);
-        void _EventVt52Param(const wchar_t wch);
-        void _EventDcsEntry(const wchar_t wch);
-        void _EventDcsIgnore() noexcept;
-        void _EventDcsIntermediate(const wchar_t wch);
-        void _EventDcsParam(const wchar_t wch);
-        void _EventDcsPassThrough(const wchar_t wch);
-        void _EventSosPmApcString(const wchar_t wch) noexcept;
         void _EventVariableLengthStringTermination(const wchar_t wch);
 
         void _AccumulateTo(const wchar_t wch, size_t& value) noexcept;
@@ -142,6 +128,62 @@ namespace Microsoft::Console::VirtualTerminal
             SosPmApcTermination
         };
 
+        // Characters are sorted into these classes before they're looked up in
+        // the transition table. Every state treats all the characters of a
+        // class the same way.
+        enum class VTCharClass : uint8_t
+        {
+            C0, // 0x00 - 0x1F, except for the ones below
+            Bel, // 0x07
+            CanSub, // 0x18, 0x1A
+            Escape, // 0x1B
+            Intermediate, // 0x20 - 0x2F
+            Digit, // 0x30 - 0x39
+            Colon, // 0x3A
+            Semicolon, // 0x3B
+            PrivateMarker, // 0x3C - 0x3F
+            Final, // 0x40 - 0x7E
+            Delete, // 0x7F
+            C1, // 0x80 - 0x9F
+            Other, // 0xA0 and above
+            Count
+        };
+
+        enum class VTAction : uint8_t
+        {
+            None,
+            Event, // The state depends on more than the character and is handled by its _Event function.
+            Ignore,
+            Execute,
+            Print,
+            Collect,
+            Param,
+            CsiDispatch,
+            Ss3Dispatch,
+            OscParam,
+            OscPut,
+            OscDispatch,
+            DcsPassThrough,
+            Vt52Param
+        };
+
+        struct VTTransition
+        {
+            VTAction action;
+            VTStates next; // Equal to the current state when the state doesn't change.
+        };
+
+        static constexpr size_t VTStateCount = static_cast<size_t>(VTStates::SosPmApcTermination) + 1;
+        using VTCharClassTable = std::array<VTCharClass, 256>;
+        using VTTransitionTable = std::array<std::array<VTTransition, static_cast<size_t>(VTCharClass::Count)>, VTStateCount>;
+
+        static constexpr VTCharClassTable _BuildCharClassTable() noexcept;
+        static constexpr VTTransition _GetTransition(const VTStates state, const wchar_t wch) noexcept;
+        static constexpr VTTransitionTable _BuildTransitionTable(const VTCharClassTable& charClasses) noexcept;
+
+        void _TakeTransition(const VTTransition transition, const wchar_t wch);
+        void _EnterState(const VTStates state);
+
         Microsoft::Console::VirtualTerminal::ParserTracing _trace;
 
         std::unique_ptr<IStateMachineEngine> _engine;
@@ -150,6 +192,10 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _isInAnsiMode;
 
+        // When set, printable runs in the ground state are found a whole
+        // block of characters at a time instead of one character at a time.
+        bool _isGroundScanVectorized;
+
         std::wstring_view _run;
 
         VTIDBuilder _identifier;
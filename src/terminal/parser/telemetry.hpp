@@ -101,6 +101,13 @@ namespace Microsoft::Console::VirtualTerminal
             OSCBG,
             DECALN,
             OSCSCB,
+            DECCRA,
+            DECFRA,
+            DECERA,
+            DECSERA,
+            DECCARA,
+            DECRARA,
+            DECSACE,
             // Only use this last enum as a count of the number of codes.
             NUMBER_OF_CODES
         };
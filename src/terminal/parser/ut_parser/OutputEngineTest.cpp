@@ -1052,6 +1052,9 @@ public:
         _setDefaultBackground(false),
         _defaultBackgroundColor{ RGB(0, 0, 0) },
         _hyperlinkMode{ false },
+        _repeatCharacter{ false },
+        _repeatedChar{ 0 },
+        _repeatCount{ 0 },
         _options{ s_cMaxOptions, static_cast<DispatchTypes::GraphicsOptions>(s_uiGraphicsCleared) }, // fill with cleared option
         _colorTable{},
         _setColorTableEntry{ false }
@@ -1170,6 +1173,14 @@ public:
         return true;
     }
 
+    bool RepeatCharacter(const wchar_t wch, const size_t count) noexcept override
+    {
+        _repeatCharacter = true;
+        _repeatedChar = wch;
+        _repeatCount = count;
+        return true;
+    }
+
     bool InsertCharacter(_In_ size_t const uiCount) noexcept override
     {
         _insertCharacter = true;
@@ -1518,6 +1529,9 @@ public:
     DWORD _defaultBackgroundColor;
     bool _setColorTableEntry;
     bool _hyperlinkMode;
+    bool _repeatCharacter;
+    wchar_t _repeatedChar;
+    size_t _repeatCount;
     std::wstring _copyContent;
     std::wstring _uri;
     std::wstring _customId;
@@ -2687,6 +2701,36 @@ class StateMachineExternalTest final
         pDispatch->ClearState();
     }
 
+    TEST_METHOD(TestRepeatCharacter)
+    {
+        auto dispatch = std::make_unique<StatefulDispatch>();
+        auto pDispatch = dispatch.get();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"REP repeats the last printed character.");
+        mach.ProcessString(L"ab\x1b[5b");
+        VERIFY_IS_TRUE(pDispatch->_repeatCharacter);
+        VERIFY_ARE_EQUAL(L'b', pDispatch->_repeatedChar);
+        VERIFY_ARE_EQUAL(5u, pDispatch->_repeatCount);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"The count defaults to 1.");
+        mach.ProcessString(L"c\x1b[b");
+        VERIFY_IS_TRUE(pDispatch->_repeatCharacter);
+        VERIFY_ARE_EQUAL(L'c', pDispatch->_repeatedChar);
+        VERIFY_ARE_EQUAL(1u, pDispatch->_repeatCount);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Nothing is repeated once another action was dispatched.");
+        mach.ProcessString(L"d\r\x1b[3b");
+        VERIFY_IS_FALSE(pDispatch->_repeatCharacter);
+
+        pDispatch->ClearState();
+    }
+
     TEST_METHOD(TestTabClear)
     {
         auto dispatch = std::make_unique<StatefulDispatch>();
@@ -31,16 +31,23 @@ public:
     void ResetTestState()
     {
         printed.clear();
+        printStringCount = 0;
+        executed.clear();
         passedThrough.clear();
         csiParams.clear();
     }
 
-    bool ActionExecute(const wchar_t /* wch */) override { return true; };
+    bool ActionExecute(const wchar_t wch) override
+    {
+        executed += wch;
+        return true;
+    };
     bool ActionExecuteFromEscape(const wchar_t /* wch */) override { return true; };
     bool ActionPrint(const wchar_t /* wch */) override { return true; };
     bool ActionPrintString(const std::wstring_view string) override
     {
         printed += string;
+        ++printStringCount;
         return true;
     };
 
@@ -107,6 +114,12 @@ public:
 
     // Printed string.
     std::wstring printed;
+
+    // Number of times ActionPrintString was called.
+    size_t printStringCount = 0;
+
+    // Executed control characters.
+    std::wstring executed;
 };
 
 class Microsoft::Console::VirtualTerminal::StateMachineTest
@@ -129,6 +142,7 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(RunStorageBeforeEscape);
     TEST_METHOD(BulkTextPrint);
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
+    TEST_METHOD(VectorizedGroundScanMatchesScalar);
 };
 
 void StateMachineTest::TwoStateMachinesDoNotInterfereWithEachother()
@@ -246,3 +260,51 @@ void StateMachineTest::PassThroughUnhandledSplitAcrossWrites()
     VERIFY_ARE_EQUAL(L"\x1b]99;foo\x1b\\", engine.passedThrough);
     VERIFY_ARE_EQUAL(L"", engine.printed);
 }
+
+// Feeds the string into a new state machine in pieces of the given size and
+// returns the engine that recorded what was dispatched.
+static TestStateMachineEngine _ProcessInChunks(const std::wstring_view string,
+                                               const size_t chunkSize,
+                                               const bool vectorized)
+{
+    StateMachine machine{ std::make_unique<TestStateMachineEngine>() };
+    machine.SetVectorizedGroundScan(vectorized);
+
+    for (size_t offset = 0; offset < string.size(); offset += chunkSize)
+    {
+        machine.ProcessString(string.substr(offset, chunkSize));
+    }
+
+    return std::move(static_cast<TestStateMachineEngine&>(machine.Engine()));
+}
+
+void StateMachineTest::VectorizedGroundScanMatchesScalar()
+{
+    // Put every class of character the ground state cares about at every
+    // position within a block, so each lane of the vectorized scan sees all of
+    // them, and surround it with printable text, sequences and wide glyphs.
+    static constexpr std::wstring_view interesting{ L"\0\a\n\x1b\x1f ~\x7f\x80\x9b\x9f\xa0\xff\x100", 14 };
+    std::wstring corpus;
+    for (const auto wch : interesting)
+    {
+        for (size_t offset = 0; offset < 17; ++offset)
+        {
+            corpus.append(offset, L'x');
+            corpus.push_back(wch);
+            corpus.append(L"\x1b[1;2m日本\U0001F600 text\x1b[m\r\n");
+        }
+    }
+
+    for (const size_t chunkSize : { 1u, 3u, 8u, 61u, 4096u })
+    {
+        Log::Comment(NoThrowString().Format(L"Processing in chunks of %zu characters", chunkSize));
+
+        const auto scalar = _ProcessInChunks(corpus, chunkSize, false);
+        const auto vectorized = _ProcessInChunks(corpus, chunkSize, true);
+
+        VERIFY_ARE_EQUAL(scalar.printed, vectorized.printed);
+        VERIFY_ARE_EQUAL(scalar.printStringCount, vectorized.printStringCount);
+        VERIFY_ARE_EQUAL(scalar.executed, vectorized.executed);
+        VERIFY_ARE_EQUAL(scalar.csiParams, vectorized.csiParams);
+    }
+}
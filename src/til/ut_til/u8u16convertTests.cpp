@@ -17,6 +17,9 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestU8ToU16Invalid);
+    TEST_METHOD(TestU16ToU8Invalid);
+    TEST_METHOD(TestAsciiRuns);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +194,83 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+void Utf8Utf16ConvertTests::TestU8ToU16Invalid()
+{
+    // clang-format off
+    const std::string u8String{
+        '\x41',
+        '\x80',                 // lone continuation byte
+        '\xC0', '\xAF',         // overlong '/' (C0 is never valid)
+        '\xE0', '\x80', '\xAF', // overlong '/' (E0 requires A0..BF)
+        '\xED', '\xA0', '\x80', // encoded surrogate U+D800
+        '\xF4', '\x90', '\x80', '\x80', // > U+10FFFF
+        '\xE2', '\x82',         // truncated EURO SIGN followed by ASCII
+        '\x42',
+        '\xF0', '\x9F', '\x93'  // truncated CAMERA at the end
+    };
+
+    const std::wstring u16StringComp{
+        L'A',
+        0xFFFD,
+        0xFFFD, 0xFFFD,
+        0xFFFD, 0xFFFD, 0xFFFD,
+        0xFFFD, 0xFFFD, 0xFFFD,
+        0xFFFD, 0xFFFD, 0xFFFD, 0xFFFD,
+        0xFFFD, // a valid prefix is replaced as a whole
+        L'B',
+        0xFFFD
+    };
+    // clang-format on
+
+    std::wstring u16Out{};
+    VERIFY_ARE_EQUAL(S_OK, til::u8u16(u8String, u16Out));
+    VERIFY_ARE_EQUAL(u16StringComp, u16Out);
+}
+
+void Utf8Utf16ConvertTests::TestU16ToU8Invalid()
+{
+    const std::wstring u16String{
+        gsl::narrow_cast<wchar_t>(0xDF5CU), // low surrogate only
+        gsl::narrow_cast<wchar_t>(0x0041U),
+        gsl::narrow_cast<wchar_t>(0xD853U), // high surrogate followed by a non-surrogate
+        gsl::narrow_cast<wchar_t>(0x0042U),
+        gsl::narrow_cast<wchar_t>(0xD853U) // high surrogate at the end
+    };
+
+    const std::string u8StringComp{
+        '\xEF', '\xBF', '\xBD',
+        '\x41',
+        '\xEF', '\xBF', '\xBD',
+        '\x42',
+        '\xEF', '\xBF', '\xBD'
+    };
+
+    std::string u8Out{};
+    VERIFY_ARE_EQUAL(S_OK, til::u16u8(u16String, u8Out));
+    VERIFY_ARE_EQUAL(u8StringComp, u8Out);
+}
+
+void Utf8Utf16ConvertTests::TestAsciiRuns()
+{
+    // ASCII runs are converted in blocks. Place a non-ASCII character
+    // at every offset around the block size to cover the transitions.
+    for (size_t prefix = 0; prefix < 40; ++prefix)
+    {
+        std::wstring u16String(prefix, L'x');
+        u16String += gsl::narrow_cast<wchar_t>(0x20ACU); // EURO SIGN
+        u16String.append(prefix, L'y');
+
+        std::string u8StringComp(prefix, 'x');
+        u8StringComp += "\xE2\x82\xAC";
+        u8StringComp.append(prefix, 'y');
+
+        std::string u8Out{};
+        VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out));
+        VERIFY_ARE_EQUAL(u8StringComp, u8Out);
+
+        std::wstring u16Out{};
+        VERIFY_SUCCEEDED(til::u8u16(u8Out, u16Out));
+        VERIFY_ARE_EQUAL(u16String, u16Out);
+    }
+}
@@ -4,6 +4,11 @@
 #include "precomp.h"
 #include "inc/CodepointWidthDetector.hpp"
 
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#include <emmintrin.h>
+#endif
+
 namespace
 {
     // used to store range data in CodepointWidthDetector's internal map
@@ -321,6 +326,131 @@ namespace
         UnicodeRange{ 0xf0000, 0xffffd, CodepointWidth::Ambiguous },
         UnicodeRange{ 0x100000, 0x10fffd, CodepointWidth::Ambiguous },
     };
+
+    // Widths are looked up in two stages that are built from the table above
+    // at compile time. The high bits of a codepoint select a block of 128
+    // codepoints, and the low bits select the width within that block.
+    // Blocks whose codepoints all have the same width share one block, so
+    // only the blocks at the edges of the ranges above need their own.
+    static constexpr unsigned int s_blockShift = 7;
+    static constexpr unsigned int s_blockSize = 1u << s_blockShift;
+    static constexpr unsigned int s_codepointLimit = 0x110000;
+    static constexpr size_t s_blockCount = s_codepointLimit >> s_blockShift;
+
+    // The blocks whose codepoints are all Narrow, Wide or Ambiguous come
+    // first, at the index of their width.
+    static constexpr size_t s_uniformBlockCount = 3;
+    static_assert(static_cast<size_t>(CodepointWidth::Narrow) < s_uniformBlockCount);
+    static_assert(static_cast<size_t>(CodepointWidth::Wide) < s_uniformBlockCount);
+    static_assert(static_cast<size_t>(CodepointWidth::Ambiguous) < s_uniformBlockCount);
+
+    // Walks the blocks in order and calls the function with each block and
+    // the width all of its codepoints share, or Invalid if they differ.
+    // Along the way, firstRange is the first range that doesn't end before
+    // the block, which is where looking up the block's codepoints starts.
+    template<typename Function>
+    static constexpr void s_visitBlocks(Function&& function)
+    {
+        size_t firstRange = 0;
+        for (size_t block = 0; block < s_blockCount; ++block)
+        {
+            const auto first = gsl::narrow_cast<unsigned int>(block << s_blockShift);
+            const auto last = first + s_blockSize - 1;
+            while (firstRange < s_wideAndAmbiguousTable.size() && til::at(s_wideAndAmbiguousTable, firstRange).upperBound < first)
+            {
+                ++firstRange;
+            }
+
+            auto width = CodepointWidth::Invalid;
+            if (firstRange == s_wideAndAmbiguousTable.size() || til::at(s_wideAndAmbiguousTable, firstRange).lowerBound > last)
+            {
+                width = CodepointWidth::Narrow;
+            }
+            else if (til::at(s_wideAndAmbiguousTable, firstRange).lowerBound <= first && til::at(s_wideAndAmbiguousTable, firstRange).upperBound >= last)
+            {
+                width = til::at(s_wideAndAmbiguousTable, firstRange).width;
+            }
+            function(block, width, firstRange);
+        }
+    }
+
+    static constexpr size_t s_countMixedBlocks()
+    {
+        size_t count = 0;
+        s_visitBlocks([&](size_t, const CodepointWidth width, size_t) {
+            if (width == CodepointWidth::Invalid)
+            {
+                ++count;
+            }
+        });
+        return count;
+    }
+
+    static constexpr size_t s_mixedBlockCount = s_countMixedBlocks();
+    static_assert(s_uniformBlockCount + s_mixedBlockCount <= UINT8_MAX, "A block index needs to fit into the first stage");
+
+    struct WidthStages final
+    {
+        std::array<uint8_t, s_blockCount> blocks;
+        std::array<CodepointWidth, (s_uniformBlockCount + s_mixedBlockCount) * s_blockSize> widths;
+    };
+
+    static constexpr WidthStages s_buildWidthStages()
+    {
+        WidthStages stages{};
+        for (size_t i = 0; i < s_uniformBlockCount * s_blockSize; ++i)
+        {
+            til::at(stages.widths, i) = static_cast<CodepointWidth>(i / s_blockSize);
+        }
+
+        auto nextBlock = s_uniformBlockCount;
+        s_visitBlocks([&](const size_t block, const CodepointWidth width, size_t range) {
+            if (width != CodepointWidth::Invalid)
+            {
+                til::at(stages.blocks, block) = static_cast<uint8_t>(width);
+                return;
+            }
+
+            til::at(stages.blocks, block) = static_cast<uint8_t>(nextBlock);
+            const auto first = gsl::narrow_cast<unsigned int>(block << s_blockShift);
+            for (unsigned int i = 0; i < s_blockSize; ++i)
+            {
+                const auto codepoint = first + i;
+                while (range < s_wideAndAmbiguousTable.size() && til::at(s_wideAndAmbiguousTable, range).upperBound < codepoint)
+                {
+                    ++range;
+                }
+                const auto inRange = range < s_wideAndAmbiguousTable.size() && til::at(s_wideAndAmbiguousTable, range).lowerBound <= codepoint;
+                til::at(stages.widths, nextBlock * s_blockSize + i) = inRange ? til::at(s_wideAndAmbiguousTable, range).width : CodepointWidth::Narrow;
+            }
+            ++nextBlock;
+        });
+        return stages;
+    }
+
+    static constexpr WidthStages s_widthStages = s_buildWidthStages();
+
+    static constexpr CodepointWidth s_lookupCodepointWidth(const unsigned int codepoint) noexcept
+    {
+        if (codepoint >= s_codepointLimit)
+        {
+            return CodepointWidth::Narrow;
+        }
+        const size_t block = til::at(s_widthStages.blocks, codepoint >> s_blockShift);
+        return til::at(s_widthStages.widths, (block << s_blockShift) | (codepoint & (s_blockSize - 1)));
+    }
+
+    static_assert(s_lookupCodepointWidth(0x20) == CodepointWidth::Narrow);
+    static_assert(s_lookupCodepointWidth(0xa1) == CodepointWidth::Ambiguous);
+    static_assert(s_lookupCodepointWidth(0xa2) == CodepointWidth::Narrow);
+    static_assert(s_lookupCodepointWidth(0x1104) == CodepointWidth::Wide);
+    static_assert(s_lookupCodepointWidth(0x1f922) == CodepointWidth::Wide);
+    static_assert(s_lookupCodepointWidth(0x10fffd) == CodepointWidth::Ambiguous);
+    static_assert(s_lookupCodepointWidth(0x10fffe) == CodepointWidth::Narrow);
+
+    // Every code unit below the first entry of the table is narrow.
+    static constexpr wchar_t s_firstNonNarrowCodeUnit = 0xa1;
+    static_assert(s_wideAndAmbiguousTable.front().lowerBound == s_firstNonNarrowCodeUnit);
 }
 
 // Routine Description:
@@ -403,6 +533,75 @@ bool CodepointWidthDetector::IsWide(const std::wstring_view glyph) const
     return GetWidth(glyph) == CodepointWidth::Wide;
 }
 
+// Routine Description:
+// - measures how many columns a run of text takes up, where every wide codepoint
+//   takes up two columns and every other codepoint one. Surrogate pairs are
+//   measured as one codepoint.
+// - Code units below U+00A1 are all narrow. On x86/x64 they're skipped 8 at a time
+//   with SSE2, so ASCII and most Latin-1 text is measured without any lookups.
+// Arguments:
+// - text - the utf16 encoded text to measure
+// Return Value:
+// - the number of columns the text takes up
+size_t CodepointWidthDetector::MeasureColumns(const std::wstring_view text) const
+{
+    static_assert(sizeof(wchar_t) == sizeof(uint16_t), "The vectorized scan compares 16-bit code units");
+
+    const auto size = text.size();
+    size_t columns = 0;
+    size_t offset = 0;
+
+#if defined(_M_X64) || defined(_M_IX86)
+    const auto narrowLast = _mm_set1_epi16(s_firstNonNarrowCodeUnit - 1);
+    const auto zero = _mm_setzero_si128();
+#endif
+
+    while (offset < size)
+    {
+#if defined(_M_X64) || defined(_M_IX86)
+        for (; offset + 8 <= size; offset += 8)
+        {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. We're reading a block of 8 characters we already bounds checked.
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast. Required to load into an SSE register.
+            const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + offset));
+
+            // An unsigned saturating subtraction only yields zero when wch <= 0xA0.
+            const auto isNarrow = _mm_cmpeq_epi16(_mm_subs_epu16(chars, narrowLast), zero);
+            const auto mask = gsl::narrow_cast<unsigned long>(_mm_movemask_epi8(isNarrow));
+            if (mask != 0xFFFF)
+            {
+                // The mask has two bits for every 16-bit character.
+                unsigned long index = 0;
+                _BitScanForward(&index, ~mask);
+                columns += index / 2;
+                offset += index / 2;
+                break;
+            }
+            columns += 8;
+        }
+#endif
+
+        // Measure one codepoint at a time until we get back to a narrow code unit.
+        while (offset < size)
+        {
+            const auto wch = til::at(text, offset);
+            if (wch < s_firstNonNarrowCodeUnit)
+            {
+                ++columns;
+                ++offset;
+                break;
+            }
+
+            const auto isPair = IS_HIGH_SURROGATE(wch) && offset + 1 < size && IS_LOW_SURROGATE(til::at(text, offset + 1));
+            const size_t glyphSize = isPair ? 2 : 1;
+            columns += IsWide(text.substr(offset, glyphSize)) ? 2 : 1;
+            offset += glyphSize;
+        }
+    }
+
+    return columns;
+}
+
 // Routine Description:
 // - returns the width type of codepoint by searching the map generated from the unicode spec
 // Arguments:
@@ -416,7 +615,19 @@ CodepointWidth CodepointWidthDetector::_lookupGlyphWidth(const std::wstring_view
         return CodepointWidth::Invalid;
     }
 
-    const auto codepoint = _extractCodepoint(glyph);
+    return s_lookupCodepointWidth(_extractCodepoint(glyph));
+}
+
+// Routine Description:
+// - returns the width type of codepoint by binary searching the ranges generated from the unicode spec
+//   that the lookup stages are built from. This is how widths used to be looked up, and the result
+//   must always match the one of _lookupGlyphWidth.
+// Arguments:
+// - codepoint - the codepoint to search for
+// Return Value:
+// - the width type of the codepoint
+CodepointWidth CodepointWidthDetector::_lookupCodepointWidthInRanges(const unsigned int codepoint) noexcept
+{
     const auto it = std::lower_bound(s_wideAndAmbiguousTable.begin(), s_wideAndAmbiguousTable.end(), codepoint);
 
     // For characters that are not _in_ the table, lower_bound will return the nearest item that is.
@@ -476,9 +687,9 @@ CodepointWidth CodepointWidthDetector::_lookupGlyphWidthWithCache(const std::wst
 // - true if codepoint is wide or false if it is narrow
 bool CodepointWidthDetector::_checkFallbackViaCache(const std::wstring_view glyph) const
 {
-    const std::wstring findMe{ glyph };
+    // The cache is keyed by codepoint, so looking up a glyph doesn't allocate.
+    const auto findMe = _extractCodepoint(glyph);
 
-    // TODO: Cache needs to be emptied when font changes.
     const auto it = _fallbackCache.find(findMe);
     if (it == _fallbackCache.end())
     {
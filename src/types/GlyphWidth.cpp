@@ -25,6 +25,14 @@ bool IsGlyphFullWidth(const wchar_t wch) noexcept
     return widthDetector.IsWide(wch);
 }
 
+// Function Description:
+// - measures how many columns a run of text takes up, with wide glyphs taking
+//      up two columns. See CodepointWidthDetector::MeasureColumns
+size_t MeasureGlyphColumns(const std::wstring_view text)
+{
+    return widthDetector.MeasureColumns(text);
+}
+
 // Function Description:
 // - Sets a function that should be used by the global CodepointWidthDetector
 //      as the fallback mechanism for determining a particular glyph's width,
@@ -34,6 +34,12 @@ static const WORD leftShiftScanCode = 0x2A;
         return {};
     }
 
+    // UTF-8 is transcoded by til in a single pass rather than two Mb2Wc calls.
+    if (codePage == CP_UTF8)
+    {
+        return til::u8u16(source);
+    }
+
     int iSource; // convert to int because Mb2Wc requires it.
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 
@@ -79,6 +85,12 @@ static const WORD leftShiftScanCode = 0x2A;
         return {};
     }
 
+    // UTF-8 is transcoded by til in a single pass rather than two Wc2Mb calls.
+    if (codepage == CP_UTF8)
+    {
+        return til::u16u8(source);
+    }
+
     int iSource; // convert to int because Wc2Mb requires it.
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 